@@ -0,0 +1,1039 @@
+// checks for the parts of crawl.exe the benchmarks link against, builds with bench/Makefile on Linux, make check runs it from the bench
+// directory over the python.org snapshots in pages/.
+//
+// crawl-check [page.html]...
+//
+// kernels   scan_pair_scalar, scan_pair_sse2 and scan_pair_avx2 (where the CPU has AVX2) must find the same "<h" and "<a" in every page,
+//           from every offset to every end up to CHECK_KERNEL_WINDOW bytes after it and to the end of the page, and in small buffers from
+//           every offset to every end: with a single pair at each offset, across the 16 and 32 byte strides of the vector kernels, with
+//           the '<' in the last byte of the range and the second byte right past it, and with nothing but pair characters.
+// baseline  locate_stable_releases_htmldiv and parse_stable_releases must agree with the byte at a time loops they had before scan_pair: the
+//           same stable releases section, and the same amd64 installers in the same order.
+// stream    every page is pushed through the streaming parser in pieces of random sizes, CHECK_STREAM_ROUNDS times over for each of the piece
+//           size limits down to a single byte, and must come out with exactly the releases parse_stable_releases finds in the whole page.
+// socket    every page is fetched through the socket transport from a server on a loopback port of its own, the server running on a thread of
+//           crawl-check itself. the page must arrive byte for byte delimited by its Content-Length, in chunks of random sizes with chunk extensions
+//           and a trailer, and read until the server closes the connection. the second request on a kept-alive connection must reuse it, a
+//           request the server drops unanswered on a pooled connection must go out again on a fresh one, and a 404 must fail the read.
+// cache     every page is fetched from a route that sends validators, parsed and stored in the response cache, and then revalidated the
+//           way crawl.exe does it: requests with the cached ETag or Last-Modified must come back 304 with an empty body and leave the cached
+//           releases to be used as they were loaded, a request after the page changed must bring the whole page and the new ETag.
+// inflate   the compressed pages in fixtures/ are inflated in pieces of random sizes down to a single byte and must come out as the pages
+//           they were made from. a flipped bit in the checksum and streams cut short must fail, and the fixtures served with their
+//           Content-Encoding, chunked and with a length, must arrive inflated through the socket transport.
+// guard     every page, cut down to a whole number of memory pages with a '<' in its last byte, is located and parsed right in front of a
+//           memory page that can't be read, the way replay.c parses a mapped file. the scans must keep to the page and find its releases.
+// digest    MD5 and SHA-256 must come out as published for the test vectors of RFC 1321 and FIPS 180-2, and as python's hashlib has them for
+//           a pattern cut right before, at and after every block edge the padding cares about, fed in one go and in pieces of random sizes.
+// release   parse_release_files must find every file of the saved release page fixtures/release-python-3130.html with the MD5 sum of its
+//           row and skip the signatures, Sigstore bundles and SBOMs linked around them, and keep the SHA-256 of a row that has both.
+//
+// make check runs the checks a second time in crawl-check-scalar, built with CRAWL_FORCE_SCALAR_SCAN and CRAWL_FORCE_SCALAR_DIGEST, so that
+// the parsers and SHA-256 go through the portable kernels there and SHA-NI answers to the same digests in crawl-check. the pieces and the
+// chunks come from a fixed seed, so a failure reproduces run after run. the transport reports the 404 like any other and the decoder the
+// broken streams, those messages are expected. prints what failed and exits with 1 if anything did.
+
+#include <poll.h>
+#include <stdatomic.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <project.h> // after the system headers, it redefines malloc and friends in this project
+
+#define CHECK_PADDING         16LLU                 // zeroed bytes after a page, the kernels read a byte past a scan and the baseline loops 9
+#define CHECK_KERNEL_WINDOW   80LLU                 // ends after every offset of a page the kernels are compared at, past two AVX2 strides
+#define CHECK_KERNEL_STARTS   64LLU                 // offsets of a page the kernels also scan to the end of the page from
+#define CHECK_SYNTHETIC_SIZE  100LLU                // bytes of the small buffers the kernels are compared over every range of
+#define CHECK_MAX_RELEASES    1024LLU               // amd64 installers the baseline parse finds in a page at most
+#define CHECK_STREAM_ROUNDS   4LLU                  // runs over each page for every piece size limit above 1
+#define CHECK_SEED            0x9E3779B97F4A7C15LLU // seed of the piece and chunk sizes
+#define CHECK_CHUNKED_ROUNDS  4LLU                  // fetches of a page in chunks, each cut differently
+#define CHECK_MAX_CHUNK       3000LLU               // largest chunk the local server cuts a chunked body into
+#define CHECK_MAX_ROUTES      8LLU                  // paths the local server answers at most
+#define CHECK_MAX_CONNECTIONS 16LLU                 // connections the local server keeps open at once
+#define CHECK_REQUEST_SIZE    8192LLU               // most bytes a request to the local server may take up
+#define CHECK_POLL_INTERVAL   20                    // milliseconds the local server waits for anything to happen before it checks for a stop
+#define CHECK_DIGEST_PATTERN  1000LLU               // bytes of the pattern the digests are checked over, the longest vector
+#define CHECK_DIGEST_ROUNDS   8LLU                  // feeds of every vector in pieces, for each of the piece size limits
+
+// a compressed page in fixtures/
+typedef struct _check_fixture {
+        const char*      name;     // the compressed page
+        const char*      page;     // the page it inflates to
+        inflate_format_t format;   // container around the DEFLATE stream
+        const char*      encoding; // Content-Encoding the local server sends it with
+} check_fixture_t;
+
+// the python.org snapshots in pages/
+static const char* const default_pages[] = { "pages/downloads-windows-2024-05-24.html", "pages/downloads-windows-2024-10-07.html" };
+
+// largest pieces the stream check cuts a page into, single bytes, pieces that end mid tag, about a packet, a slab and whole staging windows
+static const unsigned long piece_limits[] = { 1, 3, 17, 1500, HTTP_CHUNK_SIZE, STREAM_STAGING_SIZE + 1 };
+
+// the pages compressed with gzip -9 (with the file name in the header), zlib's default level, nothing but fixed Huffman codes and nothing
+// but stored blocks, every container and block type the decoder knows between them
+static const check_fixture_t fixtures[] = {
+    { .name = "fixtures/downloads-windows-2024-10-07.html.gz",
+      .page = "pages/downloads-windows-2024-10-07.html", .format = INFLATE_GZIP, .encoding = "gzip" },
+    { .name = "fixtures/downloads-windows-2024-05-24.html.deflate",
+      .page = "pages/downloads-windows-2024-05-24.html", .format = INFLATE_ZLIB, .encoding = "deflate" },
+    { .name = "fixtures/downloads-windows-2024-05-24.html.fixed.deflate",
+      .page = "pages/downloads-windows-2024-05-24.html", .format = INFLATE_ZLIB, .encoding = "deflate" },
+    { .name = "fixtures/downloads-windows-2024-10-07.html.stored.deflate",
+      .page = "pages/downloads-windows-2024-10-07.html", .format = INFLATE_ZLIB, .encoding = "deflate" },
+};
+
+// MD5 and SHA-256 of a message, the digests of the pattern come from python's hashlib
+typedef struct _check_vector {
+        const char*   message; // NULL for the first size bytes of the pattern, byte i of which is i * 7 + 1
+        unsigned long size;    // bytes of the message
+        const char*   md5;     // 32 hex digits
+        const char*   sha256;  // 64 hex digits
+} check_vector_t;
+
+// "abc" and the 448 bit message of the standards, and the pattern around the edges of a block: up to 55 bytes the padding and the length
+// fit after the message in its last block, from 56 on they spill into one more
+static const check_vector_t vectors[] = {
+    { .message = "abc", .size = 3,
+      .md5 = "900150983cd24fb0d6963f7d28e17f72", .sha256 = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { .message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", .size = 56,
+      .md5 = "8215ef0796a20bcaaae116d3876c664a", .sha256 = "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { .size = 0, .md5 = "d41d8cd98f00b204e9800998ecf8427e", .sha256 = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { .size = 1, .md5 = "55a54008ad1ba589aa210d2629c1df41", .sha256 = "4bf5122f344554c53bde2ebb8cd2b7e3d1600ad631c385a5d7cce23c7785459a" },
+    { .size = 55, .md5 = "8c3eb046bcdb1f0ffe75fdbaf890cf13", .sha256 = "16fa57a0a3423a715d594516339f36189d6b5f93754a9714fef202616a9fabfe" },
+    { .size = 56, .md5 = "d5e0fa3122448ddd3d843a9c5ed9e839", .sha256 = "c37b44e5f1b18554b36966f4f8e08bfbf3164c4b6c10374d12d89850892073c5" },
+    { .size = 57, .md5 = "839d97df06aa4f2d02f931151a66111d", .sha256 = "12b234922502022f755ab8550a3d4e202ad39c81d961a4f59ec39d5fd83d15a7" },
+    { .size = 63, .md5 = "1dd0d6ddeb881b118518c2881555f34b", .sha256 = "bbba992d2c85af960fb2987a1fd05e0aa82a3db3c740dd8982a9e273b75e36a3" },
+    { .size = 64, .md5 = "7b412e00d38c31b0845a4f502d39d5e3", .sha256 = "66bd4633ed6f71c4ecfa4763bf7ba1c8ec7612de9aa6c0578a7b675207c71e0b" },
+    { .size = 65, .md5 = "ba03b626aceb7b09c86c2d544afe1dce", .sha256 = "9f7dc47107b750a1f3d35db5d9547f24ef40da5b731b9540d4f43710a154f6c9" },
+    { .size = 119, .md5 = "dac58560b386c3d5b29ebbdec5197e10", .sha256 = "a3ed307b730fa77c07531300c6e4a282330011d4d4caf6bb7b63ae05950f4b66" },
+    { .size = 120, .md5 = "6818845a0494b5fade3155f6a8e47b15", .sha256 = "8e3b15d9fea7472655aa069620b7f8c2e55ee1499f763200a7515fe826e99d20" },
+    { .size = 127, .md5 = "84c7b17567b70836d3b39cd28d4631b8", .sha256 = "44480fb9672845177f5368a08b69ea263275f2a5ec42e06a933370fe0d2968a4" },
+    { .size = 128, .md5 = "912f49566518d1b4c883f811d86ddecc", .sha256 = "e462c130fef8c97e34f7dc3ff3ad2f8b3533ab849af21c10531552a2852387a4" },
+    { .size = 129, .md5 = "523874fe6549e794ae5195fc606bf474", .sha256 = "aa7ea4e8bf89146aeb67ff195fd8182a0e504c9d580aa7af8d2c862e14b98405" },
+    { .size = 1000, .md5 = "7874d3c13d4ed33f057def947e0621ef", .sha256 = "095ecb62e30793ab4b954cd6a0586d0cc91f7ea5b1332694d8da780e98676d78" },
+};
+
+// largest pieces the digests are fed in, single bytes, pieces that straddle the blocks, whole blocks and several blocks at once
+static const unsigned long digest_limits[] = { 1, 7, 63, 64, 65, 200 };
+
+// the release page and the files of its table with the MD5 sums of their rows, in the order they're listed
+static const char* const release_page = "fixtures/release-python-3130.html";
+
+static const char* const release_files[][2] = {
+    { "Python-3.13.0.tgz", "d6ce5d2720ae8cd60d11ca6fb62d6c82" },
+    { "Python-3.13.0.tar.xz", "b21642c2662e6df22110e86feae9285e" },
+    { "python-3.13.0-macos11.pkg", "efc5f6e1a98ba3c9fe2badffbe8b81b1" },
+    { "python-3.13.0-amd64.exe", "08ad7800ac8d55bb8f3aae0064eefd81" },
+    { "python-3.13.0-arm64.exe", "f891d9902f9bf43131ba64decfc85172" },
+    { "python-3.13.0-embed-amd64.zip", "08472cbeba5e77cba66de59b4f9d7f81" },
+    { "python-3.13.0-embed-arm64.zip", "1a6f1c7a7111a0cbea5e08c0cc7152c8" },
+    { "python-3.13.0-embed-win32.zip", "999cdda726a0cde9e7eceb5ba0ad0b76" },
+    { "python-3.13.0.exe", "6e13f6b21d3879e464ff7ef962e338fa" },
+};
+
+static unsigned long failures = 0;
+
+#define expect(condition, ...)                                                                                                                    \
+    do {                                                                                                                                          \
+        if (!(condition)) {                                                                                                                       \
+            fwprintf_s(stderr, L"FAILED %S:%d: ", __FILE__, __LINE__);                                                                            \
+            fwprintf_s(stderr, __VA_ARGS__);                                                                                                      \
+            fputwc(L'\n', stderr);                                                                                                                \
+            failures++;                                                                                                                           \
+        }                                                                                                                                         \
+    } while (0)
+
+// a page and the releases parse_stable_releases finds in it, which everything else has to agree with
+typedef struct _check_page {
+        const char*   name;     // file the page was read from
+        char*         html;     // the page
+        unsigned long size;     // size of the page
+        results_t     releases; // parsed out of the whole page in one go, borrowing html
+} check_page_t;
+
+// how the local server tells where the body of a response ends
+typedef enum _check_framing {
+    CHECK_FRAMING_LENGTH,  // Content-Length
+    CHECK_FRAMING_CHUNKED, // Transfer-Encoding: chunked
+    CHECK_FRAMING_CLOSE,   // neither, the server closes the connection after the body
+} check_framing_t;
+
+// a path the local server answers and what with
+typedef struct _check_route {
+        const char*     path;     // request target
+        check_framing_t framing;  // how the body is delimited
+        const char*     body;     // the body
+        unsigned long   size;     // size of the body
+        const char*     etag;     // ETag sent with the body and compared with If-None-Match, NULL for none
+        const char*     date;     // Last-Modified sent with the body and compared with If-Modified-Since, NULL for none
+        const char*     encoding; // Content-Encoding of the body, NULL for none
+        bool            is_idle;  // a second request on a connection is dropped unanswered, the way a server closes an idle connection
+} check_route_t;
+
+// a connection to the local server and the request it's receiving
+typedef struct _check_connection {
+        int           socket;                      // -1 for a free slot
+        unsigned long filled;                      // bytes of the request received so far
+        unsigned long answered;                    // requests answered on the connection
+        char          request[CHECK_REQUEST_SIZE]; // the request line and headers, up to the empty line
+} check_connection_t;
+
+// an HTTP/1.1 server on a loopback port, serving on a thread of its own from start_server to stop_server. the routes are set before the
+// requests go out
+typedef struct _check_server {
+        int                listener;                           // listening socket
+        unsigned short     port;                               // port it listens on, picked by the OS
+        atomic_bool        is_stopping;                        // set by stop_server
+        check_route_t      routes[CHECK_MAX_ROUTES];           // what it answers, a 404 for everything else
+        unsigned long      nroutes;                            // number of routes
+        unsigned long      dropped;                            // requests dropped unanswered, see check_route_t
+        unsigned long long state;                              // where the sizes of the chunks come from
+        check_connection_t connections[CHECK_MAX_CONNECTIONS]; // open connections
+        task_t             task;                               // the thread it serves on
+} check_server_t;
+
+// xorshift64, plenty random for cutting pages into pieces
+static unsigned long long __cdecl next_random(_Inout_ unsigned long long* const restrict state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// the same releases in the same order, wherever their text lives
+static bool __cdecl is_same_releases(_In_ const results_t left, _In_ const results_t right) {
+    if (left.count != right.count) return false;
+    for (unsigned long i = 0; i < left.count; ++i) {
+        const span_t lv = left.versions[i], rv = right.versions[i], lu = left.downloadurls[i], ru = right.downloadurls[i]; // NOLINT
+        if (lv.length != rv.length || lu.length != ru.length || left.kinds[i] != right.kinds[i]) return false;
+        if (memcmp(left.text + lv.offset, right.text + rv.offset, lv.length)) return false;
+        if (memcmp(left.text + lu.offset, right.text + ru.offset, lu.length)) return false;
+    }
+    return true;
+}
+
+// reads a whole file followed by CHECK_PADDING zeroes, the caller frees the returned buffer. NULL when it can't be read or is empty
+static char* __cdecl read_file(_In_ const char* const restrict filename, _Inout_ unsigned long* const restrict size) {
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb")) {
+        fwprintf_s(stderr, L"Error: could not open %S!\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* contents = length > 0 ? calloc((size_t) length + CHECK_PADDING, 1) : NULL;
+    if (contents && fread(contents, 1, (size_t) length, file) != (size_t) length) {
+        free(contents);
+        contents = NULL;
+    }
+    fclose(file);
+    *size = contents ? (unsigned long) length : 0;
+    return contents;
+}
+
+// reads a page and parses it the one-shot way, the page must have stable releases for the checks to make any sense
+static bool __cdecl load_page(_In_ const char* const restrict filename, _Inout_ check_page_t* const restrict page) {
+    unsigned long size = 0;
+    char* const   html = read_file(filename, &size);
+    *page              = (check_page_t) { .name = filename, .html = html, .size = size };
+    if (html) {
+        const range_t stable = locate_stable_releases_htmldiv(page->html, page->size);
+        if (stable.end > stable.begin) page->releases = parse_stable_releases(page->html + stable.begin, stable.end - stable.begin);
+    }
+    if (!page->releases.versions || !page->releases.count) {
+        fwprintf_s(stderr, L"Error: %S is empty, unreadable or has no stable releases!\n", filename);
+        results_release(&page->releases);
+        free(page->html);
+        return false;
+    }
+    return true;
+}
+
+#ifndef CRAWL_FORCE_SCALAR_SCAN // the kernels are called directly, the scalar build has nothing to add there
+// the three kernels find the same pair in html[begin, end), scan_pair_avx2 only runs where the CPU has AVX2
+static bool __cdecl is_same_scan(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+) {
+    const unsigned long found = scan_pair_scalar(html, begin, end, first, second);
+    if (scan_pair_sse2(html, begin, end, first, second) != found) return false;
+    return !__builtin_cpu_supports("avx2") || scan_pair_avx2(html, begin, end, first, second) == found;
+}
+
+// compares the kernels over every range of html[0, size], size + 1 bytes must be readable. reports the first range they disagree on
+static void __cdecl check_ranges(
+    _In_ const char* const restrict name,
+    _In_ const char* const restrict html,
+    _In_ const unsigned long size,
+    _In_ const char first,
+    _In_ const char second
+) {
+    for (unsigned long begin = 0; begin <= size; ++begin)
+        for (unsigned long end = begin; end <= size; ++end)
+            if (!is_same_scan(html, begin, end, first, second)) {
+                expect(false, L"%S: the kernels disagree on %c%c in [%lu, %lu)", name, first, second, begin, end);
+                return;
+            }
+}
+
+static void __cdecl check_kernels(_In_ const check_page_t* const restrict page) {
+    static const char pairs[][2] = { { '<', 'h' }, { '<', 'a' } };
+    for (unsigned long k = 0; k < sizeof(pairs) / sizeof(pairs[0]); ++k) {
+        const char    first = pairs[k][0], second = pairs[k][1]; // NOLINT(readability-isolate-declaration)
+        unsigned long begin = 0;
+        for (; begin < page->size; ++begin) {
+            const unsigned long last = begin + CHECK_KERNEL_WINDOW < page->size ? begin + CHECK_KERNEL_WINDOW : page->size;
+            unsigned long       end  = begin;
+            while (end <= last && is_same_scan(page->html, begin, end, first, second)) ++end;
+            if (end <= last) break;
+            if (begin < CHECK_KERNEL_STARTS && !is_same_scan(page->html, begin, page->size, first, second)) break;
+        }
+        expect(begin == page->size, L"%S: the kernels disagree on %c%c from offset %lu", page->name, first, second, begin);
+    }
+}
+
+// small buffers with the pairs where the vector kernels could go wrong, compared over every range. every buffer has a byte past it
+static void __cdecl check_synthetic_kernels(void) {
+    char               html[CHECK_SYNTHETIC_SIZE + 1] = { 0 };
+    unsigned long long state                          = CHECK_SEED;
+
+    for (unsigned long offset = 0; offset < CHECK_SYNTHETIC_SIZE; ++offset) {
+        // "<h" at every offset, the last one with the 'h' right past the ranges
+        memset(html, 'x', sizeof(html));
+        html[offset]     = '<';
+        html[offset + 1] = 'h';
+        check_ranges("<h at an offset", html, CHECK_SYNTHETIC_SIZE, '<', 'h');
+
+        // the '<' on its own, and another one in the last byte of the buffer with or without an 'h' right past it
+        html[offset + 1]               = 'x';
+        html[CHECK_SYNTHETIC_SIZE - 1] = '<';
+        html[CHECK_SYNTHETIC_SIZE]     = offset % 2 ? 'h' : 'x';
+        check_ranges("a lone <", html, CHECK_SYNTHETIC_SIZE, '<', 'h');
+    }
+
+    // nothing but pair characters, '<' twice as often as the others. every vector holds several candidates and most of them are half a pair
+    static const char alphabet[] = { '<', 'h', 'a', '<' };
+    for (unsigned long round = 0; round < CHECK_STREAM_ROUNDS; ++round) {
+        for (unsigned long i = 0; i < sizeof(html); ++i) html[i] = alphabet[next_random(&state) % sizeof(alphabet)];
+        check_ranges("pair characters", html, CHECK_SYNTHETIC_SIZE, '<', 'h');
+        check_ranges("pair characters", html, CHECK_SYNTHETIC_SIZE, '<', 'a');
+    }
+}
+#endif
+
+// the heading loop locate_stable_releases_htmldiv had before scan_pair, reads up to 9 bytes past size
+static range_t __cdecl baseline_locate(_In_ const char* const restrict html, _In_ const unsigned long size) {
+    range_t delimiters = { .begin = 0, .end = 0 };
+    for (unsigned long i = 0; i < size; ++i) {
+        if (memcmp(html + i, "<h2>", 4)) continue;
+        if (!delimiters.begin && !memcmp(html + i + 4, "Stable", 6)) delimiters.begin = i + 24;
+        if (!memcmp(html + i + 4, "Pre-re", 6)) {
+            delimiters.end = i - 1;
+            break;
+        }
+    }
+    return delimiters;
+}
+
+// the anchor loop parse_stable_releases had before scan_pair, back when it only knew amd64 installers: a python.org/ftp/python/ link whose
+// version ends at a slash within 15 bytes and which has "amd64.exe" within 20 bytes of where "-amd64.exe" would come after
+// "/python-<version>". stores the versions and the urls, returns how many there are
+static unsigned long __cdecl baseline_amd64_releases(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long size,
+    _Inout_ range_t* const restrict versions,
+    _Inout_ range_t* const restrict urls,
+    _In_ const unsigned long capacity
+) {
+    unsigned long count = 0;
+    for (unsigned long i = 0; i + 100 < size && count < capacity; ++i) {
+        if (memcmp(html + i, "<a href=\"https://www.python.org/ftp/python/", 43)) continue;
+
+        const unsigned long version = i + 43;
+        unsigned long       slash   = 0;
+        for (unsigned long j = version; j < version + 15 && !slash; ++j)
+            if (html[j] == '/') slash = j;
+        if (!slash) continue;
+
+        const unsigned long suffix = slash + 8 + slash - version;
+        for (unsigned long k = suffix; k < suffix + 20; ++k)
+            if (!memcmp(html + k, "amd64.exe", 9)) {
+                versions[count] = (range_t) { .begin = version, .end = slash };
+                urls[count++]   = (range_t) { .begin = i + 9, .end = k + 9 };
+                break;
+            }
+    }
+    return count;
+}
+
+static void __cdecl check_baseline(_In_ const check_page_t* const restrict page) {
+    const range_t baseline = baseline_locate(page->html, page->size), stable = locate_stable_releases_htmldiv(page->html, page->size);
+    expect(
+        stable.begin == baseline.begin && stable.end == baseline.end,
+        L"%S: the stable releases are at [%lu, %lu) rather than [%lu, %lu)",
+        page->name,
+        stable.begin,
+        stable.end,
+        baseline.begin,
+        baseline.end
+    );
+
+    static range_t      versions[CHECK_MAX_RELEASES] = { 0 }, urls[CHECK_MAX_RELEASES] = { 0 }; // NOLINT(readability-isolate-declaration)
+    const unsigned long size  = stable.end - stable.begin;
+    const unsigned long count = baseline_amd64_releases(page->html + stable.begin, size, versions, urls, CHECK_MAX_RELEASES);
+    unsigned long       found = 0;
+    for (unsigned long i = 0; i < page->releases.count; ++i) {
+        if (page->releases.kinds[i] != ARTIFACT_AMD64) continue;
+        const span_t version = page->releases.versions[i], url = page->releases.downloadurls[i]; // NOLINT(readability-isolate-declaration)
+        const bool   is_same = found < count && version.offset == versions[found].begin && version.offset + version.length == versions[found].end &&
+                             url.offset == urls[found].begin && url.offset + url.length == urls[found].end;
+        expect(is_same, L"%S: amd64 installer %lu isn't the one the baseline parse found", page->name, found);
+        found++;
+    }
+    expect(found == count, L"%S: %lu amd64 installers rather than the %lu the baseline parse found", page->name, found, count);
+}
+
+// feeds the page to a streaming parser in pieces of 1 to limit bytes, the results are the caller's to release
+static results_t __cdecl stream_page(
+    _In_ const check_page_t* const restrict page, _In_ const unsigned long limit, _Inout_ unsigned long long* const restrict state
+) {
+    stream_parser_t parser = { 0 };
+    if (!stream_parser_init(&parser)) return (results_t) { 0 }; // stream_parser_init will do the error reporting
+
+    for (unsigned long offset = 0, piece = 0; offset < page->size; offset += piece) { // NOLINT(readability-isolate-declaration)
+        piece = 1 + (unsigned long) (next_random(state) % limit);
+        if (piece > page->size - offset) piece = page->size - offset;
+        (void) stream_parser_feed(&parser, page->html + offset, piece);
+    }
+    return stream_parser_finish(&parser);
+}
+
+static void __cdecl check_stream(_In_ const check_page_t* const restrict page) {
+    unsigned long long state = CHECK_SEED;
+    for (unsigned long i = 0; i < sizeof(piece_limits) / sizeof(piece_limits[0]); ++i) {
+        const unsigned long rounds = piece_limits[i] == 1 ? 1 : CHECK_STREAM_ROUNDS; // single bytes cut a page one way only
+        for (unsigned long round = 0; round < rounds; ++round) {
+            const unsigned long long seed     = state;
+            results_t                streamed = stream_page(page, piece_limits[i], &state);
+            expect(
+                streamed.versions && is_same_releases(streamed, page->releases),
+                L"%S: pieces of up to %lu bytes from seed %llx made %lu releases instead of %lu",
+                page->name,
+                piece_limits[i],
+                seed,
+                streamed.count,
+                page->releases.count
+            );
+            results_release(&streamed);
+        }
+    }
+}
+
+static bool __cdecl send_all(_In_ const int socket_, _In_ const char* const restrict data, _In_ const unsigned long size) {
+    for (unsigned long sent = 0; sent < size;) {
+        const ssize_t written = send(socket_, data + sent, size - sent, MSG_NOSIGNAL);
+        if (written <= 0) return false;
+        sent += (unsigned long) written;
+    }
+    return true;
+}
+
+// sends the body in chunks of random sizes, every other one with a chunk extension, and a trailer after the last one
+static bool __cdecl send_chunked(
+    _Inout_ check_server_t* const restrict server,
+    _In_ const int socket_,
+    _In_ const char* const restrict body,
+    _In_ const unsigned long size
+) {
+    char line[64] = { 0 };
+    for (unsigned long offset = 0, n = 0; offset < size; ++n) { // NOLINT(readability-isolate-declaration)
+        unsigned long chunk = 1 + (unsigned long) (next_random(&server->state) % CHECK_MAX_CHUNK);
+        if (chunk > size - offset) chunk = size - offset;
+        const int length = snprintf(line, sizeof(line), n % 2 ? "%lx;piece=%lu\r\n" : "%lX\r\n", chunk, n);
+        if (!send_all(socket_, line, (unsigned long) length) || !send_all(socket_, body + offset, chunk) || !send_all(socket_, "\r\n", 2))
+            return false;
+        offset += chunk;
+    }
+    static const char last[] = "0\r\nX-Check: trailer\r\n\r\n";
+    return send_all(socket_, last, sizeof(last) - 1);
+}
+
+// the value of the header is exactly the string, up to the CRLF that ends its line
+static bool __cdecl is_header_value(_In_ const char* const restrict value, _In_ const char* const restrict string) {
+    const size_t length = strlen(string);
+    return !strncmp(value, string, length) && value[length] == '\r';
+}
+
+// answers a request, returns false when the connection is to be closed
+static bool __cdecl respond(
+    _Inout_ check_server_t* const restrict server,
+    _Inout_ check_connection_t* const restrict connection,
+    _In_ const char* const restrict request
+) {
+    char      head[512] = { 0 };
+    char      path[256] = { 0 };
+    const int socket_   = connection->socket;
+    if (sscanf(request, "GET %255s HTTP/1.1", path) != 1) return false;
+
+    const check_route_t* route = NULL;
+    for (unsigned long i = 0; i < server->nroutes && !route; ++i)
+        if (!strcmp(server->routes[i].path, path)) route = server->routes + i;
+    if (!route) {
+        static const char missing[] = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 9\r\n\r\nnot found";
+        return send_all(socket_, missing, sizeof(missing) - 1);
+    }
+    if (route->is_idle && connection->answered++) {
+        server->dropped++;
+        return false;
+    }
+
+    // the ETag and Last-Modified lines of the route's responses, the ones with a body add its encoding and framing
+    char headers[HTTP_VALIDATOR_LENGTH * 4] = { 0 };
+    int  nheaders                           = 0;
+    if (route->etag) nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "ETag: %s\r\n", route->etag);
+    if (route->date) nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "Last-Modified: %s\r\n", route->date);
+
+    // a conditional request for a page that hasn't changed, If-Modified-Since only counts without an If-None-Match
+    const char* const none_match = strstr(request, "\r\nIf-None-Match: ");
+    const char* const since      = strstr(request, "\r\nIf-Modified-Since: ");
+    const bool        is_fresh   = none_match ? route->etag && is_header_value(none_match + 17, route->etag)
+                                              : since && route->date && is_header_value(since + 21, route->date);
+    if (is_fresh) {
+        const int length = snprintf(head, sizeof(head), "HTTP/1.1 304 Not Modified\r\n%s\r\n", headers);
+        return send_all(socket_, head, (unsigned long) length);
+    }
+
+    if (route->encoding) nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "Content-Encoding: %s\r\n", route->encoding);
+    if (route->framing == CHECK_FRAMING_LENGTH)
+        nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "Content-Length: %lu\r\n", route->size);
+    else if (route->framing == CHECK_FRAMING_CHUNKED)
+        nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "Transfer-Encoding: chunked\r\n");
+    else
+        nheaders += snprintf(headers + nheaders, sizeof(headers) - nheaders, "Connection: close\r\n");
+
+    const int length = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n%s\r\n", headers);
+    if (!send_all(socket_, head, (unsigned long) length)) return false;
+    if (route->framing == CHECK_FRAMING_CHUNKED) return send_chunked(server, socket_, route->body, route->size);
+    const bool is_sent = send_all(socket_, route->body, route->size);
+    return is_sent && route->framing == CHECK_FRAMING_LENGTH; // a close ends the body with the connection
+}
+
+static void __cdecl drop_connection(_Inout_ check_connection_t* const restrict connection) {
+    close(connection->socket);
+    connection->socket   = -1;
+    connection->filled   = 0;
+    connection->answered = 0;
+}
+
+// receives what arrived on the connection and answers every request that's complete by now
+static void __cdecl receive(_Inout_ check_server_t* const restrict server, _Inout_ check_connection_t* const restrict connection) {
+    const unsigned long room     = CHECK_REQUEST_SIZE - 1 - connection->filled; // one byte for the terminator strstr needs
+    const ssize_t       received = recv(connection->socket, connection->request + connection->filled, room, 0);
+    if (received <= 0) {
+        drop_connection(connection);
+        return;
+    }
+    connection->filled                      += (unsigned long) received;
+    connection->request[connection->filled]  = 0;
+
+    for (char* end = strstr(connection->request, "\r\n\r\n"); end; end = strstr(connection->request, "\r\n\r\n")) {
+        end[2] = 0; // the request line and headers, each with its CRLF
+        if (!respond(server, connection, connection->request)) {
+            drop_connection(connection);
+            return;
+        }
+        const unsigned long consumed = (unsigned long) (end + 4 - connection->request);
+        memmove(connection->request, end + 4, connection->filled - consumed + 1);
+        connection->filled -= consumed;
+    }
+    if (connection->filled == CHECK_REQUEST_SIZE - 1) drop_connection(connection); // a request larger than the buffer
+}
+
+static bool __cdecl serve(_Inout_opt_ void* const argument) {
+    check_server_t* const restrict server = argument;
+    struct pollfd                  polled[CHECK_MAX_CONNECTIONS + 1];
+
+    while (!atomic_load(&server->is_stopping)) {
+        polled[0] = (struct pollfd) { .fd = server->listener, .events = POLLIN };
+        for (unsigned long i = 0; i < CHECK_MAX_CONNECTIONS; ++i)
+            polled[i + 1] = (struct pollfd) { .fd = server->connections[i].socket, .events = POLLIN }; // poll skips the free slots' -1
+        if (poll(polled, CHECK_MAX_CONNECTIONS + 1, CHECK_POLL_INTERVAL) <= 0) continue;
+
+        for (unsigned long i = 0; i < CHECK_MAX_CONNECTIONS; ++i)
+            if (server->connections[i].socket >= 0 && polled[i + 1].revents) receive(server, server->connections + i);
+
+        if (polled[0].revents & POLLIN) {
+            const int accepted = accept(server->listener, NULL, NULL);
+            unsigned long slot = 0;
+            while (slot < CHECK_MAX_CONNECTIONS && server->connections[slot].socket >= 0) ++slot;
+            if (accepted >= 0 && slot < CHECK_MAX_CONNECTIONS)
+                server->connections[slot] = (check_connection_t) { .socket = accepted, .filled = 0, .answered = 0 };
+            else if (accepted >= 0)
+                close(accepted);
+        }
+    }
+
+    for (unsigned long i = 0; i < CHECK_MAX_CONNECTIONS; ++i)
+        if (server->connections[i].socket >= 0) drop_connection(server->connections + i);
+    return true;
+}
+
+static bool __cdecl start_server(_Inout_ check_server_t* const restrict server) {
+    struct sockaddr_in address = { .sin_family = AF_INET, .sin_port = 0, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t          length  = sizeof(address);
+    const int          yes     = 1;
+
+    server->listener = socket(AF_INET, SOCK_STREAM, 0);
+    server->state    = CHECK_SEED;
+    for (unsigned long i = 0; i < CHECK_MAX_CONNECTIONS; ++i) server->connections[i].socket = -1;
+    atomic_init(&server->is_stopping, false);
+
+    if (server->listener < 0 || setsockopt(server->listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes))
+        || bind(server->listener, (const struct sockaddr*) &address, sizeof(address)) || listen(server->listener, SOMAXCONN)
+        || getsockname(server->listener, (struct sockaddr*) &address, &length)) {
+        fwprintf_s(stderr, L"Error %d while setting up the local server!\n", errno);
+        if (server->listener >= 0) close(server->listener);
+        return false;
+    }
+    server->port = ntohs(address.sin_port);
+    task_start(&server->task, serve, server);
+    return true;
+}
+
+static void __cdecl stop_server(_Inout_ check_server_t* const restrict server) {
+    atomic_store(&server->is_stopping, true);
+    (void) task_wait(&server->task);
+    close(server->listener);
+}
+
+// transport_get_conditional for the socket transport alone, transport.c would drag the WinHttp backend in
+static http_request_t __cdecl get(
+    _In_ const check_server_t* const restrict server,
+    _In_ const wchar_t* const restrict path,
+    _In_opt_ const http_validators_t* const conditions
+) {
+    http_request_t request = { 0 };
+    request.port           = server->port;
+    wcscpy_s(request.server, BUFF_SIZE, L"127.0.0.1");
+    if (conditions) request.conditions = *conditions;
+    if (socket_transport.get(&request, L"127.0.0.1", server->port, path)) request.transport = &socket_transport;
+    return request;
+}
+
+// appends the piece to the body_t behind context
+static bool __cdecl body_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    return body_append(context, chunk, size);
+}
+
+// fetches the path into body, which the caller must body_release even when the fetch failed
+static bool __cdecl fetch(
+    _In_ const check_server_t* const restrict server,
+    _In_ const wchar_t* const restrict path,
+    _In_opt_ const http_validators_t* const conditions,
+    _Inout_ http_request_t* const restrict request,
+    _Inout_ body_t* const restrict body
+) {
+    unsigned long size = 0;
+    *request           = get(server, path, conditions);
+    return request->transport && socket_transport.read(request, body_sink, body, &size);
+}
+
+// the body is the page, byte for byte
+static bool __cdecl is_page_body(_In_ const check_page_t* const restrict page, _Inout_ body_t* const restrict body) {
+    const char* const flat = body->size == page->size ? body_flatten(body) : NULL;
+    return flat && !memcmp(flat, page->html, page->size);
+}
+
+static void __cdecl check_socket(_Inout_ check_server_t* const restrict server, _In_ const check_page_t* const restrict page) {
+    static const wchar_t* const paths[] = { L"/length", L"/chunked", L"/close" };
+    http_request_t              request = { 0 };
+
+    server->routes[0] = (check_route_t) { .path = "/length", .framing = CHECK_FRAMING_LENGTH, .body = page->html, .size = page->size };
+    server->routes[1] = (check_route_t) { .path = "/chunked", .framing = CHECK_FRAMING_CHUNKED, .body = page->html, .size = page->size };
+    server->routes[2] = (check_route_t) { .path = "/close", .framing = CHECK_FRAMING_CLOSE, .body = page->html, .size = page->size };
+    server->routes[3] = (check_route_t) {
+        .path = "/idle", .framing = CHECK_FRAMING_LENGTH, .body = page->html, .size = page->size, .is_idle = true
+    };
+    server->nroutes   = 4;
+
+    for (unsigned long i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i)
+        for (unsigned long round = 0; round < (i == 1 ? CHECK_CHUNKED_ROUNDS : 1); ++round) {
+            body_t     body    = { 0 };
+            const bool is_read = fetch(server, paths[i], NULL, &request, &body);
+            const bool is_page = is_read && request.status == HTTP_STATUS_OK && is_page_body(page, &body);
+            expect(is_page, L"%S: %s came back different", page->name, paths[i]);
+            if (i == 0) expect(request.total_size == page->size, L"%S: %s told a size of %llu", page->name, paths[i], request.total_size);
+            body_release(&body);
+        }
+
+    // the close left no connection behind, the first of these opens one and the second goes out over it
+    const pool_stats_t before = pool_statistics();
+    for (unsigned long i = 0; i < 2; ++i) {
+        body_t     body    = { 0 };
+        const bool is_page = fetch(server, paths[i], NULL, &request, &body) && is_page_body(page, &body);
+        expect(is_page, L"%S: %s came back different", page->name, paths[i]);
+        body_release(&body);
+    }
+    const pool_stats_t after = pool_statistics();
+    expect(after.misses - before.misses == 1 && after.hits - before.hits == 1, L"%S: a kept-alive connection wasn't reused", page->name);
+
+    // the second of these goes out over the connection the first left in the pool, which the server drops without an answer
+    const unsigned long dropped = server->dropped;
+    for (unsigned long i = 0; i < 2; ++i) {
+        body_t body = { 0 };
+        const bool is_page = fetch(server, L"/idle", NULL, &request, &body) && is_page_body(page, &body);
+        expect(is_page, L"%S: /idle came back different after %lu requests", page->name, i);
+        body_release(&body);
+    }
+    expect(server->dropped > dropped, L"%S: the server didn't drop a pooled connection", page->name);
+
+    body_t body = { 0 };
+    expect(!fetch(server, L"/missing", NULL, &request, &body) && request.status == 404, L"%S: a 404 was read as a page", page->name);
+    body_release(&body);
+}
+
+// deletes the cache file the check left behind
+static void __cdecl remove_cache(_In_ const wchar_t* const restrict path) {
+    char narrow[MAX_PATH * 4] = { 0 };
+    if (wcstombs(narrow, path, sizeof(narrow)) != (size_t) -1) (void) remove(narrow);
+}
+
+// fetches the page the way fetch_page in main.c does with a warm cache, conditionally on the cached validators. true for a 304, the body
+// stays empty then
+static bool __cdecl is_not_modified(
+    _In_ const check_server_t* const restrict server,
+    _In_ const http_validators_t* const restrict conditions,
+    _Inout_ body_t* const restrict body
+) {
+    http_request_t request = { 0 };
+    return fetch(server, L"/page", conditions, &request, body) && request.status == HTTP_STATUS_NOT_MODIFIED && !body->size;
+}
+
+static void __cdecl check_cache(_Inout_ check_server_t* const restrict server, _In_ const check_page_t* const restrict page) {
+    wchar_t           path[MAX_PATH] = { 0 };
+    http_request_t    request        = { 0 };
+    body_t            body           = { 0 };
+    cached_page_t     cached         = { 0 };
+    results_t         parsed         = { 0 };
+    http_validators_t etag_only      = { 0 };
+    http_validators_t date_only      = { 0 };
+
+    server->routes[0] = (check_route_t) {
+        .path    = "/page",
+        .framing = CHECK_FRAMING_LENGTH,
+        .body    = page->html,
+        .size    = page->size,
+        .etag    = "\"v1\"",
+        .date    = "Mon, 07 Oct 2024 09:00:00 GMT",
+    };
+    server->nroutes = 1;
+    if (!cache_path(L"", L"127.0.0.1", server->port, L"/page", path, MAX_PATH)) {
+        expect(false, L"%S: no cache path", page->name);
+        return;
+    }
+
+    // the cold run, a 200 with validators, whose releases go to the cache
+    bool is_read = fetch(server, L"/page", NULL, &request, &body);
+    is_read      = is_read && request.status == HTTP_STATUS_OK && is_page_body(page, &body);
+    expect(is_read, L"%S: the first fetch came back different", page->name);
+    expect(
+        !strcmp(request.validators.etag, "\"v1\"") && !strcmp(request.validators.last_modified, server->routes[0].date),
+        L"%S: the validators came back as %S and %S",
+        page->name,
+        request.validators.etag,
+        request.validators.last_modified
+    );
+    const char* const html   = is_read ? body_flatten(&body) : NULL;
+    const range_t     stable = html ? locate_stable_releases_htmldiv(html, body.size) : (range_t) { 0 };
+    if (stable.end > stable.begin) parsed = parse_stable_releases(html + stable.begin, stable.end - stable.begin);
+    expect(parsed.versions && cache_store(path, &request.validators, parsed), L"%S: the releases didn't make it to the cache", page->name);
+    results_release(&parsed);
+    body_release(&body);
+
+    // the warm runs, the cache has what the page had and the server says it's still current, whichever validator is sent
+    cached = cache_load(path);
+    expect(cached.results.versions && is_same_releases(cached.results, page->releases), L"%S: the cache holds other releases", page->name);
+    expect(!strcmp(cached.validators.etag, "\"v1\""), L"%S: the cache holds the ETag %S", page->name, cached.validators.etag);
+    strcpy_s(etag_only.etag, HTTP_VALIDATOR_LENGTH, cached.validators.etag);
+    strcpy_s(date_only.last_modified, HTTP_VALIDATOR_LENGTH, cached.validators.last_modified);
+    expect(is_not_modified(server, &cached.validators, &body), L"%S: revalidating with both validators didn't give a 304", page->name);
+    body_release(&body);
+    expect(is_not_modified(server, &etag_only, &body), L"%S: revalidating with the ETag didn't give a 304", page->name);
+    body_release(&body);
+    expect(is_not_modified(server, &date_only, &body), L"%S: revalidating with Last-Modified didn't give a 304", page->name);
+    body_release(&body);
+
+    // the page changed, the same conditions now bring the whole of it and the new validators
+    server->routes[0].etag = "\"v2\"";
+    server->routes[0].date = "Tue, 08 Oct 2024 09:00:00 GMT";
+    is_read                = fetch(server, L"/page", &cached.validators, &request, &body);
+    expect(
+        is_read && request.status == HTTP_STATUS_OK && is_page_body(page, &body) && !strcmp(request.validators.etag, "\"v2\""),
+        L"%S: a changed page didn't come back whole with its new ETag",
+        page->name
+    );
+    body_release(&body);
+
+    results_release(&cached.results);
+    remove_cache(path);
+}
+
+// inflates the first size bytes of the fixture in pieces of 1 to limit bytes into body, true if the stream ended cleanly
+static bool __cdecl inflate_pieces(
+    _In_ const check_fixture_t* const restrict fixture,
+    _In_ const char* const restrict compressed,
+    _In_ const unsigned long size,
+    _In_ const unsigned long limit,
+    _Inout_ unsigned long long* const restrict state,
+    _Inout_ body_t* const restrict body
+) {
+    inflater_t inflater  = { 0 };
+    bool       is_pushed = true;
+    if (!inflater_init(&inflater, fixture->format, body_sink, body)) return false; // inflater_init will do the error reporting
+
+    for (unsigned long offset = 0, piece = 0; offset < size && is_pushed; offset += piece) { // NOLINT(readability-isolate-declaration)
+        piece = 1 + (unsigned long) (next_random(state) % limit);
+        if (piece > size - offset) piece = size - offset;
+        is_pushed = inflater_push(&inflater, compressed + offset, piece);
+    }
+    return inflater_finish(&inflater) && is_pushed; // inflater_finish must be called regardless, it releases the window
+}
+
+static void __cdecl check_inflate(_Inout_ check_server_t* const restrict server, _In_ const check_fixture_t* const restrict fixture) {
+    static const wchar_t* const paths[]    = { L"/length", L"/chunked" };
+    unsigned long long          state      = CHECK_SEED;
+    unsigned long               size       = 0;
+    check_page_t                page       = { .name = fixture->page };
+    char* const                 compressed = read_file(fixture->name, &size);
+    http_request_t              request    = { 0 };
+    body_t                      body       = { 0 };
+    bool                        is_read    = false;
+
+    page.html = read_file(fixture->page, &page.size);
+    if (!compressed || !page.html) {
+        expect(false, L"%S: the fixture or its page can't be read", fixture->name);
+        goto CLEANUP;
+    }
+
+    for (unsigned long i = 0; i < sizeof(piece_limits) / sizeof(piece_limits[0]); ++i) {
+        const unsigned long rounds = piece_limits[i] == 1 ? 1 : CHECK_STREAM_ROUNDS;
+        for (unsigned long round = 0; round < rounds; ++round) {
+            const unsigned long long seed = state;
+            is_read                       = inflate_pieces(fixture, compressed, size, piece_limits[i], &state, &body);
+            expect(
+                is_read && is_page_body(&page, &body),
+                L"%S: pieces of up to %lu bytes from seed %llx inflated to %lu bytes instead of %lu",
+                fixture->name,
+                piece_limits[i],
+                seed,
+                body.size,
+                page.size
+            );
+            body_release(&body);
+        }
+    }
+
+    // the checksum is the last byte of a zlib stream, gzip ends with the size, which the CRC-32 comes right before
+    const unsigned long checksum = fixture->format == INFLATE_GZIP ? size - 5 : size - 1;
+    compressed[checksum]        ^= 0x10;
+    is_read                      = inflate_pieces(fixture, compressed, size, HTTP_CHUNK_SIZE, &state, &body);
+    expect(!is_read, L"%S: a broken checksum went unnoticed", fixture->name);
+    body_release(&body);
+    compressed[checksum] ^= 0x10;
+    is_read               = inflate_pieces(fixture, compressed, size - 1, HTTP_CHUNK_SIZE, &state, &body);
+    expect(!is_read, L"%S: a missing last byte went unnoticed", fixture->name);
+    body_release(&body);
+    is_read = inflate_pieces(fixture, compressed, size / 2, HTTP_CHUNK_SIZE, &state, &body);
+    expect(!is_read, L"%S: a stream cut in half went unnoticed", fixture->name);
+    body_release(&body);
+
+    // what the server sends is the compressed page, what the sink gets the page itself
+    server->routes[0] = (check_route_t) {
+        .path = "/length", .framing = CHECK_FRAMING_LENGTH, .body = compressed, .size = size, .encoding = fixture->encoding
+    };
+    server->routes[1] = (check_route_t) {
+        .path = "/chunked", .framing = CHECK_FRAMING_CHUNKED, .body = compressed, .size = size, .encoding = fixture->encoding
+    };
+    server->nroutes = 2;
+    for (unsigned long i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
+        is_read            = fetch(server, paths[i], NULL, &request, &body);
+        const bool is_page = is_read && request.status == HTTP_STATUS_OK && is_page_body(&page, &body);
+        expect(is_page, L"%S: %s with Content-Encoding: %S didn't arrive inflated", fixture->name, paths[i], fixture->encoding);
+        body_release(&body);
+    }
+
+CLEANUP:
+    free(compressed);
+    free(page.html);
+}
+
+static void __cdecl check_guard(_In_ const check_page_t* const restrict page) {
+    const unsigned long memory_page = (unsigned long) sysconf(_SC_PAGESIZE);
+    const unsigned long size        = page->size / memory_page * memory_page;
+    char* const         mapping     = mmap(NULL, size + memory_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        fwprintf_s(stderr, L"Error %d in mmap!\n", errno);
+        failures++;
+        return;
+    }
+
+    // read-only like a mapped file, and the memory page after it not at all
+    memcpy(mapping, page->html, size);
+    mapping[size - 1] = '<';
+    if (mprotect(mapping, size, PROT_READ) || mprotect(mapping + size, memory_page, PROT_NONE)) {
+        fwprintf_s(stderr, L"Error %d in mprotect!\n", errno);
+        failures++;
+        goto CLEANUP;
+    }
+
+    const range_t stable = locate_stable_releases_htmldiv(mapping, size), whole = locate_stable_releases_htmldiv(page->html, page->size);
+    expect(stable.begin == whole.begin, L"%S: the stable releases start at %lu in front of a guard page", page->name, stable.begin);
+
+    // all the way to the end, past where parse_stable_releases stops
+    results_t results = { 0 };
+    if (results_init(&results, mapping, RESULTS_INITIAL_CAPACITY)) {
+        const bool is_parsed = parse_releases_between(mapping, stable.begin, size, size, &results);
+        expect(is_parsed && results.count, L"%S: no releases in front of a guard page", page->name);
+    }
+    results_release(&results);
+
+CLEANUP:
+    munmap(mapping, size + memory_page);
+}
+
+// the digest of the bytes fed in pieces of random sizes up to limit, empty ones included, or all in one go when limit is 0, is the hex
+static bool __cdecl is_digest(
+    _In_ const digest_kind_t kind,
+    _In_ const char* const restrict bytes,
+    _In_ const unsigned long size,
+    _In_ const unsigned long limit,
+    _Inout_ unsigned long long* const restrict state,
+    _In_ const char* const restrict hex
+) {
+    digest_t       digest                    = { 0 };
+    digest_value_t expected                  = { 0 };
+    unsigned char  value[DIGEST_SHA256_SIZE] = { 0 };
+
+    digest_init(&digest, kind);
+    for (unsigned long offset = 0; offset < size;) {
+        unsigned long piece = limit ? (unsigned long) (next_random(state) % (limit + 1)) : size;
+        if (piece > size - offset) piece = size - offset;
+        digest_update(&digest, bytes + offset, piece);
+        offset += piece;
+    }
+    const unsigned long length = digest_final(&digest, value);
+    return digest_parse(hex, (unsigned long) strlen(hex), &expected) && expected.kind == kind && !memcmp(value, expected.bytes, length);
+}
+
+static void __cdecl check_digests(void) {
+    static char        pattern[CHECK_DIGEST_PATTERN] = { 0 };
+    unsigned long long state                         = CHECK_SEED;
+    digest_value_t     expected                      = { 0 };
+    for (unsigned long i = 0; i < CHECK_DIGEST_PATTERN; ++i) pattern[i] = (char) (i * 7 + 1);
+
+    for (unsigned long i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i) {
+        const check_vector_t* const vector = vectors + i;
+        const char* const           bytes  = vector->message ? vector->message : pattern;
+        expect(is_digest(DIGEST_MD5, bytes, vector->size, 0, &state, vector->md5), L"MD5 of %lu bytes", vector->size);
+        expect(is_digest(DIGEST_SHA256, bytes, vector->size, 0, &state, vector->sha256), L"SHA-256 of %lu bytes", vector->size);
+
+        for (unsigned long j = 0; j < sizeof(digest_limits) / sizeof(digest_limits[0]); ++j)
+            for (unsigned long round = 0; round < CHECK_DIGEST_ROUNDS; ++round) {
+                const unsigned long limit  = digest_limits[j];
+                const bool          is_md5 = is_digest(DIGEST_MD5, bytes, vector->size, limit, &state, vector->md5);
+                expect(is_md5, L"MD5 of %lu bytes in pieces of up to %lu", vector->size, limit);
+                const bool is_sha256 = is_digest(DIGEST_SHA256, bytes, vector->size, limit, &state, vector->sha256);
+                expect(is_sha256, L"SHA-256 of %lu bytes in pieces of up to %lu", vector->size, limit);
+            }
+    }
+
+    // a million 'a's, the long message of the standards, uppercase digits are read as well
+    static char       letters[1000000] = { 0 };
+    const char* const million[]        = { "7707d6ae4e027c70eea2a935c2296f21", "CDC76E5C9914FB9281A1C7E284D73E67F1809A48A497200E046D39CCC7112CD0" };
+    memset(letters, 'a', sizeof(letters));
+    expect(is_digest(DIGEST_MD5, letters, sizeof(letters), HTTP_CHUNK_SIZE, &state, million[0]), L"MD5 of a million 'a's");
+    expect(is_digest(DIGEST_SHA256, letters, sizeof(letters), HTTP_CHUNK_SIZE, &state, million[1]), L"SHA-256 of a million 'a's");
+
+    // neither 32 nor 64 digits, and something that isn't a digit
+    expect(!digest_parse("7707d6ae4e027c70eea2a935c2296f2", 31, &expected), L"31 hex digits were read as a checksum");
+    expect(!digest_parse("7707d6ae4e027c70eea2a935c2296fg1", 32, &expected), L"a 'g' was read as a hex digit");
+}
+
+static void __cdecl check_release_files(void) {
+    static const char row[] = "<tr><td><a href=\"https://www.python.org/ftp/python/3.14.0/python-3.14.0-amd64.exe\">Windows installer</a></td>"
+                              "<td>Windows</td><td>d41d8cd98f00b204e9800998ecf8427e</td>"
+                              "<td>e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855</td><td>28056048</td></tr>";
+    static const char   base[]                   = "https://www.python.org/ftp/python/3.13.0/";
+    const unsigned long nfiles                   = (unsigned long) (sizeof(release_files) / sizeof(release_files[0]));
+    release_file_t      files[RELEASE_MAX_FILES] = { 0 };
+    unsigned long       size                     = 0;
+    char* const         html                     = read_file(release_page, &size);
+    if (!html) {
+        failures++;
+        return;
+    }
+
+    const unsigned long count = parse_release_files(html, size, files, RELEASE_MAX_FILES);
+    expect(count == nfiles, L"%S: %lu files rather than %lu", release_page, count, nfiles);
+    for (unsigned long i = 0; i < count && i < nfiles; ++i) {
+        const span_t url = files[i].url, digest = files[i].digest; // NOLINT(readability-isolate-declaration)
+        const size_t length = strlen(base) + strlen(release_files[i][0]);
+        const bool   is_url = url.length == length && !memcmp(html + url.offset, base, strlen(base))
+                         && !memcmp(html + url.offset + strlen(base), release_files[i][0], strlen(release_files[i][0]));
+        expect(is_url, L"%S: file %lu is %.*S", release_page, i, (int) url.length, html + url.offset);
+        const bool is_sum = digest.length == 2 * DIGEST_MD5_SIZE && !memcmp(html + digest.offset, release_files[i][1], digest.length);
+        expect(is_sum, L"%S: %S has the checksum %.*S", release_page, release_files[i][0], (int) digest.length, html + digest.offset);
+    }
+    free(html);
+
+    // the row has room for a single file, and the checksum with more digits wins
+    expect(parse_release_files(row, sizeof(row) - 1, files, 1) == 1 && files[0].digest.length == 2 * DIGEST_SHA256_SIZE,
+           L"a row with an MD5 and a SHA-256 didn't keep the SHA-256");
+}
+
+int main(int argc, char* argv[]) {
+    const char* const*    filenames = argc > 1 ? (const char* const*) argv + 1 : default_pages;
+    const unsigned long   npages    = argc > 1 ? (unsigned long) argc - 1 : sizeof(default_pages) / sizeof(default_pages[0]);
+    static check_server_t server    = { 0 }; // the request buffers of its connections are a bit much for the stack
+
+    if (!start_server(&server)) return EXIT_FAILURE;
+
+#ifndef CRAWL_FORCE_SCALAR_SCAN
+    check_synthetic_kernels();
+#endif
+    check_digests();
+    check_release_files();
+
+    for (unsigned long i = 0; i < npages; ++i) {
+        check_page_t page = { 0 };
+        if (!load_page(filenames[i], &page)) {
+            failures++;
+            continue;
+        }
+#ifndef CRAWL_FORCE_SCALAR_SCAN
+        check_kernels(&page);
+#endif
+        check_baseline(&page);
+        check_stream(&page);
+        check_socket(&server, &page);
+        check_cache(&server, &page);
+        check_guard(&page);
+        results_release(&page.releases);
+        free(page.html);
+    }
+
+    const unsigned long nfixtures = (unsigned long) (sizeof(fixtures) / sizeof(fixtures[0]));
+    for (unsigned long i = 0; i < nfixtures; ++i) check_inflate(&server, fixtures + i);
+
+    stop_server(&server);
+    pool_drain();
+    body_drain();
+    wprintf_s(L"%lu pages, %lu fixtures: %s\n", npages, nfixtures, failures ? L"FAILED" : L"ok");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
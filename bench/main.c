@@ -0,0 +1,919 @@
+// benchmarks for the crawl.exe parse pipeline, links against the parser sources of crawl.exe and runs without network access.
+// builds with the bench project on Windows and with bench/Makefile on Linux, run it from the bench directory so it finds pages/ and fixtures/.
+//
+// bench [--json] [--samples <count>] [page.html]...
+// bench --scaling
+// bench --inflate [fixture]...
+// bench --startup [page.html]...
+// bench --pythons
+// bench --fanout <port> [--fetches <count>] [path]
+//
+// every page (the python.org snapshots in pages/ unless told otherwise) is benchmarked as is and with its stable releases section repeated
+// 10 to 100 times over. locate_stable_releases_htmldiv, parse_stable_releases, the parse of a page received into pooled slabs (view) and
+// print (the table, JSON and CSV) are measured one at a time and chained together, each after a few warm-up samples, reporting the spread
+// of ns/op across the timed samples, bytes of input per TSC cycle and heap allocations per op. --json prints one JSON object per
+// measurement instead of the table. --scaling runs parse_stable_releases_parallel on a synthetic multi-megabyte listing with 1, 2, 4 and 8
+// threads instead. --pythons times the detection of the python interpreters on PATH and lists what it found. --fanout fetches the path (/
+// by default) 1000 times over from a local server on the port, once through the blocking socket transport on BENCH_FANOUT_THREADS threads
+// and once through the completion rings of fetch_all with every fetch in flight at once, and reports the fetches per second of both. it's
+// the one benchmark that needs a server, any will do. --inflate decodes the compressed pages in fixtures/ (gzip for .gz, zlib for
+// everything else) with inflate.c, in one piece and in the HTTP_CHUNK_SIZE pieces the socket transport pushes, and with zlib's inflate when
+// built with BENCH_ZLIB (make inflate does), and reports the median time and throughput of each. --startup compares what a run that prints
+// from a snapshot and one that prints from a saved page do before printing: mapping and validating the snapshot of the page against
+// reading and parsing the page, warm with the file in the page cache and cold with it evicted before each run.
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <intrin.h>
+    #include <io.h>
+    #define NULL_DEVICE "NUL"
+#else
+    #include <x86intrin.h>
+    #define NULL_DEVICE "/dev/null"
+#endif
+#include <math.h>
+#include <time.h>
+#ifdef BENCH_ZLIB
+    #include <zlib.h>
+#endif
+
+#include <project.h> // after the system headers, it redefines malloc and friends in this project
+
+#define BENCH_WARMUP_SAMPLES 3LLU          // untimed samples before the timed ones
+#define BENCH_SAMPLES        15LLU         // timed samples per measurement unless --samples says otherwise
+#define BENCH_MAX_SAMPLES    1024LLU       // most timed samples --samples can ask for
+#define BENCH_SAMPLE_NS      2000000.0     // 2 ms, a sample repeats the measured op until it takes about this long
+#define BENCH_LISTING_SIZE   (16LLU << 20) // 16 MiB, synthetic listing the scaling benchmark parses
+#define BENCH_REPETITIONS    9LLU          // timed runs per thread count in the scaling benchmark, the median is reported
+#define BENCH_MAX_THREADS    8LLU          // the scaling benchmark doubles the thread count from 1 up to this
+#define BENCH_FANOUT_FETCHES 1000LLU       // fetches the fanout benchmark makes unless --fetches says otherwise
+#define BENCH_FANOUT_THREADS 64LLU         // threads the blocking side of the fanout benchmark fetches on, a keep-alive connection each
+#define BENCH_INFLATIONS     25LLU         // timed decodes per fixture and decoder in the inflate benchmark, the median is reported
+#define BENCH_STARTUPS       25LLU         // timed startups per page, source and cache state in the startup benchmark, the median is reported
+#define BENCH_SNAPSHOT       "startup.snapshot" // where the startup benchmark writes the snapshots of the pages, removed when it's done
+
+// the python.org snapshots, named after the day they show the page as of, so that a new snapshot never changes the numbers of an old one
+static const char* const default_pages[] = { "pages/downloads-windows-2024-05-24.html", "pages/downloads-windows-2024-10-07.html" };
+
+// the snapshots compressed in every container and block type inflate.c knows, see check.c
+static const char* const default_fixtures[] = {
+    "fixtures/downloads-windows-2024-10-07.html.gz",
+    "fixtures/downloads-windows-2024-05-24.html.deflate",
+    "fixtures/downloads-windows-2024-05-24.html.fixed.deflate",
+    "fixtures/downloads-windows-2024-10-07.html.stored.deflate",
+};
+
+// how many times over the scaled pages repeat the stable releases section, 1 is the page as it is
+static const unsigned long scales[] = { 1, 10, 25, 50, 100 };
+
+// the system python print highlights, so that both of its row formats get exercised
+static const char syspy[BUFF_SIZE] = "Python 3.12.4";
+
+static _Thread_local unsigned long long allocations = 0; // heap allocations made by this thread so far
+
+// the parenthesized names dodge the macros in project.h
+[[nodiscard]] void* __cdecl counted_malloc(_In_ const size_t size) {
+    allocations++;
+    return (malloc)(size);
+}
+
+[[nodiscard]] void* __cdecl counted_calloc(_In_ const size_t count, _In_ const size_t size) {
+    allocations++;
+    return (calloc)(count, size);
+}
+
+[[nodiscard]] void* __cdecl counted_realloc(_In_opt_ void* const block, _In_ const size_t size) {
+    allocations++;
+    return (realloc)(block, size);
+}
+
+// a page and everything the stages downstream of locate_stable_releases_htmldiv need, prepared once up front
+typedef struct _bench_page {
+        const char*   name;    // file the page was read from
+        unsigned long scale;   // how many times over the stable releases section is repeated
+        char*         html;    // the page
+        unsigned long size;    // size of the page
+        range_t       stable;  // the stable releases section, as located in the page
+        results_t     results; // releases parsed out of the stable releases section
+} bench_page_t;
+
+// a measured op, returns something derived from its work so that none of it can be optimized away
+typedef unsigned long(__cdecl* bench_op_t)(_In_ const bench_page_t* const restrict page);
+
+typedef struct _bench_stage {
+        const wchar_t* name;        // what the output calls the stage
+        bench_op_t     op;          // the measured op
+        bool           is_printing; // the op writes to stdout, which goes to the null device while it's measured
+} bench_stage_t;
+
+// spread of the per op values of a measurement
+typedef struct _bench_statistics {
+        double min;
+        double median;
+        double mean;
+        double stddev;
+        double max;
+} bench_statistics_t;
+
+static unsigned long __cdecl locate_op(_In_ const bench_page_t* const restrict page) {
+    return locate_stable_releases_htmldiv(page->html, page->size).end;
+}
+
+static unsigned long __cdecl parse_op(_In_ const bench_page_t* const restrict page) {
+    results_t           results = parse_stable_releases(page->html + page->stable.begin, page->stable.end - page->stable.begin);
+    const unsigned long count   = results.count;
+    results_release(&results);
+    return count;
+}
+
+// the page the way a transport delivers it, HTTP_CHUNK_SIZE pieces appended to a body, then located and parsed through the view of its
+// slabs. after the warm-up the slabs all come from the pool, the allocations are the view's and the streaming parser's
+static unsigned long __cdecl view_op(_In_ const bench_page_t* const restrict page) {
+    body_t        body  = { 0 };
+    unsigned long count = 0;
+    for (unsigned long offset = 0; offset < page->size; offset += HTTP_CHUNK_SIZE) {
+        const unsigned long piece = page->size - offset < HTTP_CHUNK_SIZE ? page->size - offset : HTTP_CHUNK_SIZE;
+        if (!body_append(&body, page->html + offset, piece)) goto CLEANUP;
+    }
+
+    body_slice_t* const slices = malloc(sizeof(body_slice_t) * body.nslabs);
+    if (!slices) goto CLEANUP;
+    (void) body_view(&body, slices, body.nslabs);
+    results_t results = parse_stable_releases_view(slices, body.nslabs);
+    count             = results.count + locate_stable_releases_view(slices, body.nslabs).end;
+    results_release(&results);
+    free(slices);
+
+CLEANUP:
+    body_release(&body);
+    return count;
+}
+
+static unsigned long __cdecl print_op(_In_ const bench_page_t* const restrict page) {
+    print(page->results, ARTIFACT_MASK_ALL, syspy);
+    return page->results.count;
+}
+
+static unsigned long __cdecl json_op(_In_ const bench_page_t* const restrict page) {
+    print_ex(page->results, ARTIFACT_MASK_ALL, syspy, OUTPUT_JSON);
+    return page->results.count;
+}
+
+static unsigned long __cdecl csv_op(_In_ const bench_page_t* const restrict page) {
+    print_ex(page->results, ARTIFACT_MASK_ALL, syspy, OUTPUT_CSV);
+    return page->results.count;
+}
+
+static unsigned long __cdecl pipeline_op(_In_ const bench_page_t* const restrict page) {
+    const range_t       stable  = locate_stable_releases_htmldiv(page->html, page->size);
+    results_t           results = parse_stable_releases(page->html + stable.begin, stable.end - stable.begin);
+    const unsigned long count   = results.count;
+    print(results, ARTIFACT_MASK_ALL, syspy);
+    results_release(&results);
+    return count;
+}
+
+static const bench_stage_t stages[] = {
+    { .name = L"locate",   .op = locate_op,   .is_printing = false },
+    { .name = L"parse",    .op = parse_op,    .is_printing = false },
+    { .name = L"view",     .op = view_op,     .is_printing = false },
+    { .name = L"print",    .op = print_op,    .is_printing = true  },
+    { .name = L"json",     .op = json_op,     .is_printing = true  },
+    { .name = L"csv",      .op = csv_op,      .is_printing = true  },
+    { .name = L"pipeline", .op = pipeline_op, .is_printing = true  },
+};
+
+static volatile unsigned long sink = 0; // where the ops' return values go
+
+// nanoseconds since the first call, counting from the epoch would leave a double with a resolution of hundreds of nanoseconds
+static double __cdecl nanoseconds(void) {
+    static time_t   origin = 0;
+    struct timespec now    = { 0 };
+    timespec_get(&now, TIME_UTC);
+    if (!origin) origin = now.tv_sec;
+    return (double) (now.tv_sec - origin) * 1e9 + (double) now.tv_nsec;
+}
+
+static int __cdecl compare_doubles(_In_ const void* const left, _In_ const void* const right) {
+    const double l = *(const double*) left, r = *(const double*) right; // NOLINT(readability-isolate-declaration)
+    return (l > r) - (l < r);
+}
+
+// sorts the values in place
+static bench_statistics_t __cdecl summarize(_Inout_ double* const restrict values, _In_ const unsigned long count) {
+    qsort(values, count, sizeof(double), compare_doubles);
+
+    double sum = 0, squares = 0; // NOLINT(readability-isolate-declaration)
+    for (unsigned long i = 0; i < count; ++i) sum += values[i];
+    const double mean = sum / count;
+    for (unsigned long i = 0; i < count; ++i) squares += (values[i] - mean) * (values[i] - mean);
+
+    return (bench_statistics_t) {
+        .min    = values[0],
+        .median = count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2,
+        .mean   = mean,
+        .stddev = count > 1 ? sqrt(squares / (count - 1)) : 0,
+        .max    = values[count - 1],
+    };
+}
+
+// points stdout at the null device and returns a duplicate of the old stdout to restore it with, -1 on failures
+static int __cdecl silence_stdout(void) {
+    fflush(stdout);
+    const int saved = _dup(_fileno(stdout)), null = _open(NULL_DEVICE, _O_WRONLY); // NOLINT(readability-isolate-declaration)
+    if (saved < 0 || null < 0 || _dup2(null, _fileno(stdout)) < 0) {
+        fputws(L"Error: could not redirect stdout to the null device!\n", stderr);
+        if (saved >= 0) _close(saved);
+        if (null >= 0) _close(null);
+        return -1;
+    }
+    _close(null);
+    return saved;
+}
+
+static void __cdecl restore_stdout(_In_ const int saved) {
+    fflush(stdout);
+    _dup2(saved, _fileno(stdout));
+    _close(saved);
+}
+
+// runs the op over and over, BENCH_WARMUP_SAMPLES untimed samples first and then the timed ones, and reports the figures
+static bool __cdecl measure(
+    _In_ const bench_page_t* const restrict page,
+    _In_ const bench_stage_t* const restrict stage,
+    _In_ const unsigned long nsamples,
+    _In_ const bool is_json
+) {
+    double timings[BENCH_MAX_SAMPLES] = { 0 }, cycles[BENCH_MAX_SAMPLES] = { 0 }; // NOLINT(readability-isolate-declaration)
+
+    const int saved = stage->is_printing ? silence_stdout() : -1;
+    if (stage->is_printing && saved < 0) return false;
+
+    // one untimed op decides how many ops a sample takes to last about BENCH_SAMPLE_NS
+    const double        start = nanoseconds();
+    const unsigned long first = stage->op(page);
+    const double        once  = nanoseconds() - start;
+    const unsigned long batch = once >= BENCH_SAMPLE_NS ? 1 : (unsigned long) (BENCH_SAMPLE_NS / (once > 1 ? once : 1));
+    sink                     += first;
+
+    for (unsigned long i = 0; i < BENCH_WARMUP_SAMPLES * batch; ++i) sink += stage->op(page);
+
+    const unsigned long long allocated = allocations;
+    for (unsigned long i = 0; i < nsamples; ++i) {
+        const double             begin = nanoseconds();
+        const unsigned long long tsc   = __rdtsc();
+        for (unsigned long j = 0; j < batch; ++j) sink += stage->op(page);
+        cycles[i]  = (double) (__rdtsc() - tsc) / batch;
+        timings[i] = (nanoseconds() - begin) / batch;
+    }
+    const double per_op_allocations = (double) (allocations - allocated) / ((double) nsamples * batch);
+
+    if (stage->is_printing) restore_stdout(saved);
+
+    // the bytes each stage consumes, the whole page for locate and the pipeline, the stable releases section for parse and the text of the
+    // releases for the printing stages
+    const unsigned long bytes = stage->op == parse_op                          ? page->stable.end - page->stable.begin
+                              : stage->is_printing && stage->op != pipeline_op ? results_text_size(page->results)
+                                                                               : page->size;
+    const bench_statistics_t ns = summarize(timings, nsamples), tsc = summarize(cycles, nsamples); // NOLINT(readability-isolate-declaration)
+
+    if (is_json)
+        wprintf_s(
+            L"{\"page\":\"%S\",\"scale\":%lu,\"stage\":\"%s\",\"bytes\":%lu,\"releases\":%lu,\"samples\":%lu,\"ops_per_sample\":%lu,"
+            L"\"ns_per_op\":{\"min\":%.1f,\"median\":%.1f,\"mean\":%.1f,\"stddev\":%.1f,\"max\":%.1f},\"cycles_per_op\":%.1f,"
+            L"\"bytes_per_cycle\":%.4f,\"allocations_per_op\":%.2f}\n",
+            page->name,
+            page->scale,
+            stage->name,
+            bytes,
+            page->results.count,
+            nsamples,
+            batch,
+            ns.min,
+            ns.median,
+            ns.mean,
+            ns.stddev,
+            ns.max,
+            tsc.median,
+            bytes / tsc.median,
+            per_op_allocations
+        );
+    else
+        wprintf_s(
+            L"%-40S %5lux %-9s %10lu %14.0f %7.2f%% %12.4f %10.2f\n",
+            page->name,
+            page->scale,
+            stage->name,
+            bytes,
+            ns.median,
+            ns.mean > 0 ? 100 * ns.stddev / ns.mean : 0,
+            bytes / tsc.median,
+            per_op_allocations
+        );
+    return true;
+}
+
+// reads a page, which must have a stable releases section for the benchmarks to make any sense
+static bool __cdecl load_page(_In_ const char* const restrict filename, _Inout_ bench_page_t* const restrict page) {
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb")) {
+        fwprintf_s(stderr, L"Error: could not open %S!\n", filename);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    *page = (bench_page_t) { .name = filename, .scale = 1, .html = size > 0 ? malloc((size_t) size) : NULL, .size = (unsigned long) size };
+    const bool is_read = page->html && fread(page->html, 1, (size_t) size, file) == (size_t) size;
+    fclose(file);
+
+    if (is_read) page->stable = locate_stable_releases_htmldiv(page->html, page->size);
+    if (!is_read || !page->stable.begin || page->stable.end <= page->stable.begin) {
+        fwprintf_s(stderr, L"Error: %S is empty, unreadable or has no stable releases section!\n", filename);
+        free(page->html);
+        return false;
+    }
+    return true;
+}
+
+// builds a page whose stable releases section is that of the given page repeated scale times over, everything around it stays as is
+static bool __cdecl scale_page(
+    _In_ const bench_page_t* const restrict original, _In_ const unsigned long scale, _Inout_ bench_page_t* const restrict page
+) {
+    const unsigned long section = original->stable.end - original->stable.begin;
+    const unsigned long size    = original->size + (scale - 1) * section;
+
+    *page = (bench_page_t) { .name = original->name, .scale = scale, .html = malloc(size), .size = size };
+    if (!page->html) {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    char* caret = page->html;
+    memcpy(caret, original->html, original->stable.end);
+    caret += original->stable.end;
+    for (unsigned long i = 1; i < scale; ++i, caret += section) memcpy(caret, original->html + original->stable.begin, section);
+    memcpy(caret, original->html + original->stable.end, original->size - original->stable.end);
+
+    page->stable = locate_stable_releases_htmldiv(page->html, page->size);
+    return true;
+}
+
+// measures every stage on the page, the releases print needs are parsed here
+static bool __cdecl bench_page(_Inout_ bench_page_t* const restrict page, _In_ const unsigned long nsamples, _In_ const bool is_json) {
+    page->results = parse_stable_releases(page->html + page->stable.begin, page->stable.end - page->stable.begin);
+    if (!page->results.versions) return false; // parse_stable_releases will do the error reporting
+
+    bool is_success = true;
+    for (unsigned long i = 0; i < sizeof(stages) / sizeof(stages[0]); ++i) is_success &= measure(page, stages + i, nsamples, is_json);
+
+    results_release(&page->results);
+    return is_success;
+}
+
+static bool __cdecl bench_pipeline(
+    _In_ const char* const* const restrict filenames, _In_ const unsigned long npages, _In_ const unsigned long nsamples, _In_ const bool is_json
+) {
+    if (!is_json)
+        wprintf_s(
+            L"%-40s %6s %-9s %10s %14s %8s %12s %10s\n", L"page", L"scale", L"stage", L"bytes", L"median ns/op", L"rsd", L"bytes/cycle", L"allocs/op"
+        );
+
+    bool is_success = true;
+    for (unsigned long i = 0; i < npages; ++i) {
+        bench_page_t original = { 0 };
+        if (!load_page(filenames[i], &original)) {
+            is_success = false;
+            continue;
+        }
+
+        for (unsigned long j = 0; j < sizeof(scales) / sizeof(scales[0]); ++j) {
+            bench_page_t scaled = { 0 };
+            if (!scale_page(&original, scales[j], &scaled)) {
+                is_success = false;
+                continue;
+            }
+            is_success &= bench_page(&scaled, nsamples, is_json);
+            free(scaled.html);
+        }
+        free(original.html);
+    }
+    return is_success;
+}
+
+// file name suffixes the synthetic listing cycles through, a mix of every artifact kind and links that aren't artifacts at all
+static const char* const suffixes[] = {
+    "-amd64.exe",       "-arm64.exe", ".exe",    "-embed-amd64.zip", "-embed-arm64.zip", "-embed-win32.zip",    ".tgz",
+    ".tar.xz",          ".chm",       ".msix",   "-amd64.exe.asc",   "-webinstall.exe",  "-macos11.pkg",        "-amd64.zip.sigstore",
+};
+
+// builds a listing in the style of the /ftp/python/ directory indices, at least size bytes of anchors to versioned artifacts with the dates and
+// sizes the server pads them with. the caller frees the returned buffer
+static char* __cdecl synthesize_listing(_In_ const unsigned long size, _Inout_ unsigned long* const restrict length) {
+    char* const restrict listing = malloc(size + 512);
+    if (!listing) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return NULL;
+    }
+
+    unsigned long offset
+        = (unsigned long) sprintf_s(listing, 512, "<html>\r\n<head><title>Index of /ftp/python/</title></head>\r\n<body>\r\n<pre>");
+    for (unsigned long i = 0; offset < size; ++i) {
+        const unsigned minor = (unsigned) (i / 280) % 14, micro = (unsigned) (i / 14) % 20; // NOLINT(readability-isolate-declaration)
+        const char* const suffix = suffixes[i % (sizeof(suffixes) / sizeof(suffixes[0]))];
+
+        offset += (unsigned long) sprintf_s(
+            listing + offset,
+            size + 512 - offset,
+            "<a href=\"https://www.python.org/ftp/python/3.%u.%u/python-3.%u.%u%s\">python-3.%u.%u%s</a>%*s%02u-Jun-2024 %02u:%02u %8lu\r\n",
+            minor,
+            micro,
+            minor,
+            micro,
+            suffix,
+            minor,
+            micro,
+            suffix,
+            (int) (40 - strlen(suffix)),
+            "",
+            (unsigned) (i % 28) + 1,
+            (unsigned) (i % 24),
+            (unsigned) (i % 60),
+            (i * 7919) % 30000000
+        );
+    }
+    offset += (unsigned long) sprintf_s(listing + offset, size + 512 - offset, "</pre><hr></body>\r\n</html>\r\n");
+
+    *length = offset;
+    return listing;
+}
+
+static bool __cdecl is_identical(_In_ const results_t left, _In_ const results_t right) {
+    return left.count == right.count && !memcmp(left.versions, right.versions, sizeof(span_t) * left.count) &&
+           !memcmp(left.downloadurls, right.downloadurls, sizeof(span_t) * left.count) && !memcmp(left.kinds, right.kinds, left.count);
+}
+
+// parses the synthetic listing with 1, 2, 4 ... BENCH_MAX_THREADS threads and reports the median throughput of each, after checking that
+// the parallel parse found exactly what the serial one did
+static bool __cdecl bench_parallel_scaling(void) {
+    unsigned long length  = 0;
+    char* const   listing = synthesize_listing(BENCH_LISTING_SIZE, &length);
+    if (!listing) return false;
+
+    results_t serial = parse_stable_releases(listing, length);
+    if (!serial.versions) {
+        free(listing);
+        return false;
+    }
+    wprintf_s(L"parse_stable_releases_parallel, %.1f MiB listing, %lu releases\n", (double) length / (1 << 20), serial.count);
+    wprintf_s(L"%8s %12s %12s %10s\n", L"threads", L"median ms", L"MiB/s", L"speedup");
+
+    bool   is_success                 = true;
+    double baseline                   = 0;
+    double timings[BENCH_REPETITIONS] = { 0 };
+
+    for (unsigned long nthreads = 1; nthreads <= BENCH_MAX_THREADS; nthreads *= 2) {
+        results_t warmup = parse_stable_releases_parallel(listing, length, nthreads); // faults the pages in and checks the output
+        if (!is_identical(serial, warmup)) {
+            fwprintf_s(stderr, L"Error: %lu threads parsed something else than the serial parser!\n", nthreads);
+            is_success = false;
+        }
+        results_release(&warmup);
+
+        for (unsigned long i = 0; i < BENCH_REPETITIONS; ++i) {
+            const double start   = nanoseconds();
+            results_t    results = parse_stable_releases_parallel(listing, length, nthreads);
+            timings[i]           = (nanoseconds() - start) / 1e9;
+            results_release(&results);
+        }
+        const double median = summarize(timings, BENCH_REPETITIONS).median;
+        if (nthreads == 1) baseline = median;
+        wprintf_s(L"%8lu %12.3f %12.1f %9.2fx\n", nthreads, median * 1e3, (double) length / (1 << 20) / median, baseline / median);
+    }
+
+    results_release(&serial);
+    free(listing);
+    return is_success;
+}
+
+// counts the bytes into the unsigned long behind context
+static bool __cdecl count_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    (void) chunk;
+    *(unsigned long*) context += size;
+    return true;
+}
+
+// a buffer the inflated bytes are copied to, sized by a first decode
+typedef struct _bench_output {
+        char*         data;
+        unsigned long size;
+        unsigned long capacity;
+} bench_output_t;
+
+static bool __cdecl copy_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    bench_output_t* const restrict output = context;
+    if (size > output->capacity - output->size) return false;
+    memcpy(output->data + output->size, chunk, size);
+    output->size += size;
+    return true;
+}
+
+// decodes the stream with inflate.c, pushing it in pieces of the given size
+static bool __cdecl inflate_once(
+    _In_ const char* const restrict compressed,
+    _In_ const unsigned long size,
+    _In_ const inflate_format_t format,
+    _In_ const unsigned long piece,
+    _In_ const http_sink_t sink,
+    _Inout_ void* const context
+) {
+    inflater_t inflater  = { 0 };
+    bool       is_pushed = true;
+    if (!inflater_init(&inflater, format, sink, context)) return false; // inflater_init will do the error reporting
+    for (unsigned long offset = 0; offset < size && is_pushed; offset += piece)
+        is_pushed = inflater_push(&inflater, compressed + offset, size - offset < piece ? size - offset : piece);
+    return inflater_finish(&inflater) && is_pushed; // inflater_finish must be called regardless, it releases the window
+}
+
+#ifdef BENCH_ZLIB
+// decodes the stream with zlib in one call, into an output buffer that's known to be large enough
+static bool __cdecl zlib_once(
+    _In_ const char* const restrict compressed, _In_ const unsigned long size, _Inout_ bench_output_t* const restrict output
+) {
+    z_stream stream = { 0 };
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) return false; // + 32 tells the gzip and zlib headers apart on its own
+
+    stream.next_in   = (Bytef*) compressed;
+    stream.avail_in  = (uInt) size;
+    stream.next_out  = (Bytef*) output->data;
+    stream.avail_out = (uInt) output->capacity;
+    const int status = inflate(&stream, Z_FINISH);
+    output->size     = stream.total_out;
+    inflateEnd(&stream);
+    return status == Z_STREAM_END;
+}
+#endif // BENCH_ZLIB
+
+// decodes every fixture BENCH_INFLATIONS times over with each decoder after an untimed decode, which must reproduce the page the first
+// decode found
+static bool __cdecl bench_inflate(_In_ const char* const* const restrict filenames, _In_ const unsigned long count) {
+    static const wchar_t* const decoders[] = { L"inflate.c", L"inflate.c 16K", L"zlib" };
+    double                      timings[BENCH_INFLATIONS] = { 0 };
+    bool                        is_success                = true;
+
+    wprintf_s(L"%-56s %10s %10s %-14s %10s %10s\n", L"fixture", L"bytes", L"inflated", L"decoder", L"median ms", L"MiB/s");
+    for (unsigned long i = 0; i < count; ++i) {
+        FILE*                  file       = NULL;
+        bench_output_t         expected   = { 0 };
+        bench_output_t         output     = { 0 };
+        char*                  compressed = NULL;
+        const size_t           length     = strlen(filenames[i]);
+        const bool             is_gzip    = length > 3 && !strcmp(filenames[i] + length - 3, ".gz");
+        const inflate_format_t format     = is_gzip ? INFLATE_GZIP : INFLATE_ZLIB;
+
+        if (fopen_s(&file, filenames[i], "rb")) {
+            fwprintf_s(stderr, L"Error: could not open %S!\n", filenames[i]);
+            is_success = false;
+            continue;
+        }
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        compressed         = size > 0 ? malloc((size_t) size) : NULL;
+        const bool is_read = compressed && fread(compressed, 1, (size_t) size, file) == (size_t) size;
+        fclose(file);
+
+        // the first decode only counts, the second fills the reference copy every timed decode is checked against
+        if (!is_read || !inflate_once(compressed, (unsigned long) size, format, (unsigned long) size, count_sink, &expected.capacity)) {
+            fwprintf_s(stderr, L"Error: %S is unreadable or not a %s stream!\n", filenames[i], is_gzip ? L"gzip" : L"zlib");
+            is_success = false;
+            goto NEXT;
+        }
+        expected.data   = malloc(expected.capacity);
+        output.data     = malloc(expected.capacity);
+        output.capacity = expected.capacity;
+        if (!expected.data || !output.data
+            || !inflate_once(compressed, (unsigned long) size, format, (unsigned long) size, copy_sink, &expected)) {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            is_success = false;
+            goto NEXT;
+        }
+
+        for (unsigned long decoder = 0; decoder < sizeof(decoders) / sizeof(decoders[0]); ++decoder) {
+#ifndef BENCH_ZLIB
+            if (decoder == 2) break; // built without zlib
+#endif
+            const unsigned long piece = decoder == 1 ? HTTP_CHUNK_SIZE : (unsigned long) size;
+            for (unsigned long j = 0; j <= BENCH_INFLATIONS; ++j) { // the first decode is the untimed one
+                const double begin = nanoseconds();
+                output.size        = 0;
+#ifdef BENCH_ZLIB
+                const bool is_inflated = decoder == 2 ? zlib_once(compressed, (unsigned long) size, &output)
+                                                      : inflate_once(compressed, (unsigned long) size, format, piece, copy_sink, &output);
+#else
+                const bool is_inflated = inflate_once(compressed, (unsigned long) size, format, piece, copy_sink, &output);
+#endif
+                if (j) timings[j - 1] = (nanoseconds() - begin) / 1e6;
+                if (!is_inflated || output.size != expected.size || memcmp(output.data, expected.data, expected.size)) {
+                    fwprintf_s(stderr, L"Error: %s decoded %S into something else!\n", decoders[decoder], filenames[i]);
+                    is_success = false;
+                    break;
+                }
+            }
+            const double median = summarize(timings, BENCH_INFLATIONS).median;
+            wprintf_s(
+                L"%-56S %10ld %10lu %-14s %10.3f %10.1f\n",
+                filenames[i],
+                size,
+                expected.size,
+                decoders[decoder],
+                median,
+                (double) expected.size / (1 << 20) / (median / 1e3)
+            );
+        }
+
+    NEXT:
+        free(compressed);
+        free(expected.data);
+        free(output.data);
+    }
+    return is_success;
+}
+
+// drops the file from the page cache, so the next read of it comes from the disk. dirty pages can't be dropped, so they're written back first
+static void __cdecl evict(_In_ const char* const restrict filename) {
+#ifdef _WIN32
+    // an unbuffered handle flushes the cached pages of the file and purges them
+    const HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+#endif
+}
+
+// reads every release the way printing them would, so that the mapped snapshot gets paged in as much as the parsed page is
+static unsigned long __cdecl touch(_In_ const results_t results) {
+    unsigned long sum = 0;
+    for (unsigned long i = 0; i < results.count; ++i)
+        sum += results.versions[i].length + (unsigned char) results.text[results.versions[i].offset] + results.downloadurls[i].length +
+               (unsigned char) results.text[results.downloadurls[i].offset] + results.kinds[i];
+    return sum;
+}
+
+// what crawl --from-file does before printing, read the page, find the stable releases section and parse it
+static bool __cdecl start_from_html(_In_ const char* const restrict filename, _Inout_ unsigned long* const restrict sum) {
+    bench_page_t page = { 0 };
+    if (!load_page(filename, &page)) return false; // load_page will do the error reporting
+    results_t results = parse_stable_releases(page.html + page.stable.begin, page.stable.end - page.stable.begin);
+    if (results.versions) *sum += touch(results);
+    const bool is_parsed = results.versions;
+    results_release(&results);
+    free(page.html);
+    return is_parsed;
+}
+
+// what crawl --from-snapshot does before printing, map the snapshot and validate it
+static bool __cdecl start_from_snapshot(_Inout_ unsigned long* const restrict sum) {
+    snapshot_t snapshot = { 0 };
+    if (!snapshot_map(L"" BENCH_SNAPSHOT, &snapshot)) return false; // snapshot_map will do the error reporting
+    *sum += touch(snapshot.releases);
+    snapshot_unmap(&snapshot);
+    return true;
+}
+
+// times the start of a run from every page and from its snapshot BENCH_STARTUPS times over, warm after an untimed run and cold with the file
+// evicted before every run
+static bool __cdecl bench_startup(_In_ const char* const* const restrict filenames, _In_ const unsigned long count) {
+    static const wchar_t* const sources[] = { L"html", L"snapshot" };
+    double                      timings[BENCH_STARTUPS] = { 0 };
+    bool                        is_success              = true;
+
+    wprintf_s(L"%-40s %10s %10s %-9s %-5s %12s\n", L"page", L"releases", L"file bytes", L"source", L"cache", L"median us");
+    for (unsigned long i = 0; i < count && is_success; ++i) {
+        bench_page_t page = { 0 };
+        if (!load_page(filenames[i], &page)) return false; // load_page will do the error reporting
+        results_t results = parse_stable_releases(page.html + page.stable.begin, page.stable.end - page.stable.begin);
+        is_success        = results.versions && snapshot_write(L"" BENCH_SNAPSHOT, results); // both will do the error reporting
+        const unsigned long      releases      = results.count;
+        const unsigned long long snapshot_size = sizeof(snapshot_header_t) + results.count * RESULTS_RECORD_SIZE + results_text_size(results);
+        results_release(&results);
+        free(page.html);
+
+        for (unsigned long source = 0; source < sizeof(sources) / sizeof(sources[0]) && is_success; ++source) {
+            const char* const filename = source ? BENCH_SNAPSHOT : filenames[i];
+            for (unsigned long is_cold = 0; is_cold <= 1 && is_success; ++is_cold) {
+                for (unsigned long j = 0; j <= BENCH_STARTUPS && is_success; ++j) { // the first run is the untimed one
+                    unsigned long sum = 0;
+                    if (is_cold) evict(filename);
+                    const double begin = nanoseconds();
+                    is_success         = source ? start_from_snapshot(&sum) : start_from_html(filename, &sum);
+                    if (j) timings[j - 1] = (nanoseconds() - begin) / 1e3;
+                    if (!j && !is_success) fwprintf_s(stderr, L"Error: %s startup from %S failed!\n", sources[source], filename);
+                }
+                if (!is_success) break;
+                wprintf_s(
+                    L"%-40S %10lu %10llu %-9s %-5s %12.1f\n",
+                    filenames[i],
+                    releases,
+                    source ? snapshot_size : (unsigned long long) page.size,
+                    sources[source],
+                    is_cold ? L"cold" : L"warm",
+                    summarize(timings, BENCH_STARTUPS).median
+                );
+            }
+        }
+    }
+    remove(BENCH_SNAPSHOT);
+    return is_success;
+}
+
+// finds every python on PATH the way crawl.exe --pythons does, lists them and reports how long it took and how many had to be run. a
+// single run, a second one would only measure the file system cache
+static bool __cdecl bench_python_detection(void) {
+    python_interpreter_t interpreters[PYTHON_MAX_INTERPRETERS] = { 0 };
+    unsigned long        nspawned                              = 0;
+
+    const double        begin = nanoseconds();
+    const unsigned long count = find_python_interpreters(interpreters, PYTHON_MAX_INTERPRETERS, false);
+    const double        end   = nanoseconds();
+
+    print_python_interpreters(interpreters, count);
+    for (unsigned long i = 0; i < count; ++i)
+        nspawned += interpreters[i].source == PYTHON_SOURCE_SPAWN || interpreters[i].source == PYTHON_SOURCE_NONE;
+    wprintf_s(L"%lu interpreters in %.3f ms, %lu of them run with --version\n", count, (end - begin) / 1e6, nspawned);
+    return count > 0;
+}
+
+// a thread of the blocking side of the fanout benchmark, fetches its share of the fetches one after the other
+typedef struct _fanout_worker {
+        const wchar_t* path;
+        unsigned short port;
+        unsigned long  count;   // fetches to make
+        unsigned long  nfailed; // fetches that didn't come through
+        unsigned long  size;    // bytes of body received
+} fanout_worker_t;
+
+static bool __cdecl fanout_worker(_Inout_opt_ void* const argument) {
+    fanout_worker_t* const restrict worker = argument;
+    for (unsigned long i = 0; i < worker->count; ++i) {
+        http_request_t request  = { 0 };
+        unsigned long  received = 0;
+        if (!socket_transport.get(&request, L"127.0.0.1", worker->port, worker->path)
+            || !socket_transport.read(&request, count_sink, &worker->size, &received))
+            worker->nfailed++;
+    }
+    return !worker->nfailed;
+}
+
+// times count fetches of the path through both backends, the blocking one first so that fetch_all finds the server as warm as it left it
+static bool __cdecl bench_fanout(_In_ const unsigned short port, _In_ const char* const restrict path, _In_ const unsigned long count) {
+    fanout_worker_t workers[BENCH_FANOUT_THREADS];
+    task_t          tasks[BENCH_FANOUT_THREADS];
+    wchar_t         wide_path[BUFF_SIZE] = { 0 };
+    unsigned long   nfailed              = 0;
+    unsigned long   size                 = 0;
+    fetch_t* const  fetches              = calloc(count, sizeof(fetch_t));
+
+    if (!fetches) {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+    if (mbstowcs(wide_path, path, BUFF_SIZE - 1) == (size_t) -1) {
+        fwprintf_s(stderr, L"Error: %S is not a path!\n", path);
+        free(fetches);
+        return false;
+    }
+
+    const double blocking_begin = nanoseconds();
+    for (unsigned long i = 0; i < BENCH_FANOUT_THREADS; ++i) {
+        const unsigned long share = count / BENCH_FANOUT_THREADS + (i < count % BENCH_FANOUT_THREADS); // the first ones take the remainder
+        workers[i]                = (fanout_worker_t) { .path = wide_path, .port = port, .count = share };
+        task_start(tasks + i, fanout_worker, workers + i);
+    }
+    for (unsigned long i = 0; i < BENCH_FANOUT_THREADS; ++i) {
+        (void) task_wait(tasks + i);
+        nfailed += workers[i].nfailed;
+        size    += workers[i].size;
+    }
+    const double blocking_end = nanoseconds();
+    pool_drain();
+    wprintf_s(
+        L"%-10s %6lu fetches on %3llu threads     %9.1f ms %9.0f fetches/s %lu failed, %lu bytes\n",
+        L"blocking",
+        count,
+        BENCH_FANOUT_THREADS,
+        (blocking_end - blocking_begin) / 1e6,
+        count / (blocking_end - blocking_begin) * 1e9,
+        nfailed,
+        size
+    );
+
+    for (unsigned long i = 0; i < count; ++i) fetches[i].path = path;
+    const double        ring_begin = nanoseconds();
+    const unsigned long nsucceeded = fetch_all(L"127.0.0.1", port, fetches, count, count);
+    const double        ring_end   = nanoseconds();
+    unsigned long       ring_size  = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        ring_size += fetches[i].body.size;
+        body_release(&fetches[i].body);
+    }
+    free(fetches);
+    wprintf_s(
+        L"%-10s %6lu fetches on %4lu connections %9.1f ms %9.0f fetches/s %lu failed, %lu bytes\n",
+        L"ring",
+        count,
+        count < RING_MAX_CONNECTIONS ? count : (unsigned long) RING_MAX_CONNECTIONS,
+        (ring_end - ring_begin) / 1e6,
+        count / (ring_end - ring_begin) * 1e9,
+        count - nsucceeded,
+        ring_size
+    );
+    return !nfailed && nsucceeded == count;
+}
+
+int main(int argc, char* argv[]) {
+    bool          is_json    = false;
+    bool          is_scaling = false;
+    bool          is_inflate = false;
+    bool          is_startup = false;
+    bool          is_pythons = false;
+    unsigned long port       = 0;
+    unsigned long nfetches   = BENCH_FANOUT_FETCHES;
+    unsigned long nsamples   = BENCH_SAMPLES;
+    unsigned long npages     = 0;
+    const char**  filenames  = calloc(argc > 1 ? (size_t) argc : 1, sizeof(char*));
+
+    if (!filenames) {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--json"))
+            is_json = true;
+        else if (!strcmp(argv[i], "--scaling"))
+            is_scaling = true;
+        else if (!strcmp(argv[i], "--inflate"))
+            is_inflate = true;
+        else if (!strcmp(argv[i], "--startup"))
+            is_startup = true;
+        else if (!strcmp(argv[i], "--pythons"))
+            is_pythons = true;
+        else if (!strcmp(argv[i], "--fanout") && i + 1 < argc) {
+            port = strtoul(argv[++i], NULL, 10);
+            if (!port || port > 65535) {
+                fwprintf_s(stderr, L"Error: --fanout takes a port between 1 and 65535!\n");
+                free(filenames);
+                return EXIT_FAILURE;
+            }
+        } else if (!strcmp(argv[i], "--fetches") && i + 1 < argc) {
+            nfetches = strtoul(argv[++i], NULL, 10);
+            if (!nfetches) {
+                fputws(L"Error: --fetches takes a positive count!\n", stderr);
+                free(filenames);
+                return EXIT_FAILURE;
+            }
+        } else if (!strcmp(argv[i], "--samples") && i + 1 < argc) {
+            nsamples = strtoul(argv[++i], NULL, 10);
+            if (!nsamples || nsamples > BENCH_MAX_SAMPLES) {
+                fwprintf_s(stderr, L"Error: --samples takes a count between 1 and %llu!\n", BENCH_MAX_SAMPLES);
+                free(filenames);
+                return EXIT_FAILURE;
+            }
+        } else if (!strncmp(argv[i], "--", 2)) {
+            fwprintf_s(stderr, L"Error: unrecognized argument %S!\n", argv[i]);
+            free(filenames);
+            return EXIT_FAILURE;
+        } else
+            filenames[npages++] = argv[i];
+    }
+
+    bool is_success = false;
+    if (is_pythons)
+        is_success = bench_python_detection();
+    else if (port)
+        is_success = bench_fanout((unsigned short) port, npages ? filenames[0] : "/", nfetches);
+    else if (is_scaling)
+        is_success = bench_parallel_scaling();
+    else if (is_inflate && npages)
+        is_success = bench_inflate(filenames, npages);
+    else if (is_inflate)
+        is_success = bench_inflate(default_fixtures, sizeof(default_fixtures) / sizeof(default_fixtures[0]));
+    else if (is_startup && npages)
+        is_success = bench_startup(filenames, npages);
+    else if (is_startup)
+        is_success = bench_startup(default_pages, sizeof(default_pages) / sizeof(default_pages[0]));
+    else if (npages)
+        is_success = bench_pipeline(filenames, npages, nsamples, is_json);
+    else
+        is_success = bench_pipeline(default_pages, sizeof(default_pages) / sizeof(default_pages[0]), nsamples, is_json);
+
+    free(filenames);
+    return is_success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+// just enough of Windows.h and the MSVC runtime for the sources the benchmarks, crawl-check and the crawl of bench/Makefile link against to
+// build with gcc or clang on Linux. that's all of crawl.exe but http.c, the WinHttp transport, which is Win32 through and through.
+// the wide printf family follows MSVC, where %s takes a wide string and %S a narrow one, so the formats are translated to their glibc spelling.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#define _In_
+#define _In_opt_
+#define _Inout_
+#define _Inout_opt_
+#define _Out_
+#define _Out_opt_
+#define __cdecl
+#define __stdcall
+#define __FUNCTIONW__ L"" // there's no wide counterpart of __func__ outside MSVC
+
+typedef void*              HANDLE;
+typedef void*              HANDLE64;
+typedef void*              HINTERNET;
+typedef int                BOOL;
+typedef unsigned long      DWORD;
+typedef unsigned long long ULONGLONG;
+
+typedef union _LARGE_INTEGER {
+        struct {
+                DWORD LowPart;
+                long  HighPart;
+        };
+        long long QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _FILETIME {
+        DWORD dwLowDateTime;
+        DWORD dwHighDateTime;
+} FILETIME;
+
+#define INVALID_HANDLE_VALUE               ((HANDLE) (intptr_t) -1)
+#define GENERIC_READ                       0x80000000LU
+#define GENERIC_WRITE                      0x40000000LU
+#define FILE_SHARE_READ                    0x1LU
+#define FILE_SHARE_DELETE                  0x4LU
+#define OPEN_EXISTING                      3LU
+#define CREATE_ALWAYS                      2LU
+#define FILE_ATTRIBUTE_READONLY            0x1LU
+#define FILE_ATTRIBUTE_DIRECTORY           0x10LU
+#define FILE_ATTRIBUTE_NORMAL              0x80LU
+#define INVALID_FILE_ATTRIBUTES            ((DWORD) -1)
+#define PAGE_READONLY                      0x2LU
+#define FILE_MAP_READ                      0x4LU
+#define MOVEFILE_REPLACE_EXISTING          0x1LU
+#define STD_OUTPUT_HANDLE                  ((DWORD) -11)
+#define STD_ERROR_HANDLE                   ((DWORD) -12)
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x4LU
+#define MAX_PATH                           260
+
+// file handles are file descriptors off by one, so that descriptor 0 doesn't look like a NULL handle. lib.c holds them through const pointers
+#define handle_to_fd(handle) ((int) (intptr_t) (handle) - 1)
+
+static inline DWORD GetLastError(void) {
+    return (DWORD) errno;
+}
+
+static inline HANDLE CreateFileW(
+    const wchar_t* const filename, const DWORD access, const DWORD share, void* const security, const DWORD disposition, const DWORD flags,
+    const HANDLE template
+) {
+    (void) share, (void) security, (void) disposition, (void) flags, (void) template;
+    char path[MAX_PATH * 4] = { 0 };
+    if (wcstombs(path, filename, sizeof(path)) == (size_t) -1) return INVALID_HANDLE_VALUE;
+
+    const int fd = access & GENERIC_WRITE ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    return fd < 0 ? INVALID_HANDLE_VALUE : (HANDLE) (intptr_t) (fd + 1);
+}
+
+// only tells files from directories, that's all cache.c asks it
+static inline DWORD GetFileAttributesW(const wchar_t* const filename) {
+    char        path[MAX_PATH * 4] = { 0 };
+    struct stat status             = { 0 };
+    if (wcstombs(path, filename, sizeof(path)) == (size_t) -1 || stat(path, &status)) return INVALID_FILE_ATTRIBUTES;
+    return S_ISDIR(status.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+}
+
+static inline BOOL DeleteFileW(const wchar_t* const filename) {
+    char path[MAX_PATH * 4] = { 0 };
+    return wcstombs(path, filename, sizeof(path)) != (size_t) -1 && !unlink(path);
+}
+
+// rename replaces the target anyway, which is all snapshot.c asks for
+static inline BOOL MoveFileExW(const wchar_t* const from, const wchar_t* const to, const DWORD flags) {
+    (void) flags;
+    char source[MAX_PATH * 4] = { 0 }, target[MAX_PATH * 4] = { 0 }; // NOLINT(readability-isolate-declaration)
+    if (wcstombs(source, from, sizeof(source)) == (size_t) -1 || wcstombs(target, to, sizeof(target)) == (size_t) -1) return 0;
+    return !rename(source, target);
+}
+
+// TMPDIR or /tmp, ending with a separator like the path GetTempPathW returns. 0 when it doesn't fit
+static inline DWORD GetTempPathW(const DWORD size, wchar_t* const buffer) {
+    const char* const directory = getenv("TMPDIR") && *getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    const char* const separator = directory[strlen(directory) - 1] == '/' ? "" : "/";
+    const int         length    = swprintf(buffer, size, L"%s%s", directory, separator);
+    return length < 0 ? 0 : (DWORD) length;
+}
+
+// 100 nanosecond intervals since 1601-01-01, 11644473600 seconds before the Unix epoch
+static inline void GetSystemTimeAsFileTime(FILETIME* const filetime) {
+    struct timespec now = { 0 };
+    clock_gettime(CLOCK_REALTIME, &now);
+    const uint64_t ticks     = ((uint64_t) now.tv_sec + 11644473600LLU) * 10000000LLU + (uint64_t) now.tv_nsec / 100;
+    filetime->dwLowDateTime  = (DWORD) (ticks & 0xFFFFFFFFLLU);
+    filetime->dwHighDateTime = (DWORD) (ticks >> 32);
+}
+
+static inline BOOL GetFileSizeEx(const void* const file, LARGE_INTEGER* const size) {
+    struct stat status = { 0 };
+    if (fstat(handle_to_fd(file), &status)) return 0;
+    size->QuadPart = status.st_size;
+    return 1;
+}
+
+static inline BOOL ReadFile(const void* const file, void* const buffer, const DWORD size, DWORD* const read_size, void* const overlapped) {
+    (void) overlapped;
+    const ssize_t count = read(handle_to_fd(file), buffer, size);
+    if (read_size) *read_size = count < 0 ? 0 : (DWORD) count;
+    return count >= 0;
+}
+
+static inline BOOL WriteFile(const void* const file, const void* const buffer, const DWORD size, DWORD* const written_size, void* const overlapped) {
+    (void) overlapped;
+    const ssize_t count = write(handle_to_fd(file), buffer, size);
+    if (written_size) *written_size = count < 0 ? 0 : (DWORD) count;
+    return count >= 0;
+}
+
+static inline BOOL CloseHandle(const void* const handle) {
+    return !close(handle_to_fd(handle));
+}
+
+// a file mapping is a duplicate of the file's descriptor, and a view the whole file mapped read-only behind a page that holds its size, as
+// munmap needs the size that UnmapViewOfFile isn't given. only whole file read-only views, which is what snapshot.c maps
+static inline HANDLE CreateFileMappingW(
+    const HANDLE file, void* const security, const DWORD protection, const DWORD high, const DWORD low, const wchar_t* const name
+) {
+    (void) security, (void) protection, (void) high, (void) low, (void) name;
+    const int fd = dup(handle_to_fd(file));
+    return fd < 0 ? NULL : (HANDLE) (intptr_t) (fd + 1);
+}
+
+static inline void* MapViewOfFile(const HANDLE mapping, const DWORD access, const DWORD high, const DWORD low, const size_t size) {
+    (void) access, (void) high, (void) low, (void) size;
+    const size_t page   = (size_t) sysconf(_SC_PAGESIZE);
+    struct stat  status = { 0 };
+    if (fstat(handle_to_fd(mapping), &status) || status.st_size <= 0) return NULL;
+
+    char* const base = mmap(NULL, page + (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+    *(size_t*) base = (size_t) status.st_size;
+    if (mmap(base + page, (size_t) status.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, handle_to_fd(mapping), 0) == MAP_FAILED) {
+        munmap(base, page + (size_t) status.st_size);
+        return NULL;
+    }
+    return base + page;
+}
+
+static inline BOOL UnmapViewOfFile(const void* const view) {
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    char* const  base = (char*) view - page;
+    return !munmap(base, page + *(const size_t*) base);
+}
+
+static inline HANDLE GetStdHandle(const DWORD which) {
+    return (HANDLE) (intptr_t) ((which == STD_ERROR_HANDLE ? STDERR_FILENO : STDOUT_FILENO) + 1);
+}
+
+// terminals on Linux understand VT escape sequences to begin with
+static inline BOOL GetConsoleMode(const HANDLE console, DWORD* const mode) {
+    (void) console;
+    *mode = ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    return 1;
+}
+
+static inline BOOL SetConsoleMode(const HANDLE console, const DWORD mode) {
+    (void) console, (void) mode;
+    return 1;
+}
+
+// rewrites an MSVC wide format string for glibc: %s becomes %ls and %S becomes %s, everything else is spelled the same
+static inline const wchar_t* translate_format(const wchar_t* const format, wchar_t* const translated, const size_t size) {
+    size_t j = 0;
+    for (size_t i = 0; format[i] && j + 3 < size; ++i) {
+        translated[j++] = format[i];
+        if (format[i] != L'%') continue;
+        if (format[i + 1] == L'%') {
+            translated[j++] = format[++i];
+            continue;
+        }
+
+        while (format[i + 1] && wcschr(L"-+ #0123456789.*", format[i + 1]) && j + 3 < size) translated[j++] = format[++i];
+        if (format[i + 1] == L's') translated[j++] = L'l';
+        else if (format[i + 1] == L'S') {
+            translated[j++] = L's';
+            ++i;
+        }
+    }
+    translated[j] = L'\0';
+    return translated;
+}
+
+static inline int fwprintf_s(FILE* const stream, const wchar_t* const format, ...) {
+    wchar_t translated[1024] = { 0 };
+    va_list arguments;
+    va_start(arguments, format);
+    const int count = vfwprintf(stream, translate_format(format, translated, 1024), arguments);
+    va_end(arguments);
+    return count;
+}
+
+static inline int wprintf_s(const wchar_t* const format, ...) {
+    wchar_t translated[1024] = { 0 };
+    va_list arguments;
+    va_start(arguments, format);
+    const int count = vwprintf(translate_format(format, translated, 1024), arguments);
+    va_end(arguments);
+    return count;
+}
+
+static inline int swprintf_s(wchar_t* const buffer, const size_t size, const wchar_t* const format, ...) {
+    wchar_t translated[1024] = { 0 };
+    va_list arguments;
+    va_start(arguments, format);
+    const int count = vswprintf(buffer, size, translate_format(format, translated, 1024), arguments);
+    va_end(arguments);
+    return count;
+}
+
+static inline int wcscpy_s(wchar_t* const destination, const size_t size, const wchar_t* const source) {
+    if (wcslen(source) >= size) return ERANGE;
+    wcscpy(destination, source);
+    return 0;
+}
+
+static inline int wcscat_s(wchar_t* const destination, const size_t size, const wchar_t* const source) {
+    if (wcslen(destination) + wcslen(source) >= size) return ERANGE;
+    wcscat(destination, source);
+    return 0;
+}
+
+static inline int _wtoi(const wchar_t* const string) {
+    return (int) wcstol(string, NULL, 10);
+}
+
+static inline int strcpy_s(char* const destination, const size_t size, const char* const source) {
+    if (strlen(source) >= size) return ERANGE;
+    strcpy(destination, source);
+    return 0;
+}
+
+static inline int _putws(const wchar_t* const string) {
+    return fputws(string, stdout) < 0 ? WEOF : fputwc(L'\n', stdout) == WEOF ? WEOF : 0;
+}
+
+static inline int fopen_s(FILE** const file, const char* const filename, const char* const mode) {
+    *file = fopen(filename, mode);
+    return *file ? 0 : errno;
+}
+
+#define sprintf_s snprintf
+#define _dup      dup
+#define _dup2     dup2
+#define _close    close
+#define _fileno   fileno
+#define _open     open
+#define _O_WRONLY O_WRONLY
@@ -0,0 +1,9 @@
+#pragma once
+
+// the sources built here talk HTTP through sockets.c and ring.c, never WinHttp. project.h and the status checks only need the handful of
+// names below, see Windows.h
+
+#define INTERNET_DEFAULT_HTTP_PORT  80
+#define HTTP_STATUS_OK              200
+#define HTTP_STATUS_PARTIAL_CONTENT 206
+#define HTTP_STATUS_NOT_MODIFIED    304
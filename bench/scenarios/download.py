@@ -0,0 +1,181 @@
+# --download against local servers that serve an /ftp/python/ tree with a single installer and the release page with its SHA-256:
+#
+#     1. a server that does ranges and caps every connection at RATE bytes a second, the installer must come over --connections 4 in
+#        about the time a quarter of it takes on one connection, and come out byte for byte with its checksum verified
+#     2. a server that ignores Range and answers with the whole installer, which must come over the single connection of the first request
+#     3. a run killed in the middle of the download, and a second run that must pick up the segments where the first left them on disk
+#        rather than fetching the installer again
+#     4. an installer that changes on the server after the first segments, the If-Range of the requests after it gets the new copy with a
+#        200, which must fail the download with nothing left in place of the installer. a second run must then download the new copy
+#
+# the installer is found with --ftp and picked with --exact, every scenario downloads into a directory of its own.
+# python download.py <crawl> [argument]...
+
+import hashlib
+import os
+import shutil
+import tempfile
+import threading
+import time
+
+from local import Checks, Run, Server, arguments, run, wait
+
+VERSION = "3.13.0"
+NAME = f"python-{VERSION}-amd64.exe"
+PATH = f"/ftp/python/{VERSION}/{NAME}"
+SIZE = 6 * 1024 * 1024  # bytes of the installer, six segments of DOWNLOAD_MIN_SEGMENT
+RATE = 1024 * 1024  # bytes a second every connection of the capped servers sends
+
+crawl, extra = arguments()
+checks = Checks("download")
+workspace = tempfile.mkdtemp(prefix="crawl-download-")
+
+
+def listing(names):
+    rows = "".join(f'<a href="{name}">{name}</a>                 07-Oct-2024 12:00    -\n' for name in names)
+    return f'<html><body><h1>Index</h1><pre><a href="../">../</a>\n{rows}</pre></body></html>'.encode()
+
+
+def release_page(body):
+    url = f"https://www.python.org{PATH}"
+    row = f'<tr><td><a href="{url}">Windows installer (64-bit)</a></td><td>Windows</td><td>Recommended</td>'
+    row += f"<td>{hashlib.sha256(body).hexdigest()}</td><td>{len(body)}</td><td><a href=\"{url}.asc\">SIG</a></td></tr>"
+    return f"<html><body><table><tbody>{row}</tbody></table></body></html>".encode()
+
+
+class Installer:
+    """the tree, the release page and the installer, served with an ETag of its bytes. ranges=False ignores Range headers, change_after
+    swaps in another copy of the installer once that many ranges of the first were asked for. ranges logs (If-Range, first, last) of every
+    ranged request"""
+
+    def __init__(self, ranges=True, change_after=None):
+        self.body = os.urandom(SIZE)
+        self.is_ranging = ranges
+        self.change_after = change_after
+        self.ranges = []
+        self.lock = threading.Lock()
+
+    @staticmethod
+    def etag(body):
+        return '"' + hashlib.sha1(body).hexdigest()[:16] + '"'
+
+    def answer(self, request):
+        if request.path == "/ftp/python/":
+            return 200, {"Content-Type": "text/html"}, listing([f"{VERSION}/"])
+        if request.path == f"/ftp/python/{VERSION}/":
+            return 200, {"Content-Type": "text/html"}, listing([NAME])
+        if request.path == f"/downloads/release/python-{VERSION.replace('.', '')}/":
+            return 200, {"Content-Type": "text/html"}, release_page(self.body)
+        if request.path != PATH:
+            return None
+
+        wanted = request.headers.get("Range")
+        condition = request.headers.get("If-Range")
+        with self.lock:
+            if wanted and self.change_after is not None and len(self.ranges) == self.change_after:
+                self.body = os.urandom(SIZE)
+            if wanted:
+                first, last = (int(bound) for bound in wanted[len("bytes=") :].split("-"))
+                self.ranges.append((condition, first, last))
+            body, etag = self.body, self.etag(self.body)
+
+        headers = {"Content-Type": "application/octet-stream", "ETag": etag, "Accept-Ranges": "bytes" if self.is_ranging else "none"}
+        if not wanted or not self.is_ranging or (condition and condition != etag):
+            return 200, headers, body
+        headers["Content-Range"] = f"bytes {first}-{last}/{len(body)}"
+        return 206, headers, body[first : last + 1]
+
+    def segments(self):
+        """the ranges after the probe of the first byte"""
+        with self.lock:
+            return [(first, last) for _, first, last in self.ranges if (first, last) != (0, 0)]
+
+
+def options(server, directory, *more):
+    return ["--ftp", "--server", "127.0.0.1", "--port", str(server.port), "--exact", VERSION, "--download", directory, *more]
+
+
+def directory(name):
+    path = os.path.join(workspace, name)
+    os.mkdir(path)
+    return path
+
+
+def downloaded(path):
+    with open(os.path.join(path, NAME), "rb") as file:
+        return file.read()
+
+
+def leftovers(path):
+    return sorted(name for name in os.listdir(path) if name != NAME)
+
+
+try:
+    installer = Installer()
+    server = Server(installer.answer, rate=RATE)
+    target = directory("capped")
+    started = time.monotonic()
+    code, output, errors = run(crawl, *extra, *options(server, target, "--connections", "4"))
+    elapsed = time.monotonic() - started
+    server.stop()
+    checks.expect(code == 0, f"the capped download exited with {code}: {errors.strip()[-500:]}")
+    checks.expect(code == 0 and downloaded(target) == installer.body, "the capped download isn't the installer")
+    checks.expect("SHA-256 checksum verified" in errors, "the capped download wasn't verified against its SHA-256")
+    checks.expect("over 4 connections" in errors, "the capped download didn't run over 4 connections")
+    checks.expect(elapsed < SIZE / RATE * 0.75, f"the capped download took {elapsed:.1f} s, the connections didn't add up")
+    checks.expect(len(installer.segments()) == SIZE // (1024 * 1024), f"the installer came in {len(installer.segments())} ranges")
+    checks.expect(not leftovers(target), f"the capped download left {leftovers(target)} behind")
+
+    installer = Installer(ranges=False)
+    server = Server(installer.answer)
+    target = directory("whole")
+    code, output, errors = run(crawl, *extra, *options(server, target))
+    server.stop()
+    requests = [entry for entry in server.requests("GET") if entry[1] == PATH]
+    checks.expect(code == 0, f"the download without ranges exited with {code}: {errors.strip()[-500:]}")
+    checks.expect(code == 0 and downloaded(target) == installer.body, "the download without ranges isn't the installer")
+    checks.expect("over a single connection" in errors, "the download without ranges didn't keep to the first connection")
+    checks.expect(len(requests) == 1, f"the installer was asked for {len(requests)} times by a server without ranges")
+    checks.expect("SHA-256 checksum verified" in errors, "the download without ranges wasn't verified against its SHA-256")
+
+    installer = Installer()
+    server = Server(installer.answer, rate=RATE // 4)
+    target = directory("resumed")
+    downloader = Run(crawl, *extra, *options(server, target, "--connections", "2"))
+    wait(lambda: os.path.exists(os.path.join(target, NAME + ".segments")) or downloader.process.poll() is not None, 30)
+    wait(lambda: downloader.process.poll() is not None, 3)  # long enough for a few checkpoints of progress on either connection
+    downloader.process.kill()
+    downloader.process.wait(30)
+    checks.expect(leftovers(target) == [NAME + ".part", NAME + ".segments"], f"the killed download left {leftovers(target)}")
+
+    before = len(installer.ranges)
+    server.rate = None
+    code, output, errors = run(crawl, *extra, *options(server, target, "--connections", "2"))
+    server.stop()
+    resumed = [(first, last) for _, first, last in installer.ranges[before:] if (first, last) != (0, 0)]
+    fetched = sum(last + 1 - first for first, last in resumed)
+    checks.expect(code == 0, f"the resumed download exited with {code}: {errors.strip()[-500:]}")
+    checks.expect(code == 0 and downloaded(target) == installer.body, "the resumed download isn't the installer")
+    checks.expect("SHA-256 checksum verified" in errors, "the resumed download wasn't verified against its SHA-256")
+    checks.expect(0 < fetched < SIZE, f"the resumed download fetched {fetched} of the {SIZE} bytes again")
+    checks.expect(not leftovers(target), f"the resumed download left {leftovers(target)} behind")
+
+    installer = Installer(change_after=2)
+    server = Server(installer.answer, rate=RATE)
+    target = directory("changed")
+    code, output, errors = run(crawl, *extra, *options(server, target, "--connections", "2"))
+    statuses = [status for _, path, status in server.requests("GET") if path == PATH]
+    checks.expect(code != 0, "the download of an installer that changed on the server succeeded")
+    checks.expect(200 in statuses[1:], f"the If-Range of the old copy was answered with {statuses}, not a 200")
+    checks.expect("changed on the server" in errors, "the download didn't tell the installer changed on the server")
+    checks.expect(not os.path.exists(os.path.join(target, NAME)), "the installer that changed on the server was left in place")
+
+    installer.change_after = None
+    code, output, errors = run(crawl, *extra, *options(server, target, "--connections", "2"))
+    server.stop()
+    checks.expect(code == 0, f"the download after the change exited with {code}: {errors.strip()[-500:]}")
+    checks.expect(code == 0 and downloaded(target) == installer.body, "the download after the change isn't the new copy")
+    checks.expect(not leftovers(target), f"the download after the change left {leftovers(target)} behind")
+finally:
+    shutil.rmtree(workspace, ignore_errors=True)
+checks.finish()
@@ -0,0 +1,108 @@
+# --ftp against a local server that serves a generated /ftp/python/ tree of 700 releases, a little over 2100 directories and 24000 links:
+#
+#     /ftp/python/                 every release, a few of their amd64/ directories a second time, doc/, README.html, the sorting links of
+#                                  the listing, a link to the parent, an absolute link and one to another host
+#     /ftp/python/<version>/       the installers, the embeddable amd64 zip and the source tarball, which are artifacts, a web installer and a
+#                                  signature, which aren't, and the amd64/ and win32/ directories
+#     /ftp/python/<version>/win32/ MSIs and the embeddable win32 zip, which is an artifact of the version of the directory above
+#     .../amd64/loop/              one release has a link loop, which must stop at the depth limit of --ftp (8 below /ftp/python/)
+#
+# every configuration must index exactly the artifacts of the tree, list every directory once and keep to --per-host requests in flight.
+# python ftp.py <crawl> [argument]...
+
+from local import Checks, Server, arguments, run
+
+DELAY = 0.002  # seconds every listing is held back, enough to have the workers overlap
+MAX_DEPTH = 8  # FTP_MAX_DEPTH
+LOOPED = "3.13.0"  # the release whose amd64/ directory has the link loop
+CONFIGURATIONS = [["--jobs", "1", "--per-host", "1"], [], ["--jobs", "32", "--per-host", "4"]]
+
+crawl, extra = arguments()
+checks = Checks("ftp")
+versions = [f"{major}.{minor}.{micro}" for major in (2, 3) for minor in range(14) for micro in range(25)]
+
+
+def listing(names):
+    rows = "".join(f'<a href="{name}">{name}</a>                 01-Jan-2024 00:00    -\n' for name in names)
+    return f'<html><body><h1>Index</h1><pre><a href="?C=N;O=D">Name</a>\n<a href="../">../</a>\n{rows}</pre></body></html>'.encode()
+
+
+def directory(path):
+    """the names in the directory at path below /ftp/python/, None for anything that isn't one"""
+    parts = [part for part in path.split("/") if part]
+    if not parts:
+        return [f"{version}/" for version in versions] + [f"{version}/amd64/" for version in versions[::50]] + [
+            "doc/",
+            "README.html",
+            "/ftp/python/",
+            "http://elsewhere.example/ftp/python/",
+        ]
+    if parts[0] == "doc" and len(parts) == 1:
+        return ["index.html", "python-docs.zip"]
+    if parts[0] not in versions:
+        return None
+    version = parts[0]
+    if len(parts) == 1:
+        return [
+            f"python-{version}-amd64.exe",
+            f"python-{version}-arm64.exe",
+            f"python-{version}.exe",
+            f"python-{version}-embed-amd64.zip",
+            f"Python-{version}.tgz",
+            f"python-{version}-webinstall.exe",
+            f"python-{version}-amd64.exe.asc",
+            "amd64/",
+            "win32/",
+        ]
+    if len(parts) == 2 and parts[1] == "win32":
+        return [f"core_{i}.msi" for i in range(10)] + [f"python-{version}-embed-win32.zip"]
+    if len(parts) == 2 and parts[1] == "amd64":
+        return [f"core_{i}.msi" for i in range(10)] + (["loop/"] if version == LOOPED else [])
+    if version == LOOPED and parts[1] == "amd64" and all(part == "loop" for part in parts[2:]):
+        return ["loop/", "core.msi"]
+    return None
+
+
+def answer(request):
+    if not request.path.startswith("/ftp/python/") or not request.path.endswith("/"):
+        return None
+    names = directory(request.path[len("/ftp/python/") :])
+    return None if names is None else (200, {"Content-Type": "text/html"}, listing(names))
+
+
+def artifacts(origin):
+    expected = set()
+    for version in versions:
+        base = f"{origin}/ftp/python/{version}/"
+        expected |= {
+            (version, f"{base}python-{version}-amd64.exe", "amd64"),
+            (version, f"{base}python-{version}-arm64.exe", "arm64"),
+            (version, f"{base}python-{version}.exe", "win32"),
+            (version, f"{base}python-{version}-embed-amd64.zip", "embed-amd64"),
+            (version, f"{base}Python-{version}.tgz", "source-tgz"),
+            (version, f"{base}win32/python-{version}-embed-win32.zip", "embed-win32"),
+        }
+    return expected
+
+
+for configuration in CONFIGURATIONS:
+    name = " ".join(configuration) or "the defaults"
+    server = Server(answer, DELAY)
+    options = ["--server", "127.0.0.1", "--port", str(server.port), "--artifact", "all", "--format", "csv"]
+    code, output, errors = run(crawl, *extra, "--ftp", *configuration, *options)
+    server.stop()
+
+    rows = [tuple(line.split(",")[:3]) for line in output.splitlines()[1:]]
+    listed = [path for _, path, status in server.requests("GET") if status == 200]
+    depth = max(path.count("/") - 3 for path in listed) if listed else 0  # the slashes of /ftp/python/ aren't below it
+    per_host = int(configuration[configuration.index("--per-host") + 1]) if "--per-host" in configuration else 8
+
+    checks.expect(code == 0, f"{name}: crawl --ftp exited with {code}: {errors.strip()[-500:]}")
+    checks.expect(set(rows) == artifacts(f"http://127.0.0.1:{server.port}"), f"{name}: the index isn't the artifacts of the tree")
+    checks.expect(len(rows) == len(set(rows)), f"{name}: {len(rows) - len(set(rows))} artifacts were indexed twice")
+    checks.expect(len(listed) == len(set(listed)), f"{name}: {len(listed) - len(set(listed))} directories were listed twice")
+    checks.expect(len(listed) > 2 * len(versions), f"{name}: only {len(listed)} directories were listed")
+    checks.expect(3 < depth <= MAX_DEPTH, f"{name}: the link loop was followed {depth} directories deep")
+    checks.expect(server.peak <= per_host, f"{name}: {server.peak} requests were in flight at once, more than --per-host {per_host}")
+    checks.expect(len(server.requests()) == len(listed), f"{name}: crawl asked for something that isn't a directory of the tree")
+checks.finish()
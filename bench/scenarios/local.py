@@ -0,0 +1,167 @@
+# what the scenarios share: local HTTP/1.1 servers with keep-alive whose answers the scenario scripts, and crawl runs against them.
+# the scenarios take the path of a crawl build as their first argument and any further arguments are passed on to every run of it,
+# --transport socket for instance. they need python 3.8 or later and nothing else, and exit non-zero with the failed checks on stderr
+
+import os
+import signal
+import socket
+import subprocess
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+PAGES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "pages")
+
+
+def page_path(name):
+    return os.path.join(PAGES, name)
+
+
+def page(name):
+    with open(page_path(name), "rb") as file:
+        return file.read()
+
+
+class Server(ThreadingHTTPServer):
+    """serves 127.0.0.1 on a port of its own, every request goes to answer(request) which returns (status, headers, body) or None for a
+    404. delay (seconds) holds every answer back and rate (bytes per second) caps how fast every connection sends a body. the requests are
+    logged as (method, path, status) in the order they were answered, and peak is the most requests that were being answered at once"""
+
+    daemon_threads = True
+    request_queue_size = 128
+
+    def __init__(self, answer, delay=0.0, rate=None):
+        self.answer = answer
+        self.delay = delay
+        self.rate = rate
+        self.log = []
+        self.lock = threading.Lock()
+        self.in_flight = 0
+        self.peak = 0
+        super().__init__(("127.0.0.1", 0), Handler)
+        self.port = self.server_address[1]
+        threading.Thread(target=self.serve_forever, daemon=True).start()
+
+    def requests(self, method=None):
+        with self.lock:
+            return [entry for entry in self.log if method is None or entry[0] == method]
+
+    def stop(self):
+        self.shutdown()
+        self.server_close()
+
+    def handle_error(self, request, client_address):
+        pass  # a client that goes away in the middle of a body, which some scenarios have crawl do
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, *arguments):
+        pass
+
+    def setup(self):
+        super().setup()
+        # the headers and the body go out in separate writes, which would otherwise wait on the client's delayed ACK every time
+        self.connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def respond(self, has_body):
+        with self.server.lock:
+            self.server.in_flight += 1
+            self.server.peak = max(self.server.peak, self.server.in_flight)
+        if self.server.delay:
+            threading.Event().wait(self.server.delay)
+        status, headers, body = self.server.answer(self) or (404, {}, b"")
+        with self.server.lock:
+            self.server.log.append((self.command, self.path, status))
+            self.server.in_flight -= 1
+
+        self.send_response(status)
+        for name, value in headers.items():
+            self.send_header(name, value)
+        self.send_header("Content-Length", str(len(body) if status != 304 else 0))
+        self.end_headers()
+        if has_body and status != 304:
+            self.send_body(body)
+
+    def send_body(self, body):
+        step = max(1, self.server.rate // 50) if self.server.rate else max(1, len(body))  # 20 ms worth of bytes at a time when capped
+        for offset in range(0, len(body), step):
+            self.wfile.write(body[offset : offset + step])
+            if self.server.rate:
+                time.sleep(step / self.server.rate)
+
+    def do_GET(self):
+        self.respond(True)
+
+    def do_HEAD(self):
+        self.respond(False)
+
+
+def run(crawl, *arguments, timeout=120, cwd=None):
+    """runs crawl to completion, returns (exit code, stdout, stderr) as text"""
+    done = subprocess.run([crawl, *arguments], capture_output=True, timeout=timeout, cwd=cwd)
+    return done.returncode, done.stdout.decode(errors="replace"), done.stderr.decode(errors="replace")
+
+
+class Run:
+    """a crawl that runs in the background, its output lines are collected as they come and stop() asks it to quit the way Ctrl+C does"""
+
+    def __init__(self, crawl, *arguments, cwd=None):
+        windows = sys.platform == "win32"
+        self.process = subprocess.Popen(
+            [crawl, *arguments],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            cwd=cwd,
+            creationflags=subprocess.CREATE_NEW_PROCESS_GROUP if windows else 0,
+        )
+        self.lines = []
+        self.errors = []
+        threading.Thread(target=self.collect, args=(self.process.stdout, self.lines), daemon=True).start()
+        threading.Thread(target=self.collect, args=(self.process.stderr, self.errors), daemon=True).start()
+
+    @staticmethod
+    def collect(stream, lines):
+        for line in stream:
+            lines.append(line.decode(errors="replace").rstrip("\r\n"))
+
+    def stop(self, timeout=30):
+        self.process.send_signal(signal.CTRL_BREAK_EVENT if sys.platform == "win32" else signal.SIGINT)
+        return self.process.wait(timeout)
+
+
+def wait(condition, timeout):
+    """polls the condition every 50 ms until it holds or the timeout (seconds) is up, returns whether it held"""
+    deadline = time.monotonic() + timeout
+    while not condition():
+        if time.monotonic() >= deadline:
+            return False
+        time.sleep(0.05)
+    return True
+
+
+class Checks:
+    """collects failed checks, finish() prints them and exits"""
+
+    def __init__(self, name):
+        self.name = name
+        self.failures = []
+
+    def expect(self, condition, message):
+        if not condition:
+            self.failures.append(message)
+            print(f"FAILED {self.name}: {message}", file=sys.stderr)
+        return condition
+
+    def finish(self):
+        print(f"{self.name}: {'FAILED' if self.failures else 'ok'}")
+        sys.exit(1 if self.failures else 0)
+
+
+def arguments():
+    if len(sys.argv) < 2:
+        print(f"usage: {os.path.basename(sys.argv[0])} <crawl> [argument]...", file=sys.stderr)
+        sys.exit(2)
+    return sys.argv[1], sys.argv[2:]
@@ -0,0 +1,97 @@
+# --mirror against local servers that answer after different delays:
+#
+#     1. a slow (1 s), a stalled (8 s, past the race timeout) and a fast mirror (20 ms), listed in that order with no scoreboard yet. the
+#        probes start 250 ms apart in the order given, the fast mirror still answers first and must be the one the page comes from
+#     2. the same mirrors again, the scoreboard of the first run now ranks the fast mirror first, which must answer before the 250 ms are up
+#        so that the others aren't even probed
+#     3. a flaky mirror that answers its probe at once and fails the page with a 500, and a backup (100 ms) that must take the page over
+#     4. nothing but flaky mirrors, which must fail the run
+#
+# the scoreboard lives next to the page cache, every scenario that starts afresh gets a cache directory of its own.
+# python mirrors.py <crawl> [argument]...
+
+import os
+import shutil
+import tempfile
+
+from local import Checks, Server, arguments, page, page_path, run
+
+PATH = "/downloads/windows/"
+NAME = "downloads-windows-2024-10-07.html"
+
+crawl, extra = arguments()
+checks = Checks("mirrors")
+body = page(NAME)
+workspace = tempfile.mkdtemp(prefix="crawl-mirrors-")
+
+
+def answer(request):
+    if request.path != PATH:
+        return None
+    return 200, {"Content-Type": "text/html; charset=utf-8"}, body
+
+
+def flaky(request):
+    if request.path != PATH:
+        return None
+    return (200, {"Content-Type": "text/html; charset=utf-8"}, body) if request.command == "HEAD" else (500, {}, b"")
+
+
+def crawl_mirrors(servers, cache):
+    mirrors = [argument for server in servers for argument in ("--mirror", f"127.0.0.1:{server.port}")]
+    code, output, errors = run(crawl, *extra, *mirrors, "--cache", cache, "--format", "csv")
+    return code, {tuple(line.split(",")[:3]) for line in output.splitlines()[1:]}, errors.strip()
+
+
+def pages(server):
+    return [entry for entry in server.requests("GET") if entry[1] == PATH]
+
+
+def probes(server):
+    return len(server.requests("HEAD"))
+
+
+code, output, errors = run(crawl, "--format", "csv", "--from-file", page_path(NAME))
+releases = {tuple(line.split(",")[:3]) for line in output.splitlines()[1:]}
+checks.expect(code == 0 and releases, f"--from-file {NAME} exited with {code}: {errors.strip()}")
+
+try:
+    slow, stalled, fast = Server(answer, 1.0), Server(answer, 8.0), Server(answer, 0.02)
+    cache = os.path.join(workspace, "race")
+    os.mkdir(cache)
+
+    code, printed, errors = crawl_mirrors([slow, stalled, fast], cache)
+    checks.expect(code == 0, f"the race exited with {code}: {errors}")
+    checks.expect(printed == releases, "the race didn't print the releases of the page")
+    checks.expect(len(pages(fast)) == 1, f"the fast mirror served {len(pages(fast))} pages rather than the page")
+    checks.expect(not pages(slow) and not pages(stalled), "the page came from a mirror other than the fast one")
+
+    before = [probes(slow), probes(stalled), probes(fast)]
+    code, printed, errors = crawl_mirrors([slow, stalled, fast], cache)
+    checks.expect(code == 0, f"the ranked race exited with {code}: {errors}")
+    checks.expect(printed == releases, "the ranked race didn't print the releases of the page")
+    checks.expect(probes(fast) == before[2] + 1, "the scoreboard didn't have the fast mirror probed")
+    checks.expect([probes(slow), probes(stalled)] == before[:2], "the scoreboard didn't rank the fast mirror first")
+    checks.expect(len(pages(fast)) == 2 and not pages(slow) and not pages(stalled), "the ranked page came from another mirror")
+
+    broken, backup = Server(flaky), Server(answer, 0.1)
+    cache = os.path.join(workspace, "failover")
+    os.mkdir(cache)
+    code, printed, errors = crawl_mirrors([broken, backup], cache)
+    checks.expect(code == 0, f"the failover exited with {code}: {errors}")
+    checks.expect(printed == releases, "the failover didn't print the releases of the page")
+    checks.expect(len(pages(broken)) == 1 and pages(broken)[0][2] == 500, "the flaky mirror wasn't asked for the page first")
+    checks.expect(len(pages(backup)) == 1, "the backup mirror didn't take the page over")
+
+    others = Server(flaky)
+    cache = os.path.join(workspace, "outage")
+    os.mkdir(cache)
+    code, printed, errors = crawl_mirrors([broken, others], cache)
+    checks.expect(code != 0, "a run with nothing but failing mirrors succeeded")
+    checks.expect(not printed, "a run with nothing but failing mirrors printed releases")
+
+    for server in (slow, stalled, fast, broken, backup, others):
+        server.stop()
+finally:
+    shutil.rmtree(workspace, ignore_errors=True)
+checks.finish()
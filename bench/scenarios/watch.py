@@ -0,0 +1,66 @@
+# --watch against a local server whose page changes between polls. the polls are answered in steps:
+#
+#     1. the 2024-05-24 page, every release is printed as added
+#     2. the same page, which the validators of the first answer must turn into a 304
+#     3. the 2024-10-07 page, only the releases the two pages don't share are printed, as added or removed
+#     4. the 2024-10-07 page with a banner outside the stable releases section, a 200 that must print nothing
+#     5. the same page again, another 304
+#
+# the releases of both pages come from a plain run of crawl against a server of their own. python watch.py <crawl> [argument]...
+
+import hashlib
+
+from local import Checks, Run, Server, arguments, page, run, wait
+
+POLLS = 5  # polls the scenario takes crawl through before stopping it
+PATH = "/downloads/windows/"
+
+crawl, extra = arguments()
+checks = Checks("watch")
+paths = ["downloads-windows-2024-05-24.html", "downloads-windows-2024-10-07.html"]
+old, new = page(paths[0]), page(paths[1])
+banner = new.replace(b"</body>", b"<p>a banner that changes with every deploy</p></body>")
+steps = [old, old, new, banner, banner]
+
+
+def answer(request):
+    if request.path != PATH:
+        return None
+    body = steps[min(len(request.server.requests("GET")), POLLS - 1)]
+    etag = '"' + hashlib.sha1(body).hexdigest()[:16] + '"'
+    if request.headers.get("If-None-Match") == etag:
+        return 304, {"ETag": etag}, b""
+    return 200, {"Content-Type": "text/html; charset=utf-8", "ETag": etag}, body
+
+
+def releases(body):
+    single = Server(lambda request: (200, {"Content-Type": "text/html; charset=utf-8"}, body) if request.path == PATH else None)
+    code, output, errors = run(crawl, *extra, "--server", "127.0.0.1", "--port", str(single.port), "--no-cache", "--format", "csv")
+    single.stop()
+    checks.expect(code == 0, f"a plain run over {len(body)} bytes of page exited with {code}: {errors.strip()}")
+    return {tuple(line.split(",")[:3]) for line in output.splitlines()[1:]}
+
+
+before, after = releases(old), releases(new)
+checks.expect(before != after, "the two pages have the same releases, there's nothing to diff")
+
+server = Server(answer)
+watcher = Run(crawl, *extra, "--server", "127.0.0.1", "--port", str(server.port), "--format", "csv", "--watch", "1")
+wait(lambda: len(server.requests("GET")) >= POLLS or watcher.process.poll() is not None, 60)
+wait(lambda: False, 0.5)  # the last answer still has to be read
+code = watcher.stop()
+server.stop()
+
+statuses = [status for _, _, status in server.requests("GET")]
+checks.expect(statuses[:POLLS] == [200, 304, 200, 200, 304], f"the polls were answered with {statuses}, not 200 304 200 200 304")
+checks.expect(code == 0, f"crawl --watch exited with {code}: {' '.join(watcher.errors)}")
+
+header, events = watcher.lines[:1], [tuple(line.split(",")) for line in watcher.lines[1:]]
+checks.expect(header == ["event,version,url,kind"], f"the events start with {header} rather than the CSV header")
+added = [event[1:] for event in events if event[0] == "added"]
+removed = [event[1:] for event in events if event[0] == "removed"]
+checks.expect(set(added[: len(before)]) == before, "the first poll didn't print every release of the first page as added")
+checks.expect(set(added[len(before) :]) == after - before, "the changed page didn't print the releases it added")
+checks.expect(set(removed) == before - after, "the changed page didn't print the releases it removed")
+checks.expect(len(events) == len(before) + len(after - before) + len(before - after), f"{len(events)} events, some were printed twice")
+checks.finish()
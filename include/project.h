@@ -9,11 +9,49 @@
 #define WIN32_LEAN_AND_MEAN
 #define WIN32_EXTRA_MEAN
 #define BUFF_SIZE                    (1LLU << 6)
-#define HTTP_RESPONSE_SIZE           2097152LLU // 2 MiB
-#define N_PYTHON_RELEASES            100LLU
-#define PYTHON_DOWNLOAD_URL_LENGTH   150LLU
-#define PYTHON_VERSION_STRING_LENGTH 40LLU
-#define EXECUTION_TIMEOUT            100LLU // milliseconds
+#define RESULTS_INITIAL_CAPACITY     64LLU // releases a results_t has room for before it first grows
+#define HTTP_CHUNK_SIZE              16384LLU // 16 KiB, size of the reads handed to the streaming parser
+#define BODY_SLAB_SIZE               65536LLU // 64 KiB, 16 pages, response bodies are chains of slabs this size, see body.c
+#define BODY_POOL_MAX_IDLE           64LLU    // slabs kept around for the next responses once a body is released, 4 MiB
+#define STREAM_STAGING_SIZE          65536LLU // 64 KiB, window the streaming parser scans over
+#define STREAM_LOOKAHEAD             128LLU   // bytes past the start of an anchor tag that the release matcher may inspect
+#define HTTP_SOCKET_TIMEOUT          10000LLU // milliseconds, how long the socket transport waits on a stalled connection
+#define HTTP_HEADER_LINE_LENGTH      1024LLU  // longest response header line the socket transport accepts
+#define HTTP_POOL_MAX_IDLE           16LLU    // idle keep-alive connections kept around across all hosts
+#define HTTP_POOL_MAX_IDLE_PER_HOST  8LLU     // idle keep-alive connections kept around per host, as many as --ftp has in flight
+#define HTTP_VALIDATOR_LENGTH        128LLU   // longest ETag or Last-Modified value the response cache keeps track of
+#define INFLATE_WINDOW_SIZE          32768LLU // 32 KiB, the farthest a DEFLATE back reference can reach
+#define INFLATE_FAST_BITS            10LLU    // Huffman codes up to this many bits long are decoded with a single table lookup
+#define ARTIFACT_MAX_STATES          128LLU   // states the compiled extraction automaton can have, one per suffix character plus the root
+#define ARTIFACT_MAX_CLASSES         32LLU    // distinct characters the extraction rules can use, plus a class for everything else
+#define PARSE_PARALLEL_MIN_CHUNK     262144LLU // 256 KiB, smallest slice of a page worth handing to a parser thread of its own
+#define PARSE_PARALLEL_MAX_THREADS   64LLU     // most parser threads parse_stable_releases_parallel runs
+#define TRACE_MAX_EVENTS             65536LLU  // spans and counter samples a traced run keeps, the ones past it are dropped and counted
+#define PYTHON_MAX_INTERPRETERS      32LLU     // interpreters on PATH find_python_interpreters reports, the ones past it are ignored
+#define PYTHON_PROBE_TIMEOUT         2000LLU   // milliseconds the interpreters run with --version get to answer, all of them together
+#define DOWNLOAD_CONNECTIONS         4LLU       // ranged connections a download runs at once when not told otherwise
+#define DOWNLOAD_MAX_CONNECTIONS     16LLU      // most ranged connections a download runs at once
+#define DOWNLOAD_MAX_SEGMENTS        64LLU      // pieces a download is cut into at most, the connections claim them one at a time
+#define DOWNLOAD_MIN_SEGMENT         1048576LLU // 1 MiB, smallest piece worth a request of its own
+#define DOWNLOAD_CHECKPOINT_SIZE     262144LLU  // 256 KiB, bytes a segment gets through between updates of its progress on disk
+#define DOWNLOAD_MAX_RETRIES         3LLU       // requests in a row a segment may fail without progress before the download gives up
+#define DIGEST_MD5_SIZE              16LLU     // bytes of an MD5 digest
+#define DIGEST_SHA256_SIZE           32LLU     // bytes of a SHA-256 digest, the largest digest_final produces
+#define RELEASE_MAX_FILES            64LLU     // files of a release page parse_release_files keeps, the ones past it are ignored
+#define WATCH_DEFAULT_INTERVAL       60LLU     // seconds between the polls of --watch when no interval is given
+#define WATCH_MAX_BACKOFF_SHIFT      4LLU      // the poll interval doubles per unchanged or failed poll, up to 16 times the base interval
+#define FTP_DEFAULT_JOBS             16LLU     // directory listings --ftp has in flight at once when not told otherwise, one worker each
+#define FTP_MAX_JOBS                 64LLU     // most workers --ftp runs
+#define FTP_DEFAULT_PER_HOST         8LLU      // requests --ftp has in flight to the server at once when not told otherwise
+#define FTP_MAX_DEPTH                8LLU      // directories below the root --ftp descends into at most, a guard against link loops
+#define RING_MAX_CONNECTIONS         1024LLU   // connections fetch_all keeps open at once at most, across all of its rings
+#define RING_BUFFER_SIZE             4096LLU   // bytes of each of the buffers the completion rings receive into
+#define REPLAY_MAX_HEADERS           65536LLU  // 64 KiB, bytes the status line and headers of a saved response may take up at most
+#define MIRROR_MAX_HOSTS             8LLU      // hosts --mirror can list
+#define MIRROR_ATTEMPT_DELAY         250LLU    // milliseconds between the starts of two probes of the race, RFC 8305's connection attempt delay
+#define MIRROR_RACE_TIMEOUT          5000LLU   // milliseconds the race waits for the first mirror to answer
+#define MIRROR_RANK_SIZE             1048576LLU // 1 MiB, mirrors are ranked by how long they'd take to serve this many bytes
+#define MIRROR_FORGIVE_INTERVAL      3600LLU   // seconds after which a mirror's latest failure counts one failure less, and so on
 
 #include <assert.h>
 #include <stdbool.h>
@@ -30,12 +68,20 @@
     #define dbgwprintf_s(...)
 #endif // _DEBUG
 
+#ifndef _WIN32
+    #include <pthread.h> // task_t, the portable sources build on Linux for the benchmarks
+#endif
+
 #pragma comment(lib, "Winhttp.lib") // need this for the WinHttp routines
 
-typedef struct _python {
-        char version[PYTHON_VERSION_STRING_LENGTH];   // version information
-        char downloadurl[PYTHON_DOWNLOAD_URL_LENGTH]; // download URL for amd64 releases
-} python_t;
+#ifdef CRAWL_COUNT_ALLOCATIONS // defined by the bench project, which reports the heap allocations of everything it measures, see bench/main.c
+[[nodiscard]] void* __cdecl counted_malloc(_In_ size_t size);
+[[nodiscard]] void* __cdecl counted_calloc(_In_ size_t count, _In_ size_t size);
+[[nodiscard]] void* __cdecl counted_realloc(_In_opt_ void* block, _In_ size_t size);
+    #define malloc(size)         counted_malloc(size)
+    #define calloc(count, size)  counted_calloc(count, size)
+    #define realloc(block, size) counted_realloc(block, size)
+#endif // CRAWL_COUNT_ALLOCATIONS
 
 typedef struct _hinternet_triple {
         HINTERNET session;    // session handle
@@ -43,10 +89,55 @@ typedef struct _hinternet_triple {
         HINTERNET request;    // request handle
 } hinternet_triple_t;
 
+// a string as an offset and a length into some buffer, not null terminated
+typedef struct _span {
+        uint32_t offset;
+        uint32_t length;
+} span_t;
+
+// kinds of release artifacts the parsers sort download links into, the rules that tell them apart are in artifacts.c
+typedef enum _artifact_kind {
+    ARTIFACT_AMD64,       // python-3.13.3-amd64.exe
+    ARTIFACT_ARM64,       // python-3.13.3-arm64.exe
+    ARTIFACT_WIN32,       // python-3.13.3.exe
+    ARTIFACT_EMBED_AMD64, // python-3.13.3-embed-amd64.zip
+    ARTIFACT_EMBED_ARM64, // python-3.13.3-embed-arm64.zip
+    ARTIFACT_EMBED_WIN32, // python-3.13.3-embed-win32.zip
+    ARTIFACT_SOURCE_TGZ,  // Python-3.13.3.tgz
+    ARTIFACT_SOURCE_XZ,   // Python-3.13.3.tar.xz
+    ARTIFACT_KINDS,       // number of kinds
+    ARTIFACT_NONE = 0xFF  // links that aren't release artifacts
+} artifact_kind_t;
+
+#define ARTIFACT_MASK(kind) (1U << (kind))
+#define ARTIFACT_MASK_ALL   ((1U << ARTIFACT_KINDS) - 1)
+
+// what print_ex renders the releases as, see render.c
+typedef enum _output_format {
+    OUTPUT_TABLE,  // the coloured console table, the installed python's releases highlighted
+    OUTPUT_JSON,   // {"system_python":"3.13.3","releases":[{"version":...,"url":...,"kind":...,"installed":...},...]}
+    OUTPUT_NDJSON, // one release object per line
+    OUTPUT_CSV,    // version,url,kind,installed with a header line, fields quoted as RFC 4180 has it
+    OUTPUT_FORMATS // number of formats
+} output_format_t;
+
+// bytes a single release takes up in the span block and in serialized results, a version span, a download URL span and an artifact kind
+#define RESULTS_RECORD_SIZE (2 * sizeof(span_t) + sizeof(uint8_t))
+
+// parsed releases in struct of arrays form, the version, download URL and artifact kind of the i-th release are versions[i], downloadurls[i]
+// and kinds[i], the strings being spans into text. the releases either borrow their text (the HTML buffer for parse_stable_releases, a
+// mapped snapshot) or own it in the arena, in which case text == arena. either way everything is released in one go by results_release,
+// versions is NULL for failed or released results
 typedef struct _results {
-        python_t*     begin;    // pointer to the head of a heap allocated array of python_ts.s
-        unsigned long count;    // number of parsed python_t structs in the array
-        unsigned long capacity; // number of python_ts the heap allocated array can hold
+        const char*   text;           // bytes the spans refer to, must outlive the results when borrowed
+        span_t*       versions;       // capacity spans, the first half of the span block
+        span_t*       downloadurls;   // capacity spans, the second half of the span block
+        uint8_t*      kinds;          // capacity artifact_kind_t values, right after the spans in the span block
+        unsigned long count;          // number of releases
+        unsigned long capacity;       // number of releases the span block can hold, doubles when exceeded
+        char*         arena;          // heap allocated text owned by the results, NULL when the text is borrowed
+        unsigned long arena_size;     // bytes in use in the arena
+        unsigned long arena_capacity; // bytes the arena can hold, doubles when exceeded
 } results_t;
 
 typedef struct _range {
@@ -54,6 +145,419 @@ typedef struct _range {
         unsigned long end;
 } range_t;
 
+// a version as a single integer that sorts like the version does, 16 bits each for major, minor and micro, then 4 bits of release level and
+// 12 bits of pre-release serial: 3.13.0a1 < 3.13.0b2 < 3.13.0rc1 < 3.13.0 < 3.13.1. see versions.c
+typedef uint64_t version_key_t;
+
+#define VERSION_KEY_INVALID 0LLU // what version_key returns for text that isn't a version, no version packs to 0
+#define VERSION_KEY(major, minor, micro, level, serial)                                                                                \
+    (((version_key_t) (major) << 48) | ((version_key_t) (minor) << 32) | ((version_key_t) (micro) << 16) | ((version_key_t) (level) << 12) | \
+     (version_key_t) (serial))
+#define VERSION_MAJOR(key) ((unsigned) ((key) >> 48))
+#define VERSION_MINOR(key) ((unsigned) ((key) >> 32) & 0xFFFFU)
+#define VERSION_MICRO(key) ((unsigned) ((key) >> 16) & 0xFFFFU)
+#define VERSION_LEVEL(key) ((unsigned) ((key) >> 12) & 0xFU)
+
+// release levels as they sort in a version key
+typedef enum _release_level {
+    RELEASE_ALPHA     = 0xA, // 3.13.0a1
+    RELEASE_BETA      = 0xB, // 3.13.0b1
+    RELEASE_CANDIDATE = 0xC, // 3.13.0rc1
+    RELEASE_FINAL     = 0xF  // 3.13.0
+} release_level_t;
+
+// the releases of a results_t sorted by version, for queries that would otherwise compare version strings row by row. keys and rows are
+// parallel arrays sharing a single heap block, rows[i] being the release keys[i] was parsed from. releases of the same version stay in the
+// order they had in the results
+typedef struct _release_index {
+        version_key_t* keys;  // ascending
+        uint32_t*      rows;  // indices into the results the index was built from
+        unsigned long  count; // number of releases in the index
+} release_index_t;
+
+// what a task runs, its return value becomes the task's result
+typedef bool(__cdecl* task_routine_t)(_Inout_opt_ void* const argument);
+
+// a routine running on a thread of its own and the future of its result, see tasks.c
+typedef struct _task {
+        task_routine_t routine;
+        void*          argument;
+#ifdef _WIN32
+        HANDLE thread;
+#else
+        pthread_t thread;
+#endif
+        bool is_threaded; // false when the thread couldn't be started, task_start then ran the routine inline
+        bool is_joined;   // task_wait has waited for the thread, later calls return the result right away
+        bool result;      // what the routine returned, valid once task_wait returned
+} task_t;
+
+// where find_python_interpreters learnt the version of an interpreter from
+typedef enum _python_source {
+    PYTHON_SOURCE_NONE,       // nowhere, the version is unknown
+    PYTHON_SOURCE_PYVENV,     // the pyvenv.cfg of a virtual environment
+    PYTHON_SOURCE_RESOURCE,   // the version resource of python.exe
+    PYTHON_SOURCE_PATCHLEVEL, // PY_VERSION in the installation's patchlevel.h
+    PYTHON_SOURCE_SPAWN       // running it with --version
+} python_source_t;
+
+typedef struct _python_interpreter {
+        wchar_t         path[MAX_PATH];
+        char            version[BUFF_SIZE]; // "Python 3.12.4" like python --version prints it, empty when it's unknown
+        python_source_t source;
+} python_interpreter_t;
+
+// get_system_python_version running as a task, so that the fetch doesn't wait for it
+typedef struct _python_probe {
+        task_t task;
+        char   version[BUFF_SIZE]; // what get_system_python_version reported, empty when it failed. only read after python_probe_wait
+} python_probe_t;
+
+// what a run asks of the releases instead of printing all of them (--exact, --latest, --newest, --outdated), see answer_query
+typedef enum _query_kind {
+    QUERY_NONE,    // print every release
+    QUERY_EXACT,   // the releases of version key
+    QUERY_LATEST,  // the releases of the newest final patch of key's major.minor
+    QUERY_NEWEST,  // the releases of the newest final version, provided it is at least key
+    QUERY_OUTDATED // whether the system python is older than the newest final patch of its major.minor
+} query_kind_t;
+
+typedef struct _query {
+        query_kind_t  kind;
+        version_key_t key; // VERSION_KEY_INVALID for QUERY_NONE and QUERY_OUTDATED
+} query_t;
+
+// container formats around a DEFLATE stream, INFLATE_NONE stands for responses that aren't compressed
+typedef enum _inflate_format {
+    INFLATE_NONE,
+    INFLATE_RAW,  // a bare DEFLATE stream
+    INFLATE_ZLIB, // RFC 1950, what Content-Encoding: deflate is supposed to be
+    INFLATE_GZIP  // RFC 1952, Content-Encoding: gzip
+} inflate_format_t;
+
+// state of a request issued through the BSD socket transport, see sockets.c
+typedef struct _socket_request {
+        uintptr_t        socket;           // SOCKET on Windows, a file descriptor elsewhere
+        char*            buffer;           // HTTP_CHUNK_SIZE bytes receive buffer, followed by the request to send it again
+        unsigned long    request_size;     // bytes of the request after the receive buffer
+        unsigned long    head;             // offset of the first unconsumed byte in buffer
+        unsigned long    tail;             // offset one past the last received byte in buffer
+        long long        content_length;   // -1 when the response doesn't specify one
+        bool             is_chunked;       // Transfer-Encoding: chunked
+        bool             is_keep_alive;    // whether the server will keep the connection open after this response
+        inflate_format_t content_encoding; // compression of the body, from Content-Encoding
+        bool             is_pooled;        // the connection came from the pool, the server may have closed it while it sat idle
+} socket_request_t;
+
+// state of a request issued through the completion ring transport, kept between its get and read calls, see ring.c
+typedef struct _ring_request {
+        char path[HTTP_HEADER_LINE_LENGTH / 2];  // the accesspoint, narrowed
+        char headers[HTTP_VALIDATOR_LENGTH * 3]; // the conditions or the range of the request as header lines, empty when there are none
+} ring_request_t;
+
+// cache validators of a response, the values of its ETag and Last-Modified headers as they were sent (ETags keep their quotes)
+typedef struct _http_validators {
+        char etag[HTTP_VALIDATOR_LENGTH];          // empty when the server didn't send one or it didn't fit
+        char last_modified[HTTP_VALIDATOR_LENGTH]; // empty when the server didn't send one or it didn't fit
+} http_validators_t;
+
+// an in-flight GET request, valid between a transport's get and read calls
+typedef struct _http_request {
+        const struct _http_transport* transport;         // backend that issued the request, NULL if the request could not be sent
+        unsigned                      status;            // HTTP status code, known once the response headers have been received
+        unsigned short                port;              // port of the server the request went to
+        wchar_t                       server[BUFF_SIZE]; // server the request went to, the key its connection is pooled under
+        http_validators_t             conditions;        // validators of a cached copy, sent as If-None-Match/If-Modified-Since when non empty
+        http_validators_t             validators;        // validators of the response, known once the response headers have been received
+        unsigned long long            range_begin;       // first byte of the body asked for with a Range header, see transport_get_range
+        unsigned long long            range_end;         // one past the last byte asked for, 0 for the whole body and no Range header at all
+        unsigned long long            total_size;        // size of the whole body, from Content-Range or Content-Length, 0 when unknown
+        union {
+                hinternet_triple_t handles; // WinHttp handles
+                socket_request_t   socket;  // socket transport state
+                ring_request_t     ring;    // completion ring transport state
+        };
+} http_request_t;
+
+// consumer of the response body, called with each piece of the body as it arrives. return false to abort the transfer
+typedef bool(__cdecl* http_sink_t)(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size);
+
+// a pluggable HTTP client backend, http_get/read_http_response_stream are one implementation (winhttp_transport) and sockets.c is another
+typedef struct _http_transport {
+        const wchar_t* name; // what --transport selects this backend by
+        // sends a GET request for http://server:port/accesspoint, returns false if the request could not be sent
+        bool(__cdecl* get)(
+            _Inout_ http_request_t* const restrict request,
+            _In_ const wchar_t* const restrict server,
+            _In_ const unsigned short port,
+            _In_ const wchar_t* const restrict accesspoint
+        );
+        // receives the response and hands the body to sink piece by piece, always releases the request's resources
+        bool(__cdecl* read)(
+            _Inout_ http_request_t* const restrict request,
+            _In_ const http_sink_t sink,
+            _Inout_opt_ void* const context,
+            _Inout_ unsigned long* const restrict size
+        );
+        // releases process wide state of the backend, may be NULL
+        void(__cdecl* cleanup)(void);
+} http_transport_t;
+
+// closes a connection held by the pool
+typedef void(__cdecl* pool_close_t)(_In_ const uintptr_t connection);
+
+// tells whether an idle connection is still usable, servers are free to close keep-alive connections whenever they like
+typedef bool(__cdecl* pool_probe_t)(_In_ const uintptr_t connection);
+
+// a piece of a response body. slabs are allocated straight from the OS, page aligned and BODY_SLAB_SIZE bytes each, and go back to a process
+// wide pool instead of being freed
+typedef struct _body_slab {
+        char               data[BODY_SLAB_SIZE - 16]; // first, so that it starts on the page boundary the slab starts at
+        struct _body_slab* next;                      // the next piece of the body, NULL for the last one
+        unsigned long long size;                      // bytes of data in use
+} body_slab_t;
+
+static_assert(sizeof(body_slab_t) == BODY_SLAB_SIZE, "body_slab_t must fill its pages exactly");
+
+// a response body as a chain of slabs, it grows a slab at a time without copying or zeroing anything. { 0 } is an empty body
+typedef struct _body {
+        body_slab_t*  head;   // the first slab, NULL while the body is empty
+        body_slab_t*  tail;   // the slab bytes are appended to
+        unsigned long size;   // bytes in all of the slabs together
+        unsigned long nslabs; // slabs in the chain
+        char*         flat;   // heap allocated copy of a body longer than a slab, made by body_flatten. NULL otherwise
+} body_t;
+
+// an iovec style view of a body, a slice per slab, see body_view
+typedef struct _body_slice {
+        const char*   data;
+        unsigned long size;
+} body_slice_t;
+
+typedef struct _body_stats {
+        unsigned long allocations; // slabs that had to be allocated
+        unsigned long reuses;      // slabs handed out again from the pool
+        unsigned long frees;       // slabs given back to the OS, because the pool was full or by body_drain
+} body_stats_t;
+
+typedef struct _pool_stats {
+        unsigned long hits;      // requests that went out over an idle pooled connection
+        unsigned long misses;    // requests that had to open a new connection
+        unsigned long reuses;    // connections handed back to the pool after a complete response
+        unsigned long evictions; // idle connections closed because of the caps, because they went stale or by pool_drain
+} pool_stats_t;
+
+// what --download fetches the releases picked by a version query with, see download.c
+typedef struct _download_options {
+        const http_transport_t* transport;   // backend the files are fetched through
+        const wchar_t*          directory;   // where the files go, ending with a path separator. NULL when nothing is to be downloaded
+        unsigned long           connections; // ranged connections per file
+} download_options_t;
+
+// a page fetch_all fetches, see ring.c
+typedef struct _fetch {
+        const char*        path;       // what to GET, an absolute path
+        const char*        headers;    // additional request header lines, each ending with CRLF. may be NULL
+        body_t             body;       // the response body, empty unless the fetch succeeded. release it with body_release
+        bool               is_fetched; // a 2xx or 304 response came in full
+        unsigned           status;     // HTTP status code, 0 when no response came
+        unsigned long long total_size; // size of the whole body, from Content-Range or Content-Length, 0 when unknown
+        http_validators_t  validators; // the ETag and Last-Modified of the response
+} fetch_t;
+
+// how --ftp walks the directory tree, see ftp.c
+typedef struct _ftp_options {
+        const http_transport_t* transport; // backend the listings are fetched through, from every worker at once
+        const wchar_t*          server;
+        unsigned short          port;
+        const wchar_t*          root;     // the directory the crawl starts at, ending with a forward slash
+        unsigned long           jobs;     // workers, each with a listing in flight at most
+        unsigned long           per_host; // listings in flight to the server at once
+        unsigned long           delay;    // milliseconds between the starts of two requests to the server
+} ftp_options_t;
+
+// the checksums python.org publishes for its files, older release pages list MD5 sums and newer ones SHA-256
+typedef enum _digest_kind {
+    DIGEST_NONE,
+    DIGEST_MD5,
+    DIGEST_SHA256
+} digest_kind_t;
+
+// a checksum being computed over bytes fed to it in pieces, see digest.c
+typedef struct _digest {
+        digest_kind_t      kind;
+        uint32_t           state[8];  // MD5 uses the first four words
+        unsigned long long length;    // bytes fed so far
+        unsigned char      block[64]; // the bytes of the block that isn't complete yet
+} digest_t;
+
+// a checksum as published, to compare what digest_final produced against
+typedef struct _digest_value {
+        digest_kind_t kind;
+        unsigned char bytes[DIGEST_SHA256_SIZE]; // the first DIGEST_MD5_SIZE bytes for MD5
+} digest_value_t;
+
+// a file on a release page (/downloads/release/python-3130/) and its published checksum, as spans into the page, see parse_release_files
+typedef struct _release_file {
+        span_t url;    // https://www.python.org/ftp/python/3.13.0/python-3.13.0-amd64.exe
+        span_t digest; // 32 (MD5) or 64 (SHA-256) hex digits
+} release_file_t;
+
+// a page's parsed releases as they were stored in the response cache, see cache.c
+typedef struct _cached_page {
+        http_validators_t validators; // validators of the response the releases were parsed from
+        results_t         results;    // versions is NULL when there's no usable cache entry
+} cached_page_t;
+
+// fixed layout binary snapshot of parsed releases, see snapshot.c. all integers are little endian
+typedef struct _snapshot_header {
+        uint32_t magic;     // SNAPSHOT_MAGIC
+        uint32_t version;   // SNAPSHOT_VERSION, bumped whenever the layout changes
+        uint32_t count;     // number of releases, the header is followed by count version spans, count download URL spans and count kind bytes
+        uint32_t pool_size; // size of the string pool that follows the artifact kinds, in bytes
+        uint64_t created;   // FILETIME of when the snapshot was taken
+        uint64_t checksum;  // FNV-1a of the spans, the artifact kinds and the string pool
+} snapshot_header_t;
+
+// a read-only mapping of a validated snapshot file
+typedef struct _snapshot {
+        HANDLE                   file;     // handle to the snapshot file
+        HANDLE                   mapping;  // file mapping object
+        const unsigned char*     base;     // start of the mapped view
+        const snapshot_header_t* header;   // == base
+        results_t                releases; // borrows the spans and the string pool straight from the mapping, must not be modified
+} snapshot_t;
+
+// canonical Huffman code, decoded through the fast table for short codes and by walking the code lengths for the rest
+typedef struct _huffman {
+        uint16_t fast[1LLU << INFLATE_FAST_BITS]; // symbol << 4 | code length, indexed by the next INFLATE_FAST_BITS input bits. 0 for long codes
+        uint16_t count[16];                       // number of codes of each length
+        uint16_t symbols[288];                    // symbols in code order
+} huffman_t;
+
+// state of the push style DEFLATE decoder, see inflate.c. everything needed to resume mid-stream lives here, input can be pushed in pieces
+// of any size and the decoded bytes are handed to the sink through the 32 KiB window
+typedef struct _inflater {
+        http_sink_t          sink;             // consumer of the decoded bytes
+        void*                context;          // passed on to the sink
+        inflate_format_t     format;           // container to expect around the DEFLATE stream
+        unsigned             state;            // where to resume when more input arrives
+        const unsigned char* input;            // next byte of the piece being pushed
+        const unsigned char* input_end;        // end of the piece being pushed
+        uint64_t             bits;             // bit buffer, the next input bit is the lowest one
+        unsigned             nbits;            // number of valid bits in the bit buffer
+        bool                 is_last_block;    // BFINAL of the current block
+        unsigned char*       window;           // the last INFLATE_WINDOW_SIZE decoded bytes, a ring buffer
+        unsigned long        position;         // write position in the window
+        unsigned long        flushed;          // start of the bytes in the window that haven't been handed to the sink yet
+        unsigned long long   total;            // number of bytes decoded so far
+        uint32_t             checksum;         // CRC-32 (gzip) or Adler-32 (zlib) of the bytes handed to the sink so far
+        unsigned             remaining;        // bytes left in a stored block or in the part of the gzip header being skipped
+        unsigned             header_flags;     // FLG byte of the gzip header
+        unsigned             nliterals;        // HLIT + 257 of a dynamic block
+        unsigned             ndistances;       // HDIST + 1 of a dynamic block
+        unsigned             ncodelengths;     // HCLEN + 4 of a dynamic block
+        unsigned             index;            // next code length to read in a dynamic block header
+        uint8_t              lengths[320];     // code lengths of a dynamic block, literal/length codes first, then distance codes
+        huffman_t            literals;         // literal/length code of the current block, also holds the code length code while it's read
+        huffman_t            distances;        // distance code of the current block
+} inflater_t;
+
+// a declarative extraction rule, links whose file name ends with suffix are artifacts of the given kind. when the suffixes of several rules
+// match, the longest one wins, so ".exe" only claims the installers no more specific rule does
+typedef struct _artifact_rule {
+        artifact_kind_t kind;   // ARTIFACT_NONE for links that would otherwise be claimed by a shorter suffix but aren't artifacts
+        const wchar_t*  name;   // what --artifact calls the kind, NULL for ARTIFACT_NONE rules
+        const char*     suffix; // end of the file name, up to the closing quote of the href
+} artifact_rule_t;
+
+// the extraction rules compiled into a DFA, an Aho-Corasick automaton over character classes with its failure links folded into the
+// transitions. feeding it the bytes of a URL one after the other leaves it in a state whose accept value is the kind of the longest rule
+// suffix the URL ends with
+typedef struct _artifact_automaton {
+        uint8_t classes[256];                                    // character class of every byte, 0 for the bytes no suffix uses
+        uint8_t next[ARTIFACT_MAX_STATES][ARTIFACT_MAX_CLASSES]; // transitions, state 0 is the start state
+        uint8_t accept[ARTIFACT_MAX_STATES];                     // kind of the longest suffix ending in each state, ARTIFACT_NONE if none does
+} artifact_automaton_t;
+
+// state of the push style parser that consumes the HTTP response as it arrives, see stream_parser_feed
+// positions are offsets from the start of the response body, only the last few hundred bytes are kept around between chunks
+typedef struct _stream_parser {
+        char*              staging;       // STREAM_STAGING_SIZE + STREAM_LOOKAHEAD bytes, holds the part of the stream that is yet to be scanned
+        unsigned long      filled;        // number of valid bytes in staging
+        unsigned long long base;          // stream offset of staging[0]
+        unsigned long long heading_caret; // stream offset up to which "<h" candidates have been examined
+        unsigned long long anchor_caret;  // stream offset up to which "<a" candidates have been examined
+        unsigned long long stable_begin;  // stream offset where the stable releases start, 0 until <h2>Stable Releases</h2> is seen
+        unsigned long long stable_end;    // stream offset of <h2>Pre-releases</h2>, 0 until it is seen
+        unsigned long      emitted;       // number of releases in results that are final
+        bool               is_done;       // set once every release has been emitted, or on allocation failures
+        results_t          results;       // releases parsed so far, owning their text. the first emitted won't change anymore
+} stream_parser_t;
+
+// a saved response mapped read-only for --from-file, see replay.c
+typedef struct _replay {
+        const char*        base;     // start of the view of the whole file
+        unsigned long long size;     // size of the file
+        const char*        body;     // start of the body, past the status lines and headers of a recorded response
+        unsigned long long length;   // size of the body
+        unsigned           status;   // status of the recorded response, HTTP_STATUS_OK for a bare body
+        inflate_format_t   encoding; // compression of the body, from the gzip magic or the recorded Content-Encoding
+} replay_t;
+
+// --record, the copy of a live response written out as it streams into the parser, see replay.c
+typedef struct _recorder {
+        HANDLE                file;            // the recording, INVALID_HANDLE_VALUE once closed
+        const http_request_t* request;         // the response's status and validators make up the recorded headers
+        const wchar_t*        accesspoint;     // page the response is of, recorded as its Content-Location
+        stream_parser_t*      parser;          // where the body goes on to once recorded
+        bool                  is_head_written; // the headers go out with the first piece of the body
+        bool                  is_failed;       // a write failed, the rest of the body is parsed but no longer recorded
+} recorder_t;
+
+// a host --mirror lists and how it has been serving so far, the scores survive across runs in the scoreboard file, see mirrors.c
+typedef struct _mirror {
+        wchar_t            server[BUFF_SIZE];
+        unsigned short     port;
+        unsigned long long latency;    // microseconds from the start of a probe to the first byte of its answer, smoothed. 0 while unknown
+        unsigned long long throughput; // bytes per second pages were fetched at, smoothed. 0 while unknown
+        unsigned long      failures;   // probes and fetches that failed since the last fetch that succeeded
+        unsigned long      successes;  // probes and fetches that did, ever
+        long long          failed_at;  // time() of the latest failure, so that old failures can be forgiven
+} mirror_t;
+
+// the mirrors a run fetches from, a single one (--server) unless --mirror says otherwise
+typedef struct _mirrors {
+        mirror_t       hosts[MIRROR_MAX_HOSTS];
+        unsigned long  count;
+        unsigned long  ranks[MIRROR_MAX_HOSTS]; // indices into hosts, best first. the pages are fetched from the first one that answers
+        const wchar_t* scoreboard;              // file the scores are loaded from and saved to, NULL to keep them for this run alone
+} mirrors_t;
+
+// a finished span (a Chrome trace "X" event) or a counter sample ("C" event, category is NULL and bytes holds the value), see trace.c.
+// names and categories are string literals, they are written to the trace verbatim
+typedef struct _trace_event {
+        const char*        name;     // what was timed, "parse" or "first byte"
+        const char*        category; // the stage it belongs to, "http", "parse", "python" or "print"
+        unsigned long long begin;    // value of trace_ticks when the span was opened
+        unsigned long long end;      // value of trace_ticks when the span was closed, same as begin for counter samples
+        unsigned long long bytes;    // bytes the span went through
+        unsigned long long records;  // releases the span produced
+        unsigned long      thread;   // id of the thread that recorded the event
+} trace_event_t;
+
+// a span opened by trace_begin, name is NULL when tracing was off at the time and trace_end has nothing to do
+typedef struct _trace_span {
+        const char*        name;
+        const char*        category;
+        unsigned long long begin;
+} trace_span_t;
+
+// signature shared by the candidate scanning kernels in simd.c
+typedef unsigned long(__cdecl* scan_kernel_t)(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+);
+
 // enables printing coloured outputs to console. unnecessary as Windows console by default seems to be sensitive to VTE without manually enabling them
 [[deprecated("not needed in modern Win32 applications")]] bool __cdecl __activate_win32_virtual_terminal_escapes(void);
 
@@ -62,34 +566,559 @@ typedef struct _range {
 [[nodiscard("entails expensive http io"
 )]] hinternet_triple_t __cdecl http_get(_In_ const wchar_t* const restrict server, _In_ const wchar_t* const restrict accesspoint);
 
-// reads in the HTTP response content as a char buffer (automatic decompression will take place if the response is gzip or DEFLATE compressed)
+// http_get with an explicit port, INTERNET_DEFAULT_HTTP_PORT for regular use
+[[nodiscard("entails expensive http io")]] hinternet_triple_t __cdecl http_get_ex(
+    _In_ const wchar_t* const restrict server, _In_ const unsigned short port, _In_ const wchar_t* const restrict accesspoint
+);
+
+// reads in the HTTP response content into body (automatic decompression will take place if the response is gzip or DEFLATE compressed)
 [[deprecated("use the more efficient read_http_response_ex"),
   nodiscard("entails expensive http io"
-  )]] char* __cdecl read_http_response(_In_ const hinternet_triple_t handles, _Inout_ unsigned long* const restrict size);
+  )]] bool __cdecl read_http_response(_In_ const hinternet_triple_t handles, _Inout_ body_t* const restrict body);
 
-// an advanced variant of read_http_response that uses WinHttpReadDataEx internally to retrieve the whole content of the response at once unlike
+// an advanced variant of read_http_response that uses WinHttpReadDataEx internally to fill a whole slab of the body per call unlike
 // read_http_response which combines WinHttpQueryDataAvailable and WinHttpReadData to retrieve the contents in chunks, iteratively
 [[nodiscard("entails expensive http io"
-)]] char* __cdecl read_http_response_ex(_In_ const hinternet_triple_t handles, _Inout_ unsigned long* const restrict size);
+)]] bool __cdecl read_http_response_ex(_In_ const hinternet_triple_t handles, _Inout_ body_t* const restrict body);
+
+// reads the response in HTTP_CHUNK_SIZE pieces and pushes each one into the parser as soon as it arrives, so parsing overlaps the transfer
+// and no buffer proportional to the page size is ever allocated. closes the handles like read_http_response_ex
+[[nodiscard("entails expensive http io")]] bool __cdecl read_http_response_stream(
+    _In_ const hinternet_triple_t handles, _Inout_ stream_parser_t* const restrict parser, _Inout_ unsigned long* const restrict size
+);
+
+// the WinHttp backend, https is negotiated by WinHttp itself when the server redirects to it
+extern const http_transport_t winhttp_transport;
+
+// an HTTP/1.1 client over non-blocking BSD sockets (Winsock on Windows), handles chunked transfer and gzip/deflate content encoding, not TLS
+extern const http_transport_t socket_transport;
+
+// fetch_all for a single page behind the get and read of a transport, the body reaches the sink in one piece once it's complete
+extern const http_transport_t ring_transport;
+
+// formats the Range and If-Range lines of a ranged request, or the If-None-Match and If-Modified-Since lines of a conditional one, into
+// buffer as CRLF terminated header lines. returns their length, 0 when there are none
+int __cdecl format_request_conditions(
+    _In_ const http_request_t* const restrict request, _Inout_ char* const restrict buffer, _In_ const unsigned long size
+);
+
+// fetches http://server:port<path> for every one of fetches over plain HTTP/1.1, with up to concurrency keep-alive connections open at once.
+// the connections are spread over one completion ring per logical processor (io_uring on Linux, an I/O completion port on Windows), each
+// driving all of its connections from a single thread and batching their connects, sends and receives into one system call per wakeup.
+// the bodies are asked for uncompressed. returns the number of fetches that got a 2xx or 304 response, the others are left without a body
+[[nodiscard("entails expensive http io")]] unsigned long __cdecl fetch_all(
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _Inout_ fetch_t* const restrict fetches,
+    _In_ const unsigned long count,
+    _In_ const unsigned long concurrency
+);
+
+// takes an idle connection to server:port opened by owner out of the pool, most recently used first. connections the probe rejects are closed.
+// returns false when there's none, the caller is then expected to open a new connection
+[[nodiscard]] bool __cdecl pool_checkout(
+    _In_ const void* const restrict owner,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_opt_ const pool_probe_t probe,
+    _Inout_ uintptr_t* const restrict connection
+);
+
+// hands a connection that is ready for another request back to the pool, closing the least recently used idle connection when the pool
+// or the host is at capacity
+void __cdecl pool_checkin(
+    _In_ const void* const restrict owner,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const uintptr_t connection,
+    _In_ const pool_close_t close
+);
+
+// closes every idle connection in the pool
+void __cdecl pool_drain(void);
+
+// hit, miss, reuse and eviction counts since the start of the process
+[[nodiscard]] pool_stats_t __cdecl pool_statistics(void);
+
+// room at the end of the body to receive into directly, stores how many bytes fit in available (the rest of the last slab, or a fresh slab
+// when it's full) and returns where they go, NULL on allocation failures. body_commit then makes what was written there part of the body
+[[nodiscard]] char* __cdecl body_reserve(_Inout_ body_t* const restrict body, _Inout_ unsigned long* const restrict available);
+
+// appends the size bytes written at what body_reserve returned, at most the available bytes it reported
+void __cdecl body_commit(_Inout_ body_t* const restrict body, _In_ const unsigned long size);
+
+// copies the bytes to the end of the body, taking slabs from the pool as it fills up
+[[nodiscard]] bool __cdecl body_append(
+    _Inout_ body_t* const restrict body, _In_ const char* const restrict bytes, _In_ const unsigned long size
+);
+
+// stores up to capacity slices of the body in slices, in order, and returns the number of slabs the body spans
+unsigned long __cdecl body_view(
+    _In_ const body_t* const restrict body, _Inout_ body_slice_t* const restrict slices, _In_ const unsigned long capacity
+);
+
+// the body as one NUL terminated run of bytes, for the parsers that index into it: the first slab itself when the body fits in it, otherwise
+// a heap allocated copy that lives as long as the body. NULL on allocation failures
+[[nodiscard]] const char* __cdecl body_flatten(_Inout_ body_t* const restrict body);
+
+// hands the slabs back to the pool and leaves the body empty, safe to call on empty or already released bodies
+void __cdecl body_release(_Inout_ body_t* const restrict body);
+
+// frees the slabs in the pool
+void __cdecl body_drain(void);
+
+// slab allocation, reuse and free counts since the start of the process
+[[nodiscard]] body_stats_t __cdecl body_statistics(void);
+
+// drains the connection pool and releases the process wide state of every transport, call once before exiting
+void __cdecl transport_cleanup(void);
+
+// looks up a transport by its name, returns NULL for unknown names
+[[nodiscard]] const http_transport_t* __cdecl find_transport(_In_ const wchar_t* const restrict name);
+
+// issues a GET request through the given transport, on failure the returned request has a NULL transport
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint
+);
+
+// transport_get with the validators of a cached copy of the page, the server then answers with HTTP_STATUS_NOT_MODIFIED and an empty body if
+// the page hasn't changed since. conditions may be NULL, making this an unconditional transport_get
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get_conditional(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_opt_ const http_validators_t* const restrict conditions
+);
+
+// a GET request for bytes [begin, end) of the body, answered with HTTP_STATUS_PARTIAL_CONTENT by servers that support ranges and with the
+// whole body (HTTP_STATUS_OK) by those that don't. with validators the range is made conditional on them (If-Range), a server whose copy has
+// changed since sends the whole new body instead. either way request.total_size tells the size of the whole body once the headers are in
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get_range(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const unsigned long long begin,
+    _In_ const unsigned long long end,
+    _In_opt_ const http_validators_t* const restrict validators
+);
+
+// receives the response of a request made through any transport and hands the body to the sink piece by piece, releasing the request
+[[nodiscard("entails expensive http io")]] bool __cdecl transport_read(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const http_sink_t sink,
+    _Inout_opt_ void* const context,
+    _Inout_ unsigned long* const restrict size
+);
+
+// transport agnostic counterpart of read_http_response_ex, collects the whole body into body, which the caller must body_release even when
+// the read failed
+[[nodiscard("entails expensive http io"
+)]] bool __cdecl transport_read_ex(_Inout_ http_request_t* const restrict request, _Inout_ body_t* const restrict body);
+
+// transport agnostic counterpart of read_http_response_stream, pushes the body into the parser as it arrives
+[[nodiscard("entails expensive http io")]] bool __cdecl transport_read_stream(
+    _Inout_ http_request_t* const restrict request, _Inout_ stream_parser_t* const restrict parser, _Inout_ unsigned long* const restrict size
+);
+
+// prepares an empty results_t with room for capacity releases, text is the buffer the spans will refer to or NULL if the results will own
+// their text in the arena. must be paired with a call to results_release
+[[nodiscard]] bool __cdecl results_init(
+    _Inout_ results_t* const restrict results, _In_opt_ const char* const text, _In_ const unsigned long capacity
+);
+
+// appends a release whose strings are spans of results->text, doubling the span block when it's full
+[[nodiscard]] bool __cdecl results_push(
+    _Inout_ results_t* const restrict results, _In_ const span_t version, _In_ const span_t downloadurl, _In_ const artifact_kind_t kind
+);
+
+// copies size bytes to the end of the arena and stores where they landed in offset, doubling the arena when it's full.
+// only for results that own their text, the arena may move but spans are offsets so they stay valid
+[[nodiscard]] bool __cdecl results_intern(
+    _Inout_ results_t* const restrict results,
+    _In_ const char* const restrict bytes,
+    _In_ const unsigned long size,
+    _Inout_ uint32_t* const restrict offset
+);
+
+// frees the span block and the arena, a borrowed text is left alone. safe to call on failed or already released results
+void __cdecl results_release(_Inout_ results_t* const restrict results);
+
+// number of text bytes results_serialize writes after the spans
+[[nodiscard]] unsigned long __cdecl results_text_size(_In_ const results_t results);
+
+// writes count version spans, count download URL spans, count artifact kinds and then the text they cover to buffer, which must hold
+// count * RESULTS_RECORD_SIZE + results_text_size(results) bytes. the text is compacted, only the bytes the spans cover are written and
+// the written spans are offsets into the written text
+void __cdecl results_serialize(_In_ const results_t results, _Inout_ unsigned char* const restrict buffer);
+
+// prepares a decoder that hands everything it inflates to sink, must be paired with a call to inflater_finish
+[[nodiscard]] bool __cdecl inflater_init(
+    _Inout_ inflater_t* const restrict inflater, _In_ const inflate_format_t format, _In_ const http_sink_t sink, _Inout_opt_ void* const context
+);
+
+// decodes the next piece of the compressed stream, pieces can be of any size down to a single byte. returns false on corrupt input or when
+// the sink gave up. has the signature of an http_sink_t, with the inflater as context, so a transport can feed it directly
+bool __cdecl inflater_push(_Inout_opt_ void* const inflater, _In_ const char* const restrict chunk, _In_ const unsigned long size);
+
+// flushes the window to the sink and releases the decoder, returns true only if the stream ended cleanly with matching checksums
+[[nodiscard]] bool __cdecl inflater_finish(_Inout_ inflater_t* const restrict inflater);
+
+// the extraction rules compiled into an automaton, built on the first call and shared by every parser after that
+[[nodiscard]] const artifact_automaton_t* __cdecl artifact_automaton(void);
+
+// looks up an artifact kind by the name --artifact knows it by, returns ARTIFACT_NONE for unknown names
+[[nodiscard]] artifact_kind_t __cdecl find_artifact(_In_ const wchar_t* const restrict name);
+
+// the name --artifact knows the kind by
+[[nodiscard]] const wchar_t* __cdecl artifact_name(_In_ const artifact_kind_t kind);
+
+// packs a version (3.12.4, 3.13.0rc2, 3.12 which stands for 3.12.0) into a key, VERSION_KEY_INVALID if the text isn't one as a whole
+[[nodiscard]] version_key_t __cdecl version_key(_In_ const char* const restrict text, _In_ const unsigned long length);
+
+// the key of the version get_system_python_version reported ("Python 3.12.4"), VERSION_KEY_INVALID when it didn't report one
+[[nodiscard]] version_key_t __cdecl system_python_key(_In_opt_ const char* const restrict syspyversion);
+
+// spells a key out the way python.org does, returns the length of the null terminated text or 0 when it doesn't fit
+unsigned long __cdecl version_format(_In_ const version_key_t key, _Inout_ char* const restrict buffer, _In_ const unsigned long size);
+
+// sorts the releases whose artifact kind is in artifacts by version, releases whose version isn't one are left out.
+// the index must be released with release_index_release on success
+[[nodiscard]] bool __cdecl release_index_build(
+    _Inout_ release_index_t* const restrict index, _In_ const results_t results, _In_ const unsigned artifacts
+);
+
+void __cdecl release_index_release(_Inout_ release_index_t* const restrict index);
+
+// positions of the releases of exactly this version in the index, an empty range when there are none
+[[nodiscard]] range_t __cdecl release_index_find(_In_ const release_index_t* const restrict index, _In_ const version_key_t key);
+
+// the newest final release of major.minor, VERSION_KEY_INVALID when there's none
+[[nodiscard]] version_key_t __cdecl release_index_latest_patch(
+    _In_ const release_index_t* const restrict index, _In_ const unsigned major, _In_ const unsigned minor
+);
+
+// the newest final release, provided it is at least minimum, VERSION_KEY_INVALID otherwise
+[[nodiscard]] version_key_t __cdecl release_index_newest(_In_ const release_index_t* const restrict index, _In_ const version_key_t minimum);
+
+// tells whether there's a final release of the installed version's major.minor newer than it, storing the newest one in latest
+[[nodiscard]] bool __cdecl release_index_is_outdated(
+    _In_ const release_index_t* const restrict index, _In_ const version_key_t installed, _Inout_ version_key_t* const restrict latest
+);
+
+// runs query against the releases whose artifact kind is in artifacts and prints the answer in format, the matching releases for the version
+// queries, the installed and the latest version for QUERY_OUTDATED. returns false when nothing matches, when the system python is outdated
+// or its version is unknown, and on failures
+[[nodiscard]] bool __cdecl answer_query(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_opt_ const char* const restrict syspyversion,
+    _In_ const output_format_t format,
+    _In_ const query_t query
+);
+
+// the releases a version query (QUERY_EXACT, QUERY_LATEST or QUERY_NEWEST) picks among those whose artifact kind is in artifacts, as a view
+// borrowing results' text that must be released with results_release. false when nothing matches, the other query kinds match nothing
+[[nodiscard]] bool __cdecl select_releases(
+    _In_ const results_t results, _In_ const unsigned artifacts, _In_ const query_t query, _Inout_ results_t* const restrict matches
+);
 
 // finds the start and end of the HTML div containing the stable releases section of the python.org downloads page
 [[nodiscard]] range_t __cdecl locate_stable_releases_htmldiv(_In_ const char* const restrict html, _In_ const unsigned long size);
 
-// extracts information of URLs and versions from the input string buffer, caller is responsible for freeing the memory allocated in return.begin
+// extracts information of URLs and versions from the input string buffer without copying them, the returned spans refer to html which must
+// outlive the results. caller is responsible for calling results_release on the return value
 [[nodiscard]] results_t __cdecl parse_stable_releases(_In_ const char* const restrict html, _In_ const unsigned long size);
 
-// coloured console outputs of the deserialized structs
-void __cdecl print(_In_ const results_t results, _In_ const char* const restrict syspyversion);
+// locate_stable_releases_htmldiv over a body split into slices, the offsets count from the start of the first slice. headings that straddle
+// two slices are found too
+[[nodiscard]] range_t __cdecl locate_stable_releases_view(_In_ const body_slice_t* const restrict slices, _In_ const unsigned long count);
+
+// parse_stable_releases over a body split into slices, the slices go through the streaming parser one after the other so nothing is copied
+// into one buffer first. the releases own their text. caller is responsible for calling results_release on the return value
+[[nodiscard]] results_t __cdecl parse_stable_releases_view(_In_ const body_slice_t* const restrict slices, _In_ const unsigned long count);
+
+// appends the releases linked by the anchor tags that start within [begin, end) of html to results. the matcher may look up to
+// STREAM_LOOKAHEAD bytes past an anchor's start, but never at or past size, so a range can end anywhere in the buffer and still see every
+// anchor it owns in full. returns false only on allocation failures, results then keeps what was appended before
+[[nodiscard]] bool __cdecl parse_releases_between(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long begin,
+    _In_ const unsigned long end,
+    _In_ const unsigned long size,
+    _Inout_ results_t* const restrict results
+);
+
+// number of logical processors the process can run on
+[[nodiscard]] unsigned long __cdecl processor_count(void);
+
+// parse_stable_releases split over nthreads worker threads (0 for one per logical processor). the anchor starts are dealt out in contiguous
+// chunks, each chunk reading up to STREAM_LOOKAHEAD bytes into the next one, and the per-chunk releases are concatenated in chunk order, so
+// the results are identical to what parse_stable_releases returns. inputs too small to give every thread PARSE_PARALLEL_MIN_CHUNK bytes get
+// fewer threads, down to parsing on the calling thread alone
+[[nodiscard]] results_t __cdecl parse_stable_releases_parallel(
+    _In_ const char* const restrict html, _In_ const unsigned long size, _In_ const unsigned long nthreads
+);
+
+// collects the files of a release page (/downloads/release/python-3130/) that have a checksum listed in the same table row, URLs and checksums
+// in one pass over the page. the spans point into html. returns the number of files stored, at most capacity
+[[nodiscard]] unsigned long __cdecl parse_release_files(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long size,
+    _Inout_ release_file_t* const restrict files,
+    _In_ const unsigned long capacity
+);
+
+// returns the offset of the first occurrence of the two byte sequence {first, second} in html that starts within [begin, end) or end if there's
+// none, like the hand written loops it replaced, a candidate at end - 1 will have html[end] inspected. dispatches to the widest kernel the CPU supports
+[[nodiscard]] unsigned long __cdecl scan_pair(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+);
+
+// portable reference kernel, one byte at a time
+[[nodiscard]] unsigned long __cdecl scan_pair_scalar(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+);
+
+// 16 bytes per iteration, SSE2 is guaranteed on every x86-64 CPU
+[[nodiscard]] unsigned long __cdecl scan_pair_sse2(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+);
+
+// 32 bytes per iteration, only call this when the CPU and the OS support AVX2
+[[nodiscard]] unsigned long __cdecl scan_pair_avx2(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+);
+
+// prepares a streaming parser, must be paired with a call to stream_parser_finish
+[[nodiscard]] bool __cdecl stream_parser_init(_Inout_ stream_parser_t* const restrict parser);
+
+// pushes the next chunk of the response body into the parser, chunks can be of any size down to a single byte.
+// returns the number of releases that became final with this chunk, they can be read from parser->results right away
+unsigned long __cdecl stream_parser_feed(
+    _Inout_ stream_parser_t* const restrict parser, _In_ const char* const restrict chunk, _In_ const unsigned long size
+);
+
+// flushes the parser at the end of the stream and releases its internal buffers, returns the same releases parse_stable_releases would have
+// found in the whole body. caller is responsible for calling results_release on the return value, whose versions is NULL on failure
+[[nodiscard]] results_t __cdecl stream_parser_finish(_Inout_ stream_parser_t* const restrict parser);
 
-// launches python.exe in a separate process, will use the python.exe in PATH in release mode and in debug mode the dummy ./python/bin/Debug/python.exe will be launched, with "--version" as argument
-[[nodiscard]] bool __cdecl launch_python(void);
+// releases the parser's internal buffers and the releases parsed so far without flushing it, for responses whose bodies are of no interest
+void __cdecl stream_parser_discard(_Inout_ stream_parser_t* const restrict parser);
 
-// reads and captures the stdout of the launched python.exe, using a call to launch_python()
-[[nodiscard]] bool __cdecl read_stdout_python(_Inout_ char* const restrict buffer, _In_ const unsigned long size);
+// builds the path of the cache file of http://server:port/accesspoint inside directory, directory must end with a path separator
+[[nodiscard]] bool __cdecl cache_path(
+    _In_ const wchar_t* const restrict directory,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _Inout_ wchar_t* const restrict path,
+    _In_ const unsigned long size
+);
+
+// loads a cache file written by cache_store, a missing, truncated or otherwise unusable file yields a NULL results.versions.
+// caller is responsible for calling results_release on return.results
+[[nodiscard("entails expensive file io")]] cached_page_t __cdecl cache_load(_In_ const wchar_t* const restrict path);
+
+// stores the releases parsed from a response along with its validators, built on __serialize
+[[nodiscard("entails expensive file io")]] bool __cdecl cache_store(
+    _In_ const wchar_t* const restrict path, _In_ const http_validators_t* const restrict validators, _In_ const results_t results
+);
+
+// coloured console outputs of the deserialized structs, only the releases whose artifact kind is in artifacts (a mask of ARTIFACT_MASK bits)
+void __cdecl print(_In_ const results_t results, _In_ const unsigned artifacts, _In_ const char* const restrict syspyversion);
+
+// print in any of the output formats, the releases are rendered into a single buffer and written to stdout in one go.
+// returns false when the buffer can't be allocated or the write fails
+bool __cdecl print_ex(
+    _In_ const results_t results, _In_ const unsigned artifacts, _In_opt_ const char* const restrict syspyversion, _In_ const output_format_t format
+);
+
+// prints the releases that appeared on and disappeared from a watched page since the last poll, + and - rows in the table format, an
+// {"added":[...],"removed":[...]} document per batch in JSON, an {"event":"added",...} line per release in NDJSON and event,version,url,kind
+// rows in CSV, the header only when is_first. every release of the views is printed, the caller filters the artifact kinds beforehand
+bool __cdecl print_events(
+    _In_ const results_t added, _In_ const results_t removed, _In_ const output_format_t format, _In_ const bool is_first
+);
+
+// looks an output format up by its command line name (table, json, ndjson or csv), OUTPUT_FORMATS when there's no such format
+[[nodiscard]] output_format_t __cdecl find_output_format(_In_ const wchar_t* const restrict name);
+
+// an upper bound of the bytes render writes for these releases in this format
+[[nodiscard]] unsigned long __cdecl render_size(_In_ const results_t results, _In_ const unsigned artifacts, _In_ const output_format_t format);
+
+// formats the releases into buffer, which must hold at least render_size bytes, and returns the number of bytes written. no null terminator
+[[nodiscard]] unsigned long __cdecl render(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_opt_ const char* const restrict syspyversion,
+    _In_ const output_format_t format,
+    _Inout_ char* const restrict buffer
+);
 
-// a wrapper encapsulating the functionalities of launch_python and read_stdout_python, for convenience
+// writes the releases to a snapshot file, the file is replaced atomically so concurrent readers see either the old or the new snapshot
+[[nodiscard("entails expensive file io"
+)]] bool __cdecl snapshot_write(_In_ const wchar_t* const restrict filename, _In_ const results_t results);
+
+// maps a snapshot file into memory and validates it, rejecting files of other layout versions and files whose checksum doesn't match.
+// the snapshot must be released with snapshot_unmap on success
+[[nodiscard("entails expensive file io")]] bool __cdecl snapshot_map(
+    _In_ const wchar_t* const restrict filename, _Inout_ snapshot_t* const restrict snapshot
+);
+
+void __cdecl snapshot_unmap(_Inout_ snapshot_t* const restrict snapshot);
+
+// maps a saved response, either a bare body or one recorded with its status line and headers, and finds where its body starts. fails on
+// recordings of anything but a 200 response. the replay must be released with replay_unmap on success
+[[nodiscard("entails expensive file io")]] bool __cdecl replay_map(
+    _In_ const wchar_t* const restrict filename, _Inout_ replay_t* const restrict replay
+);
+
+// the stable releases of the mapped body. an uncompressed body under 4 GiB is parsed in place and the releases borrow their text from the
+// mapping, which must outlive them. caller is responsible for calling results_release on the return value
+[[nodiscard]] results_t __cdecl replay_parse(_In_ const replay_t* const restrict replay);
+
+void __cdecl replay_unmap(_Inout_ replay_t* const restrict replay);
+
+// creates the recording of the response request is about to receive, whose body is then handed to record_sink with the recorder as
+// context. the recorder must be released with record_close on success
+[[nodiscard("entails expensive file io")]] bool __cdecl record_open(
+    _In_ const wchar_t* const restrict filename,
+    _In_ const http_request_t* const restrict request,
+    _In_ const wchar_t* const restrict accesspoint,
+    _Inout_ stream_parser_t* const restrict parser,
+    _Inout_ recorder_t* const restrict recorder
+);
+
+// an http_sink_t that writes the chunk to the recording and feeds it to the recorder's parser
+bool __cdecl record_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size);
+
+// closes the recording, false when any of it could not be written
+[[nodiscard]] bool __cdecl record_close(_Inout_ recorder_t* const restrict recorder);
+
+// adds host, host:port or [address]:port to the mirrors, port when it names none. false when it isn't one or the list is full
+[[nodiscard]] bool __cdecl mirrors_add(
+    _Inout_ mirrors_t* const restrict mirrors, _In_ const wchar_t* const restrict host, _In_ const unsigned short port
+);
+
+// reads the scores of the mirrors from the scoreboard file, if there is one, and ranks them. hosts the file doesn't know start unscored
+void __cdecl mirrors_load(_Inout_ mirrors_t* const restrict mirrors);
+
+// races the mirrors happy eyeballs style (RFC 8305): a HEAD request for accesspoint goes to each one in rank order, MIRROR_ATTEMPT_DELAY ms
+// apart or as soon as every earlier one has failed, and the first to answer is ranked first. the ones that failed are scored as such and the
+// ones still underway are abandoned. false when none answered within MIRROR_RACE_TIMEOUT ms
+[[nodiscard("entails expensive http io")]] bool __cdecl mirrors_race(
+    _Inout_ mirrors_t* const restrict mirrors, _In_ const wchar_t* const restrict accesspoint
+);
+
+// scores a fetch from the mirror, size bytes in elapsed microseconds when it succeeded. the ranks are left alone until mirrors_rank
+void __cdecl mirrors_report(
+    _Inout_ mirror_t* const restrict mirror, _In_ const bool is_success, _In_ const unsigned long size, _In_ const unsigned long long elapsed
+);
+
+// orders the ranks by the time each mirror is expected to take for MIRROR_RANK_SIZE bytes, doubled for every failure that hasn't been
+// forgiven yet. one is forgiven every MIRROR_FORGIVE_INTERVAL seconds, so a mirror that was down gets another chance sooner or later
+void __cdecl mirrors_rank(_Inout_ mirrors_t* const restrict mirrors);
+
+// writes the scores to the scoreboard file, a no-op without one
+[[nodiscard("entails expensive file io")]] bool __cdecl mirrors_save(_In_ const mirrors_t* const restrict mirrors);
+
+// prints the ranked mirrors and their scores to stderr, for --stats
+void __cdecl mirrors_print(_In_ const mirrors_t* const restrict mirrors);
+
+// a monotonic timestamp in microseconds, what the scores are measured with
+[[nodiscard]] unsigned long long __cdecl mirrors_clock(void);
+
+// runs routine(argument) on a new thread, or right away on the calling thread when no thread can be started. either way the result is
+// collected with task_wait, which must be called once the task is started to release the thread. the thread works on the task_t itself,
+// which must stay where it is until then
+void __cdecl task_start(_Inout_ task_t* const restrict task, _In_ const task_routine_t routine, _Inout_opt_ void* const argument);
+
+// waits for the task to complete and returns the routine's result. everything the routine wrote is visible to the caller afterwards,
+// calling it again returns the same result without waiting
+bool __cdecl task_wait(_Inout_ task_t* const restrict task);
+
+// finds the python interpreters on PATH in PATH order and reads their versions from the metadata next to them (pyvenv.cfg, the version
+// resource of python.exe, patchlevel.h), running only the ones without any with --version, concurrently. with is_primary_only the search
+// stops at the first python.exe (python3 off Windows), the one a bare python command runs. in debug builds the dummy
+// ./python/bin/Debug/python.exe comes first. returns the number of interpreters found, whose versions may still be unknown
+[[nodiscard]] unsigned long __cdecl find_python_interpreters(
+    _Inout_ python_interpreter_t* const restrict interpreters, _In_ const unsigned long capacity, _In_ const bool is_primary_only
+);
+
+// the version of the python a bare python command runs, "Python 3.12.4" as python --version prints it. false when there's none on PATH
+// or its version couldn't be found out
 [[nodiscard]] bool __cdecl get_system_python_version(_Inout_ char* const restrict version, _In_ const unsigned long size);
 
+// starts looking for the system python's version on a thread of its own. must be paired with a call to python_probe_wait
+void __cdecl python_probe_start(_Inout_ python_probe_t* const restrict probe);
+
+// waits for the probe and returns the version it found ("Python 3.12.4"), an empty string when it failed. can be called any number of times
+[[nodiscard]] const char* __cdecl python_probe_wait(_Inout_ python_probe_t* const restrict probe);
+
+// prints the interpreters with their versions and where the versions came from, one per line
+void __cdecl print_python_interpreters(_In_ const python_interpreter_t* const restrict interpreters, _In_ const unsigned long count);
+
+// downloads http://server:port/accesspoint to path over up to connections ranged requests at once, through <path>.part and with the progress
+// of every segment in <path>.segments, so that a download that was interrupted resumes where it stopped next time. servers without range
+// support get a single plain request. with an expected checksum the bytes are hashed as they land and a file that doesn't match is thrown
+// away. returns false on failures, after which whatever made it to disk is kept for the next attempt unless it was the checksum that failed
+[[nodiscard("entails expensive http io")]] bool __cdecl download_file(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const wchar_t* const restrict path,
+    _In_ const unsigned long connections,
+    _In_opt_ const digest_value_t* const restrict expected
+);
+
+// downloads the file behind every download URL of releases into the directory of options, one file after the other, each named after the
+// last component of its URL and verified against the checksum on its release page. returns false if any of them failed
+[[nodiscard("entails expensive http io")]] bool __cdecl download_releases(
+    _In_ const results_t releases, _In_ const download_options_t* const restrict options
+);
+
+// indexes every release artifact in the directory tree under options->root, a server generated listing of links per directory like the
+// one python.org serves /ftp/python/ with. the version of an artifact is the name of the directory right under the root it sits in. the
+// index is sorted by URL and owns its text, its versions are NULL on failures. must be paired with a call to results_release
+[[nodiscard("entails expensive http io")]] results_t __cdecl crawl_ftp(_In_ const ftp_options_t* const restrict options);
+
+// starts a checksum of the given kind
+void __cdecl digest_init(_Inout_ digest_t* const restrict digest, _In_ const digest_kind_t kind);
+
+// feeds the next size bytes to the checksum, in pieces of any size
+void __cdecl digest_update(_Inout_ digest_t* const restrict digest, _In_ const void* const restrict bytes, _In_ const unsigned long long size);
+
+// completes the checksum and stores it in value, which must have room for DIGEST_SHA256_SIZE bytes. returns the size of the checksum
+unsigned long __cdecl digest_final(_Inout_ digest_t* const restrict digest, _Inout_ unsigned char* const restrict value);
+
+// reads a checksum written as 32 (MD5) or 64 (SHA-256) hex digits, false for anything else
+[[nodiscard]] bool __cdecl digest_parse(
+    _In_ const char* const restrict hex, _In_ const unsigned long length, _Inout_ digest_value_t* const restrict value
+);
+
+// MD5 or SHA-256, as the checksums are called in messages
+[[nodiscard]] const wchar_t* __cdecl digest_name(_In_ const digest_kind_t kind);
+
+// polls http://server:port/accesspoint every interval seconds until interrupted (Ctrl+C, SIGINT or SIGTERM), over the same pooled connection,
+// and prints the releases among the requested artifacts that were added or removed since the previous poll, every release being added on
+// the first one. pages whose stable releases section hashes the same as last time aren't parsed again. unchanged or failed polls back the
+// interval off exponentially, every delay is jittered. returns false when the watch couldn't start or the last poll failed
+[[nodiscard("entails expensive http io")]] bool __cdecl watch(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const unsigned long interval
+);
+
 // reads a file from disk into a buffer in read-only mode, caller should take care of (free) the buffer post-use.
 [[nodiscard("entails expensive file io"
 )]] unsigned char* __cdecl __open(_In_ const wchar_t* const restrict filename, _Inout_ unsigned long* const restrict size);
@@ -98,3 +1127,45 @@ void __cdecl print(_In_ const results_t results, _In_ const char* const restrict
 [[nodiscard("entails expensive file io")]] bool __cdecl __serialize(
     _In_ const unsigned char* const restrict buffer, _In_ const unsigned long size, _In_ const wchar_t* const restrict filename
 );
+
+// set by trace_start, every trace_begin and trace_counter checks it before doing anything else
+extern bool trace_enabled;
+
+// starts recording spans and counters, the events are kept in memory until trace_write. returns false when the event buffer can't be allocated
+[[nodiscard]] bool __cdecl trace_start(void);
+
+// stops recording and writes the events as a Chrome trace event JSON file (chrome://tracing, ui.perfetto.dev), releasing the event buffer
+[[nodiscard("entails expensive file io")]] bool __cdecl trace_write(_In_ const wchar_t* const restrict filename);
+
+// a monotonic timestamp, QueryPerformanceCounter ticks on Windows and nanoseconds of CLOCK_MONOTONIC elsewhere
+[[nodiscard]] unsigned long long __cdecl trace_ticks(void);
+
+// appends an event to the buffer, safe to call from any thread. use trace_begin, trace_end and trace_counter instead
+void __cdecl trace_record(
+    _In_ const char* const restrict name,
+    _In_opt_ const char* const restrict category,
+    _In_ const unsigned long long begin,
+    _In_ const unsigned long long end,
+    _In_ const unsigned long long bytes,
+    _In_ const unsigned long long records
+);
+
+// opens a span, with tracing off this is a single well predicted branch and the clock isn't read
+static inline trace_span_t __cdecl trace_begin(_In_ const char* const restrict name, _In_ const char* const restrict category) {
+    if (!trace_enabled) return (trace_span_t) { .name = NULL, .category = NULL, .begin = 0 };
+    return (trace_span_t) { .name = name, .category = category, .begin = trace_ticks() };
+}
+
+// closes a span opened by trace_begin, recording the bytes it went through and the releases it produced
+static inline void __cdecl trace_end(_In_ const trace_span_t span, _In_ const unsigned long long bytes, _In_ const unsigned long long records) {
+    if (span.name) [[unlikely]]
+        trace_record(span.name, span.category, span.begin, trace_ticks(), bytes, records);
+}
+
+// samples a running total, shown as a counter track by the trace viewers
+static inline void __cdecl trace_counter(_In_ const char* const restrict name, _In_ const unsigned long long value) {
+    if (trace_enabled) [[unlikely]] {
+        const unsigned long long now = trace_ticks();
+        trace_record(name, NULL, now, now, value, 0);
+    }
+}
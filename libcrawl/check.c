@@ -0,0 +1,215 @@
+// checks libcrawl the way an agent uses it, linked against the shared library and including nothing of crawl but libcrawl.h. builds with
+// libcrawl/Makefile on Linux, make check runs it over the python.org snapshots in bench/pages.
+//
+// libcrawl-check [--fetch <port> <path>] page.html...
+//
+// every page is answered on its own and then all of them in one batch, repeated CHECK_BATCH_REPEATS times over with a page that isn't a
+// downloads page in between, which must come back with the same releases page for page and CRAWL_ERROR_NOT_FOUND for the stranger alone.
+// a first try with a one byte arena must fail without touching it and tell the size that's needed. the version queries are checked against
+// what the query for every release returned. --fetch additionally fetches the path from a server on localhost:port, which must serve the first page,
+// through crawl_fetch_batch and compares the answer with the one for the file. prints what failed and exits with 1 if anything did.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libcrawl.h"
+
+#define CHECK_MAX_PAGES     16U // pages a run checks at most
+#define CHECK_BATCH_REPEATS 64U // times over the pages are repeated in the big batch
+#define CHECK_FETCHES       32U // fetches of the same path --fetch makes in one batch
+
+static const char stranger[] = "<html><body><h2>Not the downloads page</h2></body></html>";
+static unsigned failures = 0;
+
+#define expect(condition, ...)                                                                                                                    \
+    do {                                                                                                                                          \
+        if (!(condition)) {                                                                                                                       \
+            fprintf(stderr, "FAILED %s:%d: ", __FILE__, __LINE__);                                                                                \
+            fprintf(stderr, __VA_ARGS__);                                                                                                         \
+            fputc('\n', stderr);                                                                                                                  \
+            failures++;                                                                                                                           \
+        }                                                                                                                                         \
+    } while (0)
+
+static char* read_page(const char* const path, uint64_t* const size) {
+    FILE* const file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (uint64_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* const html = malloc(*size ? *size : 1);
+    if (html && fread(html, 1, *size, file) != *size) *size = 0;
+    fclose(file);
+    return html;
+}
+
+// runs a batch with an arena of exactly the size it asks for, after checking that a one byte arena is refused
+static int32_t run_batch(
+    const crawl_buffer_t* const buffers,
+    const uint32_t              count,
+    const crawl_query_t* const  query,
+    crawl_arena_t* const        arena,
+    crawl_page_t* const         pages
+) {
+    unsigned char tiny  = 0x5A;
+    crawl_arena_t small = { .base = &tiny, .capacity = 1, .used = 0, .required = 0 };
+    *arena              = (crawl_arena_t) { .base = NULL, .capacity = 0, .used = 0, .required = 0 };
+    const int32_t first = crawl_parse_batch(buffers, count, query, &small, pages);
+    if (first != CRAWL_ERROR_ARENA) return first; // nothing to place, errors and empty answers only
+    expect(small.used == 0 && tiny == 0x5A, "a refused arena was written to");
+    expect(small.required > 1, "a refused arena doesn't say how large it must be");
+
+    *arena = (crawl_arena_t) { .base = malloc(small.required), .capacity = small.required, .used = 0, .required = 0 };
+    if (!arena->base) return CRAWL_ERROR_MEMORY;
+    const int32_t status = crawl_parse_batch(buffers, count, query, arena, pages);
+    expect(arena->used <= arena->capacity && arena->required == small.required, "the arena overflowed or the size changed");
+    return status;
+}
+
+static bool is_same_page(const crawl_page_t left, const crawl_page_t right) {
+    if (left.status != right.status || left.count != right.count) return false;
+    for (uint32_t i = 0; i < left.count; ++i)
+        if (strcmp(left.releases[i].version, right.releases[i].version) || strcmp(left.releases[i].url, right.releases[i].url)
+            || left.releases[i].kind != right.releases[i].kind)
+            return false;
+    return true;
+}
+
+static void check_releases(const char* const name, const crawl_page_t page) {
+    expect(page.status == CRAWL_OK && page.count > 0, "%s: %s, %u releases", name, crawl_status_text(page.status), page.count);
+    for (uint32_t i = 0; i < page.count; ++i) {
+        const crawl_release_t release = page.releases[i];
+        expect(strlen(release.version) == release.version_length && strlen(release.url) == release.url_length, "%s: bad lengths", name);
+        expect(release.kind <= CRAWL_ARTIFACT_SOURCE_XZ && !release.reserved, "%s: bad kind %u", name, release.kind);
+        expect(!strncmp(release.url, "https://www.python.org/ftp/python/", 34), "%s: bad url %s", name, release.url);
+    }
+}
+
+// the newest final version on the page, for the version queries to ask about
+static const char* newest_version(const crawl_page_t page) {
+    const char*        newest = NULL;
+    unsigned long long best   = 0;
+    for (uint32_t i = 0; i < page.count; ++i) {
+        unsigned major = 0, minor = 0, micro = 0; // NOLINT(readability-isolate-declaration)
+        int      consumed = 0;
+        if (sscanf(page.releases[i].version, "%u.%u.%u%n", &major, &minor, &micro, &consumed) != 3) continue;
+        const unsigned long long key = (unsigned long long) major << 40 | (unsigned long long) minor << 20 | micro;
+        if (page.releases[i].version[consumed] || key <= best) continue; // pre-releases and older versions
+        newest = page.releases[i].version;
+        best   = key;
+    }
+    return newest;
+}
+
+static void check_queries(const char* const name, const crawl_buffer_t buffer, const crawl_page_t all) {
+    crawl_page_t  page   = { 0 };
+    crawl_arena_t arena  = { 0 };
+    const char*   newest = newest_version(all);
+    expect(newest != NULL, "%s: no final release", name);
+    if (!newest) return;
+
+    const crawl_query_t exact  = { .kind = CRAWL_QUERY_EXACT, .artifacts = CRAWL_ARTIFACT_ALL, .version = newest };
+    int32_t             status = run_batch(&buffer, 1, &exact, &arena, &page);
+    expect(status == CRAWL_OK && page.count > 0, "%s: --exact %s found %u releases", name, newest, page.count);
+    for (uint32_t i = 0; i < page.count; ++i)
+        expect(!strcmp(page.releases[i].version, newest), "%s: --exact %s found %s", name, newest, page.releases[i].version);
+    const uint32_t nexact = page.count;
+    free(arena.base);
+
+    const crawl_query_t newer = { .kind = CRAWL_QUERY_NEWEST, .artifacts = CRAWL_ARTIFACT_ALL, .version = "2.0" };
+    status                    = run_batch(&buffer, 1, &newer, &arena, &page);
+    expect(status == CRAWL_OK && page.count == nexact, "%s: --newest 2.0 found %u releases, not %u", name, page.count, nexact);
+    free(arena.base);
+
+    const crawl_query_t future = { .kind = CRAWL_QUERY_NEWEST, .artifacts = 0, .version = "99.0" };
+    arena                      = (crawl_arena_t) { 0 };
+    status                     = crawl_parse_batch(&buffer, 1, &future, &arena, &page); // nothing to place, an empty arena will do
+    expect(status == CRAWL_OK && page.count == 0 && !page.releases, "%s: --newest 99.0 found %u releases", name, page.count);
+
+    const crawl_query_t bad = { .kind = CRAWL_QUERY_LATEST, .artifacts = 0, .version = "three" };
+    expect(crawl_parse_batch(&buffer, 1, &bad, &arena, &page) == CRAWL_ERROR_ARGUMENT, "%s: a bad version was accepted", name);
+}
+
+static void check_fetch(const char* const port, const char* const path, const crawl_page_t expected) {
+    const char*         paths[CHECK_FETCHES] = { 0 };
+    crawl_page_t        pages[CHECK_FETCHES] = { 0 };
+    const crawl_query_t all                  = { .kind = CRAWL_QUERY_ALL, .artifacts = CRAWL_ARTIFACT_ALL, .version = NULL };
+    for (uint32_t i = 0; i < CHECK_FETCHES; ++i) paths[i] = path;
+
+    crawl_arena_t arena  = { 0 };
+    int32_t       status = crawl_fetch_batch("localhost", (uint16_t) atoi(port), paths, CHECK_FETCHES, 8, &all, &arena, pages);
+    expect(status == CRAWL_ERROR_ARENA && arena.required > 0, "fetch: an empty arena wasn't refused, %s", crawl_status_text(status));
+    arena  = (crawl_arena_t) { .base = malloc(arena.required), .capacity = arena.required, .used = 0, .required = 0 };
+    status = crawl_fetch_batch("localhost", (uint16_t) atoi(port), paths, CHECK_FETCHES, 8, &all, &arena, pages);
+    expect(status == CRAWL_OK, "fetch: %s", crawl_status_text(status));
+    for (uint32_t i = 0; i < CHECK_FETCHES && status == CRAWL_OK; ++i) expect(is_same_page(pages[i], expected), "fetch %u differs from the file", i);
+    free(arena.base);
+}
+
+int main(int argc, char* argv[]) {
+    crawl_buffer_t      buffers[CHECK_MAX_PAGES] = { 0 };
+    crawl_page_t        singles[CHECK_MAX_PAGES] = { 0 };
+    crawl_arena_t       arenas[CHECK_MAX_PAGES]  = { 0 };
+    uint32_t            count                    = 0;
+    const char*         port                     = NULL;
+    const char*         path                     = NULL;
+    const crawl_query_t all                      = { .kind = CRAWL_QUERY_ALL, .artifacts = CRAWL_ARTIFACT_ALL, .version = NULL };
+
+    expect(crawl_abi_version() == CRAWL_ABI_VERSION, "built against ABI %u, loaded %u", CRAWL_ABI_VERSION, crawl_abi_version());
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--fetch") && i + 2 < argc) {
+            port = argv[++i];
+            path = argv[++i];
+        } else if (count < CHECK_MAX_PAGES) {
+            buffers[count].data = read_page(argv[i], &buffers[count].size);
+            if (!buffers[count].data || !buffers[count].size) {
+                fprintf(stderr, "can't read %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            count++;
+        }
+    }
+    if (!count) {
+        fputs("usage: libcrawl-check [--fetch <port> <path>] page.html...\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) { // one at a time, each in an arena of its own
+        expect(run_batch(buffers + i, 1, &all, arenas + i, singles + i) == CRAWL_OK, "%s", argv[argc - count + i]);
+        check_releases(argv[argc - count + i], singles[i]);
+        check_queries(argv[argc - count + i], buffers[i], singles[i]);
+    }
+
+    // all of them CHECK_BATCH_REPEATS times over in one call, each repetition followed by the stranger
+    const uint32_t        nbatch = count * CHECK_BATCH_REPEATS + CHECK_BATCH_REPEATS;
+    crawl_buffer_t* const batch  = calloc(nbatch, sizeof(crawl_buffer_t));
+    crawl_page_t* const   pages  = calloc(nbatch, sizeof(crawl_page_t));
+    crawl_arena_t         arena  = { 0 };
+    if (!batch || !pages) return EXIT_FAILURE;
+    for (uint32_t r = 0; r < CHECK_BATCH_REPEATS; ++r) {
+        memcpy(batch + r * (count + 1), buffers, count * sizeof(crawl_buffer_t));
+        batch[r * (count + 1) + count] = (crawl_buffer_t) { .data = stranger, .size = sizeof(stranger) - 1 };
+    }
+    const int32_t status = run_batch(batch, nbatch, &all, &arena, pages);
+    expect(status == CRAWL_ERROR_NOT_FOUND, "the batch with strangers in it returned %s", crawl_status_text(status));
+    for (uint32_t i = 0; i < nbatch; ++i) {
+        const uint32_t page = i % (count + 1);
+        if (page == count) expect(pages[i].status == CRAWL_ERROR_NOT_FOUND && !pages[i].count, "stranger %u was answered", i);
+        else expect(is_same_page(pages[i], singles[page]), "page %u of the batch differs from its single answer", i);
+    }
+
+    if (port) check_fetch(port, path, singles[0]);
+
+    printf("%u pages, %u in the batch, %llu bytes of arena: %s\n", count, nbatch, (unsigned long long) arena.used, failures ? "FAILED" : "ok");
+    free(arena.base);
+    for (uint32_t i = 0; i < count; ++i) {
+        free(arenas[i].base);
+        free((void*) buffers[i].data); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+    free(batch);
+    free(pages);
+    crawl_cleanup();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
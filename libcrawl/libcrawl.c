@@ -0,0 +1,283 @@
+#include <project.h>
+
+#define CRAWL_BUILDING_LIBRARY
+#include "libcrawl.h"
+
+// the library side of libcrawl.h. a batch is answered in two passes: the pages are located, parsed and queried on up to one thread per
+// processor, every thread taking every nth page so nothing is shared between them, and the releases each page ends up with are then
+// copied into the caller's arena in page order. the first pass needs no arena at all, the releases borrow their text from the page, so
+// the second one knows exactly how much room the whole batch takes before writing any of it, and an arena that's too small is left alone.
+// crawl's own error reporting still goes to stderr, the status codes are what callers go by
+
+static_assert(CRAWL_ARTIFACT_SOURCE_XZ == ARTIFACT_SOURCE_XZ && ARTIFACT_KINDS == 8, "the artifact kinds are part of the ABI");
+static_assert(sizeof(crawl_release_t) == 2 * sizeof(void*) + 16, "crawl_release_t is part of the ABI");
+
+// a page of a batch, from the buffer it's parsed from to the releases the query picked
+typedef struct _batch_page {
+        const char*   html;     // the page, NULL when it couldn't be fetched
+        unsigned long size;     // bytes in html
+        int32_t       status;   // CRAWL_OK or why the page has no releases
+        results_t     releases; // the releases the query picked, borrowing their text from html
+} batch_page_t;
+
+// what a thread of a batch works through, pages first, first + stride, first + 2 * stride...
+typedef struct _batch_worker {
+        batch_page_t* pages;
+        unsigned long count;
+        unsigned long first;
+        unsigned long stride;
+        unsigned      artifacts;
+        query_t       query;
+} batch_worker_t;
+
+[[nodiscard]] uint32_t __cdecl crawl_abi_version(void) { return CRAWL_ABI_VERSION; }
+
+[[nodiscard]] const char* __cdecl crawl_status_text(const int32_t status) {
+    switch (status) {
+        case CRAWL_OK :              return "ok";
+        case CRAWL_ERROR_ARGUMENT :  return "invalid argument";
+        case CRAWL_ERROR_ARENA :     return "arena too small";
+        case CRAWL_ERROR_MEMORY :    return "out of memory";
+        case CRAWL_ERROR_NOT_FOUND : return "no stable releases section";
+        case CRAWL_ERROR_NETWORK :   return "fetch failed";
+        default :                    return "unknown status";
+    }
+}
+
+// the releases of the page that are among artifacts, or the ones the version query picks among those, in page->releases
+static int32_t __cdecl answer_page(_Inout_ batch_page_t* const restrict page, _In_ const unsigned artifacts, _In_ const query_t query) {
+    release_index_t index = { 0 };
+
+    const range_t stable = locate_stable_releases_htmldiv(page->html, page->size);
+    if (!stable.begin) return CRAWL_ERROR_NOT_FOUND;
+    const unsigned long end    = stable.end ? stable.end : page->size; // a page cut short of the pre-releases
+    results_t           parsed = parse_stable_releases(page->html + stable.begin, end - stable.begin);
+    if (!parsed.versions) return CRAWL_ERROR_MEMORY; // parse_stable_releases will do the error reporting
+
+    int32_t status = CRAWL_ERROR_MEMORY;
+    if (query.kind == QUERY_NONE) {
+        if (!results_init(&page->releases, parsed.text, parsed.count)) goto RELEASE_PARSED; // results_init will do the error reporting
+        for (unsigned long i = 0; i < parsed.count; ++i)
+            if (artifacts & ARTIFACT_MASK(parsed.kinds[i]))
+                if (!results_push(&page->releases, parsed.versions[i], parsed.downloadurls[i], (artifact_kind_t) parsed.kinds[i]))
+                    goto RELEASE_PARSED; // results_push will do the error reporting
+        status = CRAWL_OK;
+        goto RELEASE_PARSED;
+    }
+
+    // select_releases without its complaints on stderr, an empty answer isn't an error to a caller of the library
+    if (!release_index_build(&index, parsed, artifacts)) goto RELEASE_PARSED; // release_index_build will do the error reporting
+    version_key_t key = query.key;
+    if (query.kind == QUERY_LATEST) key = release_index_latest_patch(&index, VERSION_MAJOR(query.key), VERSION_MINOR(query.key));
+    else if (query.kind == QUERY_NEWEST) key = release_index_newest(&index, query.key);
+    const range_t range = release_index_find(&index, key);
+
+    if (!results_init(&page->releases, parsed.text, range.end - range.begin)) goto RELEASE_INDEX;
+    for (unsigned long i = range.begin; i < range.end; ++i) {
+        const uint32_t row = index.rows[i];
+        if (!results_push(&page->releases, parsed.versions[row], parsed.downloadurls[row], (artifact_kind_t) parsed.kinds[row]))
+            goto RELEASE_INDEX;
+    }
+    status = CRAWL_OK;
+
+RELEASE_INDEX:
+    release_index_release(&index);
+RELEASE_PARSED:
+    results_release(&parsed);
+    if (status != CRAWL_OK) results_release(&page->releases);
+    return status;
+}
+
+static bool __cdecl answer_pages(_Inout_opt_ void* const argument) {
+    const batch_worker_t* const worker = argument;
+    for (unsigned long i = worker->first; i < worker->count; i += worker->stride)
+        if (worker->pages[i].status == CRAWL_OK) worker->pages[i].status = answer_page(worker->pages + i, worker->artifacts, worker->query);
+    return true;
+}
+
+static void __cdecl answer_batch(
+    _Inout_ batch_page_t* const restrict pages, _In_ const unsigned long count, _In_ const unsigned artifacts, _In_ const query_t query
+) {
+    task_t         tasks[PARSE_PARALLEL_MAX_THREADS]   = { 0 };
+    batch_worker_t workers[PARSE_PARALLEL_MAX_THREADS] = { 0 };
+
+    unsigned long nworkers = processor_count();
+    if (nworkers > PARSE_PARALLEL_MAX_THREADS) nworkers = PARSE_PARALLEL_MAX_THREADS;
+    if (nworkers > count) nworkers = count;
+
+    for (unsigned long w = 0; w < nworkers; ++w)
+        workers[w]
+            = (batch_worker_t) { .pages = pages, .count = count, .first = w, .stride = nworkers, .artifacts = artifacts, .query = query };
+    if (nworkers == 1) { // not worth a thread
+        (void) answer_pages(workers);
+        return;
+    }
+    for (unsigned long w = 0; w < nworkers; ++w) task_start(tasks + w, answer_pages, workers + w);
+    for (unsigned long w = 0; w < nworkers; ++w) (void) task_wait(tasks + w);
+}
+
+// bytes the releases of a page take up in the arena, the records and then the strings, rounded up so the next page's records stay aligned
+static uint64_t __cdecl page_size(_In_ const results_t releases) {
+    uint64_t size = (uint64_t) releases.count * sizeof(crawl_release_t);
+    for (unsigned long i = 0; i < releases.count; ++i) size += releases.versions[i].length + 1LLU + releases.downloadurls[i].length + 1LLU;
+    return (size + _Alignof(crawl_release_t) - 1) / _Alignof(crawl_release_t) * _Alignof(crawl_release_t);
+}
+
+// copies the releases of a page into the arena at records, which has room for page_size bytes
+static void __cdecl place_page(
+    _In_ const results_t releases, _Inout_ crawl_release_t* const restrict records, _Inout_ crawl_page_t* const restrict page
+) {
+    char* text = (char*) (records + releases.count);
+    for (unsigned long i = 0; i < releases.count; ++i) {
+        const span_t version = releases.versions[i], url = releases.downloadurls[i]; // NOLINT(readability-isolate-declaration)
+        memcpy(text, releases.text + version.offset, version.length);
+        text[version.length] = 0;
+        memcpy(text + version.length + 1, releases.text + url.offset, url.length);
+        text[version.length + 1 + url.length] = 0;
+        records[i]                            = (crawl_release_t) {
+            .version        = text,
+            .url            = text + version.length + 1,
+            .version_length = version.length,
+            .url_length     = url.length,
+            .kind           = releases.kinds[i],
+            .reserved       = 0,
+        };
+        text += version.length + 1LLU + url.length + 1LLU;
+    }
+    *page = (crawl_page_t) { .status = CRAWL_OK, .count = (uint32_t) releases.count, .releases = releases.count ? records : NULL };
+}
+
+// copies the releases of every answered page into the arena, of all of them or none at all, and releases the pages' results. required
+// allows for the worst alignment of the arena, so that an arena of that size will do wherever it's allocated
+static int32_t __cdecl publish_batch(
+    _Inout_ batch_page_t* const restrict pages,
+    _In_ const unsigned long count,
+    _Inout_ crawl_arena_t* const restrict arena,
+    _Inout_ crawl_page_t* const restrict answers
+) {
+    const uintptr_t alignment = _Alignof(crawl_release_t);
+    int32_t         status    = CRAWL_OK;
+    uint64_t        size      = 0;
+    for (unsigned long i = 0; i < count; ++i)
+        if (pages[i].status == CRAWL_OK) size += page_size(pages[i].releases);
+    arena->required       = size ? arena->used + alignment - 1 + size : arena->used; // answers without releases take no room at all
+    const bool is_fitting = arena->required <= arena->capacity;
+    if (!is_fitting) status = CRAWL_ERROR_ARENA;
+
+    uint64_t at = arena->used;
+    if (size) at += (alignment - ((uintptr_t) arena->base + arena->used) % alignment) % alignment;
+    for (unsigned long i = 0; i < count; ++i) {
+        if (is_fitting && pages[i].status == CRAWL_OK) {
+            place_page(pages[i].releases, (crawl_release_t*) ((unsigned char*) arena->base + at), answers + i);
+            at += page_size(pages[i].releases);
+        } else {
+            answers[i] = (crawl_page_t) { .status = is_fitting ? pages[i].status : CRAWL_ERROR_ARENA, .count = 0, .releases = NULL };
+            if (status == CRAWL_OK) status = pages[i].status;
+        }
+        results_release(&pages[i].releases);
+    }
+    if (is_fitting) arena->used = at;
+    return status;
+}
+
+// the query_t crawl.exe would make of the same flags, false when the query can't be made sense of
+static bool __cdecl translate_query(
+    _In_opt_ const crawl_query_t* const restrict query, _Inout_ unsigned* const restrict artifacts, _Inout_ query_t* const restrict translated
+) {
+    static const query_kind_t kinds[] = { QUERY_NONE, QUERY_EXACT, QUERY_LATEST, QUERY_NEWEST }; // indexed by the CRAWL_QUERY_ constants
+
+    *artifacts  = ARTIFACT_MASK(ARTIFACT_AMD64);
+    *translated = (query_t) { .kind = QUERY_NONE, .key = VERSION_KEY_INVALID };
+    if (!query) return true;
+    if (query->kind >= sizeof(kinds) / sizeof(kinds[0]) || (query->artifacts & ~ARTIFACT_MASK_ALL)) return false;
+
+    if (query->artifacts) *artifacts = query->artifacts;
+    translated->kind = kinds[query->kind];
+    if (translated->kind == QUERY_NONE) return true;
+    if (!query->version) return false;
+    translated->key = version_key(query->version, (unsigned long) strlen(query->version));
+    return translated->key != VERSION_KEY_INVALID;
+}
+
+[[nodiscard]] int32_t __cdecl crawl_parse_batch(
+    _In_ const crawl_buffer_t* const restrict buffers,
+    _In_ const uint32_t count,
+    _In_opt_ const crawl_query_t* const restrict query,
+    _Inout_ crawl_arena_t* const restrict arena,
+    _Inout_ crawl_page_t* const restrict pages
+) {
+    unsigned artifacts  = 0;
+    query_t  translated = { 0 };
+    if (!arena || (count && (!buffers || !pages)) || !translate_query(query, &artifacts, &translated)) return CRAWL_ERROR_ARGUMENT;
+    if (!count) return CRAWL_OK;
+
+    batch_page_t* const batch = calloc(count, sizeof(batch_page_t));
+    if (!batch) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return CRAWL_ERROR_MEMORY;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        const bool is_valid = buffers[i].data && buffers[i].size && buffers[i].size <= UINT32_MAX;
+        batch[i]            = (batch_page_t) {
+            .html = buffers[i].data, .size = (unsigned long) buffers[i].size, .status = is_valid ? CRAWL_OK : CRAWL_ERROR_ARGUMENT
+        };
+    }
+
+    answer_batch(batch, count, artifacts, translated);
+    const int32_t status = publish_batch(batch, count, arena, pages);
+    free(batch);
+    return status;
+}
+
+[[nodiscard]] int32_t __cdecl crawl_fetch_batch(
+    _In_ const char* const restrict server,
+    _In_ const uint16_t port,
+    _In_ const char* const* const restrict paths,
+    _In_ const uint32_t count,
+    _In_ const uint32_t connections,
+    _In_opt_ const crawl_query_t* const restrict query,
+    _Inout_ crawl_arena_t* const restrict arena,
+    _Inout_ crawl_page_t* const restrict pages
+) {
+    unsigned artifacts          = 0;
+    query_t  translated         = { 0 };
+    wchar_t  widened[BUFF_SIZE] = { 0 };
+    if (!server || !arena || (count && (!paths || !pages)) || connections > RING_MAX_CONNECTIONS) return CRAWL_ERROR_ARGUMENT;
+    if (!translate_query(query, &artifacts, &translated) || mbstowcs(widened, server, BUFF_SIZE) >= BUFF_SIZE) return CRAWL_ERROR_ARGUMENT;
+    for (uint32_t i = 0; i < count; ++i)
+        if (!paths[i] || *paths[i] != '/') return CRAWL_ERROR_ARGUMENT;
+    if (!count) return CRAWL_OK;
+
+    fetch_t* const      fetches = calloc(count, sizeof(fetch_t));
+    batch_page_t* const batch   = calloc(count, sizeof(batch_page_t));
+    if (!fetches || !batch) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        free(fetches);
+        free(batch);
+        return CRAWL_ERROR_MEMORY;
+    }
+    for (uint32_t i = 0; i < count; ++i) fetches[i].path = paths[i];
+
+    // fetch_all will do the error reporting, the fetches that failed are left without a body
+    (void) fetch_all(widened, port, fetches, count, connections ? connections : FTP_DEFAULT_PER_HOST);
+    for (uint32_t i = 0; i < count; ++i) {
+        const bool        is_fetched = fetches[i].is_fetched && fetches[i].status == HTTP_STATUS_OK;
+        const char* const html       = is_fetched ? body_flatten(&fetches[i].body) : NULL; // body_flatten will do the error reporting
+        batch[i]                     = (batch_page_t) {
+            .html = html, .size = fetches[i].body.size, .status = !is_fetched ? CRAWL_ERROR_NETWORK : html ? CRAWL_OK : CRAWL_ERROR_MEMORY
+        };
+    }
+
+    answer_batch(batch, count, artifacts, translated);
+    const int32_t status = publish_batch(batch, count, arena, pages);
+    for (uint32_t i = 0; i < count; ++i) body_release(&fetches[i].body);
+    free(fetches);
+    free(batch);
+    return status;
+}
+
+void __cdecl crawl_cleanup(void) {
+    body_drain();
+    pool_drain();
+    if (ring_transport.cleanup) ring_transport.cleanup();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+// libcrawl, the fetch, locate, parse and query stages of crawl as a shared library (crawl.dll, libcrawl.so) for programs that would
+// otherwise run crawl.exe and scrape its table. this header is the whole interface and the only one a caller includes: plain C, fixed width
+// types and no Windows headers. the ABI is stable within a CRAWL_ABI_VERSION, structs only ever grow reserved fields into use, constants are
+// never renumbered, so a caller built against an older header keeps working. everything a call returns lives in the caller's arena, the
+// library keeps no pointers to it and hands out nothing the caller has to free. calls on different arenas may run concurrently
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRAWL_ABI_VERSION 1U // bumped whenever the layout of a struct or the meaning of a call changes, see crawl_abi_version
+
+#ifdef _WIN32
+    #ifdef CRAWL_BUILDING_LIBRARY
+        #define CRAWL_API __declspec(dllexport)
+    #else
+        #define CRAWL_API __declspec(dllimport)
+    #endif
+    #define CRAWL_CALL __cdecl
+#else
+    #define CRAWL_API __attribute__((visibility("default")))
+    #define CRAWL_CALL
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// what the calls return, and what every page of a batch reports in its status
+#define CRAWL_OK              0 // all went well
+#define CRAWL_ERROR_ARGUMENT  1 // a NULL pointer, an unknown query or artifact, a version that isn't one, a buffer of 4 GiB or more
+#define CRAWL_ERROR_ARENA     2 // the arena is too small, its required field says how large it has to be for the whole call
+#define CRAWL_ERROR_MEMORY    3 // the library ran out of memory of its own
+#define CRAWL_ERROR_NOT_FOUND 4 // the page has no stable releases section
+#define CRAWL_ERROR_NETWORK   5 // the page could not be fetched, or the server didn't answer with 200
+
+// kinds of release artifacts, numbered like crawl's --artifact kinds
+#define CRAWL_ARTIFACT_AMD64       0 // python-3.13.3-amd64.exe
+#define CRAWL_ARTIFACT_ARM64       1 // python-3.13.3-arm64.exe
+#define CRAWL_ARTIFACT_WIN32       2 // python-3.13.3.exe
+#define CRAWL_ARTIFACT_EMBED_AMD64 3 // python-3.13.3-embed-amd64.zip
+#define CRAWL_ARTIFACT_EMBED_ARM64 4 // python-3.13.3-embed-arm64.zip
+#define CRAWL_ARTIFACT_EMBED_WIN32 5 // python-3.13.3-embed-win32.zip
+#define CRAWL_ARTIFACT_SOURCE_TGZ  6 // Python-3.13.3.tgz
+#define CRAWL_ARTIFACT_SOURCE_XZ   7 // Python-3.13.3.tar.xz
+
+#define CRAWL_ARTIFACT_MASK(kind) (1U << (kind))
+#define CRAWL_ARTIFACT_ALL        0xFFU
+
+// what a batch asks of every page, like --exact, --latest and --newest do
+#define CRAWL_QUERY_ALL    0 // every release of the requested artifact kinds, in page order
+#define CRAWL_QUERY_EXACT  1 // the releases of exactly version
+#define CRAWL_QUERY_LATEST 2 // the releases of the newest final patch of version's major.minor
+#define CRAWL_QUERY_NEWEST 3 // the releases of the newest final version, provided it is at least version
+
+// memory the caller lends a call. results are carved out of it from used onwards and used is advanced past them, so successive calls
+// append to the same arena and resetting used to 0 reuses it. a call that runs out of room returns CRAWL_ERROR_ARENA, leaves used where
+// it was and sets required to the size base would have needed, after which the call can be repeated with an arena that large
+typedef struct crawl_arena {
+        void*    base;     // the caller's memory, any alignment
+        uint64_t capacity; // bytes at base
+        uint64_t used;     // bytes of base handed out so far
+        uint64_t required; // bytes the last call needed base to hold, counting what was in use before it
+} crawl_arena_t;
+
+// a page in memory, the HTML of a python.org downloads page as the server sent it (after any Content-Encoding was undone)
+typedef struct crawl_buffer {
+        const char* data;
+        uint64_t    size; // less than 4 GiB
+} crawl_buffer_t;
+
+typedef struct crawl_query {
+        uint32_t    kind;      // one of the CRAWL_QUERY_ constants
+        uint32_t    artifacts; // CRAWL_ARTIFACT_MASK bits of the kinds to return, 0 for CRAWL_ARTIFACT_AMD64 alone like crawl.exe
+        const char* version;   // "3.12.4", "3.13.0rc2", "3.12" for the version queries, NULL for CRAWL_QUERY_ALL
+} crawl_query_t;
+
+// a release, the strings are null terminated copies in the arena
+typedef struct crawl_release {
+        const char* version;        // "3.13.0"
+        const char* url;            // "https://www.python.org/ftp/python/3.13.0/python-3.13.0-amd64.exe"
+        uint32_t    version_length; // bytes of version, not counting the terminator
+        uint32_t    url_length;     // bytes of url, not counting the terminator
+        uint32_t    kind;           // one of the CRAWL_ARTIFACT_ constants
+        uint32_t    reserved;       // 0
+} crawl_release_t;
+
+// the answer for one page of a batch
+typedef struct crawl_page {
+        int32_t                status;   // CRAWL_OK or why this page has no releases
+        uint32_t               count;    // releases in releases, 0 when the query matches nothing
+        const crawl_release_t* releases; // count releases in the arena, NULL when there are none
+} crawl_page_t;
+
+// CRAWL_ABI_VERSION of the library that was loaded, for callers that load it at run time
+CRAWL_API uint32_t CRAWL_CALL crawl_abi_version(void);
+
+// a short English description of a status
+CRAWL_API const char* CRAWL_CALL crawl_status_text(int32_t status);
+
+// locates and parses count pages and runs query against each, on as many threads as there are processors. pages[i] receives the answer
+// for buffers[i]. a NULL query returns every amd64 release. returns CRAWL_OK when every page was answered, otherwise the first error any
+// page ran into, the other pages are answered regardless. on CRAWL_ERROR_ARENA nothing at all is written to the arena
+CRAWL_API int32_t CRAWL_CALL crawl_parse_batch(
+    const crawl_buffer_t* buffers, uint32_t count, const crawl_query_t* query, crawl_arena_t* arena, crawl_page_t* pages
+);
+
+// fetches http://server:port<paths[i]> for all count paths over plain HTTP/1.1 with up to connections keep-alive connections at once (1 to
+// 1024, 0 for 8) and answers query for each like crawl_parse_batch does. the bodies never reach the arena, only the releases do
+CRAWL_API int32_t CRAWL_CALL crawl_fetch_batch(
+    const char*          server,
+    uint16_t             port,
+    const char* const*   paths,
+    uint32_t             count,
+    uint32_t             connections,
+    const crawl_query_t* query,
+    crawl_arena_t*       arena,
+    crawl_page_t*        pages
+);
+
+// releases the memory and idle connections the library keeps around between calls, for callers that unload it
+CRAWL_API void CRAWL_CALL crawl_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
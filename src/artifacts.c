@@ -0,0 +1,94 @@
+#include <project.h>
+
+// classification of download links into release artifacts. the rules below are all there is to it, they get compiled into a DFA on first
+// use and the parsers walk every candidate URL through it exactly once: the state the automaton is in at the closing quote of the href
+// says which suffix the URL ends with. adding an artifact kind means adding a rule (and an enumerator), not another matcher.
+
+static const artifact_rule_t rules[] = {
+    { .kind = ARTIFACT_AMD64,       .name = L"amd64",       .suffix = "-amd64.exe"       },
+    { .kind = ARTIFACT_ARM64,       .name = L"arm64",       .suffix = "-arm64.exe"       },
+    { .kind = ARTIFACT_WIN32,       .name = L"win32",       .suffix = ".exe"             },
+    { .kind = ARTIFACT_EMBED_AMD64, .name = L"embed-amd64", .suffix = "-embed-amd64.zip" },
+    { .kind = ARTIFACT_EMBED_ARM64, .name = L"embed-arm64", .suffix = "-embed-arm64.zip" },
+    { .kind = ARTIFACT_EMBED_WIN32, .name = L"embed-win32", .suffix = "-embed-win32.zip" },
+    { .kind = ARTIFACT_SOURCE_TGZ,  .name = L"source-tgz",  .suffix = ".tgz"             },
+    { .kind = ARTIFACT_SOURCE_XZ,   .name = L"source-xz",   .suffix = ".tar.xz"          },
+    // the web installers of 3.5 - 3.8 would otherwise pass for win32 installers
+    { .kind = ARTIFACT_NONE,        .name = NULL,           .suffix = "-webinstall.exe"  },
+};
+
+static artifact_automaton_t automaton = { 0 };
+
+// builds the trie of the suffixes, then visits it breadth first to resolve the failure links: a state's failure target is the longest proper
+// suffix of its string that is also in the trie. missing transitions are filled in from the failure target, which turns the trie into a DFA,
+// and a state that doesn't end a suffix of its own inherits the accept value of its failure target
+static void __cdecl build_automaton(void) {
+    uint8_t  failures[ARTIFACT_MAX_STATES] = { 0 }, queue[ARTIFACT_MAX_STATES] = { 0 }; // NOLINT(readability-isolate-declaration)
+    bool     is_terminal[ARTIFACT_MAX_STATES] = { 0 };
+    unsigned nclasses = 1, nstates = 1; // NOLINT(readability-isolate-declaration)
+
+    memset(automaton.next, 0, sizeof(automaton.next));
+    memset(automaton.accept, ARTIFACT_NONE, sizeof(automaton.accept));
+
+    for (unsigned long i = 0; i < sizeof(rules) / sizeof(rules[0]); ++i) {
+        unsigned state = 0;
+        for (const unsigned char* c = (const unsigned char*) rules[i].suffix; *c; ++c) {
+            if (!automaton.classes[*c]) automaton.classes[*c] = (uint8_t) nclasses++;
+            uint8_t* const target = &automaton.next[state][automaton.classes[*c]];
+            if (!*target) *target = (uint8_t) nstates++; // state 0 can't be a target while building the trie, it has no incoming edges
+            state = *target;
+        }
+        automaton.accept[state] = (uint8_t) rules[i].kind;
+        is_terminal[state]      = true;
+    }
+    assert(nclasses <= ARTIFACT_MAX_CLASSES && nstates <= ARTIFACT_MAX_STATES);
+
+    unsigned head = 0, tail = 0; // NOLINT(readability-isolate-declaration)
+    for (unsigned class = 1; class < nclasses; ++class)
+        if (automaton.next[0][class]) queue[tail++] = automaton.next[0][class]; // depth 1 states fail to the start state
+
+    while (head < tail) {
+        const unsigned state = queue[head++];
+        if (!is_terminal[state]) automaton.accept[state] = automaton.accept[failures[state]];
+
+        for (unsigned class = 0; class < nclasses; ++class) {
+            const unsigned target = automaton.next[state][class];
+            if (target) { // a trie edge
+                failures[target] = automaton.next[failures[state]][class];
+                queue[tail++]    = (uint8_t) target;
+            } else
+                automaton.next[state][class] = automaton.next[failures[state]][class];
+        }
+    }
+}
+
+#ifdef _WIN32
+static INIT_ONCE once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK build_automaton_once(_Inout_ PINIT_ONCE init_once, _Inout_opt_ PVOID parameter, _Inout_opt_ PVOID* context) {
+    build_automaton();
+    return TRUE;
+}
+    #define automaton_init() InitOnceExecuteOnce(&once, build_automaton_once, NULL, NULL)
+#else
+    #include <pthread.h>
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+    #define automaton_init() pthread_once(&once, build_automaton)
+#endif
+
+[[nodiscard]] const artifact_automaton_t* __cdecl artifact_automaton(void) {
+    automaton_init();
+    return &automaton;
+}
+
+[[nodiscard]] artifact_kind_t __cdecl find_artifact(_In_ const wchar_t* const restrict name) {
+    for (unsigned long i = 0; i < sizeof(rules) / sizeof(rules[0]); ++i)
+        if (rules[i].name && !wcscmp(rules[i].name, name)) return rules[i].kind;
+    return ARTIFACT_NONE;
+}
+
+[[nodiscard]] const wchar_t* __cdecl artifact_name(_In_ const artifact_kind_t kind) {
+    for (unsigned long i = 0; i < sizeof(rules) / sizeof(rules[0]); ++i)
+        if (rules[i].kind == kind && rules[i].name) return rules[i].name;
+    return L"none";
+}
@@ -0,0 +1,166 @@
+#include <project.h>
+
+// response bodies as chains of BODY_SLAB_SIZE slabs. a slab comes straight from the OS (VirtualAlloc, mmap), page aligned and untouched, so
+// nothing is zeroed up front and the pages a short response never writes to are never even faulted in. a body grows a slab at a time and
+// never moves what it already holds, so there's no size limit and no copy on growth. released slabs go to a process wide free list of up to
+// BODY_POOL_MAX_IDLE slabs rather than back to the OS, which makes every response after the first few cost no allocation at all: the
+// --watch polls, the listings of --ftp and the release pages of --download all recycle the same handful of slabs.
+
+#ifdef _WIN32
+static SRWLOCK lock = SRWLOCK_INIT;
+    #define body_lock()      AcquireSRWLockExclusive(&lock)
+    #define body_unlock()    ReleaseSRWLockExclusive(&lock)
+    #define map_slab()       VirtualAlloc(NULL, BODY_SLAB_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE) // 64 KiB, the allocation granularity
+    #define unmap_slab(slab) VirtualFree(slab, 0, MEM_RELEASE)
+#else
+    #include <pthread.h>
+    #include <sys/mman.h>
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    #define body_lock()   pthread_mutex_lock(&lock)
+    #define body_unlock() pthread_mutex_unlock(&lock)
+
+static void* __cdecl map_slab(void) {
+    void* const slab = mmap(NULL, BODY_SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return slab == MAP_FAILED ? NULL : slab;
+}
+
+    #define unmap_slab(slab) munmap(slab, BODY_SLAB_SIZE)
+#endif
+
+static body_slab_t*  idle  = NULL; // the pool, a free list linked through next
+static unsigned long nidle = 0;
+static body_stats_t  stats = { 0 };
+
+static body_slab_t* __cdecl take_slab(void) {
+    body_lock();
+    body_slab_t* slab = idle;
+    if (slab) {
+        idle = slab->next;
+        nidle--;
+        stats.reuses++;
+    } else
+        stats.allocations++;
+    body_unlock();
+
+    if (!slab) slab = map_slab();
+    if (!slab) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return NULL;
+    }
+    slab->next = NULL;
+    slab->size = 0;
+    return slab;
+}
+
+[[nodiscard]] char* __cdecl body_reserve(_Inout_ body_t* const restrict body, _Inout_ unsigned long* const restrict available) {
+    *available = 0;
+    if (!body->tail || body->tail->size == sizeof(body->tail->data)) {
+        body_slab_t* const slab = take_slab();
+        if (!slab) return NULL; // take_slab will do the error reporting
+        if (body->tail) body->tail->next = slab;
+        else body->head = slab;
+        body->tail = slab;
+        body->nslabs++;
+    }
+    *available = (unsigned long) (sizeof(body->tail->data) - body->tail->size);
+    return body->tail->data + body->tail->size;
+}
+
+void __cdecl body_commit(_Inout_ body_t* const restrict body, _In_ const unsigned long size) {
+    if (!size) return;
+    body->tail->size += size;
+    body->size       += size;
+}
+
+[[nodiscard]] bool __cdecl body_append(
+    _Inout_ body_t* const restrict body, _In_ const char* const restrict bytes, _In_ const unsigned long size
+) {
+    for (unsigned long copied = 0; copied < size;) {
+        unsigned long available = 0;
+        char* const   at        = body_reserve(body, &available);
+        if (!at) return false; // body_reserve will do the error reporting
+        if (available > size - copied) available = size - copied;
+        memcpy(at, bytes + copied, available);
+        body_commit(body, available);
+        copied += available;
+    }
+    return true;
+}
+
+unsigned long __cdecl body_view(
+    _In_ const body_t* const restrict body, _Inout_ body_slice_t* const restrict slices, _In_ const unsigned long capacity
+) {
+    unsigned long count = 0;
+    for (const body_slab_t* slab = body->head; slab; slab = slab->next, ++count)
+        if (count < capacity) slices[count] = (body_slice_t) { .data = slab->data, .size = (unsigned long) slab->size };
+    return count;
+}
+
+[[nodiscard]] const char* __cdecl body_flatten(_Inout_ body_t* const restrict body) {
+    if (!body->head) return "";
+    if (body->flat) return body->flat;
+    if (body->nslabs == 1 && body->head->size < sizeof(body->head->data)) { // room for the terminator
+        body->head->data[body->head->size] = 0;
+        return body->head->data;
+    }
+
+    body->flat = malloc(body->size + 1LLU);
+    if (!body->flat) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return NULL;
+    }
+    unsigned long offset = 0;
+    for (const body_slab_t* slab = body->head; slab; slab = slab->next) {
+        memcpy(body->flat + offset, slab->data, slab->size);
+        offset += (unsigned long) slab->size;
+    }
+    body->flat[offset] = 0;
+    return body->flat;
+}
+
+void __cdecl body_release(_Inout_ body_t* const restrict body) {
+    body_slab_t* slab = body->head;
+    free(body->flat);
+    *body = (body_t) { 0 };
+
+    body_lock();
+    while (slab && nidle < BODY_POOL_MAX_IDLE) {
+        body_slab_t* const next = slab->next;
+        slab->next              = idle;
+        idle                    = slab;
+        nidle++;
+        slab = next;
+    }
+    body_unlock();
+
+    unsigned long nfreed = 0;
+    for (body_slab_t* next = NULL; slab; slab = next, ++nfreed) { // past what the pool holds on to
+        next = slab->next;
+        unmap_slab(slab);
+    }
+    if (!nfreed) return;
+    body_lock();
+    stats.frees += nfreed;
+    body_unlock();
+}
+
+void __cdecl body_drain(void) {
+    body_lock();
+    body_slab_t* slab = idle;
+    stats.frees      += nidle;
+    idle              = NULL;
+    nidle             = 0;
+    body_unlock();
+
+    for (body_slab_t* next = NULL; slab; slab = next) {
+        next = slab->next;
+        unmap_slab(slab);
+    }
+}
+
+[[nodiscard]] body_stats_t __cdecl body_statistics(void) {
+    body_lock();
+    const body_stats_t snapshot = stats;
+    body_unlock();
+    return snapshot;
+}
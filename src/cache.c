@@ -0,0 +1,113 @@
+#include <project.h>
+
+// an on-disk cache of parsed pages, one file per page. a cache file holds the validators of the response the releases were parsed from and
+// the parsed releases themselves, so when the server answers a conditional request with 304 Not Modified neither the body nor the parse
+// is needed, the releases are read straight back into memory.
+//
+// layout: cache_header_t | span_t versions[count] | span_t downloadurls[count] | uint8_t kinds[count] | text[text_size]
+
+#define CACHE_MAGIC   0x48435243U // "CRCH"
+#define CACHE_VERSION 3U          // 2 replaced the python_t records with the span arrays of results_t, 3 added the artifact kinds
+
+typedef struct _cache_header {
+        uint32_t          magic;      // CACHE_MAGIC
+        uint32_t          version;    // CACHE_VERSION of the build that wrote the file
+        uint32_t          count;      // number of releases
+        uint32_t          text_size;  // number of text bytes following the spans
+        http_validators_t validators; // validators of the cached response
+} cache_header_t;
+
+// FNV-1a over the bytes of the request's target, 64 bits is plenty to keep a handful of pages apart
+static unsigned long long __cdecl hash_target(
+    _In_ const wchar_t* const restrict server, _In_ const unsigned short port, _In_ const wchar_t* const restrict accesspoint
+) {
+    unsigned long long hash    = 0xCBF29CE484222325LLU;
+    const wchar_t*     parts[] = { server, accesspoint };
+
+    for (unsigned long i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+        for (const wchar_t* c = parts[i]; *c; ++c) hash = (hash ^ (unsigned long long) *c) * 0x100000001B3LLU;
+        hash = (hash ^ port) * 0x100000001B3LLU; // separates the server from the accesspoint, "ab" + "c" mustn't hash like "a" + "bc"
+    }
+    return hash;
+}
+
+[[nodiscard]] bool __cdecl cache_path(
+    _In_ const wchar_t* const restrict directory,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _Inout_ wchar_t* const restrict path,
+    _In_ const unsigned long size
+) {
+    return swprintf_s(path, size, L"%scrawl-%016llx.cache", directory, hash_target(server, port, accesspoint)) > 0;
+}
+
+[[nodiscard("entails expensive file io")]] cached_page_t __cdecl cache_load(_In_ const wchar_t* const restrict path) {
+    cached_page_t  page   = { 0 };
+    cache_header_t header = { 0 };
+    unsigned long  size   = 0;
+
+    // a missing file is the common case on a first run, don't let __open complain about it
+    if (GetFileAttributesW(path) == INVALID_FILE_ATTRIBUTES) return page;
+
+    unsigned char* const restrict buffer = __open(path, &size); // __open will do the error reporting
+    if (!buffer) return page;
+
+    if (size < sizeof(cache_header_t)) goto DISCARD;
+    memcpy(&header, buffer, sizeof(cache_header_t));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        size != sizeof(cache_header_t) + (unsigned long long) header.count * RESULTS_RECORD_SIZE + header.text_size)
+        goto DISCARD;
+
+    const span_t* const restrict  spans = (const span_t*) (buffer + sizeof(cache_header_t));
+    const uint8_t* const restrict kinds = (const uint8_t*) (spans + 2 * header.count);
+    for (unsigned long i = 0; i < 2 * header.count; ++i) // never trust offsets read from disk
+        if ((unsigned long long) spans[i].offset + spans[i].length > header.text_size) goto DISCARD;
+    for (unsigned long i = 0; i < header.count; ++i)
+        if (kinds[i] >= ARTIFACT_KINDS) goto DISCARD;
+
+    if (!results_init(&page.results, NULL, header.count)) goto DISCARD; // results_init will do the error reporting
+    memcpy(page.results.versions, spans, header.count * sizeof(span_t));
+    memcpy(page.results.downloadurls, spans + header.count, header.count * sizeof(span_t));
+    memcpy(page.results.kinds, kinds, header.count);
+    page.results.count = header.count;
+
+    // slide the text to the front so the buffer __open allocated becomes the arena, no need for a second allocation
+    memmove(buffer, kinds + header.count, header.text_size);
+    page.results.arena          = (char*) buffer;
+    page.results.arena_size     = header.text_size;
+    page.results.arena_capacity = size;
+    page.results.text           = page.results.arena;
+
+    header.validators.etag[HTTP_VALIDATOR_LENGTH - 1]          = 0;
+    header.validators.last_modified[HTTP_VALIDATOR_LENGTH - 1] = 0;
+    page.validators                                            = header.validators;
+    return page;
+
+DISCARD:
+    fwprintf_s(stderr, L"Warning: ignoring the malformed or outdated cache file %s\n", path);
+    free(buffer);
+    return page;
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl cache_store(
+    _In_ const wchar_t* const restrict path, _In_ const http_validators_t* const restrict validators, _In_ const results_t results
+) {
+    const unsigned long  text_size = results_text_size(results);
+    const unsigned long  size      = sizeof(cache_header_t) + results.count * RESULTS_RECORD_SIZE + text_size;
+    const cache_header_t header
+        = { .magic = CACHE_MAGIC, .version = CACHE_VERSION, .count = results.count, .text_size = text_size, .validators = *validators };
+
+    unsigned char* const restrict buffer = malloc(size);
+    if (!buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    memcpy(buffer, &header, sizeof(cache_header_t));
+    results_serialize(results, buffer + sizeof(cache_header_t));
+
+    const bool is_stored = __serialize(buffer, size, path); // __serialize will do the error reporting
+    free(buffer);
+    return is_stored;
+}
@@ -0,0 +1,299 @@
+#include <project.h>
+
+// incremental MD5 and SHA-256 for verifying downloads as they arrive, see download.c. bytes are buffered up to a 64 byte block and whole blocks
+// are handed to a compression kernel, so digest_update can be fed the transport's chunks as they are, of any size.
+// SHA-256 has a kernel built on the SHA extensions (SHA-NI) which does two rounds per sha256rnds2 and the message schedule with
+// sha256msg1/sha256msg2, several times the speed of the portable kernel, picked at the first call like the scan_pair kernels in simd.c.
+// MD5 is a single dependency chain through its four state words, there's nothing for vector instructions to do on one stream, so it
+// only has the portable kernel
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define __target_sha // MSVC does not need per function target attributes to emit SHA-NI instructions
+#else
+    #include <cpuid.h>
+    #include <immintrin.h>
+    #define __target_sha __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+
+typedef void(__cdecl* compress_kernel_t)(
+    _Inout_ uint32_t* const restrict state, _In_ const unsigned char* restrict blocks, _In_ unsigned long long nblocks
+);
+
+static inline uint32_t __cdecl rotate_left(_In_ const uint32_t value, _In_ const unsigned count) {
+    return (value << count) | (value >> (32 - count));
+}
+
+static inline uint32_t __cdecl rotate_right(_In_ const uint32_t value, _In_ const unsigned count) {
+    return (value >> count) | (value << (32 - count));
+}
+
+static inline uint32_t __cdecl load_le32(_In_ const unsigned char* const restrict bytes) {
+    return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+static inline uint32_t __cdecl load_be32(_In_ const unsigned char* const restrict bytes) {
+    return (uint32_t) bytes[0] << 24 | (uint32_t) bytes[1] << 16 | (uint32_t) bytes[2] << 8 | (uint32_t) bytes[3];
+}
+
+// RFC 1321, sines[i] = floor(abs(sin(i + 1)) * 2^32), shifts[round][i % 4]
+static const uint32_t md5_sines[64] = {
+    0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501, 0x698098D8, 0x8B44F7AF, 0xFFFF5BB1,
+    0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821, 0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453,
+    0xD8A1E681, 0xE7D3FBC8, 0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A, 0xFFFA3942,
+    0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70, 0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05,
+    0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665, 0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D,
+    0x85845DD1, 0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391,
+};
+
+static const unsigned char md5_shifts[4][4] = {
+    { 7, 12, 17, 22 },
+    { 5,  9, 14, 20 },
+    { 4, 11, 16, 23 },
+    { 6, 10, 15, 21 },
+};
+
+static void __cdecl md5_blocks(_Inout_ uint32_t* const restrict state, _In_ const unsigned char* restrict blocks, _In_ unsigned long long nblocks) {
+    for (; nblocks; --nblocks, blocks += 64) {
+        uint32_t words[16] = { 0 };
+        for (unsigned i = 0; i < 16; ++i) words[i] = load_le32(blocks + 4 * i);
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3]; // NOLINT(readability-isolate-declaration)
+        for (unsigned i = 0; i < 64; ++i) {
+            uint32_t mixed = 0;
+            unsigned word  = 0;
+            switch (i / 16) {
+                case 0 : mixed = (b & c) | (~b & d), word = i; break;
+                case 1 : mixed = (d & b) | (~d & c), word = (5 * i + 1) % 16; break;
+                case 2 : mixed = b ^ c ^ d, word = (3 * i + 5) % 16; break;
+                default : mixed = c ^ (b | ~d), word = (7 * i) % 16; break;
+            }
+            const uint32_t rotated = rotate_left(a + mixed + md5_sines[i] + words[word], md5_shifts[i / 16][i % 4]);
+            a                      = d;
+            d                      = c;
+            c                      = b;
+            b                     += rotated;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+}
+
+// FIPS 180-4, the first 32 bits of the fractional parts of the cube roots of the first 64 primes
+static const uint32_t sha256_constants[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE,
+    0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA,
+    0x5CB0A9DC, 0x76F988DA, 0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967, 0x27B70A85,
+    0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85, 0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070, 0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F,
+    0x682E6FF3, 0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+static void __cdecl sha256_blocks_scalar(
+    _Inout_ uint32_t* const restrict state, _In_ const unsigned char* restrict blocks, _In_ unsigned long long nblocks
+) {
+    for (; nblocks; --nblocks, blocks += 64) {
+        uint32_t schedule[64] = { 0 };
+        for (unsigned i = 0; i < 16; ++i) schedule[i] = load_be32(blocks + 4 * i);
+        for (unsigned i = 16; i < 64; ++i) {
+            const uint32_t sigma0 = rotate_right(schedule[i - 15], 7) ^ rotate_right(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+            const uint32_t sigma1 = rotate_right(schedule[i - 2], 17) ^ rotate_right(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+            schedule[i]           = schedule[i - 16] + sigma0 + schedule[i - 7] + sigma1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3]; // NOLINT(readability-isolate-declaration)
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7]; // NOLINT(readability-isolate-declaration)
+        for (unsigned i = 0; i < 64; ++i) {
+            const uint32_t sum1   = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const uint32_t choice = (e & f) ^ (~e & g);
+            const uint32_t first  = h + sum1 + choice + sha256_constants[i] + schedule[i];
+            const uint32_t sum0   = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const uint32_t major  = (a & b) ^ (a & c) ^ (b & c);
+            h                     = g;
+            g                     = f;
+            f                     = e;
+            e                     = d + first;
+            d                     = c;
+            c                     = b;
+            b                     = a;
+            a                     = first + sum0 + major;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+// the SHA extensions keep the state as ABEF and CDGH halves, the state is shuffled into that layout once per call rather than once per block.
+// every iteration of the round loop does four rounds (two sha256rnds2) and, from the fifth on, derives the next four schedule words from the
+// four previous groups held in a ring
+[[maybe_unused]] static __target_sha void __cdecl sha256_blocks_shani(
+    _Inout_ uint32_t* const restrict state, _In_ const unsigned char* restrict blocks, _In_ unsigned long long nblocks
+) {
+    const __m128i byteswap = _mm_set_epi64x(0x0C0D0E0F08090A0BLL, 0x0405060700010203LL);
+
+    const __m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) state), 0xB1);
+    const __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) (state + 4)), 0x1B);
+    __m128i       abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i       cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+    for (; nblocks; --nblocks, blocks += 64) {
+        const __m128i abef_saved  = abef, cdgh_saved = cdgh; // NOLINT(readability-isolate-declaration)
+        __m128i       schedule[4] = { 0 };
+
+        for (unsigned group = 0; group < 16; ++group) {
+            __m128i* const restrict words = schedule + group % 4;
+            if (group < 4)
+                *words = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (blocks + 16 * group)), byteswap);
+            else { // w[t - 16] + sigma0(w[t - 15]) + w[t - 7] + sigma1(w[t - 2])
+                const __m128i previous = schedule[(group + 3) % 4];
+                const __m128i sigma0   = _mm_sha256msg1_epu32(*words, schedule[(group + 1) % 4]);
+                const __m128i seventh  = _mm_alignr_epi8(previous, schedule[(group + 2) % 4], 4);
+                *words                 = _mm_sha256msg2_epu32(_mm_add_epi32(sigma0, seventh), previous);
+            }
+
+            __m128i message = _mm_add_epi32(*words, _mm_loadu_si128((const __m128i*) (sha256_constants + 4 * group)));
+            cdgh            = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            message         = _mm_shuffle_epi32(message, 0x0E);
+            abef            = _mm_sha256rnds2_epu32(abef, cdgh, message);
+        }
+
+        abef = _mm_add_epi32(abef, abef_saved);
+        cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+    }
+
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128((__m128i*) state, _mm_blend_epi16(feba, dchg, 0xF0));     // DCBA
+    _mm_storeu_si128((__m128i*) (state + 4), _mm_alignr_epi8(dchg, feba, 8)); // HGFE
+}
+
+// the SHA extensions are reported in CPUID leaf 7, the shuffles around them need SSSE3 and SSE4.1. none of them touch the YMM registers,
+// so unlike AVX2 there's no OS support to check
+[[maybe_unused]] static bool __cdecl is_shani_usable(void) { // CRAWL_FORCE_SCALAR_DIGEST builds never ask
+#if defined(_MSC_VER) && !defined(__clang__)
+    int registers[4] = { 0 }; // eax, ebx, ecx, edx
+    __cpuid(registers, 0);
+    if (registers[0] < 7) return false;
+    __cpuid(registers, 1);
+    if (!(registers[2] & (1 << 9)) || !(registers[2] & (1 << 19))) return false; // SSSE3, SSE4.1
+    __cpuidex(registers, 7, 0);
+    return registers[1] & (1 << 29); // NOLINT(readability-implicit-bool-conversion)
+#else
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0; // NOLINT(readability-isolate-declaration)
+    if (__get_cpuid_max(0, NULL) < 7) return false;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return ebx & bit_SHA; // NOLINT(readability-implicit-bool-conversion)
+#endif
+}
+
+// CRAWL_FORCE_SCALAR_DIGEST exists to cross-check the SHA-NI kernel against the portable one
+static compress_kernel_t __cdecl select_sha256_kernel(void) {
+#ifdef CRAWL_FORCE_SCALAR_DIGEST
+    return sha256_blocks_scalar;
+#else
+    return is_shani_usable() ? sha256_blocks_shani : sha256_blocks_scalar;
+#endif
+}
+
+// resolved on the first call, racing threads will all store the same pointer so there's no need for synchronization here
+static compress_kernel_t sha256_kernel = NULL;
+
+static void __cdecl compress(
+    _Inout_ digest_t* const restrict digest, _In_ const unsigned char* const restrict blocks, _In_ const unsigned long long nblocks
+) {
+    if (digest->kind == DIGEST_MD5) {
+        md5_blocks(digest->state, blocks, nblocks);
+        return;
+    }
+    if (!sha256_kernel) [[unlikely]]
+        sha256_kernel = select_sha256_kernel();
+    sha256_kernel(digest->state, blocks, nblocks);
+}
+
+void __cdecl digest_init(_Inout_ digest_t* const restrict digest, _In_ const digest_kind_t kind) {
+    static const uint32_t md5_initial[4]    = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+    static const uint32_t sha256_initial[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+    memset(digest, 0, sizeof(digest_t));
+    digest->kind = kind;
+    if (kind == DIGEST_MD5) memcpy(digest->state, md5_initial, sizeof(md5_initial));
+    else if (kind == DIGEST_SHA256) memcpy(digest->state, sha256_initial, sizeof(sha256_initial));
+}
+
+void __cdecl digest_update(_Inout_ digest_t* const restrict digest, _In_ const void* const restrict bytes, _In_ const unsigned long long size) {
+    const unsigned char* restrict next      = bytes;
+    unsigned long long            remaining = size;
+    const unsigned long           buffered  = (unsigned long) (digest->length % 64);
+    digest->length                         += size;
+
+    if (buffered) { // top up the partial block first
+        const unsigned long take = remaining < 64 - buffered ? (unsigned long) remaining : 64 - buffered;
+        memcpy(digest->block + buffered, next, take);
+        next      += take;
+        remaining -= take;
+        if (buffered + take < 64) return;
+        compress(digest, digest->block, 1);
+    }
+
+    // whole blocks straight from the caller's bytes, no copy
+    if (remaining >= 64) compress(digest, next, remaining / 64);
+    memcpy(digest->block, next + remaining / 64 * 64, remaining % 64);
+}
+
+unsigned long __cdecl digest_final(_Inout_ digest_t* const restrict digest, _Inout_ unsigned char* const restrict value) {
+    const uint64_t bits     = digest->length * 8;
+    unsigned long  buffered = (unsigned long) (digest->length % 64);
+
+    // a 1 bit, zeroes up to 56 bytes into a block, then the message length in bits, little endian for MD5 and big endian for SHA-256
+    digest->block[buffered++] = 0x80;
+    if (buffered > 56) {
+        memset(digest->block + buffered, 0, 64 - buffered);
+        compress(digest, digest->block, 1);
+        buffered = 0;
+    }
+    memset(digest->block + buffered, 0, 56 - buffered);
+    for (unsigned i = 0; i < 8; ++i) digest->block[56 + i] = (unsigned char) (bits >> (digest->kind == DIGEST_MD5 ? 8 * i : 56 - 8 * i));
+    compress(digest, digest->block, 1);
+
+    const unsigned long nwords = digest->kind == DIGEST_MD5 ? 4 : 8;
+    for (unsigned long i = 0; i < nwords; ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            value[4 * i + j] = (unsigned char) (digest->state[i] >> (digest->kind == DIGEST_MD5 ? 8 * j : 24 - 8 * j));
+    return 4 * nwords;
+}
+
+[[nodiscard]] bool __cdecl digest_parse(
+    _In_ const char* const restrict hex, _In_ const unsigned long length, _Inout_ digest_value_t* const restrict value
+) {
+    memset(value, 0, sizeof(digest_value_t));
+    if (length != 2 * DIGEST_MD5_SIZE && length != 2 * DIGEST_SHA256_SIZE) return false;
+
+    for (unsigned long i = 0; i < length; ++i) {
+        const char    character = hex[i];
+        unsigned char nibble    = 0;
+        if (character >= '0' && character <= '9') nibble = (unsigned char) (character - '0');
+        else if (character >= 'a' && character <= 'f') nibble = (unsigned char) (character - 'a' + 10);
+        else if (character >= 'A' && character <= 'F') nibble = (unsigned char) (character - 'A' + 10);
+        else return false;
+        value->bytes[i / 2] |= (unsigned char) (i % 2 ? nibble : nibble << 4);
+    }
+
+    value->kind = length == 2 * DIGEST_MD5_SIZE ? DIGEST_MD5 : DIGEST_SHA256;
+    return true;
+}
+
+[[nodiscard]] const wchar_t* __cdecl digest_name(_In_ const digest_kind_t kind) {
+    return kind == DIGEST_MD5 ? L"MD5" : kind == DIGEST_SHA256 ? L"SHA-256" : L"none";
+}
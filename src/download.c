@@ -0,0 +1,618 @@
+#include <project.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// --download, fetching the installers a query picked instead of handing their URLs to another tool. a file is cut into segments of at
+// least DOWNLOAD_MIN_SEGMENT bytes which the workers, one per connection, claim one at a time and fetch with HTTP Range requests. what
+// arrives is written straight to its place in <file>.part, preallocated to the full size, with positional writes, so nothing is buffered
+// beyond the transport's chunk and nothing is stitched together afterwards. a slow connection only holds up the segment it's on, the
+// other workers claim the rest. how far every segment got is written to <file>.segments as the bytes land, so an interrupted download
+// picks up where it stopped provided the server still has the same file: same size and same validators, and the requests carry If-Range
+// so a file that changed mid-download comes back whole rather than as a range of the new copy. a server that ignores ranges answers the
+// first request with the whole file, which is then written out as a single stream. .part becomes the file once every segment is complete.
+// files with a published checksum are hashed as they arrive rather than read back once they're complete: a single stream hashes every chunk
+// it receives, segments that land out of order are hashed once the bytes before them are in, from a mapping of .part whose pages they were
+// just written to. only a download that resumes reads the bytes of the earlier attempt back
+
+#define DOWNLOAD_STATE_MAGIC 0x4C445243U // "CRDL"
+
+// the header of a .segments file, followed by nsegments uint64_t (little endian), the bytes of each segment that are on disk. segment i
+// covers [size * i / nsegments, size * (i + 1) / nsegments) of the file
+typedef struct _download_state {
+        uint32_t          magic;      // DOWNLOAD_STATE_MAGIC
+        uint32_t          nsegments;  // segments the file is cut into, at most DOWNLOAD_MAX_SEGMENTS
+        uint64_t          size;       // size of the whole file
+        http_validators_t validators; // validators of the server's copy, resuming against a copy without any isn't safe
+} download_state_t;
+
+static_assert(sizeof(download_state_t) == 16 + 2 * HTTP_VALIDATOR_LENGTH, "the segment state header is part of the file format");
+
+#ifdef _WIN32
+typedef HANDLE file_t;
+    #define INVALID_FILE INVALID_HANDLE_VALUE
+
+static SRWLOCK lock = SRWLOCK_INIT;
+    #define download_lock()   AcquireSRWLockExclusive(&lock)
+    #define download_unlock() ReleaseSRWLockExclusive(&lock)
+
+// opens the file for positional reads and writes, creating it when it doesn't exist and keeping what it holds when it does
+static file_t __cdecl open_file(_In_ const wchar_t* const restrict path) {
+    const file_t file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_FILE) fwprintf_s(stderr, L"Error %lu in CreateFileW(%s).\n", GetLastError(), path);
+    return file;
+}
+
+// an OVERLAPPED with an offset makes a synchronous handle read and write there without touching the file pointer, which is shared by
+// every thread using the handle
+static bool __cdecl write_at(
+    _In_ const file_t file, _In_ const uint64_t offset, _In_ const void* const restrict bytes, _In_ const unsigned long size
+) {
+    OVERLAPPED    overlapped = { .Offset = (DWORD) offset, .OffsetHigh = (DWORD) (offset >> 32) };
+    unsigned long written    = 0;
+    if (WriteFile(file, bytes, size, &written, &overlapped) && written == size) return true;
+    fwprintf_s(stderr, L"Error %lu in WriteFile.\n", GetLastError());
+    return false;
+}
+
+static bool __cdecl read_at(
+    _In_ const file_t file, _In_ const uint64_t offset, _Inout_ void* const restrict bytes, _In_ const unsigned long size
+) {
+    OVERLAPPED    overlapped = { .Offset = (DWORD) offset, .OffsetHigh = (DWORD) (offset >> 32) };
+    unsigned long read       = 0;
+    return ReadFile(file, bytes, size, &read, &overlapped) && read == size; // a short read is a fresh or a truncated file, not an error
+}
+
+static bool __cdecl resize_file(_In_ const file_t file, _In_ const uint64_t size) {
+    const LARGE_INTEGER end = { .QuadPart = (long long) size };
+    if (SetFilePointerEx(file, end, NULL, FILE_BEGIN) && SetEndOfFile(file)) return true;
+    fwprintf_s(stderr, L"Error %lu in SetEndOfFile.\n", GetLastError());
+    return false;
+}
+
+static uint64_t __cdecl file_size(_In_ const file_t file) {
+    LARGE_INTEGER size = { 0 };
+    return GetFileSizeEx(file, &size) ? (uint64_t) size.QuadPart : 0;
+}
+
+static void __cdecl close_file(_In_ const file_t file) { CloseHandle(file); }
+
+// a read-only view of the whole file, which keeps its mapping object alive on its own
+static const unsigned char* __cdecl map_file(_In_ const file_t file, _In_ const uint64_t size) {
+    const HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, (DWORD) (size >> 32), (DWORD) size, NULL);
+    if (!mapping) {
+        fwprintf_s(stderr, L"Error %lu in CreateFileMappingW.\n", GetLastError());
+        return NULL;
+    }
+    const unsigned char* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) fwprintf_s(stderr, L"Error %lu in MapViewOfFile.\n", GetLastError());
+    CloseHandle(mapping);
+    return view;
+}
+
+static void __cdecl unmap_file(_In_ const unsigned char* const restrict view, _In_ const uint64_t size) {
+    (void) size;
+    UnmapViewOfFile(view);
+}
+
+static void __cdecl remove_file(_In_ const wchar_t* const restrict path) { DeleteFileW(path); }
+
+static bool __cdecl rename_file(_In_ const wchar_t* const restrict from, _In_ const wchar_t* const restrict to) {
+    if (MoveFileExW(from, to, MOVEFILE_REPLACE_EXISTING)) return true;
+    fwprintf_s(stderr, L"Error %lu in MoveFileExW(%s).\n", GetLastError(), to);
+    return false;
+}
+#else
+    #include <sys/mman.h>
+
+typedef int file_t;
+    #define INVALID_FILE (-1)
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    #define download_lock()   pthread_mutex_lock(&lock)
+    #define download_unlock() pthread_mutex_unlock(&lock)
+
+static bool __cdecl narrow_path(_In_ const wchar_t* const restrict path, _Inout_ char* const restrict buffer) {
+    if (wcstombs(buffer, path, MAX_PATH * 4) < MAX_PATH * 4) return true;
+    fwprintf_s(stderr, L"Error: %s is not a valid path!\n", path);
+    return false;
+}
+
+static file_t __cdecl open_file(_In_ const wchar_t* const restrict path) {
+    char narrowed[MAX_PATH * 4] = { 0 };
+    if (!narrow_path(path, narrowed)) return INVALID_FILE;
+    const file_t file = open(narrowed, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file == INVALID_FILE) fwprintf_s(stderr, L"Error %d in open(%s).\n", errno, path);
+    return file;
+}
+
+static bool __cdecl write_at(
+    _In_ const file_t file, _In_ const uint64_t offset, _In_ const void* const restrict bytes, _In_ const unsigned long size
+) {
+    for (unsigned long written = 0; written < size;) {
+        const ssize_t count = pwrite(file, (const char*) bytes + written, size - written, (off_t) (offset + written));
+        if (count <= 0) {
+            fwprintf_s(stderr, L"Error %d in pwrite.\n", errno);
+            return false;
+        }
+        written += (unsigned long) count;
+    }
+    return true;
+}
+
+static bool __cdecl read_at(
+    _In_ const file_t file, _In_ const uint64_t offset, _Inout_ void* const restrict bytes, _In_ const unsigned long size
+) {
+    return pread(file, bytes, size, (off_t) offset) == (ssize_t) size; // a short read is a fresh or a truncated file, not an error
+}
+
+static bool __cdecl resize_file(_In_ const file_t file, _In_ const uint64_t size) {
+    if (!ftruncate(file, (off_t) size)) return true;
+    fwprintf_s(stderr, L"Error %d in ftruncate.\n", errno);
+    return false;
+}
+
+static uint64_t __cdecl file_size(_In_ const file_t file) {
+    struct stat status = { 0 };
+    return fstat(file, &status) ? 0 : (uint64_t) status.st_size;
+}
+
+static void __cdecl close_file(_In_ const file_t file) { close(file); }
+
+static const unsigned char* __cdecl map_file(_In_ const file_t file, _In_ const uint64_t size) {
+    const void* const view = mmap(NULL, (size_t) size, PROT_READ, MAP_SHARED, file, 0);
+    if (view != MAP_FAILED) return view;
+    fwprintf_s(stderr, L"Error %d in mmap.\n", errno);
+    return NULL;
+}
+
+static void __cdecl unmap_file(_In_ const unsigned char* const restrict view, _In_ const uint64_t size) {
+    munmap((void*) view, (size_t) size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+
+static void __cdecl remove_file(_In_ const wchar_t* const restrict path) {
+    char narrowed[MAX_PATH * 4] = { 0 };
+    if (narrow_path(path, narrowed)) unlink(narrowed);
+}
+
+static bool __cdecl rename_file(_In_ const wchar_t* const restrict from, _In_ const wchar_t* const restrict to) {
+    char narrowed_from[MAX_PATH * 4] = { 0 }, narrowed_to[MAX_PATH * 4] = { 0 }; // NOLINT(readability-isolate-declaration)
+    if (!narrow_path(from, narrowed_from) || !narrow_path(to, narrowed_to)) return false;
+    if (!rename(narrowed_from, narrowed_to)) return true;
+    fwprintf_s(stderr, L"Error %d in rename(%s).\n", errno, to);
+    return false;
+}
+#endif
+
+// a file being downloaded, shared by the workers
+typedef struct _download {
+        const http_transport_t* transport;
+        const wchar_t*          server;
+        unsigned short          port;
+        const wchar_t*          accesspoint;
+        file_t                  file;                        // the .part file
+        file_t                  state;                       // the .segments file
+        download_state_t        header;                      // what the .segments file starts with
+        uint64_t                done[DOWNLOAD_MAX_SEGMENTS]; // bytes of every segment on disk, only the worker on a segment touches its count
+        unsigned long           next;                        // the first segment no worker has claimed yet, under the lock
+        bool                    is_failed;                   // set under the lock by the first worker that gives up, the others stop
+        digest_t*               digest;                      // the checksum of the bytes up to hashed, NULL when there's none to verify
+        const unsigned char*    view;                        // read-only mapping of the .part file the segments are hashed from
+        uint64_t                hashed;                      // the bytes before it went into the checksum, only touched by the hasher
+        unsigned long           hashed_segment;              // the segment hashed is in, only touched by the hasher
+        bool                    is_hashing;                  // a worker is hashing, the others leave the bytes they wrote to it
+} download_t;
+
+// where the bytes of a response go
+typedef struct _segment_sink {
+        download_t*           download;
+        const http_request_t* request;    // the response's status tells whether the bytes are the range that was asked for
+        unsigned long         segment;    // the segment the range is the rest of, DOWNLOAD_MAX_SEGMENTS for a single stream
+        uint64_t              offset;     // where the next byte goes in the file
+        uint64_t              end;        // one past the last byte the response may carry
+        uint64_t              checkpoint; // offset of the last progress written to the .segments file
+} segment_sink_t;
+
+static inline uint64_t __cdecl segment_begin(_In_ const download_t* const restrict download, _In_ const unsigned long segment) {
+    return download->header.size * segment / download->header.nsegments;
+}
+
+static bool __cdecl save_progress(_Inout_ segment_sink_t* const restrict sink) {
+    download_t* const restrict download = sink->download;
+    sink->checkpoint                    = sink->offset;
+    const uint64_t position             = sizeof(download_state_t) + sizeof(uint64_t) * sink->segment;
+    return write_at(download->state, position, &download->done[sink->segment], sizeof(uint64_t)); // write_at will do the error reporting
+}
+
+// hashes what landed past the checksum's frontier without a gap. only a single worker hashes at a time, the one whose bytes found nobody
+// hashing, and it keeps at it while the others carry on writing, until it catches up with the first segment that's still missing bytes
+static void __cdecl hash_landed(_Inout_ download_t* const restrict download) {
+    for (;;) {
+        download_lock();
+        const uint64_t begin   = download->hashed;
+        unsigned long  segment = download->hashed_segment;
+        uint64_t       end     = begin;
+        for (; segment < download->header.nsegments; ++segment) {
+            end = segment_begin(download, segment) + download->done[segment];
+            if (end < segment_begin(download, segment + 1)) break;
+        }
+        download->is_hashing = end > begin;
+        download_unlock();
+        if (end == begin) return;
+
+        digest_update(download->digest, download->view + begin, end - begin);
+        download->hashed         = end;
+        download->hashed_segment = segment;
+    }
+}
+
+// writes a piece of a segment in place. the bytes of a whole response (HTTP_STATUS_OK) to a ranged request, which is how a server whose
+// copy changed since answers If-Range, or past the end of the range are refused, which aborts the transfer
+static bool __cdecl segment_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    segment_sink_t* const restrict sink = context;
+    if (sink->request->status != HTTP_STATUS_PARTIAL_CONTENT || size > sink->end - sink->offset) return false;
+    if (!write_at(sink->download->file, sink->offset, chunk, size)) return false; // write_at will do the error reporting
+
+    download_t* const restrict download = sink->download;
+    sink->offset                       += size;
+
+    download_lock(); // the hasher reads the counts of every segment
+    download->done[sink->segment] += size;
+    const bool is_hasher           = download->digest && !download->is_hashing;
+    download->is_hashing          |= is_hasher;
+    download_unlock();
+    if (is_hasher) hash_landed(download);
+
+    if (sink->offset - sink->checkpoint >= DOWNLOAD_CHECKPOINT_SIZE) return save_progress(sink);
+    return true;
+}
+
+// sink of the first request, a single byte to learn the size of the file and whether the server does ranges at all. a server that doesn't
+// answers with the whole file, which is written out from the start as it arrives
+static bool __cdecl probe_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    segment_sink_t* const restrict sink = context;
+    if (sink->request->status == HTTP_STATUS_PARTIAL_CONTENT) return true; // the byte comes again with the first segment
+    if (!write_at(sink->download->file, sink->offset, chunk, size)) return false; // write_at will do the error reporting
+    if (sink->download->digest) digest_update(sink->download->digest, chunk, size);
+    sink->offset += size;
+    return true;
+}
+
+// fetches what's missing of a segment, retrying a dropped connection as long as the retries make progress
+static bool __cdecl fetch_segment(_Inout_ download_t* const restrict download, _In_ const unsigned long segment) {
+    const uint64_t     first = segment_begin(download, segment) + download->done[segment]; // where the last attempt stopped
+    const uint64_t     end   = segment_begin(download, segment + 1);
+    const trace_span_t span  = trace_begin("segment", "download");
+    unsigned long      size  = 0, failures = 0; // NOLINT(readability-isolate-declaration)
+    segment_sink_t     sink  = { .download = download, .segment = segment, .offset = first, .end = end, .checkpoint = first };
+
+    while (sink.offset < end && failures < DOWNLOAD_MAX_RETRIES) {
+        const uint64_t begin   = sink.offset;
+        http_request_t request = transport_get_range(
+            download->transport, download->server, download->port, download->accesspoint, begin, end, &download->header.validators
+        );
+        sink.request = &request;
+        (void) transport_read(&request, segment_sink, &sink, &size); // the offset tells how far it got, transport_read reports the errors
+
+        if (request.status == HTTP_STATUS_OK) {
+            fwprintf_s(stderr, L"Error: %s changed on the server while it was being downloaded, start over!\n", download->accesspoint);
+            break;
+        }
+        failures = sink.offset > begin ? 0 : failures + 1;
+    }
+
+    const bool is_saved = sink.offset == sink.checkpoint || save_progress(&sink); // save_progress will do the error reporting
+    trace_end(span, sink.offset - first, 0);
+    return sink.offset == end && is_saved;
+}
+
+// claims segments until there are none left or some worker gave up
+static bool __cdecl download_worker(_Inout_opt_ void* const argument) {
+    download_t* const restrict download = argument;
+
+    for (;;) {
+        download_lock();
+        while (download->next < download->header.nsegments
+               && download->done[download->next] == segment_begin(download, download->next + 1) - segment_begin(download, download->next))
+            download->next++; // complete before the download was interrupted
+        const bool          is_over = download->is_failed || download->next == download->header.nsegments;
+        const bool          is_ok   = !download->is_failed;
+        const unsigned long segment = download->next;
+        if (!is_over) download->next++;
+        download_unlock();
+        if (is_over) return is_ok;
+
+        if (!fetch_segment(download, segment)) {
+            download_lock();
+            download->is_failed = true;
+            download_unlock();
+            return false;
+        }
+    }
+}
+
+// loads the progress of an earlier download when the .segments file is about this very copy of the file, which it can only be if the server
+// sent validators. the .part file must still be there with its full size too, the progress is about what's in it
+static bool __cdecl resume_state(
+    _Inout_ download_t* const restrict download, _In_ const uint64_t size, _In_ const http_validators_t* const restrict validators
+) {
+    download_state_t stored = { 0 };
+
+    if (!*validators->etag && !*validators->last_modified) return false;
+    if (file_size(download->file) != size || !read_at(download->state, 0, &stored, sizeof(stored))) return false;
+    if (stored.magic != DOWNLOAD_STATE_MAGIC || stored.size != size || !stored.nsegments || stored.nsegments > DOWNLOAD_MAX_SEGMENTS) return false;
+    if (memcmp(&stored.validators, validators, sizeof(http_validators_t))) return false;
+    if (!read_at(download->state, sizeof(stored), download->done, sizeof(uint64_t) * stored.nsegments)) return false;
+
+    download->header = stored;
+    for (unsigned long i = 0; i < stored.nsegments; ++i) // a count past the end of its segment means the file is damaged
+        if (download->done[i] > segment_begin(download, i + 1) - segment_begin(download, i)) download->done[i] = 0;
+    dbgwprintf_s(L"resuming %s from its %lu segments on disk\n", download->accesspoint, (unsigned long) stored.nsegments);
+    return true;
+}
+
+// picks up the progress of an interrupted download of the same copy of the file, or starts afresh with the file preallocated
+static bool __cdecl load_state(
+    _Inout_ download_t* const restrict download, _In_ const uint64_t size, _In_ const http_validators_t* const restrict validators
+) {
+    if (resume_state(download, size, validators)) return true;
+
+    const uint64_t segments  = (size + DOWNLOAD_MIN_SEGMENT - 1) / DOWNLOAD_MIN_SEGMENT;
+    const uint32_t nsegments = (uint32_t) (segments < DOWNLOAD_MAX_SEGMENTS ? segments : DOWNLOAD_MAX_SEGMENTS);
+    download->header = (download_state_t) { .magic = DOWNLOAD_STATE_MAGIC, .nsegments = nsegments, .size = size, .validators = *validators };
+    memset(download->done, 0, sizeof(download->done));
+
+    // the file gets its full size before any segment is written, so that the segments land in place rather than growing the file.
+    // resize_file and write_at will do the error reporting
+    return resize_file(download->state, 0) && resize_file(download->file, size)
+        && write_at(download->state, 0, &download->header, sizeof(download_state_t))
+        && write_at(download->state, sizeof(download_state_t), download->done, sizeof(uint64_t) * download->header.nsegments);
+}
+
+// compares the checksum of everything that was downloaded against the published one, a pass or fail line per file
+static bool __cdecl verify_download(
+    _Inout_ digest_t* const restrict digest, _In_ const digest_value_t* const restrict expected, _In_ const wchar_t* const restrict path
+) {
+    unsigned char       value[DIGEST_SHA256_SIZE] = { 0 };
+    const unsigned long size                      = digest_final(digest, value);
+    if (!memcmp(value, expected->bytes, size)) {
+        fwprintf_s(stderr, L"%s: %s checksum verified\n", path, digest_name(expected->kind));
+        return true;
+    }
+    fwprintf_s(stderr, L"Error: the download of %s does not match its published %s checksum and was discarded!\n", path, digest_name(expected->kind));
+    return false;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl download_file(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const wchar_t* const restrict path,
+    _In_ const unsigned long connections,
+    _In_opt_ const digest_value_t* const restrict expected
+) {
+    wchar_t        part[MAX_PATH] = { 0 }, state[MAX_PATH] = { 0 }; // NOLINT(readability-isolate-declaration)
+    download_t     download       = { .transport = transport, .server = server, .port = port, .accesspoint = accesspoint, .state = INVALID_FILE };
+    task_t         workers[DOWNLOAD_MAX_CONNECTIONS];
+    digest_t       digest         = { 0 };
+    unsigned long  nworkers       = 0;
+    unsigned long  size           = 0;
+    bool           is_complete    = false;
+    segment_sink_t probe          = { .download = &download, .segment = DOWNLOAD_MAX_SEGMENTS };
+    trace_span_t   span           = trace_begin("download", "download");
+
+    if (expected) {
+        digest_init(&digest, expected->kind);
+        download.digest = &digest;
+    }
+
+    if (swprintf_s(part, MAX_PATH, L"%s.part", path) < 0 || swprintf_s(state, MAX_PATH, L"%s.segments", path) < 0) {
+        fwprintf_s(stderr, L"Error: %s is too long a path!\n", path);
+        return false;
+    }
+    download.file = open_file(part); // open_file will do the error reporting
+    if (download.file == INVALID_FILE) return false;
+    download.state = open_file(state);
+    if (download.state == INVALID_FILE) goto PREMATURE_RETURN;
+
+    http_request_t request = transport_get_range(transport, server, port, accesspoint, 0, 1, NULL);
+    probe.request          = &request;
+    if (!transport_read(&request, probe_sink, &probe, &size)) goto PREMATURE_RETURN; // transport_read will do the error reporting
+
+    if (request.status == HTTP_STATUS_PARTIAL_CONTENT && !request.total_size) { // a range of a file of unknown size, no way to cut that up
+        request       = transport_get(transport, server, port, accesspoint);
+        probe.request = &request;
+        if (!transport_read(&request, probe_sink, &probe, &size)) goto PREMATURE_RETURN;
+    }
+
+    if (request.status != HTTP_STATUS_PARTIAL_CONTENT) { // the whole file came with the probe, if the server said so
+        if (request.status != HTTP_STATUS_OK) {
+            fwprintf_s(stderr, L"Error: the server answered the request for %s with HTTP status %u!\n", accesspoint, request.status);
+            goto PREMATURE_RETURN;
+        }
+        dbgwprintf_s(L"the server doesn't do ranges, %s was downloaded over a single connection\n", accesspoint);
+        is_complete = resize_file(download.file, probe.offset); // a copy from an earlier attempt may be longer
+        if (is_complete) fwprintf_s(stderr, L"%s: %llu bytes over a single connection\n", path, probe.offset);
+        goto PREMATURE_RETURN;
+    }
+
+    if (!load_state(&download, request.total_size, &request.validators)) goto PREMATURE_RETURN; // load_state will do the error reporting
+    if (expected && !(download.view = map_file(download.file, download.header.size))) goto PREMATURE_RETURN; // map_file will do the error reporting
+
+    nworkers = connections < download.header.nsegments ? connections : download.header.nsegments;
+    if (nworkers > DOWNLOAD_MAX_CONNECTIONS) nworkers = DOWNLOAD_MAX_CONNECTIONS;
+    if (!nworkers) nworkers = 1;
+    for (unsigned long i = 0; i < nworkers; ++i) task_start(workers + i, download_worker, &download);
+    is_complete = true;
+    for (unsigned long i = 0; i < nworkers; ++i) is_complete &= task_wait(workers + i);
+    if (is_complete && expected) hash_landed(&download); // segments that were complete before a resume never went through a sink
+    if (is_complete) fwprintf_s(stderr, L"%s: %llu bytes over %lu connection%s\n", path, download.header.size, nworkers, nworkers == 1 ? L"" : L"s");
+
+PREMATURE_RETURN:
+    if (download.view) unmap_file(download.view, download.header.size);
+    close_file(download.file);
+    if (download.state != INVALID_FILE) close_file(download.state);
+    if (is_complete && expected && !verify_download(&digest, expected, path)) { // nothing of it can be trusted, so there's nothing to resume
+        remove_file(part);
+        remove_file(state);
+        is_complete = false;
+    } else if (is_complete) {
+        remove_file(state);
+        is_complete = rename_file(part, path); // rename_file will do the error reporting
+    }
+    trace_end(span, is_complete ? (download.header.size ? download.header.size : probe.offset) : 0, 0);
+    return is_complete;
+}
+
+// splits http[s]://host[:port]/path into what the transports take. https URLs go to port 80 like the page itself does, WinHttp follows
+// python.org's redirect to https on its own. the socket transport doesn't do TLS, it only gets anywhere with plain http mirrors
+static bool __cdecl split_url(
+    _In_ const char* const restrict url,
+    _In_ const unsigned long length,
+    _Inout_ wchar_t* const restrict server,
+    _Inout_ unsigned short* const restrict port,
+    _Inout_ wchar_t* const restrict accesspoint,
+    _Inout_ const wchar_t** const restrict filename
+) {
+    unsigned long i = length >= 7 && !memcmp(url, "http://", 7) ? 7 : length >= 8 && !memcmp(url, "https://", 8) ? 8 : 0;
+    unsigned long j = 0;
+    if (!i) return false;
+
+    for (; i < length && url[i] != '/' && url[i] != ':'; ++i) {
+        if (j == BUFF_SIZE - 1) return false;
+        server[j++] = (wchar_t) (unsigned char) url[i];
+    }
+    server[j] = L'\0';
+    *port     = INTERNET_DEFAULT_HTTP_PORT;
+    if (i < length && url[i] == ':') {
+        unsigned long number = 0;
+        for (++i; i < length && url[i] >= '0' && url[i] <= '9'; ++i) number = number * 10 + (unsigned long) (url[i] - '0');
+        if (!number || number > 0xFFFF) return false;
+        *port = (unsigned short) number;
+    }
+
+    *filename = NULL;
+    for (j = 0; i < length; ++i) {
+        if (j == HTTP_HEADER_LINE_LENGTH / 2 - 1) return false;
+        accesspoint[j++] = (wchar_t) (unsigned char) url[i];
+        if (url[i] == '/') *filename = accesspoint + j;
+    }
+    accesspoint[j] = L'\0';
+    return *server && *filename && **filename;
+}
+
+// the files of a release with their checksums, from its page on the server the files are on
+typedef struct _release_page {
+        body_t         body;    // the response, in pooled slabs
+        const char*    html;    // the page as one run of bytes, see body_flatten. NULL when it couldn't be fetched
+        span_t         version; // into the releases' text, the release the page is about
+        release_file_t files[RELEASE_MAX_FILES];
+        unsigned long  count;
+} release_page_t;
+
+// fetches /downloads/release/python-3130/ for 3.13.0, unless the page at hand already is the one of the release
+static void __cdecl load_release_page(
+    _Inout_ release_page_t* const restrict page,
+    _In_ const download_options_t* const restrict options,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const char* const restrict text,
+    _In_ const span_t version
+) {
+    wchar_t       accesspoint[BUFF_SIZE] = L"/downloads/release/python-";
+    unsigned long length                 = (unsigned long) wcslen(accesspoint);
+
+    if (page->html && page->version.length == version.length && !memcmp(text + page->version.offset, text + version.offset, version.length))
+        return;
+    body_release(&page->body);
+    *page = (release_page_t) { .html = NULL, .version = version, .count = 0 };
+
+    for (unsigned long i = 0; i < version.length && length < BUFF_SIZE - 2; ++i)
+        if (text[version.offset + i] != '.') accesspoint[length++] = (wchar_t) (unsigned char) text[version.offset + i];
+    accesspoint[length++] = L'/';
+    accesspoint[length]   = L'\0';
+
+    http_request_t request = transport_get(options->transport, server, port, accesspoint);
+    if (transport_read_ex(&request, &page->body)) page->html = body_flatten(&page->body); // both will do the error reporting
+    page->count = parse_release_files(page->html, page->body.size, page->files, RELEASE_MAX_FILES);
+    dbgwprintf_s(L"%s lists %lu files with checksums\n", accesspoint, page->count);
+}
+
+// the path of an absolute URL, /ftp/python/3.13.0/python-3.13.0-amd64.exe, which is what a mirror has in common with python.org
+static span_t __cdecl url_path(_In_ const char* const restrict url, _In_ const unsigned long length) {
+    for (unsigned long i = 0; i + 3 < length; ++i) {
+        if (memcmp(url + i, "://", 3)) continue;
+        const char* const path = memchr(url + i + 3, '/', length - i - 3);
+        return path ? (span_t) { .offset = (uint32_t) (path - url), .length = (uint32_t) (url + length - path) } : (span_t) { 0 };
+    }
+    return (span_t) { 0 };
+}
+
+// the published checksum of the file behind url, false when its release page doesn't list one
+static bool __cdecl find_checksum(
+    _In_ const release_page_t* const restrict page,
+    _In_ const char* const restrict url,
+    _In_ const unsigned long length,
+    _Inout_ digest_value_t* const restrict expected
+) {
+    const span_t path = url_path(url, length);
+    if (!path.length) return false;
+
+    for (unsigned long i = 0; i < page->count; ++i) {
+        const release_file_t file   = page->files[i];
+        const span_t         listed = url_path(page->html + file.url.offset, file.url.length);
+        if (listed.length == path.length && !memcmp(page->html + file.url.offset + listed.offset, url + path.offset, path.length))
+            return digest_parse(page->html + file.digest.offset, file.digest.length, expected);
+    }
+    return false;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl download_releases(
+    _In_ const results_t releases, _In_ const download_options_t* const restrict options
+) {
+    bool            is_downloaded = true;
+    release_page_t* page          = calloc(1, sizeof(release_page_t));
+    if (!page) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    for (unsigned long i = 0; i < releases.count; ++i) {
+        const span_t   url                                      = releases.downloadurls[i];
+        wchar_t        server[BUFF_SIZE]                        = { 0 };
+        wchar_t        accesspoint[HTTP_HEADER_LINE_LENGTH / 2] = { 0 };
+        wchar_t        path[MAX_PATH]                           = { 0 };
+        const wchar_t* filename                                 = NULL;
+        unsigned short port                                     = 0;
+        digest_value_t expected                                 = { 0 };
+
+        if (!split_url(releases.text + url.offset, url.length, server, &port, accesspoint, &filename)) {
+            fwprintf_s(stderr, L"Error: %.*S is not a URL crawl can download!\n", (int) url.length, releases.text + url.offset);
+            is_downloaded = false;
+            continue;
+        }
+        if (swprintf_s(path, MAX_PATH, L"%s%s", options->directory, filename) < 0) {
+            fwprintf_s(stderr, L"Error: the path of %s is too long!\n", filename);
+            is_downloaded = false;
+            continue;
+        }
+
+        // the releases come sorted by version out of select_releases, so a page is fetched once for all the files of its release
+        load_release_page(page, options, server, port, releases.text, releases.versions[i]);
+        const bool is_published = find_checksum(page, releases.text + url.offset, url.length, &expected);
+        if (!is_published) fwprintf_s(stderr, L"Warning: there is no published checksum for %s, it can't be verified!\n", filename);
+
+        // download_file will do the error reporting
+        is_downloaded &= download_file(options->transport, server, port, accesspoint, path, options->connections, is_published ? &expected : NULL);
+    }
+
+    body_release(&page->body);
+    free(page);
+    return is_downloaded;
+}
@@ -0,0 +1,506 @@
+#include <project.h>
+
+// --ftp, an index of every release artifact under /ftp/python/ rather than the ones the downloads page links to. the tree is walked by
+// options->jobs workers, each with a queue of directories of its own: a worker lists the directories it finds into its own queue and takes
+// the newest one back out (depth first, the path it just built is still warm), and a worker whose queue ran dry steals the oldest directory
+// of another worker's queue, the one closest to the root and so most likely the largest subtree. nobody hands out work centrally and the
+// workers only ever contend on a queue when one of them is stealing.
+// every URL goes through a set of 64 bit FNV-1a fingerprints before it's followed or indexed, 8 bytes a URL, so directories reachable by
+// two paths are listed once. with a few hundred thousand URLs at most, a fingerprint collision is far less likely than a dropped connection.
+// the server is spared by a cap on the requests in flight to it and an optional pause between the starts of two requests
+// the ring transport does without the workers: every level of the tree is listed with one fetch_all, see list_levels and ring.c
+
+#ifdef _WIN32
+typedef SRWLOCK mutex_t;
+    #define mutex_init(mutex)         InitializeSRWLock(mutex)
+    #define mutex_lock(mutex)         AcquireSRWLockExclusive(mutex)
+    #define mutex_unlock(mutex)       ReleaseSRWLockExclusive(mutex)
+    #define mutex_destroy(mutex)      ((void) (mutex))
+    #define pending_add(count, value) InterlockedExchangeAdd((count), (value))
+    #define pending_load(count)       InterlockedCompareExchange((count), 0, 0)
+#else
+    #include <pthread.h>
+    #include <time.h>
+
+typedef pthread_mutex_t mutex_t;
+    #define mutex_init(mutex)         pthread_mutex_init((mutex), NULL)
+    #define mutex_lock(mutex)         pthread_mutex_lock(mutex)
+    #define mutex_unlock(mutex)       pthread_mutex_unlock(mutex)
+    #define mutex_destroy(mutex)      pthread_mutex_destroy(mutex)
+    #define pending_add(count, value) __atomic_fetch_add((count), (value), __ATOMIC_ACQ_REL)
+    #define pending_load(count)       __atomic_load_n((count), __ATOMIC_ACQUIRE)
+#endif
+
+#define FTP_QUEUE_CAPACITY 64LLU   // directories a worker's queue has room for before it first grows
+#define FTP_SET_CAPACITY   4096LLU // fingerprints the URL set has room for before it first grows, a power of two
+
+// a worker's directories, taken from the back by the worker itself and from the front by thieves
+typedef struct _ftp_queue {
+        mutex_t       lock;
+        char**        paths;    // heap allocated absolute paths ending with a forward slash
+        unsigned long begin;    // the oldest directory
+        unsigned long end;      // one past the newest directory
+        unsigned long capacity; // directories paths has room for
+} ftp_queue_t;
+
+// open addressing over fingerprints, 0 marks a vacant slot
+typedef struct _url_set {
+        uint64_t*     slots;
+        unsigned long capacity; // a power of two, kept at least twice count
+        unsigned long count;
+} url_set_t;
+
+// the state the workers share
+typedef struct _crawler {
+        const ftp_options_t* options;
+        ftp_queue_t          queues[FTP_MAX_JOBS];
+        volatile long        pending;         // directories queued or being listed, the crawl is over when it drops to 0
+        mutex_t              lock;            // guards everything below
+        url_set_t            seen;            // every URL that was queued or indexed
+        results_t            results;         // the artifacts found so far, their URLs in the results' arena
+        unsigned long        in_flight;       // requests to the server that haven't been answered yet
+        unsigned long long   next_start;      // the earliest time in milliseconds the next request may go out
+        unsigned long        ndirectories;    // directories listed
+        unsigned long        nfailures;       // directories that couldn't be listed
+        char                 root[BUFF_SIZE]; // options->root, narrowed
+        char                 origin[BUFF_SIZE * 2]; // what goes in front of the paths in the indexed URLs
+        bool                 is_failed;       // a queue couldn't grow or the results couldn't take an artifact, the index would have holes
+} crawler_t;
+
+// a worker and the queue it owns
+typedef struct _ftp_worker {
+        crawler_t*    crawler;
+        unsigned long index;
+} ftp_worker_t;
+
+static unsigned long long __cdecl now_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec now = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000LLU + (unsigned long long) now.tv_nsec / 1000000LLU;
+#endif
+}
+
+// what an idle worker or one held back by the politeness limits does before it looks again
+static void __cdecl pause_briefly(void) {
+#ifdef _WIN32
+    Sleep(1);
+#else
+    const struct timespec duration = { .tv_sec = 0, .tv_nsec = 1000000L };
+    nanosleep(&duration, NULL);
+#endif
+}
+
+static uint64_t __cdecl fingerprint(_In_ const char* const restrict url, _In_ const unsigned long length) {
+    uint64_t hash = 0xCBF29CE484222325LLU;
+    for (unsigned long i = 0; i < length; ++i) hash = (hash ^ (unsigned char) url[i]) * 0x100000001B3LLU;
+    return hash ? hash : 1; // 0 is a vacant slot
+}
+
+static void __cdecl set_place(_Inout_ uint64_t* const restrict slots, _In_ const unsigned long capacity, _In_ const uint64_t key) {
+    unsigned long slot = (unsigned long) (key & (capacity - 1));
+    while (slots[slot]) slot = (slot + 1) & (capacity - 1);
+    slots[slot] = key;
+}
+
+// false when the URL was in the set already. a set that can't grow accepts everything rather than failing the crawl, and the crawler
+// remembers that the index may have duplicates and holes
+static bool __cdecl set_insert(_Inout_ crawler_t* const restrict crawler, _In_ const uint64_t key) {
+    url_set_t* const restrict set = &crawler->seen;
+
+    for (unsigned long slot = (unsigned long) (key & (set->capacity - 1)); set->slots[slot]; slot = (slot + 1) & (set->capacity - 1))
+        if (set->slots[slot] == key) return false;
+
+    if (2 * (set->count + 1) > set->capacity) {
+        uint64_t* const restrict slots = calloc(2 * set->capacity, sizeof(uint64_t));
+        if (!slots) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            crawler->is_failed = true;
+            return true;
+        }
+        for (unsigned long i = 0; i < set->capacity; ++i)
+            if (set->slots[i]) set_place(slots, 2 * set->capacity, set->slots[i]);
+        free(set->slots);
+        set->slots     = slots;
+        set->capacity *= 2;
+    }
+
+    set_place(set->slots, set->capacity, key);
+    set->count++;
+    return true;
+}
+
+// the caller has counted the directory as pending already
+static bool __cdecl queue_push(_Inout_ ftp_queue_t* const restrict queue, _In_ char* const restrict path) {
+    mutex_lock(&queue->lock);
+    if (queue->end == queue->capacity) {
+        const unsigned long count = queue->end - queue->begin;
+        if (2 * count > queue->capacity) { // more than half full, grow, otherwise sliding the directories to the front makes room enough
+            char** const restrict paths = realloc(queue->paths, sizeof(char*) * 2 * queue->capacity);
+            if (!paths) [[unlikely]] {
+                mutex_unlock(&queue->lock);
+                fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+                return false;
+            }
+            queue->paths     = paths;
+            queue->capacity *= 2;
+        }
+        memmove(queue->paths, queue->paths + queue->begin, sizeof(char*) * count);
+        queue->begin = 0;
+        queue->end   = count;
+    }
+    queue->paths[queue->end++] = path;
+    mutex_unlock(&queue->lock);
+    return true;
+}
+
+// the newest directory for the owner, the oldest for a thief. NULL when the queue is empty
+static char* __cdecl queue_take(_Inout_ ftp_queue_t* const restrict queue, _In_ const bool is_owner) {
+    char* path = NULL;
+    mutex_lock(&queue->lock);
+    if (queue->begin < queue->end) path = is_owner ? queue->paths[--queue->end] : queue->paths[queue->begin++];
+    if (queue->begin == queue->end) queue->begin = queue->end = 0;
+    mutex_unlock(&queue->lock);
+    return path;
+}
+
+// waits until the server may be sent another request
+static void __cdecl politeness_enter(_Inout_ crawler_t* const restrict crawler) {
+    for (;;) {
+        mutex_lock(&crawler->lock);
+        const unsigned long long now        = now_ms();
+        const bool               is_allowed = crawler->in_flight < crawler->options->per_host && now >= crawler->next_start;
+        if (is_allowed) {
+            crawler->in_flight++;
+            crawler->next_start = now + crawler->options->delay;
+        }
+        mutex_unlock(&crawler->lock);
+        if (is_allowed) return;
+        pause_briefly();
+    }
+}
+
+static void __cdecl politeness_leave(_Inout_ crawler_t* const restrict crawler) {
+    mutex_lock(&crawler->lock);
+    crawler->in_flight--;
+    mutex_unlock(&crawler->lock);
+}
+
+// walks a file name through the artifact automaton like match_release walks a download URL
+static artifact_kind_t __cdecl classify(_In_ const char* const restrict name, _In_ const unsigned long length) {
+    const artifact_automaton_t* const automaton = artifact_automaton();
+    unsigned                          state     = 0;
+    for (unsigned long i = 0; i < length; ++i) state = automaton->next[state][automaton->classes[(unsigned char) name[i]]];
+    return (artifact_kind_t) automaton->accept[state];
+}
+
+// an entry of the directory listing at path, under the crawler's lock. subdirectories go to the worker's own queue, files that are
+// artifacts and sit in a version's directory (/ftp/python/3.13.0/...) go into the index, with the version taken from the path
+static void __cdecl add_entry(
+    _Inout_ crawler_t* const restrict crawler,
+    _In_ const unsigned long worker,
+    _In_ const char* const restrict path,
+    _In_ const char* const restrict href,
+    _In_ const unsigned long length
+) {
+    char                url[HTTP_HEADER_LINE_LENGTH] = { 0 };
+    const unsigned long origin                       = (unsigned long) strlen(crawler->origin);
+    const unsigned long root                         = (unsigned long) strlen(crawler->root);
+    const unsigned long directory                    = (unsigned long) strlen(path);
+    if (origin + directory + length >= sizeof(url)) return; // nothing real is that long
+
+    memcpy(url, crawler->origin, origin);
+    memcpy(url + origin, path, directory);
+    memcpy(url + origin + directory, href, length);
+    const unsigned long size = origin + directory + length;
+    if (!set_insert(crawler, fingerprint(url, size))) return;
+
+    if (href[length - 1] == '/') {
+        unsigned long depth = 0;
+        for (unsigned long i = root; i < directory; ++i) depth += path[i] == '/';
+        if (depth >= FTP_MAX_DEPTH) return;
+
+        char* const restrict child = malloc(directory + length + 1);
+        if (!child) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            crawler->is_failed = true;
+            return;
+        }
+        memcpy(child, url + origin, directory + length);
+        child[directory + length] = '\0';
+        pending_add(&crawler->pending, 1);
+        if (!queue_push(crawler->queues + worker, child)) { // queue_push will do the error reporting
+            pending_add(&crawler->pending, -1);
+            crawler->is_failed = true;
+            free(child);
+        }
+        return;
+    }
+
+    const char* const version_end = memchr(path + root, '/', directory - root);
+    if (!version_end) return; // a file in the root directory isn't of any release
+    const artifact_kind_t kind = classify(href, length);
+    if (kind == ARTIFACT_NONE) return;
+
+    uint32_t offset = 0;
+    if (!results_intern(&crawler->results, url, size, &offset)) [[unlikely]] { // results_intern will do the error reporting
+        crawler->is_failed = true;
+        return;
+    }
+    const span_t downloadurl = { .offset = offset, .length = (uint32_t) size };
+    const span_t release     = { .offset = offset + (uint32_t) (origin + root), .length = (uint32_t) (version_end - path - root) };
+    if (!results_push(&crawler->results, release, downloadurl, kind)) crawler->is_failed = true; // results_push will do the error reporting
+}
+
+// goes through the listing of a directory, under the crawler's lock: <a href="3.13.0/">3.13.0/</a> for subdirectories and
+// <a href="python-3.13.0-amd64.exe"> for files. links to parents, to other hosts, to absolute paths and the sorting links of the listing
+// (?C=N;O=D) are skipped. returns the number of entries
+static unsigned long __cdecl read_listing(
+    _Inout_ crawler_t* const restrict crawler,
+    _In_ const unsigned long worker,
+    _In_ const char* const restrict path,
+    _In_ const char* const restrict html,
+    _In_ const unsigned long size
+) {
+    unsigned long nentries = 0;
+    for (unsigned long i = scan_pair(html, 0, size, '<', 'a'); i + 9 < size; i = scan_pair(html, i + 1, size, '<', 'a')) {
+        if (memcmp(html + i + 2, " href=\"", 7)) continue;
+        const char* const href  = html + i + 9;
+        const char* const quote = memchr(href, '"', size - i - 9);
+        if (!quote || quote == href) continue;
+
+        const unsigned long length = (unsigned long) (quote - href);
+        if (*href == '?' || *href == '/' || *href == '.' || *href == '#' || memchr(href, ':', length)) continue;
+        add_entry(crawler, worker, path, href, length);
+        nentries++;
+    }
+    return nentries;
+}
+
+static void __cdecl list_directory(_Inout_ crawler_t* const restrict crawler, _In_ const unsigned long worker, _In_ const char* const restrict path) {
+    wchar_t            accesspoint[HTTP_HEADER_LINE_LENGTH / 2] = { 0 };
+    body_t             body                                     = { 0 };
+    unsigned long      nentries                                 = 0;
+    const trace_span_t span                                     = trace_begin("listing", "crawl");
+
+    for (unsigned long i = 0; path[i] && i < HTTP_HEADER_LINE_LENGTH / 2 - 1; ++i) accesspoint[i] = (wchar_t) (unsigned char) path[i];
+
+    politeness_enter(crawler);
+    http_request_t request = transport_get(crawler->options->transport, crawler->options->server, crawler->options->port, accesspoint);
+    bool           is_read = transport_read_ex(&request, &body); // transport_read_ex will do the error reporting
+    politeness_leave(crawler);
+    if (is_read && request.status != HTTP_STATUS_OK) { // only a 200 carries a listing, whatever else came is counted as a failure
+        fwprintf_s(stderr, L"Error: listing %s came back with HTTP status %u!\n", accesspoint, request.status);
+        is_read = false;
+    }
+
+    // a listing is rarely larger than a slab, which makes the flattening free
+    const char* const html = is_read ? body_flatten(&body) : NULL; // body_flatten will do the error reporting
+    mutex_lock(&crawler->lock);
+    if (!html) crawler->nfailures++;
+    else {
+        crawler->ndirectories++;
+        nentries = read_listing(crawler, worker, path, html, body.size);
+    }
+    mutex_unlock(&crawler->lock);
+
+    trace_end(span, body.size, nentries);
+    body_release(&body);
+}
+
+// lists directories until there are none left anywhere. the queue of the worker comes first, then the queues of the others, starting with
+// the next one over so that the thieves don't all descend on the same victim
+static bool __cdecl ftp_worker(_Inout_opt_ void* const argument) {
+    const ftp_worker_t* const restrict worker  = argument;
+    crawler_t* const restrict          crawler = worker->crawler;
+    const unsigned long                jobs    = crawler->options->jobs;
+
+    for (;;) {
+        char* path = queue_take(crawler->queues + worker->index, true);
+        for (unsigned long i = 1; !path && i < jobs; ++i) path = queue_take(crawler->queues + (worker->index + i) % jobs, false);
+
+        if (!path) {
+            if (!pending_load(&crawler->pending)) return true; // nothing queued and nobody listing a directory that could queue more
+            pause_briefly();
+            continue;
+        }
+
+        list_directory(crawler, worker->index, path);
+        free(path);
+        pending_add(&crawler->pending, -1); // after its subdirectories were counted, so pending can't touch 0 early
+    }
+}
+
+// the crawl of the ring transport, which has no use for workers. the directories are listed a level of the tree at a time, every level with a
+// single fetch_all over options->per_host connections. the subdirectories all go to the first queue, which makes up the next level
+static void __cdecl list_levels(_Inout_ crawler_t* const restrict crawler) {
+    ftp_queue_t* const restrict queue = crawler->queues;
+
+    while (queue->begin < queue->end && !crawler->is_failed) {
+        const unsigned long count   = queue->end - queue->begin;
+        char** const        paths   = malloc(sizeof(char*) * count);
+        fetch_t* const      fetches = calloc(count, sizeof(fetch_t));
+        unsigned long       size    = 0;
+        const trace_span_t  span    = trace_begin("level", "crawl");
+        if (!paths || !fetches) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            crawler->is_failed = true;
+            free(paths);
+            free(fetches);
+            return;
+        }
+
+        memcpy(paths, queue->paths + queue->begin, sizeof(char*) * count);
+        queue->begin = queue->end = 0;
+        for (unsigned long i = 0; i < count; ++i) fetches[i].path = paths[i];
+        const ftp_options_t* const options = crawler->options;
+        (void) fetch_all(options->server, options->port, fetches, count, options->per_host); // fetch_all will do the error reporting
+
+        for (unsigned long i = 0; i < count; ++i) {
+            const char* const html = fetches[i].is_fetched ? body_flatten(&fetches[i].body) : NULL; // body_flatten will do the error reporting
+            if (!html) crawler->nfailures++;
+            else {
+                crawler->ndirectories++;
+                size += fetches[i].body.size;
+                (void) read_listing(crawler, 0, paths[i], html, fetches[i].body.size);
+            }
+            body_release(&fetches[i].body);
+            free(paths[i]);
+        }
+        free(paths);
+        free(fetches);
+        trace_end(span, size, count);
+    }
+}
+
+// qsort can't take a context, the URLs to sort are copied out into entries that carry their own
+typedef struct _indexed_url {
+        const char* url;
+        uint32_t    length;
+        uint32_t    row;
+} indexed_url_t;
+
+static int __cdecl compare_urls(_In_ const void* const left, _In_ const void* const right) {
+    const indexed_url_t* const restrict a = left;
+    const indexed_url_t* const restrict b = right;
+    const int order                       = memcmp(a->url, b->url, a->length < b->length ? a->length : b->length);
+    return order ? order : (a->length > b->length) - (a->length < b->length);
+}
+
+// the workers index artifacts in whatever order the responses come in, the index is sorted by URL so that every crawl of the same tree
+// prints the same. sorted gets its own copy of the text
+static results_t __cdecl sort_index(_In_ const results_t results) {
+    results_t            sorted  = { 0 };
+    indexed_url_t* const entries = malloc(sizeof(indexed_url_t) * (results.count ? results.count : 1));
+    if (!entries) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return sorted;
+    }
+    if (!results_init(&sorted, NULL, results.count)) goto PREMATURE_RETURN; // results_init will do the error reporting
+
+    for (unsigned long i = 0; i < results.count; ++i)
+        entries[i] = (indexed_url_t) { .url = results.text + results.downloadurls[i].offset, .length = results.downloadurls[i].length, .row = i };
+    qsort(entries, results.count, sizeof(indexed_url_t), compare_urls);
+
+    for (unsigned long i = 0; i < results.count; ++i) {
+        const span_t downloadurl = results.downloadurls[entries[i].row], version = results.versions[entries[i].row]; // NOLINT
+        uint32_t     offset      = 0;
+        if (!results_intern(&sorted, entries[i].url, entries[i].length, &offset)
+            || !results_push(
+                &sorted,
+                (span_t) { .offset = offset + (version.offset - downloadurl.offset), .length = version.length },
+                (span_t) { .offset = offset, .length = downloadurl.length },
+                (artifact_kind_t) results.kinds[entries[i].row]
+            )) { // results_intern and results_push will do the error reporting
+            results_release(&sorted);
+            break;
+        }
+    }
+
+PREMATURE_RETURN:
+    free(entries);
+    return sorted;
+}
+
+[[nodiscard("entails expensive http io")]] results_t __cdecl crawl_ftp(_In_ const ftp_options_t* const restrict options) {
+    crawler_t* const restrict crawler    = calloc(1, sizeof(crawler_t));
+    ftp_worker_t              workers[FTP_MAX_JOBS];
+    task_t                    tasks[FTP_MAX_JOBS];
+    results_t                 index      = { 0 };
+    const unsigned long       jobs       = options->jobs;
+    const bool                is_batched = options->transport == &ring_transport && !options->delay; // spacing requests takes workers
+    const unsigned long long  started    = now_ms();
+    const trace_span_t        span       = trace_begin("crawl", "crawl");
+
+    if (!crawler) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return index;
+    }
+    crawler->options = options;
+    mutex_init(&crawler->lock);
+    for (unsigned long i = 0; i < jobs; ++i) mutex_init(&crawler->queues[i].lock);
+
+    // the URLs of the index are those of python.org's own pages when the tree is python.org's, https that WinHttp gets to over port 80
+    if (options->port == INTERNET_DEFAULT_HTTP_PORT) sprintf_s(crawler->origin, sizeof(crawler->origin), "https://%S", options->server);
+    else sprintf_s(crawler->origin, sizeof(crawler->origin), "http://%S:%hu", options->server, options->port);
+    if (wcstombs(crawler->root, options->root, BUFF_SIZE) >= BUFF_SIZE || crawler->root[strlen(crawler->root) - 1] != '/') {
+        fwprintf_s(stderr, L"Error: %s is not a directory to start a crawl at, it must end with a forward slash!\n", options->root);
+        goto CLEANUP;
+    }
+
+    crawler->seen.slots    = calloc(FTP_SET_CAPACITY, sizeof(uint64_t));
+    crawler->seen.capacity = FTP_SET_CAPACITY;
+    char* const root       = malloc(strlen(crawler->root) + 1);
+    for (unsigned long i = 0; i < jobs; ++i) {
+        crawler->queues[i].paths    = malloc(sizeof(char*) * FTP_QUEUE_CAPACITY);
+        crawler->queues[i].capacity = FTP_QUEUE_CAPACITY;
+        if (!crawler->queues[i].paths) crawler->is_failed = true;
+    }
+    if (!crawler->seen.slots || !root || crawler->is_failed || !results_init(&crawler->results, NULL, RESULTS_INITIAL_CAPACITY)) {
+        if (!crawler->results.versions) fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        free(root);
+        goto CLEANUP;
+    }
+
+    strcpy_s(root, strlen(crawler->root) + 1, crawler->root);
+    crawler->pending = 1;
+    (void) queue_push(crawler->queues, root); // there's room, the queue is empty
+    if (is_batched) list_levels(crawler);
+    else {
+        for (unsigned long i = 0; i < jobs; ++i) {
+            workers[i] = (ftp_worker_t) { .crawler = crawler, .index = i };
+            task_start(tasks + i, ftp_worker, workers + i);
+        }
+        for (unsigned long i = 0; i < jobs; ++i) (void) task_wait(tasks + i);
+    }
+
+    if (!crawler->ndirectories) fwprintf_s(stderr, L"Error: could not list %s!\n", options->root);
+    else if (crawler->is_failed) fputws(L"Error: the crawl ran out of memory, the index would be incomplete!\n", stderr);
+    else {
+        if (crawler->nfailures) fwprintf_s(stderr, L"Warning: %lu directories could not be listed, the index is incomplete!\n", crawler->nfailures);
+        index = sort_index(crawler->results); // sort_index will do the error reporting
+        fwprintf_s(
+            stderr,
+            L"indexed %lu artifacts in %lu directories in %llu ms, %lu listings at a time\n",
+            index.count,
+            crawler->ndirectories,
+            now_ms() - started,
+            is_batched || options->per_host < jobs ? options->per_host : jobs
+        );
+    }
+
+CLEANUP:
+    trace_end(span, crawler->ndirectories, index.count);
+    for (unsigned long i = 0; i < jobs; ++i) {
+        for (unsigned long j = crawler->queues[i].begin; j < crawler->queues[i].end; ++j) free(crawler->queues[i].paths[j]);
+        free(crawler->queues[i].paths);
+        mutex_destroy(&crawler->queues[i].lock);
+    }
+    mutex_destroy(&crawler->lock);
+    free(crawler->seen.slots);
+    results_release(&crawler->results);
+    free(crawler);
+    return index;
+}
@@ -1,7 +1,7 @@
 #include <project.h>
 
-[[nodiscard("entails expensive http io"
-)]] hinternet_triple_t __cdecl http_get(_In_ const wchar_t* const restrict server, _In_ const wchar_t* const restrict accesspoint) {
+// opens a WinHttp session with DEFLATE/gzip decoding enabled, NULL on failure
+static HINTERNET __cdecl open_session(void) {
     // WinHttpOpen returns a valid session handle if successful, or NULL otherwise.
     // first of the WinHTTP functions called by an application.
     // initializes internal WinHTTP data structures and prepares for future calls from the application.
@@ -16,7 +16,7 @@
 
     if (!session_handle) [[unlikely]] {
         fwprintf_s(stderr, L"Error %lu in WinHttpOpen.\n", GetLastError());
-        goto PREMATURE_RETURN;
+        return NULL;
     }
 
     // as of 24/05/2024 www.python.org/downloads/windows/ sends a gzipped file in response to a GET request
@@ -38,24 +38,18 @@
 
     if (!is_winhttp_decoding_enabled) [[unlikely]] {
         fwprintf_s(stderr, L"Error %lu in the WinHttpSetOption, DEFLATE/gzip decompression request failed!\n", GetLastError());
-        goto CLOSE_SESSION_HANDLE;
+        WinHttpCloseHandle(session_handle);
+        return NULL;
     }
 
-    // WinHttpConnect specifies the initial target server of an HTTP request and returns an HINTERNET connection handle
-    // to an HTTP session for that initial target.
-    // returns a valid connection handle to the HTTP session if the connection is successful, or NULL otherwise.
-    const HINTERNET connection_handle = WinHttpConnect(
-        session_handle,
-        server,
-        INTERNET_DEFAULT_HTTP_PORT, // uses port 80 for HTTP and port 443 for HTTPS.
-        0
-    );
-
-    if (!connection_handle) [[unlikely]] {
-        fwprintf_s(stderr, L"Error %lu in WinHttpConnect.\n", GetLastError());
-        goto CLOSE_SESSION_HANDLE;
-    }
+    return session_handle;
+}
 
+// creates a GET request for the accesspoint on an open connection and sends it along with the additional headers, NULL on failure
+// headers must be WINHTTP_NO_ADDITIONAL_HEADERS or a series of CRLF terminated header lines
+static HINTERNET __cdecl send_get_request(
+    _In_ const HINTERNET connection_handle, _In_ const wchar_t* const restrict accesspoint, _In_opt_ const wchar_t* const restrict headers
+) {
     // WinHttpOpenRequest creates an HTTP request handle.
     // an HTTP request handle holds a request to send to an HTTP server and contains all RFC822/MIME/HTTP headers to be sent as part of the
     // request.
@@ -75,32 +69,63 @@
 
     if (!request_handle) [[unlikely]] {
         fwprintf_s(stderr, L"Error %lu in the WinHttpOpenRequest.\n", GetLastError());
-        goto CLOSE_CONNECTION_HANDLE;
+        return NULL;
     }
 
     // WinHttpSendRequest sends the specified request to the HTTP server and returns true if successful, or false otherwise.
-    const bool is_request_sent = WinHttpSendRequest( // NOLINT(readability-implicit-bool-conversion)
+    // WinHttpConnect doesn't touch the network, resolving the name and opening the connection happen in here, hence the span's name
+    const trace_span_t span            = trace_begin("connect", "http");
+    const bool         is_request_sent = WinHttpSendRequest( // NOLINT(readability-implicit-bool-conversion)
         request_handle,
-        WINHTTP_NO_ADDITIONAL_HEADERS, // pointer to a string that contains the additional headers to append to the request.
-        0,                             // an unsigned long integer value that contains the length, in characters, of the additional headers.
-        WINHTTP_NO_REQUEST_DATA,       // pointer to a buffer that contains any optional data to send immediately after the request headers
-        0,                             // an unsigned long integer value that contains the length, in bytes, of the optional data.
-        0,                             // an unsigned long integer value that contains the length, in bytes, of the total data sent.
+        headers,                           // pointer to a string that contains the additional headers to append to the request.
+        headers ? (unsigned long) -1L : 0, // length of the additional headers in characters, -1 for null terminated strings
+        WINHTTP_NO_REQUEST_DATA,           // pointer to a buffer that contains any optional data to send immediately after the request headers
+        0,                                 // an unsigned long integer value that contains the length, in bytes, of the optional data.
+        0,                                 // an unsigned long integer value that contains the length, in bytes, of the total data sent.
         0
     ); // a pointer to a pointer-sized variable that contains an application-defined value that is passed, with the request handle, to
         // any callback functions.
+    trace_end(span, 0, 0);
 
     if (!is_request_sent) [[unlikely]] {
         fwprintf_s(stderr, L"Error %lu in the WinHttpSendRequest.\n", GetLastError());
-        goto CLOSE_REQUEST_HANDLE;
+        WinHttpCloseHandle(request_handle);
+        return NULL;
+    }
+
+    return request_handle;
+}
+
+[[nodiscard("entails expensive http io")]] hinternet_triple_t __cdecl http_get_ex(
+    _In_ const wchar_t* const restrict server, _In_ const unsigned short port, _In_ const wchar_t* const restrict accesspoint
+) {
+    const HINTERNET session_handle = open_session(); // open_session will do the error reporting
+    if (!session_handle) [[unlikely]]
+        goto PREMATURE_RETURN;
+
+    // WinHttpConnect specifies the initial target server of an HTTP request and returns an HINTERNET connection handle
+    // to an HTTP session for that initial target.
+    // returns a valid connection handle to the HTTP session if the connection is successful, or NULL otherwise.
+    const HINTERNET connection_handle = WinHttpConnect(
+        session_handle,
+        server,
+        port, // INTERNET_DEFAULT_HTTP_PORT uses port 80 for HTTP and port 443 for HTTPS.
+        0
+    );
+
+    if (!connection_handle) [[unlikely]] {
+        fwprintf_s(stderr, L"Error %lu in WinHttpConnect.\n", GetLastError());
+        goto CLOSE_SESSION_HANDLE;
     }
 
+    const HINTERNET request_handle = send_get_request(connection_handle, accesspoint, WINHTTP_NO_ADDITIONAL_HEADERS);
+    if (!request_handle) [[unlikely]]
+        goto CLOSE_CONNECTION_HANDLE;
+
     // these 3 handles need to be closed by the caller.
     return (hinternet_triple_t) { .session = session_handle, .connection = connection_handle, .request = request_handle };
 
 // cleanup
-CLOSE_REQUEST_HANDLE:
-    WinHttpCloseHandle(request_handle);
 CLOSE_CONNECTION_HANDLE:
     WinHttpCloseHandle(connection_handle);
 CLOSE_SESSION_HANDLE:
@@ -109,22 +134,26 @@ PREMATURE_RETURN:
     return (hinternet_triple_t) { .session = NULL, .connection = NULL, .request = NULL };
 }
 
+[[nodiscard("entails expensive http io"
+)]] hinternet_triple_t __cdecl http_get(_In_ const wchar_t* const restrict server, _In_ const wchar_t* const restrict accesspoint) {
+    return http_get_ex(server, INTERNET_DEFAULT_HTTP_PORT, accesspoint);
+}
+
 [[deprecated("use the more efficient read_http_response_ex"),
   nodiscard("entails expensive http io"
-  )]] char* __cdecl read_http_response(_In_ const hinternet_triple_t handles, _Inout_ unsigned long* const restrict size) {
+  )]] bool __cdecl read_http_response(_In_ const hinternet_triple_t handles, _Inout_ body_t* const restrict body) {
     // if the call to http_get() failed,
     if (!handles.session || !handles.connection || !handles.request) [[unlikely]] {
         fputws(__FUNCTIONW__ " failed! (Errors in previous call to http_get).\n", stderr);
-        return NULL;
+        return false;
     }
 
     // NOLINTNEXTLINE(readability-isolate-declaration)
-    unsigned long total_bytes_read = 0, bytes_in_current_query = 0, bytes_read_from_current_query = 0;
-    bool          is_failure       = false;
+    unsigned long bytes_in_current_query = 0, bytes_read_from_current_query = 0, available = 0;
+    bool          is_failure             = false;
 
     // NOLINTNEXTLINE(readability-isolate-declaration) - unpack the handles for convenience
     const HINTERNET session_handle = handles.session, connection_handle = handles.connection, request_handle = handles.request;
-    char* restrict buffer           = NULL;
 
     const bool is_response_received = WinHttpReceiveResponse(request_handle, NULL); // NOLINT(readability-implicit-bool-conversion)
     if (!is_response_received) [[unlikely]] {
@@ -133,44 +162,33 @@ PREMATURE_RETURN:
         goto PREMATURE_RETURN;
     }
 
-    // calling malloc first and then calling realloc in a do while loop is terribly inefficient for a simple app sending a single GET request.
-    // we'll malloc all the needed memory beforehand and use a moving pointer to keep track of the
-    // last write offset, so the next write can start from where the last write terminated
-    buffer = malloc(HTTP_RESPONSE_SIZE);
-    if (!buffer) [[unlikely]] {
-        fputws(
-            L"Memory allocation error inside "__FUNCTIONW__
-            "!\n",
-            stderr
-        );
-        is_failure = true;
-        goto PREMATURE_RETURN;
-    }
-    memset(buffer, 0U, HTTP_RESPONSE_SIZE); // zero out the buffer.
-
     do {
         // for every iteration, zero these counters since these are specific to each query.
         bytes_in_current_query = bytes_read_from_current_query = 0;
 
         if (!WinHttpQueryDataAvailable(request_handle, &bytes_in_current_query)) {
             fwprintf_s(stderr, L"Error %lu in WinHttpQueryDataAvailable.\n", GetLastError());
+            is_failure = true;
             break;
         }
 
         if (!bytes_in_current_query) break; // if there aren't any more bytes to read,
 
-        if (!WinHttpReadData(request_handle, buffer + total_bytes_read, bytes_in_current_query, &bytes_read_from_current_query)) {
-            fwprintf_s(stderr, L"Error %lu in WinHttpReadData.\n", GetLastError());
+        // the bytes go straight into the body, as many as the slab at its end has room for. the rest is read on the next iteration
+        char* const destination = body_reserve(body, &available);
+        if (!destination) [[unlikely]] { // body_reserve will do the error reporting
+            is_failure = true;
             break;
         }
+        if (bytes_in_current_query > available) bytes_in_current_query = available;
 
-        total_bytes_read += bytes_read_from_current_query;
-
-        if (total_bytes_read >= (HTTP_RESPONSE_SIZE - 128U)) [[unlikely]] {
-            fputws(L"Warning: Truncation of response due to insufficient memory!\n", stderr);
+        if (!WinHttpReadData(request_handle, destination, bytes_in_current_query, &bytes_read_from_current_query)) {
+            fwprintf_s(stderr, L"Error %lu in WinHttpReadData.\n", GetLastError());
+            is_failure = true;
             break;
         }
 
+        body_commit(body, bytes_read_from_current_query);
     } while (bytes_in_current_query > 0); // while there's still data in the response,
 
 PREMATURE_RETURN:
@@ -178,58 +196,273 @@ PREMATURE_RETURN:
     WinHttpCloseHandle(session_handle);
     WinHttpCloseHandle(connection_handle);
     WinHttpCloseHandle(request_handle);
-    *size = total_bytes_read;
-    return is_failure ? NULL : buffer; // NOLINT(readability-implicit-bool-conversion)
+    return !is_failure;
 }
 
 [[nodiscard("entails expensive http io"
-)]] char* __cdecl read_http_response_ex(_In_ const hinternet_triple_t handles, _Inout_ unsigned long* const restrict size) {
+)]] bool __cdecl read_http_response_ex(_In_ const hinternet_triple_t handles, _Inout_ body_t* const restrict body) {
     if (!handles.session || !handles.connection || !handles.request) {
         fputws(__FUNCTIONW__ " failed! (Errors in previous call to http_get)\n", stderr);
-        return NULL;
+        return false;
     }
 
-    unsigned long total_bytes_read = 0;
-    bool          is_failure       = false;
-    char* restrict buffer          = NULL;
+    unsigned long available = 0, bytes_read = 0; // NOLINT(readability-isolate-declaration)
+    bool          is_failure = false;
     // NOLINTNEXTLINE(readability-isolate-declaration) - unpack the handles for convenience
     const HINTERNET session_handle = handles.session, connection_handle = handles.connection, request_handle = handles.request;
+    trace_span_t    span           = trace_begin("first byte", "http");
 
     const bool is_response_received = WinHttpReceiveResponse(request_handle, NULL); // NOLINT(readability-implicit-bool-conversion)
+    trace_end(span, 0, 0);
     if (!is_response_received) {
         fwprintf_s(stderr, L"Error %lu in WinHttpReceiveResponse.\n", GetLastError());
         is_failure = true;
         goto PREMATURE_RETURN;
     }
 
-    // calling malloc first and then calling realloc in a do while loop is terribly inefficient for a simple app sending a single GET request.
-    // we'll malloc all the needed memory beforehand and use a moving pointer to keep track of the
-    // last write offset, so the next write can start from where the last write terminated
-    buffer = malloc(HTTP_RESPONSE_SIZE);
-    if (!buffer) {
-        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+    // WINHTTP_READ_DATA_EX_FLAG_FILL_BUFFER will condition the WinHttpReadDataEx to return only after the slab is full or all the bytes in
+    // the response have been collected, so a call that leaves room in the slab was the last one. a response of any size costs one call per
+    // slab and is never truncated
+    span = trace_begin("transfer", "http");
+    do {
+        char* const destination = body_reserve(body, &available);
+        if (!destination) { // body_reserve will do the error reporting
+            is_failure = true;
+            break;
+        }
+
+        bytes_read                               = 0;
+        const unsigned long response_read_status = // will be 0 if the call succeeds
+            WinHttpReadDataEx(request_handle, destination, available, &bytes_read, WINHTTP_READ_DATA_EX_FLAG_FILL_BUFFER, 0, NULL);
+        if (response_read_status) { // dwReadStatus != 0
+            fwprintf_s(stderr, L"Error %lu in WinHttpReadDataEx.\n", GetLastError());
+            is_failure = true;
+            break;
+        }
+        body_commit(body, bytes_read);
+    } while (bytes_read == available);
+    trace_end(span, body->size, 0);
+
+PREMATURE_RETURN:
+    // using regular CloseHandle() to close HINTERNET handles will (did) crash the debug session.
+    WinHttpCloseHandle(session_handle);
+    WinHttpCloseHandle(connection_handle);
+    WinHttpCloseHandle(request_handle);
+    return !is_failure;
+}
+
+// a single WinHttp session shared by every request going through winhttp_transport. WinHttp keeps its own keep-alive connections per session,
+// so as long as the session and the connection handles stay open, consecutive requests to a host reuse the same TCP (and TLS) connection
+static HINTERNET shared_session      = NULL;
+static SRWLOCK   shared_session_lock = SRWLOCK_INIT;
+
+static void __cdecl close_connection_handle(_In_ const uintptr_t connection) { WinHttpCloseHandle((HINTERNET) connection); }
+
+// formats the additional header lines of a request, If-None-Match and If-Modified-Since for a conditional one or Range and If-Range for a
+// ranged one, returns false if there are none. WinHttp still asks for a compressed body on ranged requests since the decompression is
+// enabled for the whole session, servers don't compress the binaries ranges are meant for anyway
+static bool __cdecl format_headers(
+    _In_ const http_request_t* const restrict request, _Inout_ wchar_t* const restrict headers, _In_ const unsigned long size
+) {
+    const http_validators_t* const conditions = &request->conditions;
+    int                            length     = 0;
+
+    if (request->range_end) { // If-Range takes a single validator and a weak ETag won't do
+        const bool        is_strong = *conditions->etag && strncmp(conditions->etag, "W/", 2);
+        const char* const validator = is_strong ? conditions->etag : conditions->last_modified;
+        length += swprintf_s(headers, size, L"Range: bytes=%llu-%llu\r\n", request->range_begin, request->range_end - 1);
+        if (*validator) length += swprintf_s(headers + length, size - length, L"If-Range: %S\r\n", validator);
+        return true;
+    }
+
+    if (*conditions->etag) length += swprintf_s(headers + length, size - length, L"If-None-Match: %S\r\n", conditions->etag);
+    if (*conditions->last_modified)
+        length += swprintf_s(headers + length, size - length, L"If-Modified-Since: %S\r\n", conditions->last_modified);
+    return length > 0;
+}
+
+// copies the value of a response header into buffer, validators are plain ASCII so a narrowing copy will do. leaves buffer empty when the
+// header is absent, or too long to be worth keeping around
+static void __cdecl query_validator(_In_ const HINTERNET request_handle, _In_ const unsigned long query, _Inout_ char* const restrict buffer) {
+    wchar_t       value[HTTP_VALIDATOR_LENGTH] = { 0 };
+    unsigned long size                         = sizeof(value);
+
+    *buffer = 0;
+    if (!WinHttpQueryHeaders(request_handle, query, WINHTTP_HEADER_NAME_BY_INDEX, value, &size, WINHTTP_NO_HEADER_INDEX)) return;
+    for (unsigned long i = 0; i < HTTP_VALIDATOR_LENGTH; ++i) {
+        if (value[i] > 0x7F) {
+            *buffer = 0;
+            return;
+        }
+        buffer[i] = (char) value[i];
+        if (!value[i]) return;
+    }
+    buffer[HTTP_VALIDATOR_LENGTH - 1] = 0;
+}
+
+// the size of the whole body, the total of Content-Range in a partial response or Content-Length in a whole one, 0 when unknown. the
+// Content-Length of a compressed body is that of the encoded bytes, which WinHttp never hands out, so it's no use here
+static unsigned long long __cdecl query_total_size(_In_ const HINTERNET request_handle, _In_ const unsigned long status) {
+    wchar_t       value[BUFF_SIZE] = { 0 };
+    unsigned long size             = sizeof(value);
+
+    if (status == HTTP_STATUS_PARTIAL_CONTENT) { // bytes 0-1023/4096, the total after the slash is * when unknown
+        if (!WinHttpQueryHeaders(request_handle, WINHTTP_QUERY_CONTENT_RANGE, WINHTTP_HEADER_NAME_BY_INDEX, value, &size, WINHTTP_NO_HEADER_INDEX))
+            return 0;
+        const wchar_t* const slash = wcschr(value, L'/');
+        return slash ? wcstoull(slash + 1, NULL, 10) : 0;
+    }
+    if (status != HTTP_STATUS_OK) return 0;
+    if (WinHttpQueryHeaders(request_handle, WINHTTP_QUERY_CONTENT_ENCODING, WINHTTP_HEADER_NAME_BY_INDEX, value, &size, WINHTTP_NO_HEADER_INDEX))
+        return 0;
+    size = sizeof(value);
+    if (!WinHttpQueryHeaders(request_handle, WINHTTP_QUERY_CONTENT_LENGTH, WINHTTP_HEADER_NAME_BY_INDEX, value, &size, WINHTTP_NO_HEADER_INDEX))
+        return 0;
+    return wcstoull(value, NULL, 10);
+}
+
+static bool __cdecl winhttp_get(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint
+) {
+    AcquireSRWLockExclusive(&shared_session_lock);
+    if (!shared_session) shared_session = open_session(); // open_session will do the error reporting
+    const HINTERNET session_handle = shared_session;
+    ReleaseSRWLockExclusive(&shared_session_lock);
+    if (!session_handle) return false;
+
+    uintptr_t connection = 0;
+    if (!pool_checkout(&winhttp_transport, server, port, NULL, &connection)) {
+        connection = (uintptr_t) WinHttpConnect(session_handle, server, port, 0);
+        if (!connection) [[unlikely]] {
+            fwprintf_s(stderr, L"Error %lu in WinHttpConnect.\n", GetLastError());
+            return false;
+        }
+    }
+
+    wchar_t         headers[HTTP_VALIDATOR_LENGTH * 3] = { 0 };
+    const HINTERNET request_handle                     = send_get_request(
+        (HINTERNET) connection, accesspoint, format_headers(request, headers, sizeof(headers) / sizeof(wchar_t)) ? headers : WINHTTP_NO_ADDITIONAL_HEADERS
+    );
+    if (!request_handle) [[unlikely]] {
+        WinHttpCloseHandle((HINTERNET) connection);
+        return false;
+    }
+
+    request->handles = (hinternet_triple_t) { .session = session_handle, .connection = (HINTERNET) connection, .request = request_handle };
+    return true;
+}
+
+static void __cdecl winhttp_cleanup(void) {
+    AcquireSRWLockExclusive(&shared_session_lock);
+    if (shared_session) WinHttpCloseHandle(shared_session);
+    shared_session = NULL;
+    ReleaseSRWLockExclusive(&shared_session_lock);
+}
+
+// receives the response and hands it to the sink in HTTP_CHUNK_SIZE pieces as WinHttp collects them
+static bool __cdecl winhttp_read(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const http_sink_t sink,
+    _Inout_opt_ void* const context,
+    _Inout_ unsigned long* const restrict size
+) {
+    const hinternet_triple_t handles = request->handles;
+    if (!handles.session || !handles.connection || !handles.request) {
+        fputws(__FUNCTIONW__ " failed! (Errors in previous call to http_get)\n", stderr);
+        return false;
+    }
+
+    // NOLINTNEXTLINE(readability-isolate-declaration)
+    unsigned long total_bytes_read = 0, bytes_in_current_query = 0, bytes_read_from_current_query = 0, status_size = sizeof(unsigned long);
+    unsigned long status           = 0;
+    bool          is_failure       = false;
+    char          chunk[HTTP_CHUNK_SIZE]; // no need to zero this, only the bytes WinHttpReadData reports are handed to the sink
+    // NOLINTNEXTLINE(readability-isolate-declaration) - unpack the handles for convenience
+    const HINTERNET session_handle = handles.session, connection_handle = handles.connection, request_handle = handles.request;
+    trace_span_t    span           = trace_begin("first byte", "http");
+
+    const bool is_response_received = WinHttpReceiveResponse(request_handle, NULL); // NOLINT(readability-implicit-bool-conversion)
+    trace_end(span, 0, 0);
+    if (!is_response_received) {
+        fwprintf_s(stderr, L"Error %lu in WinHttpReceiveResponse.\n", GetLastError());
         is_failure = true;
         goto PREMATURE_RETURN;
     }
-    memset(buffer, 0U, HTTP_RESPONSE_SIZE); // zero out the buffer.
 
-    const unsigned long response_read_status = // will be 0 if the call succeeds
-        WinHttpReadDataEx(request_handle, buffer, HTTP_RESPONSE_SIZE, &total_bytes_read, WINHTTP_READ_DATA_EX_FLAG_FILL_BUFFER, 0, NULL);
-    // WINHTTP_READ_DATA_EX_FLAG_FILL_BUFFER will condition the WinHttpReadDataEx to return only after all the bytes in the response have been collected in the buffer
-    // without this we'd have to read the response in chunks using a loop, checking every time for bytes remaining
-
-    if (response_read_status) { // dwReadStatus != 0
-        fwprintf_s(stderr, L"Error %lu in WinHttpReadDataEx.\n", GetLastError());
-        free(buffer);
+    if (WinHttpQueryHeaders(
+            request_handle,
+            WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+            WINHTTP_HEADER_NAME_BY_INDEX,
+            &status,
+            &status_size,
+            WINHTTP_NO_HEADER_INDEX
+        ))
+        request->status = status;
+    // a 304 has no body and is a success as far as the transports go, every other status outside 2xx is an error page the sinks mustn't see
+    if (request->status != HTTP_STATUS_NOT_MODIFIED && (request->status < 200 || request->status > 299)) {
+        fwprintf_s(stderr, L"Error: the server responded with HTTP status %u.\n", request->status);
         is_failure = true;
+        goto PREMATURE_RETURN;
     }
+    request->total_size = query_total_size(request_handle, request->status);
+
+    query_validator(request_handle, WINHTTP_QUERY_ETAG, request->validators.etag);
+    query_validator(request_handle, WINHTTP_QUERY_LAST_MODIFIED, request->validators.last_modified);
+
+    span = trace_begin("transfer", "http"); // the sink's own spans nest inside this one
+    do {
+        bytes_in_current_query = bytes_read_from_current_query = 0;
+
+        if (!WinHttpQueryDataAvailable(request_handle, &bytes_in_current_query)) {
+            fwprintf_s(stderr, L"Error %lu in WinHttpQueryDataAvailable.\n", GetLastError());
+            is_failure = true;
+            break;
+        }
+
+        if (!bytes_in_current_query) break; // if there aren't any more bytes to read,
+        if (bytes_in_current_query > HTTP_CHUNK_SIZE) bytes_in_current_query = HTTP_CHUNK_SIZE;
+
+        if (!WinHttpReadData(request_handle, chunk, bytes_in_current_query, &bytes_read_from_current_query)) {
+            fwprintf_s(stderr, L"Error %lu in WinHttpReadData.\n", GetLastError());
+            is_failure = true;
+            break;
+        }
+
+        // let the sink work on what we have while WinHttp keeps receiving the rest of the body in the background
+        total_bytes_read += bytes_read_from_current_query;
+        trace_counter("bytes received", total_bytes_read);
+        if (!sink(context, chunk, bytes_read_from_current_query)) {
+            is_failure = true;
+            break;
+        }
+
+    } while (bytes_read_from_current_query > 0);
+    trace_end(span, total_bytes_read, 0);
 
 PREMATURE_RETURN:
     // using regular CloseHandle() to close HINTERNET handles will (did) crash the debug session.
-    WinHttpCloseHandle(session_handle);
-    WinHttpCloseHandle(connection_handle);
     WinHttpCloseHandle(request_handle);
+    if (session_handle != shared_session) { // handles from a plain http_get, nothing to pool
+        WinHttpCloseHandle(connection_handle);
+        WinHttpCloseHandle(session_handle);
+    } else if (is_failure)
+        WinHttpCloseHandle(connection_handle);
+    else
+        pool_checkin(&winhttp_transport, request->server, request->port, (uintptr_t) connection_handle, close_connection_handle);
+    request->handles = (hinternet_triple_t) { .session = NULL, .connection = NULL, .request = NULL };
 
     *size = total_bytes_read;
-    return is_failure ? NULL : buffer; // NOLINT(readability-implicit-bool-conversion)
+    return !is_failure;
+}
+
+const http_transport_t winhttp_transport = { .name = L"winhttp", .get = winhttp_get, .read = winhttp_read, .cleanup = winhttp_cleanup };
+
+[[nodiscard("entails expensive http io")]] bool __cdecl read_http_response_stream(
+    _In_ const hinternet_triple_t handles, _Inout_ stream_parser_t* const restrict parser, _Inout_ unsigned long* const restrict size
+) {
+    http_request_t request = { .transport = &winhttp_transport, .status = 0, .handles = handles };
+    return transport_read_stream(&request, parser, size);
 }
@@ -0,0 +1,582 @@
+#include <project.h>
+
+// a streaming DEFLATE (RFC 1951) decoder, with the zlib (RFC 1950) and gzip (RFC 1952) wrappers, for transports that don't decompress
+// responses themselves. compressed bytes are pushed in whatever pieces the network delivers them and the decoded bytes are handed to a
+// sink as soon as they leave the 32 KiB window, so a compressed page streams into the parser without ever being inflated into a buffer
+// of its own. the decoder never blocks on input: a symbol (or a whole length/distance pair) is decoded on a copy of the bit buffer and
+// committed only once all its bits are there, otherwise the state is saved and decoding picks up where it left off on the next push.
+
+#define WINDOW_MASK    (INFLATE_WINDOW_SIZE - 1)
+#define FAST_MASK      ((1LLU << INFLATE_FAST_BITS) - 1)
+#define NEEDS_MORE     (-1) // returned by decode when the bit buffer runs out mid-code
+#define INVALID_CODE   (-2) // returned by decode for bit patterns no symbol has
+
+#define GZIP_FLAG_HCRC    0x02
+#define GZIP_FLAG_EXTRA   0x04
+#define GZIP_FLAG_NAME    0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+// the states follow the order of the stream, most of them fall through to the next one
+enum {
+    STATE_HEADER,
+    STATE_GZIP_MTIME,
+    STATE_GZIP_EXTRA_LENGTH,
+    STATE_GZIP_EXTRA,
+    STATE_GZIP_NAME,
+    STATE_GZIP_COMMENT,
+    STATE_GZIP_HCRC,
+    STATE_BLOCK,
+    STATE_STORED_LENGTH,
+    STATE_STORED,
+    STATE_TABLE_SIZES,
+    STATE_CODELENGTH_LENGTHS,
+    STATE_CODE_LENGTHS,
+    STATE_CODES,
+    STATE_TRAILER,
+    STATE_TRAILER_SIZE,
+    STATE_DONE,
+    STATE_FAILED
+};
+
+static const uint16_t length_bases[29]     = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                               31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t  length_extras[29]    = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distance_bases[30]   = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                               193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t  distance_extras[30]  = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t  codelength_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// CRC-32 tables for slicing by 8, crc_tables[0] is the classic byte at a time table for the polynomial 0xEDB88320 and crc_tables[k] advances
+// a byte k positions further. built once, on the first decoder that gets set up
+static uint32_t crc_tables[8][256] = { 0 };
+
+static void __cdecl build_crc_tables(void) {
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        uint32_t crc = byte;
+        for (unsigned bit = 0; bit < 8; ++bit) crc = crc & 1 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+        crc_tables[0][byte] = crc;
+    }
+    for (unsigned k = 1; k < 8; ++k)
+        for (unsigned byte = 0; byte < 256; ++byte)
+            crc_tables[k][byte] = (crc_tables[k - 1][byte] >> 8) ^ crc_tables[0][crc_tables[k - 1][byte] & 0xFF];
+}
+
+#ifdef _WIN32
+static INIT_ONCE crc_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK build_crc_tables_once(_Inout_ PINIT_ONCE once, _Inout_opt_ PVOID parameter, _Inout_opt_ PVOID* context) {
+    build_crc_tables();
+    return TRUE;
+}
+    #define crc_tables_init() InitOnceExecuteOnce(&crc_once, build_crc_tables_once, NULL, NULL)
+#else
+    #include <pthread.h>
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+    #define crc_tables_init() pthread_once(&crc_once, build_crc_tables)
+#endif
+
+// 8 bytes per step through the sliced tables, the byte at a time loop was what capped gzip bodies at a third of zlib's speed
+static uint32_t __cdecl crc32_update(_In_ uint32_t crc, _In_ const unsigned char* restrict bytes, _In_ unsigned long size) {
+    crc = ~crc;
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint64_t word = 0;
+        memcpy(&word, bytes, sizeof(word));
+        word ^= crc;
+        crc   = crc_tables[7][word & 0xFF] ^ crc_tables[6][(word >> 8) & 0xFF] ^ crc_tables[5][(word >> 16) & 0xFF]
+            ^ crc_tables[4][(word >> 24) & 0xFF] ^ crc_tables[3][(word >> 32) & 0xFF] ^ crc_tables[2][(word >> 40) & 0xFF]
+            ^ crc_tables[1][(word >> 48) & 0xFF] ^ crc_tables[0][word >> 56];
+    }
+    while (size--) crc = crc_tables[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t __cdecl adler32_update(_In_ const uint32_t adler, _In_ const unsigned char* restrict bytes, _In_ unsigned long size) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16; // NOLINT(readability-isolate-declaration)
+    while (size) {
+        unsigned long stretch = size < 5552 ? size : 5552; // the most bytes b can sum before it may overflow 32 bits
+        size                 -= stretch;
+        while (stretch--) b += a += *bytes++;
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+
+static bool __cdecl fail(_Inout_ inflater_t* const restrict inflater, _In_ const wchar_t* const restrict reason) {
+    fwprintf_s(stderr, L"Error: corrupt compressed response body, %s.\n", reason);
+    inflater->state = STATE_FAILED;
+    return false;
+}
+
+// tops the bit buffer up to at least 56 bits, or as many as the pushed piece has left. the fast path loads 8 bytes at once and leaves the
+// bits past nbits holding the start of the next byte, which is harmless since the next load ORs the very same bits back in
+static inline void __cdecl refill(_Inout_ inflater_t* const restrict inflater) {
+    if (inflater->nbits >= 56) return;
+    if (inflater->input_end - inflater->input >= 8) {
+        uint64_t word = 0;
+        memcpy(&word, inflater->input, sizeof(word)); // little endian, like every target Windows runs on
+        inflater->bits    |= word << inflater->nbits;
+        inflater->input   += (63 - inflater->nbits) >> 3;
+        inflater->nbits   |= 56;
+        return;
+    }
+    while (inflater->nbits < 56 && inflater->input < inflater->input_end) {
+        inflater->bits  |= (uint64_t) *inflater->input++ << inflater->nbits;
+        inflater->nbits += 8;
+    }
+}
+
+// refills and reports whether count bits are available
+static inline bool __cdecl need(_Inout_ inflater_t* const restrict inflater, _In_ const unsigned count) {
+    if (inflater->nbits < count) refill(inflater);
+    return inflater->nbits >= count;
+}
+
+static inline unsigned __cdecl peek(_In_ const inflater_t* const restrict inflater, _In_ const unsigned count) {
+    return (unsigned) (inflater->bits & ((1LLU << count) - 1));
+}
+
+static inline void __cdecl drop(_Inout_ inflater_t* const restrict inflater, _In_ const unsigned count) {
+    inflater->bits  >>= count;
+    inflater->nbits  -= count;
+}
+
+// hands the bytes decoded since the last flush to the sink
+static bool __cdecl flush(_Inout_ inflater_t* const restrict inflater) {
+    const unsigned long size = inflater->position - inflater->flushed;
+    if (size) {
+        const unsigned char* const bytes = inflater->window + inflater->flushed;
+        if (inflater->format == INFLATE_GZIP) inflater->checksum = crc32_update(inflater->checksum, bytes, size);
+        if (inflater->format == INFLATE_ZLIB) inflater->checksum = adler32_update(inflater->checksum, bytes, size);
+        if (!inflater->sink(inflater->context, (const char*) bytes, size)) {
+            inflater->state = STATE_FAILED;
+            return false;
+        }
+    }
+    if (inflater->position == INFLATE_WINDOW_SIZE) inflater->position = 0;
+    inflater->flushed = inflater->position;
+    return true;
+}
+
+// builds the canonical Huffman code for the given code lengths. incomplete codes are accepted (a lone distance code is legal), the
+// missing bit patterns decode to INVALID_CODE
+static bool __cdecl build(_Inout_ huffman_t* const restrict huffman, _In_ const uint8_t* const restrict lengths, _In_ const unsigned count) {
+    uint16_t offsets[16] = { 0 }, next_codes[16] = { 0 }; // NOLINT(readability-isolate-declaration)
+
+    memset(huffman->count, 0, sizeof(huffman->count));
+    for (unsigned symbol = 0; symbol < count; ++symbol) huffman->count[lengths[symbol]]++;
+    huffman->count[0] = 0;
+
+    int left = 1; // bit patterns of the current length that no shorter code has claimed
+    for (unsigned length = 1; length < 16; ++length) {
+        left <<= 1;
+        left  -= huffman->count[length];
+        if (left < 0) return false; // over-subscribed
+    }
+
+    for (unsigned length = 1; length < 15; ++length) offsets[length + 1] = offsets[length] + huffman->count[length];
+    for (unsigned symbol = 0; symbol < count; ++symbol)
+        if (lengths[symbol]) huffman->symbols[offsets[lengths[symbol]]++] = (uint16_t) symbol;
+
+    unsigned code = 0;
+    for (unsigned length = 1; length < 16; ++length) {
+        code               = (code + huffman->count[length - 1]) << 1;
+        next_codes[length] = (uint16_t) code;
+    }
+
+    // codes go into the stream most significant bit first while the bit buffer is read from the least significant end, so the fast
+    // table is indexed by the reversed code, repeated for every value of the bits that follow a short code
+    memset(huffman->fast, 0, sizeof(huffman->fast));
+    for (unsigned symbol = 0; symbol < count; ++symbol) {
+        const unsigned length = lengths[symbol];
+        if (!length || length > INFLATE_FAST_BITS) continue;
+
+        unsigned reversed = 0;
+        for (unsigned bit = 0, forward = next_codes[length]++; bit < length; ++bit, forward >>= 1) reversed = reversed << 1 | (forward & 1);
+        for (unsigned index = reversed; index <= FAST_MASK; index += 1U << length) huffman->fast[index] = (uint16_t) (symbol << 4 | length);
+    }
+    return true;
+}
+
+// decodes the next symbol from a copy of the bit buffer, storing the length of its code. codes longer than INFLATE_FAST_BITS take the slow
+// path, walking the code one bit at a time against the number of codes of each length
+static inline int __cdecl decode(
+    _In_ const huffman_t* const restrict huffman, _In_ const uint64_t bits, _In_ const unsigned nbits, _Inout_ unsigned* const restrict length
+) {
+    const unsigned entry = huffman->fast[bits & FAST_MASK];
+    if (entry) {
+        if ((entry & 15) > nbits) return NEEDS_MORE;
+        *length = entry & 15;
+        return (int) (entry >> 4);
+    }
+
+    int code = 0, first = 0, index = 0; // NOLINT(readability-isolate-declaration)
+    for (unsigned bit = 1; bit < 16; ++bit) {
+        if (bit > nbits) return NEEDS_MORE;
+        code            |= (int) ((bits >> (bit - 1)) & 1);
+        const int count  = huffman->count[bit];
+        if (code - count < first) {
+            *length = bit;
+            return huffman->symbols[index + (code - first)];
+        }
+        index  += count;
+        first   = (first + count) << 1;
+        code  <<= 1;
+    }
+    return INVALID_CODE;
+}
+
+// the codes of a fixed Huffman block, RFC 1951 3.2.6
+static void __cdecl build_fixed(_Inout_ inflater_t* const restrict inflater) {
+    uint8_t* const lengths = inflater->lengths;
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    memset(lengths + 288, 5, 30);
+    (void) build(&inflater->literals, lengths, 288);
+    (void) build(&inflater->distances, lengths + 288, 30);
+}
+
+// copies a back reference inside the window. runs that don't overlap their source go through memmove, overlapping ones (distance < length,
+// a repeated pattern) have to be copied byte by byte
+static bool __cdecl copy_match(_Inout_ inflater_t* const restrict inflater, _In_ unsigned length, _In_ const unsigned distance) {
+    unsigned char* const window = inflater->window;
+
+    while (length) {
+        const unsigned long source = (inflater->position - distance) & WINDOW_MASK;
+        unsigned long       piece  = length;
+        if (piece > INFLATE_WINDOW_SIZE - inflater->position) piece = INFLATE_WINDOW_SIZE - inflater->position;
+        if (piece > INFLATE_WINDOW_SIZE - source) piece = INFLATE_WINDOW_SIZE - source;
+
+        if (source > inflater->position || inflater->position - source >= piece)
+            memmove(window + inflater->position, window + source, piece);
+        else
+            for (unsigned long i = 0; i < piece; ++i) window[inflater->position + i] = window[source + i];
+
+        inflater->position += piece;
+        length             -= (unsigned) piece;
+        if (inflater->position == INFLATE_WINDOW_SIZE && !flush(inflater)) return false;
+    }
+    return true;
+}
+
+// decodes the literals and matches of a Huffman block until its end of block code or until the input runs dry
+static bool __cdecl inflate_codes(_Inout_ inflater_t* const restrict inflater) {
+    for (;;) {
+        refill(inflater);
+        uint64_t bits   = inflater->bits;
+        unsigned nbits  = inflater->nbits, length = 0; // NOLINT(readability-isolate-declaration)
+        int      symbol = decode(&inflater->literals, bits, nbits, &length);
+        if (symbol < 0) return symbol == NEEDS_MORE || fail(inflater, L"invalid literal/length code");
+        bits  >>= length;
+        nbits  -= length;
+
+        if (symbol < 256) {
+            inflater->bits                         = bits;
+            inflater->nbits                        = nbits;
+            inflater->window[inflater->position++] = (unsigned char) symbol;
+            inflater->total++;
+            if (inflater->position == INFLATE_WINDOW_SIZE && !flush(inflater)) return false;
+            continue;
+        }
+
+        if (symbol == 256) {
+            inflater->bits  = bits;
+            inflater->nbits = nbits;
+            inflater->state = inflater->is_last_block ? STATE_TRAILER : STATE_BLOCK;
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) return fail(inflater, L"invalid length code");
+        if (nbits < length_extras[symbol]) return true;
+        const unsigned count   = length_bases[symbol] + (unsigned) (bits & ((1LLU << length_extras[symbol]) - 1));
+        bits                 >>= length_extras[symbol];
+        nbits                 -= length_extras[symbol];
+
+        symbol = decode(&inflater->distances, bits, nbits, &length);
+        if (symbol < 0) return symbol == NEEDS_MORE || fail(inflater, L"invalid distance code");
+        if (symbol >= 30) return fail(inflater, L"invalid distance code");
+        bits  >>= length;
+        nbits  -= length;
+        if (nbits < distance_extras[symbol]) return true;
+        const unsigned distance = distance_bases[symbol] + (unsigned) (bits & ((1LLU << distance_extras[symbol]) - 1));
+        if (distance > inflater->total) return fail(inflater, L"distance reaching before the start of the stream");
+
+        inflater->bits   = bits >> distance_extras[symbol];
+        inflater->nbits  = nbits - distance_extras[symbol];
+        inflater->total += count;
+        if (!copy_match(inflater, count, distance)) return false;
+    }
+}
+
+// runs the state machine over the pushed piece, returns false once the stream is beyond saving
+static bool __cdecl run(_Inout_ inflater_t* const restrict inflater) {
+    for (;;) switch (inflater->state) {
+        case STATE_HEADER :
+            if (inflater->format == INFLATE_GZIP) {
+                if (!need(inflater, 32)) return true;
+                if (peek(inflater, 24) != 0x088B1F) return fail(inflater, L"not a gzip stream");
+                inflater->header_flags = peek(inflater, 32) >> 24;
+                drop(inflater, 32);
+                inflater->state = STATE_GZIP_MTIME;
+            } else if (inflater->format == INFLATE_ZLIB) {
+                if (!need(inflater, 16)) return true;
+                const unsigned cmf = peek(inflater, 8), flags = peek(inflater, 16) >> 8; // NOLINT(readability-isolate-declaration)
+                // plenty of servers send a bare DEFLATE stream for Content-Encoding: deflate, a zlib header is recognizable by its check bits
+                if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (cmf << 8 | flags) % 31) {
+                    inflater->format   = INFLATE_RAW;
+                    inflater->checksum = 0;
+                    inflater->state    = STATE_BLOCK;
+                    continue;
+                }
+                if (flags & 0x20) return fail(inflater, L"preset dictionaries are not supported");
+                drop(inflater, 16);
+                inflater->state = STATE_BLOCK;
+                continue;
+            } else {
+                inflater->state = STATE_BLOCK;
+                continue;
+            }
+            [[fallthrough]];
+
+        case STATE_GZIP_MTIME : // MTIME, XFL and OS
+            if (!need(inflater, 48)) return true;
+            drop(inflater, 48);
+            inflater->state = STATE_GZIP_EXTRA_LENGTH;
+            [[fallthrough]];
+
+        case STATE_GZIP_EXTRA_LENGTH :
+            inflater->remaining = 0;
+            if (inflater->header_flags & GZIP_FLAG_EXTRA) {
+                if (!need(inflater, 16)) return true;
+                inflater->remaining = peek(inflater, 16);
+                drop(inflater, 16);
+            }
+            inflater->state = STATE_GZIP_EXTRA;
+            [[fallthrough]];
+
+        case STATE_GZIP_EXTRA :
+            for (; inflater->remaining; inflater->remaining--) {
+                if (!need(inflater, 8)) return true;
+                drop(inflater, 8);
+            }
+            inflater->state = STATE_GZIP_NAME;
+            [[fallthrough]];
+
+        case STATE_GZIP_NAME : // zero terminated, just like the comment
+        case STATE_GZIP_COMMENT :
+            for (; inflater->state != STATE_GZIP_HCRC; inflater->state++) {
+                if (!(inflater->header_flags & (inflater->state == STATE_GZIP_NAME ? GZIP_FLAG_NAME : GZIP_FLAG_COMMENT))) continue;
+                for (;;) {
+                    if (!need(inflater, 8)) return true;
+                    const unsigned byte = peek(inflater, 8);
+                    drop(inflater, 8);
+                    if (!byte) break;
+                }
+            }
+            [[fallthrough]];
+
+        case STATE_GZIP_HCRC :
+            if (inflater->header_flags & GZIP_FLAG_HCRC) {
+                if (!need(inflater, 16)) return true;
+                drop(inflater, 16);
+            }
+            inflater->state = STATE_BLOCK;
+            [[fallthrough]];
+
+        case STATE_BLOCK : {
+            if (!need(inflater, 3)) return true;
+            inflater->is_last_block = peek(inflater, 1);
+            const unsigned type     = peek(inflater, 3) >> 1;
+            drop(inflater, 3);
+
+            if (type == 1) {
+                build_fixed(inflater);
+                inflater->state = STATE_CODES;
+                continue;
+            }
+            if (type == 2) {
+                inflater->state = STATE_TABLE_SIZES;
+                continue;
+            }
+            if (type == 3) return fail(inflater, L"invalid block type");
+            drop(inflater, inflater->nbits & 7); // stored blocks start on a byte boundary
+            inflater->state = STATE_STORED_LENGTH;
+        }
+            [[fallthrough]];
+
+        case STATE_STORED_LENGTH :
+            if (!need(inflater, 32)) return true;
+            if (peek(inflater, 16) != (~(peek(inflater, 32) >> 16) & 0xFFFF)) return fail(inflater, L"stored block length mismatch");
+            inflater->remaining = peek(inflater, 16);
+            drop(inflater, 32);
+            inflater->state = STATE_STORED;
+            [[fallthrough]];
+
+        case STATE_STORED :
+            // whole bytes may still be sitting in the bit buffer, after them the block is copied straight from the input
+            for (; inflater->remaining && inflater->nbits >= 8; inflater->remaining--) {
+                inflater->window[inflater->position++] = (unsigned char) peek(inflater, 8);
+                inflater->total++;
+                drop(inflater, 8);
+                if (inflater->position == INFLATE_WINDOW_SIZE && !flush(inflater)) return false;
+            }
+            if (!inflater->nbits) inflater->bits = 0; // the input pointer moves on without it, stale look ahead bits would corrupt the next refill
+            while (inflater->remaining && inflater->input < inflater->input_end) {
+                unsigned long piece = inflater->remaining;
+                if (piece > (unsigned long) (inflater->input_end - inflater->input)) piece = (unsigned long) (inflater->input_end - inflater->input);
+                if (piece > INFLATE_WINDOW_SIZE - inflater->position) piece = INFLATE_WINDOW_SIZE - inflater->position;
+
+                memcpy(inflater->window + inflater->position, inflater->input, piece);
+                inflater->input     += piece;
+                inflater->position  += piece;
+                inflater->total     += piece;
+                inflater->remaining -= (unsigned) piece;
+                if (inflater->position == INFLATE_WINDOW_SIZE && !flush(inflater)) return false;
+            }
+            if (inflater->remaining) return true;
+            inflater->state = inflater->is_last_block ? STATE_TRAILER : STATE_BLOCK;
+            continue;
+
+        case STATE_TABLE_SIZES :
+            if (!need(inflater, 14)) return true;
+            inflater->nliterals    = peek(inflater, 5) + 257;
+            inflater->ndistances   = (peek(inflater, 10) >> 5) + 1;
+            inflater->ncodelengths = (peek(inflater, 14) >> 10) + 4;
+            drop(inflater, 14);
+            if (inflater->nliterals > 286 || inflater->ndistances > 30) return fail(inflater, L"too many length or distance codes");
+            memset(inflater->lengths, 0, 19);
+            inflater->index = 0;
+            inflater->state = STATE_CODELENGTH_LENGTHS;
+            [[fallthrough]];
+
+        case STATE_CODELENGTH_LENGTHS :
+            for (; inflater->index < inflater->ncodelengths; inflater->index++) {
+                if (!need(inflater, 3)) return true;
+                inflater->lengths[codelength_order[inflater->index]] = (uint8_t) peek(inflater, 3);
+                drop(inflater, 3);
+            }
+            // the code length code lives in literals until the literal/length code replaces it
+            if (!build(&inflater->literals, inflater->lengths, 19)) return fail(inflater, L"invalid code length code");
+            inflater->index = 0;
+            inflater->state = STATE_CODE_LENGTHS;
+            [[fallthrough]];
+
+        case STATE_CODE_LENGTHS :
+            while (inflater->index < inflater->nliterals + inflater->ndistances) {
+                unsigned length = 0;
+                refill(inflater);
+                const int symbol = decode(&inflater->literals, inflater->bits, inflater->nbits, &length);
+                if (symbol < 0) return symbol == NEEDS_MORE || fail(inflater, L"invalid code length code");
+
+                if (symbol < 16) {
+                    drop(inflater, length);
+                    inflater->lengths[inflater->index++] = (uint8_t) symbol;
+                    continue;
+                }
+
+                // 16 repeats the previous length 3 - 6 times, 17 and 18 write runs of 3 - 10 and 11 - 138 zeros
+                const unsigned extra = symbol == 16 ? 2 : symbol == 17 ? 3 : 7;
+                if (inflater->nbits < length + extra) return true;
+                drop(inflater, length);
+                const unsigned repeat = (symbol == 16 ? 3 : symbol == 17 ? 3 : 11) + peek(inflater, extra);
+                drop(inflater, extra);
+
+                if (symbol == 16 && !inflater->index) return fail(inflater, L"code length repeat without a previous length");
+                if (inflater->index + repeat > inflater->nliterals + inflater->ndistances) return fail(inflater, L"too many code lengths");
+                const uint8_t value = symbol == 16 ? inflater->lengths[inflater->index - 1] : 0;
+                memset(inflater->lengths + inflater->index, value, repeat);
+                inflater->index += repeat;
+            }
+            if (!inflater->lengths[256]) return fail(inflater, L"missing end of block code");
+            if (!build(&inflater->literals, inflater->lengths, inflater->nliterals)
+                || !build(&inflater->distances, inflater->lengths + inflater->nliterals, inflater->ndistances))
+                return fail(inflater, L"invalid literal/length or distance code");
+            inflater->state = STATE_CODES;
+            [[fallthrough]];
+
+        case STATE_CODES :
+            if (!inflate_codes(inflater)) return false;
+            if (inflater->state == STATE_CODES) return true; // out of input
+            continue;
+
+        case STATE_TRAILER :
+            drop(inflater, inflater->nbits & 7); // the trailer starts on a byte boundary
+            if (inflater->format == INFLATE_GZIP) { // CRC-32, then the size modulo 2^32, both little endian
+                if (!need(inflater, 32)) return true;
+                if (!flush(inflater)) return false;
+                if (peek(inflater, 32) != inflater->checksum) return fail(inflater, L"CRC-32 mismatch");
+                drop(inflater, 32);
+                inflater->state = STATE_TRAILER_SIZE;
+                continue;
+            }
+            if (inflater->format == INFLATE_ZLIB) { // Adler-32, big endian
+                if (!need(inflater, 32)) return true;
+                if (!flush(inflater)) return false;
+                const uint32_t adler = peek(inflater, 32);
+                drop(inflater, 32);
+                if ((adler >> 24 | (adler >> 8 & 0xFF00) | (adler << 8 & 0xFF0000) | adler << 24) != inflater->checksum)
+                    return fail(inflater, L"Adler-32 mismatch");
+            }
+            inflater->state = STATE_DONE;
+            continue;
+
+        case STATE_TRAILER_SIZE :
+            if (!need(inflater, 32)) return true;
+            if (peek(inflater, 32) != (uint32_t) inflater->total) return fail(inflater, L"size mismatch");
+            drop(inflater, 32);
+            inflater->state = STATE_DONE;
+            [[fallthrough]];
+
+        case STATE_DONE : // anything after the end of the stream is ignored
+            inflater->input = inflater->input_end;
+            return true;
+
+        default : return false;
+    }
+}
+
+[[nodiscard]] bool __cdecl inflater_init(
+    _Inout_ inflater_t* const restrict inflater, _In_ const inflate_format_t format, _In_ const http_sink_t sink, _Inout_opt_ void* const context
+) {
+    memset(inflater, 0, sizeof(*inflater));
+    inflater->sink     = sink;
+    inflater->context  = context;
+    inflater->format   = format;
+    inflater->state    = STATE_HEADER;
+    inflater->checksum = format == INFLATE_ZLIB ? 1 : 0; // Adler-32 starts at 1, CRC-32 at 0
+    if (format == INFLATE_GZIP) crc_tables_init();
+
+    inflater->window = malloc(INFLATE_WINDOW_SIZE);
+    if (!inflater->window) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        inflater->state = STATE_FAILED;
+        return false;
+    }
+    return true;
+}
+
+bool __cdecl inflater_push(_Inout_opt_ void* const inflater, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    inflater_t* const restrict self = inflater;
+    if (self->state == STATE_FAILED) return false;
+
+    self->input     = (const unsigned char*) chunk;
+    self->input_end = self->input + size;
+    // everything decoded from this piece goes to the sink before returning, the parser shouldn't lag behind the network
+    const trace_span_t span       = trace_begin("inflate", "http");
+    const bool         is_flushed = run(self) && flush(self);
+    trace_end(span, size, 0);
+    return is_flushed;
+}
+
+[[nodiscard]] bool __cdecl inflater_finish(_Inout_ inflater_t* const restrict inflater) {
+    const bool is_flushed = inflater->state != STATE_FAILED && flush(inflater);
+    const bool is_done    = inflater->state == STATE_DONE;
+    if (is_flushed && !is_done) fputws(L"Error: the compressed response body ended prematurely.\n", stderr);
+
+    free(inflater->window);
+    inflater->window = NULL;
+    return is_done;
+}
@@ -24,46 +24,171 @@
     return true;
 }
 
+// unaligned 8 byte load, compilers lower the memcpy into a single mov so an 8 character comparison costs one cmp instead of eight
+static inline uint64_t __cdecl load_word(_In_ const char* const restrict string) {
+    uint64_t word = 0;
+    memcpy(&word, string, sizeof(uint64_t));
+    return word;
+}
+
+// what follows "<a" in the download links, 41 chars -> 5 words and a trailing '/'
+static const char python_ftp_href[] = " href=\"https://www.python.org/ftp/python/";
+
+// expects a pointer to the character right after "<a"
+static inline bool __cdecl is_python_ftp_href(_In_ const char* const restrict tag) {
+    return load_word(tag) == load_word(python_ftp_href) && load_word(tag + 8) == load_word(python_ftp_href + 8) &&
+           load_word(tag + 16) == load_word(python_ftp_href + 16) && load_word(tag + 24) == load_word(python_ftp_href + 24) &&
+           load_word(tag + 32) == load_word(python_ftp_href + 32) && tag[40] == '/';
+}
+
+// the heading scan of locate_stable_releases_htmldiv, returns the offset of "<h2>Pre-releases</h2>" or size if there's none. the offset
+// where the stable releases start is stored in stable when "<h2>Stable Releases</h2>" comes first and stable is still 0
+static unsigned long __cdecl scan_headings(
+    _In_ const char* const restrict html, _In_ const unsigned long size, _Inout_ unsigned long* const restrict stable
+) {
+    // let scan_pair skip over everything that isn't a "<h" sequence. a heading starting in the last 9 bytes is too close to the end to hold
+    // "<h2>Stable" or "<h2>Pre-re", leaving them out keeps scan_pair from reading past html, which may be a mapped file that ends on a page
+    const unsigned long limit = size > 9 ? size - 9 : 0;
+    for (unsigned long i = scan_pair(html, 0, limit, '<', 'h'); i < limit; i = scan_pair(html, i + 1, limit, '<', 'h')) {
+        // if the text matches the <h2> tag, html[i + 2] to html[i + 9] is either "2>Stable" or "2>Pre-re", a single word each
+        const uint64_t heading = load_word(html + i + 2);
+
+        // <h2>Stable Releases</h2>
+        if (*stable == 0 && heading == load_word("2>Stable")) {
+            // the HTML body contains only a single <h2> tag with an inner text that starts with "Stable"
+            // so ignoring the " Releases</h2> part for cycle trimming.
+            // if the start offset has already been found, do not waste time in this body in subsequent
+            // iterations -> short circuiting with the first conditional.
+            *stable = (i + 24);
+        }
+
+        // <h2>Pre-releases</h2>
+        // the HTML body contains only a single <h2> tag with an inner text that starts with "Pre"
+        // so ignoring the "leases</h2> part for cycle trimming.
+        if (heading == load_word("2>Pre-re")) return i;
+    }
+    return size;
+}
+
 // return the offset of the buffer where the stable releases start.
 [[nodiscard]] range_t __cdecl locate_stable_releases_htmldiv(_In_ const char* const restrict html, _In_ const unsigned long size) {
     range_t delimiters = { .begin = 0, .end = 0 };
     if (!html) return delimiters;
 
-    unsigned long start = 0, end = 0; // NOLINT(readability-isolate-declaration)
-
-    for (unsigned long i = 0; i < size; ++i) {
-        // if the text matches the <h2> tag,
-        if (html[i] == '<' && html[i + 1] == 'h' && html[i + 2] == '2' && html[i + 3] == '>') {
-            // <h2>Stable Releases</h2>
-            if (start == 0 && html[i + 4] == 'S' && html[i + 5] == 't' && html[i + 6] == 'a' && html[i + 7] == 'b' && html[i + 8] == 'l' &&
-                html[i + 9] == 'e') {
-                // the HTML body contains only a single <h2> tag with an inner text that starts with "Stable"
-                // so ignoring the " Releases</h2> part for cycle trimming.
-                // if the start offset has already been found, do not waste time in this body in subsequent
-                // iterations -> short circuiting with the first conditional.
-                start = (i + 24);
-            }
+    const trace_span_t  span        = trace_begin("locate", "parse");
+    const unsigned long prereleases = scan_headings(html, size, &delimiters.begin);
+    if (prereleases < size) delimiters.end = prereleases - 1;
 
-            // <h2>Pre-releases</h2>
-            if (html[i + 4] == 'P' && html[i + 5] == 'r' && html[i + 6] == 'e' && html[i + 7] == '-' && html[i + 8] == 'r' &&
-                html[i + 9] == 'e') {
-                // the HTML body contains only a single <h2> tag with an inner text that starts with "Pre"
-                // so ignoring the "leases</h2> part for cycle trimming.
-                end = (i - 1);
-                // if found, break out of the loop.
-                break;
-            }
+    trace_end(span, delimiters.end ? delimiters.end : size, 0); // the bytes scanned
+    return delimiters;
+}
+
+[[nodiscard]] range_t __cdecl locate_stable_releases_view(_In_ const body_slice_t* const restrict slices, _In_ const unsigned long count) {
+    range_t            delimiters      = { .begin = 0, .end = 0 };
+    char               seam[2 * 9]     = { 0 }; // a heading starting in the last 9 bytes of a slice ends in the next one
+    unsigned long      base            = 0;     // offset of the slice in the body
+    const trace_span_t span            = trace_begin("locate", "parse");
+
+    for (unsigned long k = 0; k < count; base += slices[k++].size) {
+        unsigned long       stable      = 0;
+        const unsigned long prereleases = scan_headings(slices[k].data, slices[k].size, &stable);
+        if (stable && !delimiters.begin) delimiters.begin = base + stable;
+        if (prereleases < slices[k].size) {
+            delimiters.end = base + prereleases - 1;
+            break;
+        }
+        if (k + 1 == count) break;
+
+        const unsigned long tail      = slices[k].size < 9 ? slices[k].size : 9;
+        const unsigned long head      = slices[k + 1].size < 9 ? slices[k + 1].size : 9;
+        const unsigned long seam_base = base + slices[k].size - tail;
+        memcpy(seam, slices[k].data + slices[k].size - tail, tail);
+        memcpy(seam + tail, slices[k + 1].data, head);
+
+        stable                         = 0;
+        const unsigned long straddling = scan_headings(seam, tail + head, &stable);
+        if (stable && !delimiters.begin) delimiters.begin = seam_base + stable;
+        if (straddling < tail + head) {
+            delimiters.end = seam_base + straddling - 1;
+            break;
         }
     }
 
-    delimiters.begin = start;
-    delimiters.end   = end;
-
+    trace_end(span, delimiters.end ? delimiters.end : base, 0); // the bytes scanned
     return delimiters;
 }
 
+// target template -> <a href="https://www.python.org/ftp/python/3.10.11/python-3.10.11-amd64.exe">
+// examines the anchor tag starting at html[i] and returns the kind of release artifact it links to, ARTIFACT_NONE if it isn't one, storing the
+// offsets of the version and url strings in version and url. the url is walked once, up to its closing quote but not past end: the version
+// ends at the first forward slash and every byte also advances the artifact automaton, which is left in a state that knows which rule suffix
+// the url ends with. a version that isn't followed by a forward slash within 15 chars is not considered a release.
+static inline artifact_kind_t __cdecl match_release(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long i,
+    _In_ const unsigned long end,
+    _In_ const artifact_automaton_t* const restrict automaton,
+    _Inout_ range_t* const restrict version,
+    _Inout_ range_t* const restrict url
+) {
+    if (!is_python_ftp_href(html + i + 2)) return ARTIFACT_NONE;
+
+    // targetting <a> tags in the form href="https://www.python.org/ftp/python/ ...>
+    url->begin     = i + 9;  // ...https://www.python.org/ftp/python/.....
+    version->begin = i + 43; // ...3.10.11/python-3.10.11-amd64.exe.....
+    version->end   = 0;
+
+    unsigned state = 0;
+    for (unsigned long j = version->begin; j < end; ++j) {
+        const unsigned char character = (unsigned char) html[j];
+
+        if (!version->end) {
+            if (j == version->begin + 15) return ARTIFACT_NONE;
+            if (character == '/') version->end = j; // ...3.10.11/....
+        }
+        if (character == '"') {
+            url->end = j;
+            return version->end ? (artifact_kind_t) automaton->accept[state] : ARTIFACT_NONE;
+        }
+        state = automaton->next[state][automaton->classes[character]];
+    }
+
+    return ARTIFACT_NONE;
+}
+
+// a range of a buffer as a span, response buffers stay well below 4 GiB
+static inline span_t __cdecl as_span(_In_ const range_t range) {
+    return (span_t) { .offset = (uint32_t) range.begin, .length = (uint32_t) (range.end - range.begin) };
+}
+
+[[nodiscard]] bool __cdecl parse_releases_between(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long begin,
+    _In_ const unsigned long end,
+    _In_ const unsigned long size,
+    _Inout_ results_t* const restrict results
+) {
+    // start and end offsets of the version and url strings.
+    range_t version = { .begin = 0, .end = 0 }, url = { .begin = 0, .end = 0 }; // NOLINT(readability-isolate-declaration)
+
+    const artifact_automaton_t* const automaton = artifact_automaton();
+
+    // scan_pair jumps straight to the next "<a" so the body below only runs on actual anchor tags. it looks at the byte after a candidate,
+    // which must still be in html, an anchor in the last byte couldn't link anywhere anyway
+    const unsigned long last = end < size ? end : size ? size - 1 : 0;
+    for (unsigned long i = scan_pair(html, begin, last, '<', 'a'); i < last; i = scan_pair(html, i + 1, last, '<', 'a')) {
+        const artifact_kind_t kind = match_release(html, i, i + STREAM_LOOKAHEAD < size ? i + STREAM_LOOKAHEAD : size, automaton, &version, &url);
+        if (kind == ARTIFACT_NONE) continue; // if the link is not a release artifact,
+
+        if (!results_push(results, as_span(version), as_span(url), kind)) [[unlikely]]
+            return false; // results_push will do the error reporting
+    }
+
+    return true;
+}
+
 [[nodiscard]] results_t __cdecl parse_stable_releases(_In_ const char* const restrict html, _In_ const unsigned long size) {
-    results_t results = { .begin = NULL, .capacity = 0, .count = 0 };
+    results_t results = { .text = NULL, .versions = NULL, .downloadurls = NULL, .kinds = NULL, .count = 0, .capacity = 0, .arena = NULL };
 
     // if the chunk is NULL or size is 0,
     if (!html || !size) {
@@ -71,122 +196,225 @@
         return results;
     }
 
-    python_t* releases = malloc(sizeof(python_t) * N_PYTHON_RELEASES);
-    if (!releases) [[unlikely]] {
+    // the spans point straight into html, nothing gets copied
+    if (!results_init(&results, html, RESULTS_INITIAL_CAPACITY)) [[unlikely]]
+        return results; // results_init will do the error reporting
+
+    // (size - 100) to prevent reading past the buffer.
+    const trace_span_t span = trace_begin("parse", "parse");
+    if (!parse_releases_between(html, 0, size > 100 ? size - 100 : 0, size, &results)) [[unlikely]]
+        results_release(&results);
+    trace_end(span, size, results.count);
+
+    return results;
+}
+
+// the files table of a release page lists a file per row, the checksum a few cells after the link:
+// <tr><td><a href="https://www.python.org/ftp/python/3.13.0/python-3.13.0-amd64.exe">Windows installer (64-bit)</a></td><td>Windows</td>
+// <td>Recommended</td><td>b3f5b8ea2e2de6d0bd2e5d0a9d5c8f4e</td><td>27428176</td><td><a href="...amd64.exe.asc">SIG</a></td>...</tr>
+// so every ftp link is followed to the end of its row, and a cell holding nothing but 32 or 64 hex digits is its checksum. a row with both
+// an MD5 and a SHA-256 column gets the SHA-256. links without a checksum in their row, the signatures and SBOMs, are skipped
+[[nodiscard]] unsigned long __cdecl parse_release_files(
+    _In_ const char* const restrict html,
+    _In_ const unsigned long size,
+    _Inout_ release_file_t* const restrict files,
+    _In_ const unsigned long capacity
+) {
+    unsigned long count = 0;
+    if (!html) return 0;
+
+    for (unsigned long i = scan_pair(html, 0, size, '<', 'a'); i + 43 < size && count < capacity; i = scan_pair(html, i + 1, size, '<', 'a')) {
+        if (!is_python_ftp_href(html + i + 2)) continue;
+        const char* const quote = memchr(html + i + 9, '"', size - i - 9);
+        if (!quote) break;
+
+        span_t digest = { .offset = 0, .length = 0 };
+        for (const char* cell = memchr(quote, '<', html + size - quote); cell && cell + 4 < html + size;
+             cell             = memchr(cell + 1, '<', html + size - cell - 1)) {
+            if (!memcmp(cell, "</tr", 4) || !memcmp(cell, "<tr", 3)) break; // the end of the row, or of a row that never was closed
+            if (memcmp(cell, "<td>", 4)) continue;
+
+            const char* digits = cell + 4;
+            while (digits < html + size && ((*digits >= '0' && *digits <= '9') || (*digits >= 'a' && *digits <= 'f'))) ++digits;
+            const uint32_t length      = (uint32_t) (digits - cell - 4);
+            const bool     is_closed   = digits < html + size && *digits == '<'; // nothing but the digits in the cell
+            const bool     is_checksum = is_closed && (length == 2 * DIGEST_MD5_SIZE || length == 2 * DIGEST_SHA256_SIZE);
+            if (is_checksum && length > digest.length) digest = (span_t) { .offset = (uint32_t) (cell + 4 - html), .length = length };
+        }
+        if (!digest.length) continue;
+
+        files[count++] = (release_file_t) {
+            .url = { .offset = (uint32_t) (i + 9), .length = (uint32_t) (quote - html - i - 9) },
+            .digest = digest
+        };
+    }
+
+    return count;
+}
+
+[[nodiscard]] bool __cdecl stream_parser_init(_Inout_ stream_parser_t* const restrict parser) {
+    memset(parser, 0, sizeof(stream_parser_t));
+
+    // the STREAM_LOOKAHEAD bytes past the window are zeroed when the stream ends, so matches close to the end of the body see zeroes just
+    // like they did in the zeroed 2 MiB buffer responses used to be read into
+    parser->staging = malloc(STREAM_STAGING_SIZE + STREAM_LOOKAHEAD);
+    if (!parser->staging) [[unlikely]] {
         fputws(L"Error: memory allocation error inside " __FUNCTIONW__ "\n", stderr);
-        return results;
+        return false;
     }
-    memset(releases, 0, sizeof(python_t) * N_PYTHON_RELEASES);
 
-    unsigned long last_write = 0; // counter to remember last deserialized struct.
+    // the window slides, so the parser's results keep their own copy of the bytes they refer to
+    if (!results_init(&parser->results, NULL, RESULTS_INITIAL_CAPACITY)) [[unlikely]] {
+        free(parser->staging);
+        memset(parser, 0, sizeof(stream_parser_t));
+        return false;
+    }
 
-    // start and end offsets of the version and url strings.
-    unsigned long url_begin = 0, url_end = 0, version_begin = 0, version_end = 0; // NOLINT(readability-isolate-declaration)
+    return true;
+}
 
-    // target template -> <a href="https://www.python.org/ftp/python/3.10.11/python-3.10.11-amd64.exe">
+// appends a release to the parser's results. only the url is copied out of the window, the version is a part of it
+static bool __cdecl stream_parser_push(
+    _Inout_ stream_parser_t* const restrict parser,
+    _In_ const char* const restrict window,
+    _In_ const range_t version,
+    _In_ const range_t url,
+    _In_ const artifact_kind_t kind
+) {
+    uint32_t offset = 0;
+    if (!results_intern(&parser->results, window + url.begin, url.end - url.begin, &offset)) [[unlikely]]
+        return false;
 
-    // stores whether the release in an -amd64.exe format release (for x86-64 AMD platforms)
-    // needed since other release types like arm64, amd32, zip files have similarly formatted urls that differ only at the end.
-    bool is_amd64 = false;
+    const span_t downloadurl = { .offset = offset, .length = (uint32_t) (url.end - url.begin) };
+    const span_t release     = { .offset = offset + (uint32_t) (version.begin - url.begin), .length = (uint32_t) (version.end - version.begin) };
+    return results_push(&parser->results, release, downloadurl, kind);
+}
 
-    // (size - 100) to prevent reading past the buffer.
-    for (unsigned long i = 0; i < size - 100; ++i) {
-        // targetting <a ....> tags
-        if (html[i] == '<' && html[i + 1] == 'a') {
-            if (html[i + 2] == ' ' && html[i + 3] == 'h' && html[i + 4] == 'r' && html[i + 5] == 'e' && html[i + 6] == 'f' &&
-                html[i + 7] == '=' && html[i + 8] == '"' && html[i + 9] == 'h' && html[i + 10] == 't' && html[i + 11] == 't' &&
-                html[i + 12] == 'p' && html[i + 13] == 's' && html[i + 14] == ':' && html[i + 15] == '/' && html[i + 16] == '/' &&
-                html[i + 17] == 'w' && html[i + 18] == 'w' && html[i + 19] == 'w' && html[i + 20] == '.' && html[i + 21] == 'p' &&
-                html[i + 22] == 'y' && html[i + 23] == 't' && html[i + 24] == 'h' && html[i + 25] == 'o' && html[i + 26] == 'n' &&
-                html[i + 27] == '.' && html[i + 28] == 'o' && html[i + 29] == 'r' && html[i + 30] == 'g' && html[i + 31] == '/' &&
-                html[i + 32] == 'f' && html[i + 33] == 't' && html[i + 34] == 'p' && html[i + 35] == '/' && html[i + 36] == 'p' &&
-                html[i + 37] == 'y' && html[i + 38] == 't' && html[i + 39] == 'h' && html[i + 40] == 'o' && html[i + 41] == 'n' &&
-                html[i + 42] == '/') {
-                // targetting <a> tags in the form href="https://www.python.org/ftp/python/ ...>
-                url_begin     = i + 9;  // ...https://www.python.org/ftp/python/.....
-                version_begin = i + 43; // ...3.10.11/python-3.10.11-amd64.exe.....
-
-                for (unsigned j = version_begin; j < version_begin + 15; ++j) { // check 15 chars downstream for the next forward slash
-                    if (html[j] == '/') {                                       // ...3.10.11/....
-                        version_end = j;
-                        break;
-                    }
-                }
-
-                // it'll be more efficient to selectively examine only the -amd64.exe releases! but the token needed to evaluate this occurs at the end of the url! YIKES!
-
-                // the above equality checks will pass even for non -amd64.exe releases, so check the url's end for -amd64.exe
-                // ...3.10.11/python-3.10.11-amd64.exe.....
-                // (8 + versionend - versionbegin) will help us jump directly to -amd.exe
-                // a stride of 8 bytes to skip over "/python-"
-                // a stride of (versionend - versionbegin) bytes to skip over "3.10.11"
-
-                // NOLINTNEXTLINE(readability-identifier-length)
-                for (unsigned k = version_end + 8 + version_end - version_begin; k < version_end + 8 + version_end - version_begin + 20;
-                     ++k) {
-                    // ...-amd64.exe...
-                    if (html[k] == 'a' && html[k + 1] == 'm' && html[k + 2] == 'd' && html[k + 3] == '6' && html[k + 4] == '4' &&
-                        html[k + 5] == '.' && html[k + 6] == 'e' && html[k + 7] == 'x' && html[k + 8] == 'e') {
-                        url_end  = k + 9;
-                        is_amd64 = true;
-                        break;
-                    }
-                }
+// examines everything in the staging window that can be decided with the bytes at hand, then discards the bytes no caret needs anymore.
+// this reproduces what locate_stable_releases_htmldiv followed by parse_stable_releases do on the whole body:
+// headings need 10 bytes to be classified and an anchor needs STREAM_LOOKAHEAD bytes past its '<'. parse_stable_releases ignores anchors in the
+// last 100 bytes before <h2>Pre-releases</h2>, so the anchor caret trails the heading caret by 101 bytes and only releases that are known to
+// sit before that cut off get parsed. on the final call, the bytes past the end of the stream read as zeroes.
+static void __cdecl stream_parser_scan(_Inout_ stream_parser_t* const restrict parser, _In_ const bool is_final) {
+    const char* const restrict window     = parser->staging;
+    const unsigned long long   base       = parser->base;
+    const unsigned long long   stream_end = base + parser->filled;
+
+    if (!parser->stable_end) {
+        const unsigned long heading_limit = parser->filled > 9 ? parser->filled - 9 : 0;
+
+        for (unsigned long i = scan_pair(window, (unsigned long) (parser->heading_caret - base), heading_limit, '<', 'h'); i < heading_limit;
+             i       = scan_pair(window, i + 1, heading_limit, '<', 'h')) {
+            const uint64_t heading = load_word(window + i + 2);
+
+            // <h2>Stable Releases</h2>, releases before it were only parsed in case the page has no such heading, drop them
+            if (!parser->stable_begin && heading == load_word("2>Stable")) {
+                parser->stable_begin       = base + i + 24;
+                parser->results.count      = 0;
+                parser->results.arena_size = 0;
+                if (parser->anchor_caret < parser->stable_begin) parser->anchor_caret = parser->stable_begin;
             }
 
-            if (!is_amd64) continue; // if the release is not an -amd64.exe release,
+            // <h2>Pre-releases</h2>
+            if (heading == load_word("2>Pre-re")) {
+                parser->stable_end = base + i;
+                break;
+            }
+        }
 
-            // deserialize the chars representing the release version to the struct's version field.
-            memcpy_s((releases[last_write]).version, PYTHON_VERSION_STRING_LENGTH, html + version_begin, version_end - version_begin);
-            // deserialize the chars representing the release url to the struct's downloadurl field.
-            memcpy_s((releases[last_write]).downloadurl, PYTHON_DOWNLOAD_URL_LENGTH, html + url_begin, url_end - url_begin);
+        if (parser->stable_end)
+            parser->heading_caret = parser->stable_end;
+        else if (parser->heading_caret < base + heading_limit)
+            parser->heading_caret = base + heading_limit;
+    }
 
-            last_write++; // move the write caret
-            results.count++;
-            // NOLINTNEXTLINE(readability-implicit-bool-conversion) reset the flag & offsets.
-            is_amd64 = url_begin = url_end = version_begin = version_end = 0;
+    unsigned long long anchor_limit = is_final ? stream_end : (stream_end > STREAM_LOOKAHEAD ? stream_end - STREAM_LOOKAHEAD : 0);
+    const unsigned long long cutoff       = parser->stable_end ? parser->stable_end : parser->heading_caret;
+    const unsigned long long cutoff_limit = cutoff > 101 ? cutoff - 101 : 0;
+    if (anchor_limit > cutoff_limit) anchor_limit = cutoff_limit;
+
+    if (parser->anchor_caret < anchor_limit) {
+        // start and end offsets of the version and url strings.
+        range_t version = { .begin = 0, .end = 0 }, url = { .begin = 0, .end = 0 }; // NOLINT(readability-isolate-declaration)
+        const unsigned long               limit     = (unsigned long) (anchor_limit - base);
+        const artifact_automaton_t* const automaton = artifact_automaton();
+
+        // every anchor below limit has STREAM_LOOKAHEAD bytes after it in the window, zeroes past the end of the stream
+        for (unsigned long i = scan_pair(window, (unsigned long) (parser->anchor_caret - base), limit, '<', 'a'); i < limit;
+             i       = scan_pair(window, i + 1, limit, '<', 'a')) {
+            const artifact_kind_t kind = match_release(window, i, i + STREAM_LOOKAHEAD, automaton, &version, &url);
+            if (kind == ARTIFACT_NONE) continue;
+            if (!stream_parser_push(parser, window, version, url, kind)) [[unlikely]] {
+                parser->is_done = true;
+                results_release(&parser->results);
+                return;
+            }
         }
+        parser->anchor_caret = anchor_limit;
     }
 
-    return (results_t) { .begin = releases, .capacity = N_PYTHON_RELEASES, .count = last_write };
+    // releases found before the stable releases heading only count if <h2>Pre-releases</h2> shows up first
+    if (parser->stable_begin || parser->stable_end) parser->emitted = parser->results.count;
+    if (parser->stable_end && parser->anchor_caret >= cutoff_limit) parser->is_done = true;
+
+    // keep only the bytes the trailing caret still has to look at
+    unsigned long long keep = parser->stable_end || parser->heading_caret > parser->anchor_caret ? parser->anchor_caret : parser->heading_caret;
+    if (parser->is_done || keep > stream_end) keep = stream_end;
+    parser->filled = (unsigned long) (stream_end - keep);
+    memmove(parser->staging, window + (keep - base), parser->filled);
+    parser->base = keep;
 }
 
-void __cdecl print(_In_ const results_t results, _In_ const char* const restrict syspyversion) {
-    // if somehow the system cannot find the installed python version, and an empty buffer is returned,
-    const bool is_unavailable = !syspyversion; // NOLINT(readability-implicit-bool-conversion)
+unsigned long __cdecl stream_parser_feed(
+    _Inout_ stream_parser_t* const restrict parser, _In_ const char* const restrict chunk, _In_ const unsigned long size
+) {
+    const unsigned long emitted = parser->emitted;
+    const trace_span_t  span    = trace_begin("parse", "parse");
+
+    for (unsigned long consumed = 0, take = 0; consumed < size && !parser->is_done; consumed += take) { // NOLINT(readability-isolate-declaration)
+        take = size - consumed;
+        if (take > STREAM_STAGING_SIZE - parser->filled) take = STREAM_STAGING_SIZE - parser->filled;
+        memcpy(parser->staging + parser->filled, chunk + consumed, take);
+        parser->filled += take;
+        stream_parser_scan(parser, false);
+    }
 
-    // if the buffer is empty don't bother with these...
-    if (!is_unavailable) [[unlikely]] {
-        char version_number[BUFF_SIZE] = { 0 };
+    trace_end(span, size, parser->emitted - emitted);
+    return parser->emitted - emitted;
+}
 
-        for (unsigned long i = 7; i < BUFF_SIZE; ++i) {
-            // ASCII '0' to '9' is 48 to 57 and '.' is 46 ('/' is 47)
-            // syspyversion will be in the form of "Python 3.10.5"
-            // version number starts after offset 7. (@ 8)
-            if ((syspyversion[i] >= 46) && (syspyversion[i] <= 57)) version_number[i - 7] = syspyversion[i];
-            // if any other characters encountered,
-            else
-                break;
-        }
+[[nodiscard]] results_t __cdecl stream_parser_finish(_Inout_ stream_parser_t* const restrict parser) {
+    if (!parser->is_done && parser->staging) {
+        const unsigned long emitted = parser->emitted;
+        const trace_span_t  span    = trace_begin("parse", "parse");
+        memset(parser->staging + parser->filled, 0, STREAM_LOOKAHEAD);
+        stream_parser_scan(parser, true);
+        trace_end(span, parser->filled, parser->emitted - emitted);
+    }
 
-        _putws(L"-----------------------------------------------------------------------------------");
-        wprintf_s(L"|\x1b[36m%9s\x1b[m  |\x1b[36m%40s\x1b[m                             |\n", L"Version", L"Download URL");
-        _putws(L"-----------------------------------------------------------------------------------");
-        for (uint64_t i = 0; i < results.count; ++i)
-            if (!strcmp(version_number, results.begin[i].version)) // to highlight the system Python version
-                wprintf_s(L"|\x1b[35;47;1m   %-7S |  %-66S \x1b[m|\n", results.begin[i].version, results.begin[i].downloadurl);
-            else
-                wprintf_s(L"|\x1b[91m   %-7S \x1b[m| \x1b[32m %-66S \x1b[m|\n", results.begin[i].version, results.begin[i].downloadurl);
-        _putws(L"-----------------------------------------------------------------------------------");
-
-    } else { // do not bother with highlighting the installed version
-        _putws(L"-----------------------------------------------------------------------------------");
-        wprintf_s(L"|\x1b[36m%9s\x1b[m  |\x1b[36m%40s\x1b[m                             |\n", L"Version", L"Download URL");
-        _putws(L"-----------------------------------------------------------------------------------");
-        for (uint64_t i = 0; i < results.count; ++i)
-            wprintf_s(L"|\x1b[91m   %-7S \x1b[m| \x1b[32m %-66S \x1b[m|\n", results.begin[i].version, results.begin[i].downloadurl);
-        _putws(L"-----------------------------------------------------------------------------------");
+    free(parser->staging);
+    parser->staging = NULL;
+
+    if (!parser->stable_end) { // the whole stream went by without a <h2>Pre-releases</h2>
+        fputws(L"Error in " __FUNCTIONW__ " : could not find the stable releases section in the response!\n", stderr);
+        results_release(&parser->results);
     }
+
+    return parser->results;
+}
+
+void __cdecl stream_parser_discard(_Inout_ stream_parser_t* const restrict parser) {
+    free(parser->staging);
+    parser->staging = NULL;
+    results_release(&parser->results);
+}
+
+[[nodiscard]] results_t __cdecl parse_stable_releases_view(_In_ const body_slice_t* const restrict slices, _In_ const unsigned long count) {
+    stream_parser_t parser = { 0 };
+    if (!stream_parser_init(&parser)) return (results_t) { 0 }; // stream_parser_init will do the error reporting
+
+    for (unsigned long k = 0; k < count && !parser.is_done; ++k) (void) stream_parser_feed(&parser, slices[k].data, slices[k].size);
+    return stream_parser_finish(&parser);
 }
 
 [[nodiscard("entails expensive file io"
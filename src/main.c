@@ -1,45 +1,552 @@
 #include <project.h>
 
-int wmain(void) {
-    unsigned long response_size          = 0;
-    wchar_t       server[BUFF_SIZE]      = L"www.python.org";
-    wchar_t       accesspoint[BUFF_SIZE] = L"/downloads/windows/";
+#ifdef _WIN32
+    #define PATH_SEPARATOR    L"\\"
+    #define DEFAULT_TRANSPORT (&winhttp_transport)
+#else // the posix build of bench/Makefile, where there's no WinHttp
+    #include <locale.h>
+    #define PATH_SEPARATOR    L"/"
+    #define DEFAULT_TRANSPORT (&socket_transport)
+#endif
 
-    const hinternet_triple_t handles     = http_get(server, accesspoint);
+#define MAX_ACCESSPOINTS 8LLU // number of pages a single run can fetch
 
-    // read_http_response or read_http_response_ex will handle if handles are NULLs, no need for external error handling here.
-    const char* const restrict html_text = read_http_response_ex(handles, &response_size);
+// downloads the installers of the releases a version query picked, after they have been printed
+static bool __cdecl download_selected(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_ const query_t query,
+    _In_ const download_options_t* const restrict options
+) {
+    results_t matches = { 0 };
+    if (!select_releases(results, artifacts, query, &matches)) { // answer_query already said there was nothing to print
+        results_release(&matches);
+        return false;
+    }
+    const bool is_downloaded = download_releases(matches, options); // download_releases will do the error reporting
+    results_release(&matches);
+    return is_downloaded;
+}
 
-    // locate_stable_releases_htmldiv will handle NULL returns from read_http_response internally,
-    // so again no need for main to handle errors explicitly.
-    // in case of a NULL input, returned range will be {0, 0}.
-    const range_t stable_releases        = locate_stable_releases_htmldiv(html_text, HTTP_RESPONSE_SIZE); // works correctly :)
+// prints the releases of a page that are among the requested artifacts, or the answer to a version query about them, after saving all of
+// them to the snapshot file if one was asked for, and downloads the releases the query picked when told to. this is where the run waits for
+// the python probe, which ran alongside the fetch and parse
+static bool __cdecl publish(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const query_t query,
+    _In_opt_ const wchar_t* const restrict snapshot,
+    _In_ const download_options_t* const restrict download,
+    _Inout_ python_probe_t* const restrict probe
+) {
+    const bool        is_saved = !snapshot || snapshot_write(snapshot, results); // snapshot_write will do the error reporting
+    const char* const syspy    = python_probe_wait(probe);
+    // answer_query prints every release for QUERY_NONE, handles empty instances of syspy internally, and does the error reporting
+    if (!answer_query(results, artifacts, syspy, format, query)) return false;
+    return (!download->directory || download_selected(results, artifacts, query, download)) && is_saved;
+}
 
-    if (!stable_releases.begin && !stable_releases.end) {
-        fputws(L"Error: Call to locate_stable_releases_htmldiv failed!\n", stderr);
-        // __serialize(pszHtmlText, response_size, L"./response.gzip");
-        goto CLEANUP;
+// packs a version given on the command line, VERSION_KEY_INVALID if it isn't one
+static version_key_t __cdecl parse_version_argument(_In_ const wchar_t* const restrict argument) {
+    char          text[BUFF_SIZE] = { 0 };
+    unsigned long length          = 0;
+    for (; argument[length] && length < BUFF_SIZE; ++length) {
+        if (argument[length] > 0x7F) return VERSION_KEY_INVALID;
+        text[length] = (char) argument[length];
     }
+    return version_key(text, length);
+}
+
+// indexes the artifacts in the directory tree under root and prints them like crawl prints the releases of a page
+static bool __cdecl crawl_tree(
+    _In_ const ftp_options_t* const restrict options,
+    _In_ const wchar_t* const restrict root,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const query_t query,
+    _In_opt_ const wchar_t* const restrict snapshot,
+    _In_ const download_options_t* const restrict download,
+    _Inout_ python_probe_t* const restrict probe
+) {
+    ftp_options_t tree = *options;
+    tree.root          = root;
+    results_t index    = crawl_ftp(&tree); // crawl_ftp will do the error reporting
+    if (!index.versions) return false;
+    const bool is_published = publish(index, artifacts, format, query, snapshot, download, probe);
+    results_release(&index);
+    return is_published;
+}
+
+// parses a saved page straight from its mapping and prints it like crawl prints a live one
+static bool __cdecl crawl_file(
+    _In_ const wchar_t* const restrict filename,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const query_t query,
+    _In_opt_ const wchar_t* const restrict snapshot,
+    _In_ const download_options_t* const restrict download,
+    _Inout_ python_probe_t* const restrict probe
+) {
+    replay_t replay = { 0 };
+    if (!replay_map(filename, &replay)) return false; // replay_map will do the error reporting
+    results_t  results      = replay_parse(&replay); // the releases may borrow their text from the mapping
+    const bool is_published = results.versions && publish(results, artifacts, format, query, snapshot, download, probe);
+    results_release(&results);
+    replay_unmap(&replay);
+    return is_published;
+}
+
+// fetches and parses a single page from one server. with a cache directory the page is revalidated against the cached copy and a 304 Not
+// Modified response is served from the cache without reading or parsing anything. when recording, the page is always fetched in full and
+// written to the record file, status line and headers included, as it's parsed. returns the releases, NULL versions when the page couldn't
+// be fetched or has no stable releases. size and elapsed receive the bytes that came in and the microseconds the request took
+static results_t __cdecl fetch_page(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_opt_ const wchar_t* const restrict cache_directory,
+    _In_opt_ const wchar_t* const restrict record,
+    _Inout_ unsigned long* const restrict size,
+    _Inout_ unsigned long long* const restrict elapsed
+) {
+    stream_parser_t parser               = { 0 };
+    wchar_t         cache_file[MAX_PATH] = { 0 };
+    cached_page_t   cached               = { 0 };
+    http_request_t  request              = { 0 };
+    recorder_t      recorder             = { 0 };
+    results_t       failed               = { 0 };
 
-    const results_t parsed_results = parse_stable_releases(html_text + stable_releases.begin, stable_releases.end - stable_releases.begin);
+    // a 304 has no body to record
+    const bool is_cache_enabled = !record && cache_directory && cache_path(cache_directory, server, port, accesspoint, cache_file, MAX_PATH);
+    if (is_cache_enabled) cached = cache_load(cache_file); // a NULL cached.results.versions means there's nothing to revalidate
 
-    // may happen due to malloc failures or invalid inputs.
-    if (!parsed_results.begin) {
-        fputws(L"Error: Call to parse_stable_releases failed!\n", stderr);
-        goto CLEANUP;
+    if (!stream_parser_init(&parser)) { // stream_parser_init will do the error reporting
+        results_release(&cached.results);
+        return failed;
+    }
+    if (record && !record_open(record, &request, accesspoint, &parser, &recorder)) { // record_open will do the error reporting
+        stream_parser_discard(&parser);
+        results_release(&cached.results);
+        return failed;
     }
 
-    char syspy[BUFF_SIZE] = { 0 }; // system python
-    if (!get_system_python_version(syspy, BUFF_SIZE)) fputws(L"Error: Call to get_system_python_version failed!\n", stderr);
+    const unsigned long long begin = mirrors_clock();
+    request = transport_get_conditional(transport, server, port, accesspoint, cached.results.versions ? &cached.validators : NULL);
 
-    // print will handle empty instances of syspy internally.
-    print(parsed_results, syspy);
+    // transport_read_stream will handle failed requests, no need for external error handling here.
+    // the body is parsed chunk by chunk as it arrives, so there's no separate locate and parse step over a whole response buffer anymore.
+    bool is_read = record ? transport_read(&request, record_sink, &recorder, size) : transport_read_stream(&request, &parser, size);
+    if (record) is_read &= record_close(&recorder); // record_sink and record_close will do the error reporting
+    *elapsed = mirrors_clock() - begin;
 
-    free(html_text);
-    free(parsed_results.begin);
-    return EXIT_SUCCESS;
+    if (is_read && request.status == HTTP_STATUS_NOT_MODIFIED && cached.results.versions) {
+        stream_parser_discard(&parser); // nothing was fed to it
+        dbgwprintf_s(L"%s has not been modified, using the cached releases\n", accesspoint);
+        return cached.results;
+    }
+    results_release(&cached.results);
+
+    // stream_parser_finish must be called regardless, it releases the parser's buffers.
+    // may fail due to malloc failures or responses without a stable releases section.
+    results_t parsed_results = stream_parser_finish(&parser);
+
+    if (!is_read || !parsed_results.versions) {
+        fwprintf_s(stderr, L"Error: Call to transport_read_stream failed for %s:%u%s!\n", server, port, accesspoint);
+        results_release(&parsed_results);
+        return failed;
+    }
+
+    // without validators there's no way to revalidate the cached copy later, so don't bother storing one
+    if (is_cache_enabled && (*request.validators.etag || *request.validators.last_modified))
+        if (!cache_store(cache_file, &request.validators, parsed_results)) fputws(L"Warning: could not update the response cache!\n", stderr);
+    return parsed_results;
+}
+
+// fetches and parses a single page and prints its stable releases. the page is asked of the mirrors best ranked first, a mirror that can't
+// be reached or doesn't send a page with releases passes it on to the next one. every attempt is scored, see mirrors.c
+static bool __cdecl crawl(
+    _In_ const http_transport_t* const restrict transport,
+    _Inout_ mirrors_t* const restrict mirrors,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_opt_ const wchar_t* const restrict cache_directory,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const query_t query,
+    _In_opt_ const wchar_t* const restrict snapshot,
+    _In_opt_ const wchar_t* const restrict record,
+    _In_ const download_options_t* const restrict download,
+    _Inout_ python_probe_t* const restrict probe
+) {
+    results_t     results  = { 0 };
+    unsigned long attempts = 0;
+    for (; attempts < mirrors->count && !results.versions; ++attempts) {
+        mirror_t* const    mirror  = mirrors->hosts + mirrors->ranks[attempts];
+        unsigned long      size    = 0;
+        unsigned long long elapsed = 0;
+        if (attempts) fwprintf_s(stderr, L"Warning: failing over to the mirror %s:%u\n", mirror->server, mirror->port);
+        results = fetch_page(transport, mirror->server, mirror->port, accesspoint, cache_directory, record, &size, &elapsed);
+        mirrors_report(mirror, results.versions != NULL, size, elapsed);
+    }
+    // the mirror that won the race keeps the pages for as long as it serves them, one that failed makes way for the next page's sake
+    if (attempts > 1) mirrors_rank(mirrors);
+    if (!results.versions) return false; // fetch_page did the error reporting
+
+    const bool is_published = publish(results, artifacts, format, query, snapshot, download, probe);
+    results_release(&results);
+    return is_published;
+}
+
+// crawl.exe [--transport winhttp|socket|ring] [--server <host>|--mirror <host[:port]>...] [--port <port>] [--path <accesspoint>]...
+//           [--cache <directory>|--no-cache]
+//           [--artifact <kind>|all]... [--format table|json|ndjson|csv] [--exact <version>|--latest <major.minor>|--newest <version>|--outdated]
+//           [--snapshot <file>] [--download <directory> [--connections <n>]] [--stats] [--trace <file>]
+// crawl.exe [--transport winhttp|socket|ring] [--server <host>|--mirror <host[:port]>...] [--port <port>] [--path <accesspoint>]
+//           [--artifact <kind>|all]... [--format table|json|ndjson|csv] [--trace <file>] --watch [<seconds>]
+// crawl.exe --ftp [--jobs <n>] [--per-host <n>] [--delay <milliseconds>] [--transport winhttp|socket|ring]
+//           [--server <host>|--mirror <host[:port]>...] [--port <port>] [--path <directory>]... [--artifact <kind>|all]...
+//           [--format table|json|ndjson|csv] [--exact <version>|...|--outdated]
+//           [--snapshot <file>] [--download <directory> [--connections <n>]] [--stats] [--trace <file>]
+// crawl.exe --pythons
+// crawl.exe [--artifact <kind>|all]... [--format table|json|ndjson|csv] [--exact <version>|...|--outdated] --from-snapshot <file>
+// crawl.exe [--artifact <kind>|all]... [--format table|json|ndjson|csv] [--exact <version>|...|--outdated] [--snapshot <file>]
+//           [--download <directory> [--connections <n>]] [--stats] [--trace <file>] --from-file <file>
+// every link is classified in the one parse, --artifact only picks the kinds that get printed (amd64 unless told otherwise), see artifacts.c
+// --transport picks the HTTP client, WinHttp unless told otherwise. the posix build bench/Makefile makes has no WinHttp and starts from socket
+// --path can be repeated, the pages are then fetched one after the other over pooled keep-alive connections
+// --mirror can be repeated to fetch from the fastest of several servers (host, host:port or [address]:port, --port when it names none)
+// instead of --server. they race for the first page happy eyeballs style, the first to answer a HEAD request gets the pages and the others
+// take over in turn when it fails one. how fast every mirror answered and served pages is kept in a scoreboard next to the cache, the best
+// scored mirrors go first in the next run's race. --stats prints the scores, see mirrors.c
+// --format picks what the releases are printed as, the coloured table by default. with several --paths every page gets a JSON document
+// (or CSV header) of its own, ndjson doesn't care
+// pages are cached in the temporary directory unless told otherwise
+// --exact, --latest and --newest print only the releases of that version, of the newest patch of that major.minor and of the newest version
+// provided it is at least the one given. --outdated prints nothing but whether the system python has a newer patch release and fails when it
+// does, for policy checks. all of them are binary searches over the versions as sorted integer keys, see versions.c
+// --download saves the installers of the releases --exact, --latest or --newest picked into the directory, each over --connections (4 by
+// default) ranged requests at once. interrupted downloads resume where they stopped on the next run, see download.c. every file is checked
+// against the MD5 or SHA-256 checksum on its release page while it downloads, and thrown away when it doesn't match, see digest.c
+// --watch keeps polling the page (every 60 seconds by default, backing off while nothing changes) and prints only the releases that were
+// added or removed since the previous poll, until Ctrl+C. the connection stays warm in between, see watch.c
+// --ftp indexes every artifact in the /ftp/python/ directory tree (or the --paths) instead of the ones a downloads page links to, listing
+// --jobs directories at once (16 by default) with at most --per-host requests in flight to the server (8 by default) and --delay ms
+// between their starts, see ftp.c. the index is printed, queried, saved and downloaded from like the releases of a page. with --transport ring
+// and no --delay the workers make way for one completion driven engine that lists a whole level of the tree at once over up to --per-host
+// (1024 at most) connections, see ring.c
+// --pythons lists every python on PATH with its version, read from the metadata next to the interpreter whenever there is any, see pipes.c
+// --snapshot saves the releases of the (single) page to a binary snapshot that --from-snapshot prints without touching the network
+// --record saves the (single) page as it arrives, status line and headers first, and --from-file parses a page saved that way, by a browser
+// or by curl (-i), gzip'ed or not, without touching the network either. the file is mapped and parsed in place, see replay.c
+// --trace times every stage of the run (connect, first byte, transfer, inflate, locate, parse, the python probe, print) and writes the spans
+// to a Chrome trace event JSON file, open it in chrome://tracing or ui.perfetto.dev
+int wmain(_In_opt_ int argc, _In_opt_ wchar_t* argv[]) {
+    wchar_t                 server[BUFF_SIZE]                         = L"www.python.org";
+    wchar_t                 accesspoints[MAX_ACCESSPOINTS][BUFF_SIZE] = { L"/downloads/windows/" };
+    unsigned long           naccesspoints                             = 0;
+    unsigned short          port                                      = INTERNET_DEFAULT_HTTP_PORT;
+    const http_transport_t* transport                                 = DEFAULT_TRANSPORT;
+    bool                    is_stats_requested                        = false;
+    bool                    is_pythons_requested                      = false;
+    unsigned long           watch_interval                            = 0; // seconds, 0 unless --watch was given
+    bool                    is_ftp_requested                          = false;
+    unsigned long           jobs                                      = FTP_DEFAULT_JOBS;
+    unsigned long           per_host                                  = FTP_DEFAULT_PER_HOST;
+    unsigned long           delay                                     = 0;
+    wchar_t                 cache_directory[MAX_PATH]                 = { 0 };
+    wchar_t                 download_directory[MAX_PATH]              = { 0 };
+    unsigned long           connections                               = DOWNLOAD_CONNECTIONS;
+    const wchar_t*          snapshot                                  = NULL;
+    const wchar_t*          source_snapshot                           = NULL;
+    const wchar_t*          record                                    = NULL;
+    const wchar_t*          source_file                               = NULL;
+    const wchar_t*          trace                                     = NULL;
+    const wchar_t*          mirror_hosts[MIRROR_MAX_HOSTS]            = { 0 };
+    unsigned long           nmirrors                                  = 0;
+    mirrors_t               mirrors                                   = { 0 };
+    wchar_t                 scoreboard[MAX_PATH]                      = { 0 };
+    unsigned                artifacts                                 = 0;
+    output_format_t         format                                    = OUTPUT_TABLE;
+    query_t                 query                                     = { .kind = QUERY_NONE, .key = VERSION_KEY_INVALID };
+
+    // GetTempPathW returns a path ending with a separator, 0 on failures which leaves the cache disabled
+    if (!GetTempPathW(MAX_PATH, cache_directory)) fwprintf_s(stderr, L"Error %lu in GetTempPathW, caching disabled.\n", GetLastError());
+
+    for (int i = 1; i < argc; ++i) {
+        if (!wcscmp(argv[i], L"--transport") && i + 1 < argc) {
+            transport = find_transport(argv[++i]);
+            if (!transport) {
+                fwprintf_s(stderr, L"Error: unknown transport %s!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (!wcscmp(argv[i], L"--server") && i + 1 < argc)
+            wcscpy_s(server, BUFF_SIZE, argv[++i]);
+        else if (!wcscmp(argv[i], L"--mirror") && i + 1 < argc) {
+            if (nmirrors == MIRROR_MAX_HOSTS) {
+                fwprintf_s(stderr, L"Error: --mirror takes up to %llu mirrors!\n", MIRROR_MAX_HOSTS);
+                return EXIT_FAILURE;
+            }
+            mirror_hosts[nmirrors++] = argv[++i];
+        } else if (!wcscmp(argv[i], L"--port") && i + 1 < argc)
+            port = (unsigned short) _wtoi(argv[++i]);
+        else if (!wcscmp(argv[i], L"--path") && i + 1 < argc && naccesspoints < MAX_ACCESSPOINTS)
+            wcscpy_s(accesspoints[naccesspoints++], BUFF_SIZE, argv[++i]);
+        else if (!wcscmp(argv[i], L"--cache") && i + 1 < argc) {
+            wcscpy_s(cache_directory, MAX_PATH - 1, argv[++i]);
+            const size_t length = wcslen(cache_directory);
+            if (length && cache_directory[length - 1] != L'\\' && cache_directory[length - 1] != L'/')
+                wcscat_s(cache_directory, MAX_PATH, PATH_SEPARATOR);
+        } else if (!wcscmp(argv[i], L"--no-cache"))
+            *cache_directory = 0;
+        else if (!wcscmp(argv[i], L"--download") && i + 1 < argc) {
+            wcscpy_s(download_directory, MAX_PATH - 1, argv[++i]);
+            const size_t length = wcslen(download_directory);
+            if (length && download_directory[length - 1] != L'\\' && download_directory[length - 1] != L'/')
+                wcscat_s(download_directory, MAX_PATH, PATH_SEPARATOR);
+        } else if (!wcscmp(argv[i], L"--connections") && i + 1 < argc) {
+            connections = wcstoul(argv[++i], NULL, 10);
+            if (!connections || connections > DOWNLOAD_MAX_CONNECTIONS) {
+                fwprintf_s(stderr, L"Error: --connections takes 1 to %llu connections!\n", DOWNLOAD_MAX_CONNECTIONS);
+                return EXIT_FAILURE;
+            }
+        } else if (!wcscmp(argv[i], L"--artifact") && i + 1 < argc) {
+            const artifact_kind_t kind = find_artifact(argv[++i]);
+            if (kind == ARTIFACT_NONE && wcscmp(argv[i], L"all")) {
+                fwprintf_s(stderr, L"Error: unknown artifact kind %s!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            artifacts |= kind == ARTIFACT_NONE ? ARTIFACT_MASK_ALL : ARTIFACT_MASK(kind);
+        } else if (!wcscmp(argv[i], L"--format") && i + 1 < argc) {
+            format = find_output_format(argv[++i]);
+            if (format == OUTPUT_FORMATS) {
+                fwprintf_s(stderr, L"Error: unknown output format %s!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if ((!wcscmp(argv[i], L"--exact") || !wcscmp(argv[i], L"--latest") || !wcscmp(argv[i], L"--newest")) && i + 1 < argc) {
+            query.kind = argv[i][2] == L'e' ? QUERY_EXACT : argv[i][2] == L'l' ? QUERY_LATEST : QUERY_NEWEST;
+            query.key  = parse_version_argument(argv[++i]);
+            if (query.key == VERSION_KEY_INVALID) {
+                fwprintf_s(stderr, L"Error: %s is not a version!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (!wcscmp(argv[i], L"--outdated"))
+            query = (query_t) { .kind = QUERY_OUTDATED, .key = VERSION_KEY_INVALID };
+        else if (!wcscmp(argv[i], L"--snapshot") && i + 1 < argc)
+            snapshot = argv[++i];
+        else if (!wcscmp(argv[i], L"--from-snapshot") && i + 1 < argc)
+            source_snapshot = argv[++i];
+        else if (!wcscmp(argv[i], L"--record") && i + 1 < argc)
+            record = argv[++i];
+        else if (!wcscmp(argv[i], L"--from-file") && i + 1 < argc)
+            source_file = argv[++i];
+        else if (!wcscmp(argv[i], L"--pythons"))
+            is_pythons_requested = true;
+        else if (!wcscmp(argv[i], L"--watch")) { // the interval is optional
+            const bool is_interval_given = i + 1 < argc && argv[i + 1][0] >= L'0' && argv[i + 1][0] <= L'9';
+            watch_interval               = is_interval_given ? wcstoul(argv[++i], NULL, 10) : WATCH_DEFAULT_INTERVAL;
+            if (!watch_interval) {
+                fputws(L"Error: the --watch interval must be at least a second!\n", stderr);
+                return EXIT_FAILURE;
+            }
+        } else if (!wcscmp(argv[i], L"--ftp"))
+            is_ftp_requested = true;
+        else if ((!wcscmp(argv[i], L"--jobs") || !wcscmp(argv[i], L"--per-host")) && i + 1 < argc) {
+            const bool           is_jobs = argv[i][2] == L'j';
+            unsigned long* const limit   = is_jobs ? &jobs : &per_host;
+            *limit                       = wcstoul(argv[++i], NULL, 10);
+            if (!*limit || *limit > (is_jobs ? FTP_MAX_JOBS : RING_MAX_CONNECTIONS)) { // the workers never exceed --jobs anyway
+                fwprintf_s(stderr, L"Error: %s takes 1 to %llu requests!\n", argv[i - 1], is_jobs ? FTP_MAX_JOBS : RING_MAX_CONNECTIONS);
+                return EXIT_FAILURE;
+            }
+        } else if (!wcscmp(argv[i], L"--delay") && i + 1 < argc)
+            delay = wcstoul(argv[++i], NULL, 10);
+        else if (!wcscmp(argv[i], L"--stats"))
+            is_stats_requested = true;
+        else if (!wcscmp(argv[i], L"--trace") && i + 1 < argc)
+            trace = argv[++i];
+        else {
+            fwprintf_s(stderr, L"Error: unrecognized argument %s!\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!naccesspoints && is_ftp_requested) wcscpy_s(*accesspoints, BUFF_SIZE, L"/ftp/python/");
+    if (!naccesspoints) naccesspoints = 1; // the default /downloads/windows/, or /ftp/python/ for --ftp
+    if (!artifacts) artifacts = ARTIFACT_MASK(ARTIFACT_AMD64);
+    if (snapshot && naccesspoints > 1) {
+        fputws(L"Error: --snapshot takes the releases of a single page, drop the extra --paths!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    if (record && (naccesspoints > 1 || is_ftp_requested || source_snapshot || source_file)) {
+        fputws(L"Error: --record saves a single page as it's fetched, it doesn't go with --ftp, extra --paths or the offline sources!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    if (source_file && source_snapshot) {
+        fputws(L"Error: --from-file and --from-snapshot are both offline sources, pick one!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    if (watch_interval && (naccesspoints > 1 || snapshot || source_snapshot || source_file || record || query.kind != QUERY_NONE)) {
+        fputws(L"Error: --watch follows a single page and prints its release events, it takes no snapshots, files or version query!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    if (is_ftp_requested && (watch_interval || source_snapshot || source_file)) {
+        fputws(L"Error: --ftp crawls the directory tree once, it doesn't go with --watch, --from-snapshot or --from-file!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    if (nmirrors && (source_snapshot || source_file || is_pythons_requested)) {
+        fputws(L"Error: --mirror picks the server pages are fetched from, it doesn't go with --pythons or the offline sources!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    for (unsigned long i = 0; i < nmirrors; ++i) { // after the loop, so that --port applies wherever it was given
+        if (!mirrors_add(&mirrors, mirror_hosts[i], port)) {
+            fwprintf_s(stderr, L"Error: %s is not a host, host:port or [address]:port!\n", mirror_hosts[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!nmirrors) { // --server, on its own there's nothing to race or score
+        wcscpy_s(mirrors.hosts->server, BUFF_SIZE, server);
+        mirrors.hosts->port = port;
+        mirrors.count       = 1;
+    }
+    // the scores of a single mirror don't matter, and they are kept where the cache is
+    if (nmirrors > 1 && *cache_directory && swprintf_s(scoreboard, MAX_PATH, L"%scrawl-mirrors.scoreboard", cache_directory) > 0)
+        mirrors.scoreboard = scoreboard;
+
+    const bool is_selecting = query.kind == QUERY_EXACT || query.kind == QUERY_LATEST || query.kind == QUERY_NEWEST;
+    if (*download_directory && (!is_selecting || watch_interval)) {
+        fputws(L"Error: --download needs --exact, --latest or --newest to pick the releases to download, and doesn't go with --watch!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    const download_options_t download = { .transport   = transport,
+                                          .directory   = *download_directory ? download_directory : NULL,
+                                          .connections = connections };
+    if (trace && !trace_start()) return EXIT_FAILURE; // trace_start will do the error reporting
+
+    if (is_pythons_requested) { // nothing gets fetched
+        python_interpreter_t interpreters[PYTHON_MAX_INTERPRETERS] = { 0 };
+        const unsigned long  count                                   = find_python_interpreters(interpreters, PYTHON_MAX_INTERPRETERS, false);
+        if (!count) fputws(L"Error: there is no python on PATH!\n", stderr);
+        print_python_interpreters(interpreters, count);
+        bool is_listed = count > 0;
+        if (trace) is_listed &= trace_write(trace); // trace_write will do the error reporting
+        return is_listed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // the mirrors race for the first page, --watch and --ftp then stick with the winner while pages go to the next best one when it fails
+    if (mirrors.count > 1) {
+        mirrors_load(&mirrors);
+        (void) mirrors_race(&mirrors, *accesspoints); // mirrors_race will do the error reporting, the fetches then go down the ranks anyway
+    }
+    const mirror_t* const best = mirrors.hosts + *mirrors.ranks;
+    const ftp_options_t   ftp  = { .transport = transport,
+                                   .server    = best->server,
+                                   .port      = best->port,
+                                   .jobs      = jobs,
+                                   .per_host  = per_host,
+                                   .delay     = delay };
+
+    if (watch_interval) { // events don't mention the system python, so there's nothing to probe
+        if (!mirrors_save(&mirrors)) fputws(L"Warning: could not update the mirror scoreboard!\n", stderr);
+        // watch will do the error reporting
+        bool is_watched = watch(transport, best->server, best->port, *accesspoints, artifacts, format, watch_interval);
+        transport_cleanup();
+        if (trace) is_watched &= trace_write(trace); // trace_write will do the error reporting
+        return is_watched ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // the system python is looked for while the page downloads and parses, publish waits for it
+    python_probe_t probe = { 0 };
+    python_probe_start(&probe);
+
+    if (source_snapshot) { // no network, no parsing, the releases are printed straight from the mapped file
+        snapshot_t mapped = { 0 };
+        if (!snapshot_map(source_snapshot, &mapped)) { // snapshot_map will do the error reporting
+            (void) python_probe_wait(&probe);
+            return EXIT_FAILURE;
+        }
+        const char* const syspy      = python_probe_wait(&probe);
+        bool              is_printed = answer_query(mapped.releases, artifacts, syspy, format, query); // answer_query will do the error reporting
+        if (is_printed && download.directory) is_printed = download_selected(mapped.releases, artifacts, query, &download);
+        snapshot_unmap(&mapped);
+        if (trace) is_printed &= trace_write(trace); // trace_write will do the error reporting
+        return is_printed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    bool is_success = true;
+    if (source_file) // no network, the saved page is parsed straight from the mapped file
+        is_success = crawl_file(source_file, artifacts, format, query, snapshot, &download, &probe);
+    for (unsigned long i = 0; i < naccesspoints && !source_file; ++i) {
+        if (is_ftp_requested) { // directory listings aren't worth caching, every crawl lists them all again
+            is_success &= crawl_tree(&ftp, accesspoints[i], artifacts, format, query, snapshot, &download, &probe);
+            continue;
+        }
+        is_success &= crawl(
+            transport,
+            &mirrors,
+            accesspoints[i],
+            *cache_directory ? cache_directory : NULL,
+            artifacts,
+            format,
+            query,
+            snapshot,
+            record,
+            &download,
+            &probe
+        );
+    }
+    (void) python_probe_wait(&probe); // in case no page made it to publish
+
+    if (is_stats_requested) {
+        const pool_stats_t stats = pool_statistics();
+        fwprintf_s(
+            stderr,
+            L"connection pool: %lu hits, %lu misses, %lu reuses, %lu evictions\n",
+            stats.hits,
+            stats.misses,
+            stats.reuses,
+            stats.evictions
+        );
+        const body_stats_t slabs = body_statistics();
+        fwprintf_s(stderr, L"response slabs: %lu allocated, %lu reused, %lu freed\n", slabs.allocations, slabs.reuses, slabs.frees);
+        if (nmirrors) mirrors_print(&mirrors);
+    }
+    if (!mirrors_save(&mirrors)) fputws(L"Warning: could not update the mirror scoreboard!\n", stderr);
+
+    transport_cleanup();
+    if (trace) is_success &= trace_write(trace); // trace_write will do the error reporting
+    return is_success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#ifndef _WIN32
+// the posix build starts here and hands wmain its arguments as wide strings, decoded the way the locale says
+int main(int argc, char* argv[]) {
+    int       exit_code = EXIT_FAILURE;
+    wchar_t** arguments = NULL;
+    (void) setlocale(LC_ALL, "");
+
+    arguments = calloc((size_t) argc + 1, sizeof(wchar_t*));
+    if (!arguments) {
+        fputws(L"Error: could not allocate the arguments!\n", stderr);
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < argc; ++i) {
+        const size_t length = mbstowcs(NULL, argv[i], 0);
+        if (length == (size_t) -1) {
+            fwprintf_s(stderr, L"Error: argument %d isn't valid in the encoding of the locale!\n", i);
+            goto CLEANUP;
+        }
+        arguments[i] = malloc((length + 1) * sizeof(wchar_t));
+        if (!arguments[i]) {
+            fputws(L"Error: could not allocate the arguments!\n", stderr);
+            goto CLEANUP;
+        }
+        (void) mbstowcs(arguments[i], argv[i], length + 1);
+    }
+    exit_code = wmain(argc, arguments);
 
 CLEANUP:
-    free(html_text);
-    return EXIT_FAILURE;
+    for (int i = 0; i < argc; ++i) free(arguments[i]);
+    free(arguments);
+    return exit_code;
 }
+#endif
@@ -0,0 +1,415 @@
+#include <project.h>
+
+// picks the mirror the pages are fetched from. every mirror is scored by how fast it answers (the latency of a HEAD request, from the start
+// of the connect to the first byte of the answer) and how fast it serves pages (the throughput of the fetches that went to it), the scores
+// are smoothed over runs and kept in a scoreboard file next to the page cache. the mirrors are ranked by the time each would take for
+// MIRROR_RANK_SIZE bytes, a mirror that keeps failing falling further behind with every failure.
+// at the start of a run the mirrors race each other happy eyeballs style (RFC 8305): the best ranked one is probed first and every
+// MIRROR_ATTEMPT_DELAY ms without an answer brings in the next, so a good mirror costs a single probe and a bad one no more than the delay.
+// the first to answer gets the pages, the others are tried in rank order when it fails them.
+//
+// scoreboard layout: scoreboard_header_t | mirror_t hosts[count]
+
+#include <time.h> // the failures are dated with time(), the scores outlive the process
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+
+    #pragma comment(lib, "Ws2_32.lib")
+
+typedef SOCKET socket_t;
+    #define close_socket(s)     closesocket(s)
+    #define last_socket_error() WSAGetLastError()
+    #define is_in_progress(e)   ((e) == WSAEWOULDBLOCK || (e) == WSAEINPROGRESS)
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+
+typedef int socket_t;
+    #define INVALID_SOCKET      (-1)
+    #define close_socket(s)     close(s)
+    #define last_socket_error() errno
+    #define is_in_progress(e)   ((e) == EINPROGRESS || (e) == EWOULDBLOCK)
+#endif
+
+#define SCOREBOARD_MAGIC   0x534D5243U // "CRMS"
+#define SCOREBOARD_VERSION 1U
+#define SCORE_MAX_SHIFT    16LLU // failures in a row past this many don't push a mirror any further back
+
+typedef struct _scoreboard_header {
+        uint32_t magic;       // SCOREBOARD_MAGIC
+        uint32_t version;     // SCOREBOARD_VERSION of the build that wrote the file
+        uint32_t count;       // number of mirrors
+        uint32_t record_size; // sizeof(mirror_t) of the build that wrote the file, wchar_t isn't the same size everywhere
+} scoreboard_header_t;
+
+// a probe of the race
+typedef struct _attempt {
+        socket_t           socket;  // INVALID_SOCKET until the probe starts and once it's over
+        unsigned long long start;   // mirrors_clock when the connect went out
+        bool               is_sent; // the connect completed and the request went out, what's left is waiting for the answer
+} attempt_t;
+
+[[nodiscard]] unsigned long long __cdecl mirrors_clock(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER        counter   = { 0 };
+    if (!frequency.QuadPart) QueryPerformanceFrequency(&frequency); // never fails on Windows XP and later
+    QueryPerformanceCounter(&counter);
+    const unsigned long long ticks = (unsigned long long) counter.QuadPart, hertz = (unsigned long long) frequency.QuadPart;
+    return ticks / hertz * 1000000LLU + ticks % hertz * 1000000LLU / hertz;
+#else
+    struct timespec now = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000LLU + (unsigned long long) now.tv_nsec / 1000LLU;
+#endif
+}
+
+// an exponentially weighted moving average that gives the newest sample a quarter of the weight, the first sample is taken as it is
+static unsigned long long __cdecl smooth(_In_ const unsigned long long average, _In_ const unsigned long long sample) {
+    return average ? (average * 3 + sample) / 4 : sample;
+}
+
+[[nodiscard]] bool __cdecl mirrors_add(
+    _Inout_ mirrors_t* const restrict mirrors, _In_ const wchar_t* const restrict host, _In_ const unsigned short port
+) {
+    if (mirrors->count >= MIRROR_MAX_HOSTS) return false;
+
+    const wchar_t* name   = host;
+    const wchar_t* colon  = wcsrchr(host, L':');
+    size_t         length = wcslen(host);
+    if (*host == L'[') { // [2001:db8::1]:8080, the brackets are only there to set the port apart
+        const wchar_t* const bracket = wcschr(host, L']');
+        if (!bracket || (bracket[1] && bracket[1] != L':')) return false;
+        name   = host + 1;
+        length = (size_t) (bracket - name);
+        colon  = bracket[1] ? bracket + 1 : NULL;
+    } else if (colon && wcschr(host, L':') != colon) // a bare IPv6 address, there's no telling its last group from a port
+        colon = NULL;
+    else if (colon)
+        length = (size_t) (colon - host);
+    if (!length || length >= BUFF_SIZE) return false;
+
+    mirror_t* const mirror = mirrors->hosts + mirrors->count;
+    *mirror                = (mirror_t) { .port = port };
+    if (colon) {
+        wchar_t*            end   = NULL;
+        const unsigned long value = wcstoul(colon + 1, &end, 10);
+        if (*end || !value || value > 0xFFFF) return false;
+        mirror->port = (unsigned short) value;
+    }
+    wmemcpy(mirror->server, name, length);
+    mirror->server[length]         = 0;
+    mirrors->ranks[mirrors->count] = mirrors->count;
+    ++mirrors->count;
+    return true;
+}
+
+void __cdecl mirrors_load(_Inout_ mirrors_t* const restrict mirrors) {
+    scoreboard_header_t header = { 0 };
+    unsigned long       size   = 0;
+    unsigned char*      buffer = NULL;
+
+    // a missing file is the common case on a first run, don't let __open complain about it
+    if (!mirrors->scoreboard || GetFileAttributesW(mirrors->scoreboard) == INVALID_FILE_ATTRIBUTES) goto RANK;
+    buffer = __open(mirrors->scoreboard, &size); // __open will do the error reporting
+    if (!buffer) goto RANK;
+
+    if (size >= sizeof(scoreboard_header_t)) memcpy(&header, buffer, sizeof(scoreboard_header_t));
+    if (header.magic != SCOREBOARD_MAGIC || header.version != SCOREBOARD_VERSION || header.record_size != sizeof(mirror_t) ||
+        size != sizeof(scoreboard_header_t) + (unsigned long long) header.count * sizeof(mirror_t)) {
+        fwprintf_s(stderr, L"Warning: ignoring the malformed or outdated mirror scoreboard %s\n", mirrors->scoreboard);
+        goto RELEASE;
+    }
+
+    // the list on the command line decides which mirrors there are, the file only has their scores. mirrors it doesn't know start unscored
+    for (unsigned long i = 0; i < header.count; ++i) {
+        mirror_t record = { 0 };
+        memcpy(&record, buffer + sizeof(scoreboard_header_t) + i * sizeof(mirror_t), sizeof(mirror_t));
+        for (unsigned long j = 0; j < mirrors->count; ++j) {
+            mirror_t* const mirror = mirrors->hosts + j;
+            if (record.port != mirror->port || wcsncmp(record.server, mirror->server, BUFF_SIZE)) continue;
+            mirror->latency    = record.latency;
+            mirror->throughput = record.throughput;
+            mirror->failures   = record.failures;
+            mirror->successes  = record.successes;
+            mirror->failed_at  = record.failed_at;
+        }
+    }
+
+RELEASE:
+    free(buffer);
+RANK:
+    mirrors_rank(mirrors);
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl mirrors_save(_In_ const mirrors_t* const restrict mirrors) {
+    if (!mirrors->scoreboard) return true;
+
+    const unsigned long           size   = sizeof(scoreboard_header_t) + mirrors->count * sizeof(mirror_t);
+    const scoreboard_header_t     header = { .magic       = SCOREBOARD_MAGIC,
+                                             .version     = SCOREBOARD_VERSION,
+                                             .count       = (uint32_t) mirrors->count,
+                                             .record_size = sizeof(mirror_t) };
+    unsigned char* const restrict buffer = malloc(size);
+    if (!buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    memcpy(buffer, &header, sizeof(scoreboard_header_t));
+    memcpy(buffer + sizeof(scoreboard_header_t), mirrors->hosts, mirrors->count * sizeof(mirror_t));
+    const bool is_saved = __serialize(buffer, size, mirrors->scoreboard); // __serialize will do the error reporting
+    free(buffer);
+    return is_saved;
+}
+
+void __cdecl mirrors_report(
+    _Inout_ mirror_t* const restrict mirror, _In_ const bool is_success, _In_ const unsigned long size, _In_ const unsigned long long elapsed
+) {
+    if (!is_success) {
+        ++mirror->failures;
+        mirror->failed_at = (long long) time(NULL);
+        return;
+    }
+    mirror->failures = 0;
+    ++mirror->successes;
+    // a 304 served from the cache moves next to nothing, which says little about the mirror's bandwidth
+    if (size) mirror->throughput = smooth(mirror->throughput, size * 1000000LLU / (elapsed ? elapsed : 1));
+}
+
+// microseconds the mirror is expected to take for MIRROR_RANK_SIZE bytes. an unprobed mirror is assumed to answer within the attempt delay,
+// so it goes ahead of the ones known to be slower, and one whose pages haven't been timed yet to be as fast as the others on average
+static unsigned long long __cdecl expected_time(
+    _In_ const mirror_t* const restrict mirror, _In_ const unsigned long long throughput, _In_ const long long now
+) {
+    unsigned long long       time     = mirror->latency ? mirror->latency : MIRROR_ATTEMPT_DELAY * 1000LLU;
+    const unsigned long long rate     = mirror->throughput ? mirror->throughput : throughput;
+    const unsigned long long forgiven = now > mirror->failed_at ? (unsigned long long) (now - mirror->failed_at) / MIRROR_FORGIVE_INTERVAL : 0;
+    const unsigned long long failures = mirror->failures > forgiven ? mirror->failures - forgiven : 0;
+    if (rate) time += MIRROR_RANK_SIZE * 1000000LLU / rate;
+    return time << (failures < SCORE_MAX_SHIFT ? failures : SCORE_MAX_SHIFT);
+}
+
+void __cdecl mirrors_rank(_Inout_ mirrors_t* const restrict mirrors) {
+    unsigned long long times[MIRROR_MAX_HOSTS] = { 0 };
+    unsigned long long throughput              = 0;
+    unsigned long      ntimed                  = 0;
+    const long long    now                     = (long long) time(NULL);
+    for (unsigned long i = 0; i < mirrors->count; ++i) {
+        throughput += mirrors->hosts[i].throughput;
+        ntimed     += mirrors->hosts[i].throughput != 0;
+    }
+    if (ntimed) throughput /= ntimed;
+    for (unsigned long i = 0; i < mirrors->count; ++i) times[i] = expected_time(mirrors->hosts + i, throughput, now);
+
+    // an insertion sort, there are a handful of mirrors at most. mirrors that score the same keep the order they were listed in
+    for (unsigned long i = 0; i < mirrors->count; ++i) mirrors->ranks[i] = i;
+    for (unsigned long i = 1; i < mirrors->count; ++i) {
+        const unsigned long index = mirrors->ranks[i];
+        unsigned long       j     = i;
+        for (; j && times[mirrors->ranks[j - 1]] > times[index]; --j) mirrors->ranks[j] = mirrors->ranks[j - 1];
+        mirrors->ranks[j] = index;
+    }
+}
+
+// Winsock needs a WSAStartup before the first socket call, a no-op elsewhere
+static bool __cdecl socket_startup(void) {
+#ifdef _WIN32
+    static bool is_started = false;
+    WSADATA     wsadata    = { 0 };
+    if (is_started) return true;
+    if (WSAStartup(MAKEWORD(2, 2), &wsadata)) {
+        fwprintf_s(stderr, L"Error %d in WSAStartup.\n", WSAGetLastError());
+        return false;
+    }
+    is_started = true;
+#endif
+    return true;
+}
+
+// server names and paths are plain ASCII
+static bool __cdecl narrow_host(_In_ const wchar_t* const restrict wide, _Inout_ char* const restrict buffer, _In_ const unsigned long size) {
+    unsigned long i = 0;
+    for (; wide[i] && i < size - 1; ++i) {
+        if (wide[i] > 0x7F) return false;
+        buffer[i] = (char) wide[i];
+    }
+    buffer[i] = 0;
+    return !wide[i];
+}
+
+// resolves the mirror and starts a non-blocking connect to the first address it resolves to, the race is between mirrors rather than
+// between the addresses of one. false when the probe failed before it got going
+static bool __cdecl start_attempt(_In_ const mirror_t* const restrict mirror, _Inout_ attempt_t* const restrict attempt) {
+    struct addrinfo  hints           = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_protocol = IPPROTO_TCP };
+    struct addrinfo* address         = NULL;
+    char             host[BUFF_SIZE] = { 0 };
+    char             service[8]      = { 0 };
+
+    attempt->start = mirrors_clock(); // name resolution included, like the socket transport's connects
+    if (!narrow_host(mirror->server, host, sizeof(host))) return false;
+    snprintf(service, sizeof(service), "%u", mirror->port);
+    const int status = getaddrinfo(host, service, &hints, &address);
+    if (status) {
+        fwprintf_s(stderr, L"Error %d in getaddrinfo for the mirror %s.\n", status, mirror->server);
+        return false;
+    }
+
+    attempt->socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (attempt->socket != INVALID_SOCKET) {
+#ifdef _WIN32
+        unsigned long is_non_blocking = 1;
+        const bool    is_configured   = !ioctlsocket(attempt->socket, FIONBIO, &is_non_blocking);
+#else
+        const int  flags         = fcntl(attempt->socket, F_GETFL, 0);
+        const bool is_configured = flags != -1 && fcntl(attempt->socket, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+        // a non-blocking connect completes in the background, the socket turns writable once it has either succeeded or failed
+        if (!is_configured || (connect(attempt->socket, address->ai_addr, (int) address->ai_addrlen) && !is_in_progress(last_socket_error()))) {
+            close_socket(attempt->socket);
+            attempt->socket = INVALID_SOCKET;
+        }
+    }
+    freeaddrinfo(address);
+    return attempt->socket != INVALID_SOCKET;
+}
+
+// takes the next step of a probe whose socket turned ready: sends the request once connected, reads the status line once it's answered.
+// returns 1 when the mirror answered, -1 when the probe failed and 0 while it's still underway
+static int __cdecl advance_attempt(
+    _In_ const mirror_t* const restrict mirror, _Inout_ attempt_t* const restrict attempt, _In_ const char* const restrict path
+) {
+    char message[HTTP_HEADER_LINE_LENGTH * 2] = { 0 };
+    char host[BUFF_SIZE]                      = { 0 };
+    char answer[16]                           = { 0 };
+
+    if (!attempt->is_sent) {
+        int       error  = 0;
+        socklen_t length = sizeof(error);
+        if (getsockopt(attempt->socket, SOL_SOCKET, SO_ERROR, (char*) &error, &length) || error) return -1;
+        (void) narrow_host(mirror->server, host, sizeof(host)); // start_attempt made sure it narrows
+        const int size = snprintf(
+            message, sizeof(message), "HEAD %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: crawl\r\nConnection: close\r\n\r\n", path, host
+        );
+        // a request this small goes out in one piece on a fresh connection
+        if (size <= 0 || send(attempt->socket, message, size, 0) != size) return -1;
+        attempt->is_sent = true;
+        return 0;
+    }
+
+    // the status line is all the race needs, "HTTP/1.1 200"
+    const int received = recv(attempt->socket, answer, (int) sizeof(answer) - 1, 0);
+    if (received < 12 || strncmp(answer, "HTTP/1.", 7)) return -1;
+    return answer[9] == '2' || answer[9] == '3' ? 1 : -1;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl mirrors_race(
+    _Inout_ mirrors_t* const restrict mirrors, _In_ const wchar_t* const restrict accesspoint
+) {
+    attempt_t     attempts[MIRROR_MAX_HOSTS]       = { 0 };
+    char          path[HTTP_HEADER_LINE_LENGTH / 2] = { 0 };
+    unsigned long nstarted                          = 0; // attempts started so far, in rank order
+    unsigned long nflight                           = 0; // attempts started that are still underway
+    long          winner                            = -1;
+    trace_span_t  span                              = trace_begin("mirror race", "http");
+
+    if (!narrow_host(accesspoint, path, sizeof(path))) {
+        fputws(L"Error: paths must be ASCII for the mirror race.\n", stderr);
+        return false;
+    }
+    if (!socket_startup()) return false;
+    for (unsigned long i = 0; i < MIRROR_MAX_HOSTS; ++i) attempts[i].socket = INVALID_SOCKET;
+
+    const unsigned long long deadline   = mirrors_clock() + MIRROR_RACE_TIMEOUT * 1000LLU;
+    unsigned long long       next_start = 0; // when the next attempt is due, right away for the first
+    for (unsigned long long now = mirrors_clock(); winner < 0 && now < deadline; now = mirrors_clock()) {
+        // the next mirror joins in when its turn has come, or straight away when every probe so far has failed
+        if (nstarted < mirrors->count && (now >= next_start || !nflight)) {
+            const unsigned long index = mirrors->ranks[nstarted++];
+            next_start                = now + MIRROR_ATTEMPT_DELAY * 1000LLU;
+            if (start_attempt(mirrors->hosts + index, attempts + index))
+                ++nflight;
+            else
+                mirrors_report(mirrors->hosts + index, false, 0, 0);
+            continue;
+        }
+        if (!nflight) break; // every mirror failed
+
+        fd_set   readable = { 0 }, writable = { 0 }; // NOLINT(readability-isolate-declaration)
+        socket_t highest  = 0;
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        for (unsigned long i = 0; i < mirrors->count; ++i) {
+            if (attempts[i].socket == INVALID_SOCKET) continue;
+            FD_SET(attempts[i].socket, attempts[i].is_sent ? &readable : &writable);
+            if (attempts[i].socket > highest) highest = attempts[i].socket;
+        }
+        // wake up for the next attempt or the deadline, whichever comes first
+        const unsigned long long until   = nstarted < mirrors->count && next_start < deadline ? next_start : deadline;
+        const unsigned long long wait    = until > now ? until - now : 0;
+        struct timeval           timeout = { .tv_sec = (long) (wait / 1000000LLU), .tv_usec = (long) (wait % 1000000LLU) };
+        // the first argument is ignored by Winsock
+        const int                ready   = select((int) highest + 1, &readable, &writable, NULL, &timeout);
+        if (ready < 0) {
+            fwprintf_s(stderr, L"Error %d in select.\n", last_socket_error());
+            break;
+        }
+
+        for (unsigned long i = 0; i < mirrors->count && ready && winner < 0; ++i) {
+            if (attempts[i].socket == INVALID_SOCKET || !FD_ISSET(attempts[i].socket, attempts[i].is_sent ? &readable : &writable)) continue;
+            const int outcome = advance_attempt(mirrors->hosts + i, attempts + i, path);
+            if (!outcome) continue;
+            if (outcome > 0) { // answering a HEAD request doesn't make up for the pages a mirror failed to serve, the failures stand
+                winner                    = (long) i;
+                mirrors->hosts[i].latency = smooth(mirrors->hosts[i].latency, mirrors_clock() - attempts[i].start);
+                ++mirrors->hosts[i].successes;
+            } else
+                mirrors_report(mirrors->hosts + i, false, 0, 0);
+            close_socket(attempts[i].socket);
+            attempts[i].socket = INVALID_SOCKET;
+            --nflight;
+        }
+    }
+
+    // the probes still underway lost the race, that's no failure of theirs
+    for (unsigned long i = 0; i < mirrors->count; ++i)
+        if (attempts[i].socket != INVALID_SOCKET) close_socket(attempts[i].socket);
+    trace_end(span, 0, 0);
+
+    mirrors_rank(mirrors);
+    if (winner < 0) {
+        fwprintf_s(stderr, L"Error: none of the %lu mirrors answered.\n", mirrors->count);
+        return false;
+    }
+    // the winner goes first whatever its score says, it's the one that answered fastest right now
+    unsigned long rank = 0;
+    while (mirrors->ranks[rank] != (unsigned long) winner) ++rank;
+    for (; rank; --rank) mirrors->ranks[rank] = mirrors->ranks[rank - 1];
+    mirrors->ranks[0] = (unsigned long) winner;
+    dbgwprintf_s(L"%s:%u won the mirror race\n", mirrors->hosts[winner].server, mirrors->hosts[winner].port);
+    return true;
+}
+
+void __cdecl mirrors_print(_In_ const mirrors_t* const restrict mirrors) {
+    for (unsigned long i = 0; i < mirrors->count; ++i) {
+        const mirror_t* const mirror = mirrors->hosts + mirrors->ranks[i];
+        fwprintf_s(
+            stderr,
+            L"mirror %lu: %s:%u, %llu.%03llu ms latency, %llu KiB/s, %lu failures since its last page, %lu answers\n",
+            i + 1,
+            mirror->server,
+            mirror->port,
+            mirror->latency / 1000,
+            mirror->latency % 1000,
+            mirror->throughput / 1024,
+            mirror->failures,
+            mirror->successes
+        );
+    }
+}
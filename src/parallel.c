@@ -0,0 +1,130 @@
+#include <project.h>
+
+// parse_stable_releases over several threads. every anchor tag belongs to the chunk its '<' falls in, the chunks cut [0, size - 100) into
+// contiguous slices and a worker only starts anchors inside its own slice, but the matcher is free to read up to STREAM_LOOKAHEAD bytes past
+// the slice's end. that overlap is what lets a chunk boundary fall in the middle of a tag: the anchor is parsed in full by the chunk it
+// starts in and skipped by the chunk it ends in. each worker appends to results of its own, borrowing html like the serial parser does, so
+// nothing is shared between workers and merging comes down to copying the span blocks back to back in chunk order.
+
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+typedef struct _parse_chunk {
+        const char*   html;    // the whole page
+        unsigned long begin;   // first offset an anchor of this chunk may start at
+        unsigned long end;     // one past the last offset an anchor of this chunk may start at
+        unsigned long size;    // size of the whole page, the matcher never reads past it
+        results_t     results; // releases found in this chunk, versions is NULL when the chunk failed
+} parse_chunk_t;
+
+static void __cdecl parse_chunk(_Inout_ parse_chunk_t* const restrict chunk) {
+    // a chunk holds its share of the page's releases, which is a fine first guess for its capacity. results_init reports its own errors
+    if (!results_init(&chunk->results, chunk->html, RESULTS_INITIAL_CAPACITY)) [[unlikely]]
+        return;
+    const trace_span_t span = trace_begin("parse chunk", "parse");
+    if (!parse_releases_between(chunk->html, chunk->begin, chunk->end, chunk->size, &chunk->results)) [[unlikely]]
+        results_release(&chunk->results);
+    trace_end(span, chunk->end - chunk->begin, chunk->results.count);
+}
+
+#ifdef _WIN32
+static unsigned long __stdcall parse_chunk_thread(_In_ void* const context) {
+    parse_chunk(context);
+    return 0;
+}
+#else
+static void* parse_chunk_thread(_In_ void* const context) {
+    parse_chunk(context);
+    return NULL;
+}
+#endif
+
+[[nodiscard]] unsigned long __cdecl processor_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO system = { 0 };
+    GetSystemInfo(&system);
+    return system.dwNumberOfProcessors ? system.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned long) count : 1;
+#endif
+}
+
+[[nodiscard]] results_t __cdecl parse_stable_releases_parallel(
+    _In_ const char* const restrict html, _In_ const unsigned long size, _In_ const unsigned long nthreads
+) {
+    results_t           merged                             = { 0 }; // versions stays NULL unless every chunk was parsed
+    parse_chunk_t       chunks[PARSE_PARALLEL_MAX_THREADS] = { 0 };
+    const unsigned long limit                              = size > 100 ? size - 100 : 0; // the same bound parse_stable_releases uses
+
+    unsigned long nchunks = nthreads ? nthreads : processor_count();
+    if (nchunks > PARSE_PARALLEL_MAX_THREADS) nchunks = PARSE_PARALLEL_MAX_THREADS;
+    if (nchunks > limit / PARSE_PARALLEL_MIN_CHUNK) nchunks = limit / PARSE_PARALLEL_MIN_CHUNK;
+    if (nchunks < 2) return parse_stable_releases(html, size); // not worth the threads, parse_stable_releases also handles NULL and empty html
+
+    for (unsigned long i = 0; i < nchunks; ++i)
+        chunks[i] = (parse_chunk_t) {
+            .html    = html,
+            .begin   = (unsigned long) ((unsigned long long) limit * i / nchunks),
+            .end     = (unsigned long) ((unsigned long long) limit * (i + 1) / nchunks),
+            .size    = size,
+            .results = { 0 },
+        };
+
+    // the calling thread takes the first chunk itself, a chunk whose thread couldn't be started is parsed inline once the others are running
+#ifdef _WIN32
+    HANDLE threads[PARSE_PARALLEL_MAX_THREADS] = { 0 };
+    for (unsigned long i = 1; i < nchunks; ++i) threads[i] = CreateThread(NULL, 0, parse_chunk_thread, chunks + i, 0, NULL);
+#else
+    pthread_t threads[PARSE_PARALLEL_MAX_THREADS]    = { 0 };
+    bool      is_started[PARSE_PARALLEL_MAX_THREADS] = { 0 };
+    for (unsigned long i = 1; i < nchunks; ++i) is_started[i] = !pthread_create(threads + i, NULL, parse_chunk_thread, chunks + i);
+#endif
+
+    parse_chunk(chunks);
+
+#ifdef _WIN32
+    for (unsigned long i = 1; i < nchunks; ++i) {
+        if (threads[i]) {
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
+        } else {
+            dbgwprintf_s(L"Error %lu in CreateThread, parsing chunk %lu inline\n", GetLastError(), i);
+            parse_chunk(chunks + i);
+        }
+    }
+#else
+    for (unsigned long i = 1; i < nchunks; ++i)
+        if (is_started[i])
+            pthread_join(threads[i], NULL);
+        else
+            parse_chunk(chunks + i);
+#endif
+
+    const trace_span_t span  = trace_begin("merge", "parse");
+    unsigned long      count = 0;
+    for (unsigned long i = 0; i < nchunks; ++i) {
+        if (!chunks[i].results.versions) [[unlikely]]
+            goto cleanup; // the chunk's results_init or results_push has done the error reporting
+        count += chunks[i].results.count;
+    }
+
+    if (!results_init(&merged, html, count)) [[unlikely]]
+        goto cleanup; // results_init will do the error reporting
+
+    // the chunks are in page order and so are the releases within each chunk, concatenating them gives exactly the serial order
+    for (unsigned long i = 0; i < nchunks; ++i) {
+        const results_t chunk = chunks[i].results;
+        memcpy(merged.versions + merged.count, chunk.versions, sizeof(span_t) * chunk.count);
+        memcpy(merged.downloadurls + merged.count, chunk.downloadurls, sizeof(span_t) * chunk.count);
+        memcpy(merged.kinds + merged.count, chunk.kinds, chunk.count);
+        merged.count += chunk.count;
+    }
+
+cleanup:
+    for (unsigned long i = 0; i < nchunks; ++i) results_release(&chunks[i].results);
+    trace_end(span, 0, merged.count);
+    return merged;
+}
@@ -1,133 +1,614 @@
 #include <project.h>
 
-// https://learn.microsoft.com/en-us/windows/win32/procthread/creating-a-child-process-with-redirected-input-and-output?redirectedfrom=MSDN
-// pipes are used in one-way communication between two different processes.
-// we will need two pipes connecting the two processes, these pipes can be named (optionally)
+// finds the python interpreters on PATH and their versions without running them. every directory of PATH is searched for interpreters
+// (python.exe, python3.exe and python3.x.exe on Windows, python3 and python3.x elsewhere) and their versions are read from the files an
+// installation comes with, in this order:
+//     pyvenv.cfg      the version key of a virtual environment, next to the interpreter or one directory above it (bin, Scripts)
+//     python.exe      the version resource of the executable, Windows only. CPython stamps it with major.minor.(micro * 1000 + level * 10 + serial)
+//     patchlevel.h    PY_VERSION of the installation's headers, include\ next to python.exe on Windows. elsewhere ../include/python3.x/, the
+//                     minor version coming from the resolved name of the interpreter (python3 -> python3.12) or the libpython3.x.so soname in ../lib
+// only the interpreters none of these know anything about are run with --version, all of them at once. their output is read as it arrives
+// (WaitForMultipleObjects on Windows, poll elsewhere) and the whole batch gets PYTHON_PROBE_TIMEOUT milliseconds, an interpreter that hasn't
+// answered by then is killed and its version reported as unknown.
 
-// parent process ------->  child process      (pipe 1)
-// child process  ------->  parent process     (pipe 2)
+// the spawned interpreter writes its version to the write end of a pipe, which it inherits as both stdout and stderr (python 2 printed
+// --version to stderr). the read end stays with this process and must not be inherited, neither must the pipes of the other interpreters
 
-// pipes are unidirectional, information can be relayed in one direction only, hence the need for two pipes to facilitate a bidirectional communication
+#ifdef _WIN32
+    #pragma comment(lib, "Version.lib") // need this for GetFileVersionInfoW
+    #define PATH_LIST_SEPARATOR L';'
+    #define PATH_SEPARATOR      L'\\'
+    #define PYTHON_EXECUTABLE   L"python.exe" // what a bare python command runs
+    #define names_equal(a, b)   (!_wcsicmp((a), (b)))
+    #define has_prefix(a, b, n) (!_wcsnicmp((a), (b), (n)))
+#else
+    #include <dirent.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <limits.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <spawn.h>
+    #include <sys/wait.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define PATH_LIST_SEPARATOR L':'
+    #define PATH_SEPARATOR      L'/'
+    #define PYTHON_EXECUTABLE   L"python3"
+    #define names_equal(a, b)   (!wcscmp((a), (b)))
+    #define has_prefix(a, b, n) (!wcsncmp((a), (b), (n)))
+extern char** environ;
+#endif
 
-// read end (right) of the pipe 1 serves as the stdin for the child process and the write end (left) serves as the stdout for the parent process.
-// read end of pipe 2 serves as the stdin for the parent process and the write end serves as the stdout for thr child process.
+#define PYTHON_METADATA_SIZE 4096LLU // bytes of pyvenv.cfg and patchlevel.h that are looked at, the version comes in the first few lines
 
-// terms parent process & child process are used here because the second process (python.exe) is spawned by the first process
+// tells whether a file name is one of the interpreters find_python_interpreters reports, with is_primary_only just the one a bare python
+// command runs
+static bool __cdecl is_interpreter_name(_In_ const wchar_t* const restrict name, _In_ const bool is_primary_only) {
+    if (names_equal(name, PYTHON_EXECUTABLE)) return true;
+    if (is_primary_only || !has_prefix(name, L"python3", 7)) return false;
 
-// the read end of first pipe serves as stdin for the child process and the write end serves as the stdout for the parent process
-// and the write end of second pipe is the stdout for the child process and the read end is the stdin for the parent process
-// these pipe handles are specified in the STARTUPINFO structure, which makes them the standard handles inherited by the child process
+    const wchar_t* cursor = name + 7;
+    if (*cursor == L'.' && cursor[1] >= L'0' && cursor[1] <= L'9') // python3.12
+        for (++cursor; *cursor >= L'0' && *cursor <= L'9';) ++cursor;
+#ifdef _WIN32
+    return names_equal(cursor, L".exe");
+#else
+    return !*cursor;
+#endif
+}
 
-// parent process uses the opposite ends of these two pipes to write to the child process's input and read from the child process's output.
-// as specified in the SECURITY_ATTRIBUTES structure, these handles are also inheritable, but Microsoft clarifies these handles must not be inherited.
-// thus, before creating the child process, the parent process uses the SetHandleInformation() function to ensure that the write handle for the child process's stdout
-// and the read handle for the child process's stdout cannot be inherited.
+// stores the version text is as the interpreter's, the way python --version spells it. false when text isn't a version
+static bool __cdecl store_version(
+    _Inout_ python_interpreter_t* const restrict interpreter,
+    _In_ const char* const restrict text,
+    _In_ const unsigned long length,
+    _In_ const python_source_t source
+) {
+    if (length + 8 > BUFF_SIZE || version_key(text, length) == VERSION_KEY_INVALID) return false;
+    memcpy(interpreter->version, "Python ", 7);
+    memcpy(interpreter->version + 7, text, length);
+    interpreter->version[7 + length] = '\0';
+    interpreter->source              = source;
+    return true;
+}
 
-// here we are only interested in a one-way communication, we just need this application to read python.exe's stdout through the pipe
-static HANDLE64 this_process_stdin_handle = NULL, python_stdout_handle = NULL; //
+// reads the beginning of a file into buffer, null terminated. a missing file is the common case here and isn't reported
+static unsigned long __cdecl read_metadata_file(_In_ const wchar_t* const restrict path, _Inout_ char* const restrict buffer) {
+    const HANDLE  file        = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    unsigned long nread_bytes = 0;
 
-// launches python.exe that uses the previously created pipe as stdin & stderr
-[[nodiscard]] bool __cdecl launch_python(void) {
-    PROCESS_INFORMATION python_proc_info    = { 0 };
-    const STARTUPINFOW  python_startup_info = {
-         .cb          = sizeof(STARTUPINFO),
-         .hStdError   = python_stdout_handle,
-         .hStdOutput  = python_stdout_handle,
-         .dwFlags     = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES,
-         .wShowWindow = SW_HIDE // prevents cmd window from flashing, requires STARTF_USESHOWWINDOW in dwFlags.
-    };
+    *buffer = '\0';
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    if (!ReadFile(file, buffer, PYTHON_METADATA_SIZE - 1, &nread_bytes, NULL)) nread_bytes = 0;
+    CloseHandle(file);
+    buffer[nread_bytes] = '\0';
+    return nread_bytes;
+}
 
-    // lookup: https://learn.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-createprocessw
-    // passing the executable's name in lpApplicationName and its arguments in lpCommandLine causes error 2. "The system cannot find the file specified"
-    // pass the whole command (executable name + arguments) in lpCommandLine.
+// the version key of a pyvenv.cfg, "version = 3.12.4" as venv writes it or "version_info = 3.12.4.final.0" as virtualenv and uv do
+static bool __cdecl parse_pyvenv(_Inout_ python_interpreter_t* const restrict interpreter, _In_ const char* const restrict cfg) {
+    for (const char* line = cfg; line && *line; line = strchr(line, '\n'), line = line ? line + 1 : NULL) {
+        while (*line == ' ' || *line == '\t') ++line;
+        if (strncmp(line, "version", 7)) continue;
 
-    // CreateProcessW, can modify the contents of lpCommandLine
-    // therefore, this parameter cannot be a pointer to read-only memory (such as a const wchar* or a string literal).
-    // if this parameter such, an access violation will be raised
+        const char* value = line + 7;
+        if (!strncmp(value, "_info", 5)) value += 5;
+        while (*value == ' ' || *value == '\t') ++value;
+        if (*value++ != '=') continue;
+        while (*value == ' ' || *value == '\t') ++value;
+
+        // up to the third dot, which is where virtualenv's release level starts
+        unsigned long length = 0, ndots = 0; // NOLINT(readability-isolate-declaration)
+        for (; value[length] && value[length] != '\r' && value[length] != '\n' && value[length] != ' '; ++length)
+            if (value[length] == '.' && ++ndots == 3) break;
+        return store_version(interpreter, value, length, PYTHON_SOURCE_PYVENV);
+    }
+    return false;
+}
+
+// PY_VERSION of a patchlevel.h, #define PY_VERSION "3.12.4". development builds append a + which isn't part of the version
+static bool __cdecl parse_patchlevel(_Inout_ python_interpreter_t* const restrict interpreter, _In_ const char* const restrict header) {
+    const char* value = strstr(header, "#define PY_VERSION");
+    if (!value || !(value = strchr(value + 18, '"'))) return false;
+
+    const char* const end = strchr(++value, '"');
+    if (!end) return false;
+    return store_version(interpreter, value, (unsigned long) (end - value) - (end > value && end[-1] == '+'), PYTHON_SOURCE_PATCHLEVEL);
+}
+
+// directory + separator + name into path, false when it doesn't fit
+static bool __cdecl join_path(
+    _Inout_ wchar_t* const restrict path, _In_ const wchar_t* const restrict directory, _In_ const wchar_t* const restrict name
+) {
+    const int length = swprintf_s(path, MAX_PATH, L"%s%c%s", directory, PATH_SEPARATOR, name);
+    return length > 0 && length < MAX_PATH;
+}
+
+#ifdef _WIN32
+
+// python.exe's fixed file version, 3.12.4150.1013 for 3.12.4 and 3.13.122.1013 for 3.13.0rc2. other executables called python.exe (the
+// Microsoft Store alias, interpreters that aren't CPython) don't follow the scheme and are left to the --version fallback
+static bool __cdecl read_version_resource(_Inout_ python_interpreter_t* const restrict interpreter) {
+    static const char* const tags[16]   = { [RELEASE_ALPHA] = "a", [RELEASE_BETA] = "b", [RELEASE_CANDIDATE] = "rc" };
+    unsigned long            handle     = 0;
+    VS_FIXEDFILEINFO*        fixed      = NULL;
+    unsigned                 fixed_size = 0;
+    bool                     is_read    = false;
+
+    const unsigned long size = GetFileVersionInfoSizeW(interpreter->path, &handle);
+    if (!size) return false;
+    void* const restrict info = malloc(size);
+    if (!info) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    if (GetFileVersionInfoW(interpreter->path, 0, size, info) && VerQueryValueW(info, L"\\", (void**) &fixed, &fixed_size) && fixed) {
+        const unsigned major = HIWORD(fixed->dwFileVersionMS), minor = LOWORD(fixed->dwFileVersionMS); // NOLINT(readability-isolate-declaration)
+        const unsigned field = HIWORD(fixed->dwFileVersionLS), level = field % 1000 / 10;              // NOLINT(readability-isolate-declaration)
+        char           text[BUFF_SIZE] = { 0 };
+        int            length          = 0;
+
+        if (level == RELEASE_FINAL)
+            length = sprintf_s(text, BUFF_SIZE, "%u.%u.%u", major, minor, field / 1000);
+        else if (tags[level])
+            length = sprintf_s(text, BUFF_SIZE, "%u.%u.%u%s%u", major, minor, field / 1000, tags[level], field % 10);
+        is_read = major >= 2 && length > 0 && store_version(interpreter, text, (unsigned long) length, PYTHON_SOURCE_RESOURCE);
+    }
+
+    free(info);
+    return is_read;
+}
+
+// the installer puts the headers in include\ next to python.exe
+static bool __cdecl read_patchlevel(_Inout_ python_interpreter_t* const restrict interpreter, _In_ const wchar_t* const restrict directory) {
+    wchar_t path[MAX_PATH]               = { 0 };
+    char    header[PYTHON_METADATA_SIZE] = { 0 };
+    return join_path(path, directory, L"include\\patchlevel.h") && read_metadata_file(path, header) && parse_patchlevel(interpreter, header);
+}
 
-#if defined(_DEBUG) || defined(DEBUG)
-    wchar_t command[BUFF_SIZE] = L"./python/bin/Debug/python.exe --version";
 #else
-    wchar_t command[BUFF_SIZE] = L"python.exe --version";
+
+// python3.x, the name the interpreter resolves to (python3 usually is a link to python3.12), or the soname of the one libpython3.x.so in
+// prefix/lib. 0 when neither tells
+static unsigned long __cdecl find_minor_version(
+    _In_ const python_interpreter_t* const restrict interpreter, _In_ const wchar_t* const restrict directory
+) {
+    char          path[MAX_PATH * 4] = { 0 };
+    char          resolved[PATH_MAX] = { 0 };
+    unsigned long minor              = 0;
+
+    if (wcstombs(path, interpreter->path, sizeof(path)) != (size_t) -1 && realpath(path, resolved)) {
+        const char* const name = strrchr(resolved, '/');
+        if (name && sscanf(name, "/python3.%lu", &minor) == 1) return minor;
+    }
+
+    if (wcstombs(path, directory, sizeof(path)) == (size_t) -1 || (size_t) snprintf(resolved, PATH_MAX, "%s/../lib", path) >= PATH_MAX) return 0;
+    DIR* const restrict libraries = opendir(resolved);
+    if (!libraries) return 0;
+
+    unsigned long nminors = 0, candidate = 0; // NOLINT(readability-isolate-declaration)
+    for (const struct dirent* entry = readdir(libraries); entry; entry = readdir(libraries)) {
+        if (sscanf(entry->d_name, "libpython3.%lu", &candidate) != 1 || !strstr(entry->d_name, ".so")) continue;
+        if (!nminors || candidate != minor) {
+            minor = candidate;
+            nminors++;
+        }
+    }
+    closedir(libraries);
+    return nminors == 1 ? minor : 0; // the interpreter could be any of several minor versions
+}
+
+// the headers live in prefix/include/python3.x/ and are only there when the development files are installed
+static bool __cdecl read_patchlevel(_Inout_ python_interpreter_t* const restrict interpreter, _In_ const wchar_t* const restrict directory) {
+    wchar_t             path[MAX_PATH]               = { 0 };
+    wchar_t             relative[MAX_PATH]           = { 0 };
+    char                header[PYTHON_METADATA_SIZE] = { 0 };
+    const unsigned long minor                        = find_minor_version(interpreter, directory);
+
+    return minor && swprintf_s(relative, MAX_PATH, L"../include/python3.%lu/patchlevel.h", minor) > 0 && join_path(path, directory, relative)
+        && read_metadata_file(path, header) && parse_patchlevel(interpreter, header);
+}
+
+#endif
+
+// tries the metadata files one after the other, see the top of the file
+static bool __cdecl read_metadata(_Inout_ python_interpreter_t* const restrict interpreter) {
+    wchar_t directory[MAX_PATH]       = { 0 };
+    wchar_t path[MAX_PATH]            = { 0 };
+    char    cfg[PYTHON_METADATA_SIZE] = { 0 };
+
+    wcscpy_s(directory, MAX_PATH, interpreter->path);
+    wchar_t* const separator = wcsrchr(directory, PATH_SEPARATOR);
+    if (!separator) return false;
+    *separator = L'\0';
+
+    // a virtual environment's interpreter sits in bin or Scripts, pyvenv.cfg in the directory above
+    if (join_path(path, directory, L"pyvenv.cfg") && read_metadata_file(path, cfg) && parse_pyvenv(interpreter, cfg)) return true;
+    if (join_path(path, directory, L"../pyvenv.cfg") && read_metadata_file(path, cfg) && parse_pyvenv(interpreter, cfg)) return true;
+#ifdef _WIN32
+    if (read_version_resource(interpreter)) return true;
+#endif
+    return read_patchlevel(interpreter, directory);
+}
+
+// the version an interpreter printed when run with --version, "Python 3.12.4\r\n"
+static void __cdecl parse_version_output(
+    _Inout_ python_interpreter_t* const restrict interpreter, _In_ const char* const restrict output, _In_ const unsigned long length
+) {
+    unsigned long end = 7;
+    if (length < 7 || memcmp(output, "Python ", 7)) return;
+    while (end < length && output[end] != '\r' && output[end] != '\n' && output[end] != ' ') ++end;
+    store_version(interpreter, output + 7, end - 7, PYTHON_SOURCE_SPAWN); // garbage stays unknown
+}
+
+// an interpreter run with --version, and what it printed so far
+typedef struct _probe {
+        python_interpreter_t* interpreter;
+#ifdef _WIN32
+        HANDLE process;
+        HANDLE output; // read end of the pipe
+#else
+        pid_t process;
+        int   output;
 #endif
+        char          buffer[BUFF_SIZE];
+        unsigned long length;
+} probe_t;
+
+#ifdef _WIN32
+
+// starts the interpreter with --version, its stdout and stderr being the write end of a new pipe
+static bool __cdecl launch_probe(_Inout_ probe_t* const restrict probe) {
+    // a struct to specify the security attributes of the pipes, .bInheritHandle = true makes pipe handles inheritable.
+    const SECURITY_ATTRIBUTES    sec_attrs              = {
+                     .bInheritHandle = true, .lpSecurityDescriptor = NULL, .nLength = sizeof(SECURITY_ATTRIBUTES)
+    };
+    PROCESS_INFORMATION          process_info           = { 0 };
+    HANDLE                       write_end              = NULL;
+    uint64_t                     attributes[32]         = { 0 }; // room for a PROC_THREAD_ATTRIBUTE_LIST with a single attribute
+    SIZE_T                       attributes_size        = sizeof(attributes);
+    LPPROC_THREAD_ATTRIBUTE_LIST attribute_list         = (LPPROC_THREAD_ATTRIBUTE_LIST) attributes;
+    bool                         is_list_prepared       = false;
+    bool                         is_launched            = false;
+    // CreateProcessW can modify the contents of lpCommandLine, it must not be a string literal
+    wchar_t                      command[MAX_PATH + 16] = { 0 }; // quoted, paths have spaces in them
+
+    if (!CreatePipe(&probe->output, &write_end, &sec_attrs, 0)) {
+        fwprintf_s(stderr, L"Error %lu in CreatePipe.\n", GetLastError());
+        return false;
+    }
+    // the read end stays with this process
+    if (!SetHandleInformation(probe->output, HANDLE_FLAG_INHERIT, 0)) {
+        fwprintf_s(stderr, L"Error %lu in SetHandleInformation.\n", GetLastError());
+        goto cleanup;
+    }
 
-    // the lpApplicationName parameter can be NULL. In that case, the module name must be the first white
-    // space delimited token in the lpCommandLine string. If you are using a long file name that contains
-    // a space, use quoted strings to indicate where the file name ends and the arguments begin; otherwise,
-    // the file name is ambiguous.
+    // the probes run alongside the fetch, so this process has sockets and the pipes of the other probes open while the interpreter starts.
+    // the handle list makes the write end of this pipe the one handle the interpreter inherits, whatever else happens to be inheritable
+    if (!InitializeProcThreadAttributeList(attribute_list, 1, 0, &attributes_size)) {
+        fwprintf_s(stderr, L"Error %lu in InitializeProcThreadAttributeList.\n", GetLastError());
+        goto cleanup;
+    }
+    is_list_prepared = true;
+    if (!UpdateProcThreadAttribute(attribute_list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &write_end, sizeof(HANDLE), NULL, NULL)) {
+        fwprintf_s(stderr, L"Error %lu in UpdateProcThreadAttribute.\n", GetLastError());
+        goto cleanup;
+    }
 
-    const bool is_created = CreateProcessW( // NOLINT(readability-implicit-bool-conversion)
-        NULL,                               // assumes python.exe is in path.
-        command, // lpCommandline must be a modifiable string, passing a string literal will (did) raise an access violation exception
+    STARTUPINFOEXW startup_info = {
+        .StartupInfo = {
+            .cb          = sizeof(STARTUPINFOEXW),
+            .hStdError   = write_end,
+            .hStdOutput  = write_end,
+            .dwFlags     = STARTF_USESHOWWINDOW | STARTF_USESTDHANDLES,
+            .wShowWindow = SW_HIDE // prevents cmd window from flashing, requires STARTF_USESHOWWINDOW in dwFlags.
+        },
+        .lpAttributeList = attribute_list
+    };
+    swprintf_s(command, MAX_PATH + 16, L"\"%s\" --version", probe->interpreter->path);
+    is_launched = CreateProcessW( // NOLINT(readability-implicit-bool-conversion)
+        NULL,
+        command,
         NULL,
         NULL,
         true,
-        CREATE_NO_WINDOW,
+        CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT,
         NULL,
         NULL,
-        &python_startup_info,
-        &python_proc_info
+        &startup_info.StartupInfo,
+        &process_info
     );
+    if (!is_launched) {
+        fwprintf_s(stderr, L"Error %lu in CreateProcessW for %s.\n", GetLastError(), probe->interpreter->path);
+        goto cleanup;
+    }
 
-    if (!is_created) { // if the invocation failed
-        fwprintf_s(stderr, L"Error %lu in CreateProcessW.\n", GetLastError());
-        return false;
+    // with the child's copy of the write end being the only one left, ReadFile sees the end of the pipe once the child exits
+    CloseHandle(process_info.hThread);
+    probe->process = process_info.hProcess;
+
+cleanup:
+    if (is_list_prepared) DeleteProcThreadAttributeList(attribute_list);
+    CloseHandle(write_end);
+    if (!is_launched) CloseHandle(probe->output);
+    return is_launched;
+}
+
+// runs the probes until every interpreter exited or the time is up
+static void __cdecl collect_probes(_Inout_ probe_t* const restrict probes, _In_ unsigned long count) {
+    HANDLE                   processes[PYTHON_MAX_INTERPRETERS] = { 0 };
+    const unsigned long long deadline                           = GetTickCount64() + PYTHON_PROBE_TIMEOUT;
+
+    while (count) {
+        for (unsigned long i = 0; i < count; ++i) processes[i] = probes[i].process;
+        const unsigned long long now    = GetTickCount64();
+        const unsigned long      status = WaitForMultipleObjects(count, processes, false, now < deadline ? (unsigned long) (deadline - now) : 0);
+        if (status >= WAIT_OBJECT_0 + count) { // WAIT_TIMEOUT or WAIT_FAILED, the rest is given up on
+            if (status == WAIT_FAILED) fwprintf_s(stderr, L"Error %lu in WaitForMultipleObjects.\n", GetLastError());
+            for (unsigned long i = 0; i < count; ++i) {
+                fwprintf_s(stderr, L"Warning: %s did not report its version in time!\n", probes[i].interpreter->path);
+                TerminateProcess(probes[i].process, EXIT_FAILURE);
+                CloseHandle(probes[i].process);
+                CloseHandle(probes[i].output);
+            }
+            return;
+        }
+
+        // the interpreter exited and everything it wrote is in the pipe, read up to the end of it
+        probe_t* const restrict probe       = probes + (status - WAIT_OBJECT_0);
+        unsigned long           nread_bytes = 0;
+        while (probe->length < BUFF_SIZE && ReadFile(probe->output, probe->buffer + probe->length, BUFF_SIZE - probe->length, &nread_bytes, NULL)
+               && nread_bytes)
+            probe->length += nread_bytes;
+        parse_version_output(probe->interpreter, probe->buffer, probe->length);
+
+        CloseHandle(probe->process);
+        CloseHandle(probe->output);
+        *probe = probes[--count];
     }
+}
+
+#else
 
-    // wait 100 milliseconds until python.exe finishes.
-    const unsigned long wait_status = WaitForSingleObject(python_proc_info.hProcess, EXECUTION_TIMEOUT);
-    switch (wait_status) {
-        case WAIT_ABANDONED :
-            fputws(L"Mutex object was not released by the child thread before the caller thread terminated.\n", stderr);
-            break;
-        case WAIT_TIMEOUT : fputws(L"The time-out interval has elapsed, and the object's state is nonsignaled.\n", stderr); break;
-        case WAIT_FAILED :
-            fwprintf_s(stderr, L"Error %lu: Wait failed.\n", GetLastError());
-            break;
-            // WAIT_OBJECT_0 0x00000000L -> The state of the specified object is signaled, wait success
-        default : break;
+static bool __cdecl launch_probe(_Inout_ probe_t* const restrict probe) {
+    char                       path[MAX_PATH * 4] = { 0 };
+    int                        ends[2]            = { -1, -1 }; // read end, write end
+    posix_spawn_file_actions_t actions;
+
+    if (wcstombs(path, probe->interpreter->path, sizeof(path)) == (size_t) -1) return false;
+    if (pipe(ends)) {
+        fwprintf_s(stderr, L"Error %d in pipe.\n", errno);
+        return false;
     }
+    // close on exec keeps the other interpreters from inheriting this pipe
+    fcntl(ends[0], F_SETFD, FD_CLOEXEC);
+    fcntl(ends[1], F_SETFD, FD_CLOEXEC);
 
-    // close handles to the child process and its primary thread.
-    CloseHandle(python_proc_info.hProcess);
-    CloseHandle(python_proc_info.hThread);
+    char* const arguments[] = { path, "--version", NULL };
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, ends[1], STDOUT_FILENO); // dup2 clears close on exec on the copies
+    posix_spawn_file_actions_adddup2(&actions, ends[1], STDERR_FILENO);
+    const int status = posix_spawn(&probe->process, path, &actions, NULL, arguments, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(ends[1]);
 
+    if (status) {
+        fwprintf_s(stderr, L"Error %d in posix_spawn for %s.\n", status, probe->interpreter->path);
+        close(ends[0]);
+        return false;
+    }
+    probe->output = ends[0];
     return true;
 }
 
-// reads python.exe's stdout and writes it to the buffer.
-[[nodiscard]] bool __cdecl read_stdout_python(_Inout_ char* const restrict buffer, _In_ const unsigned long size) {
-    // if size(stdout) > size, write will be truncated
+static void __cdecl collect_probes(_Inout_ probe_t* const restrict probes, _In_ unsigned long count) {
+    struct pollfd   descriptors[PYTHON_MAX_INTERPRETERS] = { 0 };
+    struct timespec now                                  = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const long long deadline = now.tv_sec * 1000LL + now.tv_nsec / 1000000 + (long long) PYTHON_PROBE_TIMEOUT;
 
-    unsigned long nread_bytes = 0;
-    const bool    read_status = ReadFile(this_process_stdin_handle, buffer, size, &nread_bytes, NULL);
+    while (count) {
+        for (unsigned long i = 0; i < count; ++i) descriptors[i] = (struct pollfd) { .fd = probes[i].output, .events = POLLIN };
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const long long remaining = deadline - (now.tv_sec * 1000LL + now.tv_nsec / 1000000);
+        const int       nready    = remaining > 0 ? poll(descriptors, count, (int) remaining) : 0;
+        if (nready < 0 && errno == EINTR) continue;
+        if (nready <= 0) { // timed out or failed, the rest is given up on
+            if (nready < 0) fwprintf_s(stderr, L"Error %d in poll.\n", errno);
+            for (unsigned long i = 0; i < count; ++i) {
+                fwprintf_s(stderr, L"Warning: %s did not report its version in time!\n", probes[i].interpreter->path);
+                kill(probes[i].process, SIGKILL);
+                waitpid(probes[i].process, NULL, 0);
+                close(probes[i].output);
+            }
+            return;
+        }
+
+        // walked backwards, finished probes are replaced by the last one
+        for (unsigned long i = count; i-- > 0;) {
+            if (!descriptors[i].revents) continue;
+            probe_t* const restrict probe  = probes + i;
+            const ssize_t           nbytes = read(probe->output, probe->buffer + probe->length, BUFF_SIZE - probe->length);
+            if (nbytes > 0 && (probe->length += (unsigned long) nbytes) < BUFF_SIZE) continue;
+
+            // end of the pipe, the interpreter exited (or filled the buffer, which is more than a version takes)
+            parse_version_output(probe->interpreter, probe->buffer, probe->length);
+            close(probe->output);
+            kill(probe->process, SIGKILL); // no-op for interpreters that already exited
+            waitpid(probe->process, NULL, 0);
+            *probe = probes[--count];
+        }
+    }
+}
+
+#endif
+
+// runs every interpreter the metadata didn't know the version of with --version, concurrently
+static void __cdecl spawn_probes(_Inout_ python_interpreter_t* const restrict interpreters, _In_ const unsigned long count) {
+    probe_t       probes[PYTHON_MAX_INTERPRETERS] = { 0 };
+    unsigned long nprobes                         = 0;
+
+    for (unsigned long i = 0; i < count; ++i) {
+        if (interpreters[i].source != PYTHON_SOURCE_NONE) continue;
+        probes[nprobes] = (probe_t) { .interpreter = interpreters + i, .length = 0 };
+        if (launch_probe(probes + nprobes)) nprobes++; // launch_probe will do the error reporting
+    }
+    if (nprobes) collect_probes(probes, nprobes);
+}
+
+// the PATH environment variable as a wide string, caller frees it
+static wchar_t* __cdecl read_path_variable(void) {
+#ifdef _WIN32
+    const unsigned long size = GetEnvironmentVariableW(L"PATH", NULL, 0);
+    wchar_t* const      list = size ? malloc(sizeof(wchar_t) * size) : NULL;
+    if (size && list && GetEnvironmentVariableW(L"PATH", list, size) < size) return list;
+    if (!size || list) fwprintf_s(stderr, L"Error %lu in GetEnvironmentVariableW.\n", GetLastError());
+#else
+    const char* const variable = getenv("PATH");
+    const size_t      size     = variable ? strlen(variable) + 1 : 0;
+    wchar_t* const    list     = size ? malloc(sizeof(wchar_t) * size) : NULL;
+    if (size && list && mbstowcs(list, variable, size) != (size_t) -1) return list;
+    if (!size || list) fputws(L"Error: PATH is empty or not a valid string!\n", stderr);
+#endif
+    if (size && !list) fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+    free(list);
+    return NULL;
+}
+
+static int __cdecl compare_paths(_In_ const void* const left, _In_ const void* const right) {
+    return wcscmp(((const python_interpreter_t*) left)->path, ((const python_interpreter_t*) right)->path);
+}
+
+// appends the interpreters in a directory of PATH that aren't in the list yet, in the order of their names
+static unsigned long __cdecl list_directory(
+    _In_ const wchar_t* const restrict directory,
+    _Inout_ python_interpreter_t* const restrict interpreters,
+    _In_ unsigned long count,
+    _In_ const unsigned long capacity,
+    _In_ const bool is_primary_only
+) {
+    const unsigned long first          = count;
+    wchar_t             path[MAX_PATH] = { 0 };
+
+#ifdef _WIN32
+    WIN32_FIND_DATAW found = { 0 };
+    if (!join_path(path, directory, L"python*.exe")) return count;
+    const HANDLE search = FindFirstFileW(path, &found);
+    if (search == INVALID_HANDLE_VALUE) return count;
+    do {
+        const wchar_t* const name = found.cFileName;
+        if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+#else
+    char    name_buffer[MAX_PATH * 4] = { 0 };
+    wchar_t name[MAX_PATH]            = { 0 };
+    if (wcstombs(name_buffer, directory, sizeof(name_buffer)) == (size_t) -1) return count;
+    DIR* const restrict search = opendir(name_buffer);
+    if (!search) return count;
+    for (const struct dirent* entry = readdir(search); entry; entry = readdir(search)) {
+        if (strncmp(entry->d_name, "python3", 7) || mbstowcs(name, entry->d_name, MAX_PATH) == (size_t) -1) continue;
+#endif
+        if (count == capacity || !is_interpreter_name(name, is_primary_only) || !join_path(path, directory, name)) continue;
+#ifndef _WIN32
+        if (wcstombs(name_buffer, path, sizeof(name_buffer)) == (size_t) -1 || access(name_buffer, X_OK)) continue;
+#endif
+
+        bool is_listed = false; // PATH lists the same directory twice more often than one would think
+        for (unsigned long i = 0; i < first && !is_listed; ++i) is_listed = names_equal(interpreters[i].path, path);
+        if (is_listed) continue;
+
+        interpreters[count] = (python_interpreter_t) { .version = { 0 }, .source = PYTHON_SOURCE_NONE };
+        wcscpy_s(interpreters[count++].path, MAX_PATH, path);
+#ifdef _WIN32
+    } while (FindNextFileW(search, &found));
+    FindClose(search);
+#else
+    }
+    closedir(search);
+#endif
+
+    qsort(interpreters + first, count - first, sizeof(python_interpreter_t), compare_paths);
+    return count;
+}
+
+[[nodiscard]] unsigned long __cdecl find_python_interpreters(
+    _Inout_ python_interpreter_t* const restrict interpreters, _In_ const unsigned long capacity, _In_ const bool is_primary_only
+) {
+    const trace_span_t span  = trace_begin("python probe", "python");
+    unsigned long      count = 0;
+
+    wchar_t* const restrict list = read_path_variable();
+    if (!list) goto PREMATURE_RETURN; // read_path_variable will do the error reporting
+
+#if defined(_DEBUG) || defined(DEBUG)
+    // the dummy python.exe of the python project answers first in debug builds
+    count = list_directory(L"python\\bin\\Debug", interpreters, count, capacity, is_primary_only);
+#endif
+
+    for (wchar_t *directory = list, *end = list; end && count < (is_primary_only ? 1 : capacity); directory = end + 1) {
+        end = wcschr(directory, PATH_LIST_SEPARATOR);
+        if (end) *end = L'\0';
+
+        unsigned long length = (unsigned long) wcslen(directory);
+        if (length && directory[0] == L'"') { // "C:\Program Files\Python312";
+            directory++;
+            length--;
+            if (length && directory[length - 1] == L'"') directory[--length] = L'\0';
+        }
+        while (length > 1 && directory[length - 1] == PATH_SEPARATOR) directory[--length] = L'\0';
+        if (length) count = list_directory(directory, interpreters, count, capacity, is_primary_only);
+    }
+    free(list);
+
+    for (unsigned long i = 0; i < count; ++i) read_metadata(interpreters + i);
+    spawn_probes(interpreters, count); // only the ones read_metadata found nothing for
 
-    if (!read_status) fwprintf_s(stderr, L"Error %lu in ReadFile.\n", GetLastError());
-    CloseHandle(python_stdout_handle); // close the child's ends of the pipe
-    return read_status;
+PREMATURE_RETURN:
+    trace_end(span, 0, count);
+    return count;
 }
 
 [[nodiscard]] bool __cdecl get_system_python_version(_Inout_ char* const restrict version, _In_ const unsigned long size) {
-    // a struct to specify the security attributes of the pipes, .bInheritHandle = true makes pipe handles inheritable.
-    const SECURITY_ATTRIBUTES sec_attrs = { .bInheritHandle = true, .lpSecurityDescriptor = NULL, .nLength = sizeof(SECURITY_ATTRIBUTES) };
+    python_interpreter_t interpreter = { 0 };
 
-    // creating child process ------> parent process pipe.
-    if (!CreatePipe(&this_process_stdin_handle, &python_stdout_handle, &sec_attrs, 0)) {
-        fwprintf_s(stderr, L"Error %lu in CreatePipe.\n", GetLastError());
+    if (!find_python_interpreters(&interpreter, 1, true)) {
+        fputws(L"Error: there is no " PYTHON_EXECUTABLE L" on PATH!\n", stderr);
         return false;
     }
-
-    // make the parent process's handles uninheritable.
-    if (!SetHandleInformation(this_process_stdin_handle, HANDLE_FLAG_INHERIT, false)) {
-        fwprintf_s(stderr, L"Error %lu in SetHandleInformation.\n", GetLastError());
+    if (!*interpreter.version) {
+        fwprintf_s(stderr, L"Error: the version of %s is unknown!\n", interpreter.path);
         return false;
     }
+    return sprintf_s(version, size, "%s", interpreter.version) > 0;
+}
+
+// the task python_probe_start runs
+static bool __cdecl probe_system_python(_Inout_opt_ void* const argument) {
+    python_probe_t* const restrict probe = argument;
+    if (get_system_python_version(probe->version, BUFF_SIZE)) return true;
+    fputws(L"Error: Call to get_system_python_version failed!\n", stderr);
+    *probe->version = '\0';
+    return false;
+}
 
-    const bool launch_status = launch_python();
-    if (!launch_status) return false; // launch_python will do the error reporting
+void __cdecl python_probe_start(_Inout_ python_probe_t* const restrict probe) {
+    *probe->version = '\0';
+    task_start(&probe->task, probe_system_python, probe);
+}
 
-    const bool read_status = read_stdout_python(version, size);
-    if (!read_status) return false; // read_stdout_python will do the error reporting
+[[nodiscard]] const char* __cdecl python_probe_wait(_Inout_ python_probe_t* const restrict probe) {
+    task_wait(&probe->task); // a failed probe leaves the version empty, which everything downstream handles
+    return probe->version;
+}
 
-    return true;
+void __cdecl print_python_interpreters(_In_ const python_interpreter_t* const restrict interpreters, _In_ const unsigned long count) {
+    static const wchar_t* const sources[] = { L"unknown", L"pyvenv.cfg", L"version resource", L"patchlevel.h", L"--version" };
+    for (unsigned long i = 0; i < count; ++i)
+        wprintf_s(
+            L"%-14S %-18s %s\n",
+            *interpreters[i].version ? interpreters[i].version + 7 : "unknown",
+            sources[interpreters[i].source],
+            interpreters[i].path
+        );
 }
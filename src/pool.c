@@ -0,0 +1,138 @@
+#include <project.h>
+
+// a small process wide pool of idle keep-alive connections, keyed by the transport that opened them and the server:port they lead to.
+// transports check a connection out before sending a request and check it back in once the response has been read in full, so consecutive
+// requests to the same host skip the TCP (and TLS) handshakes. the pool is tiny, a linear search over HTTP_POOL_MAX_IDLE slots beats any
+// hashing scheme here.
+
+#ifdef _WIN32
+static SRWLOCK lock = SRWLOCK_INIT;
+    #define pool_lock()   AcquireSRWLockExclusive(&lock)
+    #define pool_unlock() ReleaseSRWLockExclusive(&lock)
+#else
+    #include <pthread.h>
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    #define pool_lock()   pthread_mutex_lock(&lock)
+    #define pool_unlock() pthread_mutex_unlock(&lock)
+#endif
+
+typedef struct _pool_entry {
+        const void*        owner;             // transport that opened the connection, NULL for vacant slots
+        unsigned short     port;              // port of the server
+        wchar_t            server[BUFF_SIZE]; // server the connection leads to
+        uintptr_t          connection;        // the transport's handle
+        pool_close_t       close;             // how to close the handle
+        unsigned long long last_used;         // value of ticks when the connection was checked in
+} pool_entry_t;
+
+static pool_entry_t       entries[HTTP_POOL_MAX_IDLE] = { 0 };
+static pool_stats_t       stats                       = { 0 };
+static unsigned long long ticks                       = 0; // a logical clock, only the order of check ins matters
+
+static bool __cdecl is_match(
+    _In_ const pool_entry_t* const restrict entry,
+    _In_ const void* const restrict owner,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port
+) {
+    return entry->owner == owner && entry->port == port && !wcscmp(entry->server, server);
+}
+
+// closes the connection in the slot and marks the slot vacant, call with the lock held
+static void __cdecl evict(_Inout_ pool_entry_t* const restrict entry) {
+    entry->close(entry->connection);
+    entry->owner = NULL;
+    stats.evictions++;
+}
+
+[[nodiscard]] bool __cdecl pool_checkout(
+    _In_ const void* const restrict owner,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_opt_ const pool_probe_t probe,
+    _Inout_ uintptr_t* const restrict connection
+) {
+    pool_lock();
+
+    for (;;) {
+        pool_entry_t* latest = NULL;
+        for (unsigned long i = 0; i < HTTP_POOL_MAX_IDLE; ++i)
+            if (is_match(entries + i, owner, server, port) && (!latest || entries[i].last_used > latest->last_used)) latest = entries + i;
+
+        if (!latest) break;
+
+        if (probe && !probe(latest->connection)) { // the server has closed it in the meantime
+            evict(latest);
+            continue;
+        }
+
+        *connection   = latest->connection;
+        latest->owner = NULL;
+        stats.hits++;
+        pool_unlock();
+        return true;
+    }
+
+    stats.misses++;
+    pool_unlock();
+    return false;
+}
+
+void __cdecl pool_checkin(
+    _In_ const void* const restrict owner,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const uintptr_t connection,
+    _In_ const pool_close_t close
+) {
+    pool_lock();
+
+    pool_entry_t *vacant = NULL, *oldest = NULL, *oldest_of_host = NULL; // NOLINT(readability-isolate-declaration)
+    unsigned long of_host = 0;
+
+    for (unsigned long i = 0; i < HTTP_POOL_MAX_IDLE; ++i) {
+        pool_entry_t* const entry = entries + i;
+        if (!entry->owner) {
+            if (!vacant) vacant = entry;
+            continue;
+        }
+        if (!oldest || entry->last_used < oldest->last_used) oldest = entry;
+        if (is_match(entry, owner, server, port)) {
+            of_host++;
+            if (!oldest_of_host || entry->last_used < oldest_of_host->last_used) oldest_of_host = entry;
+        }
+    }
+
+    // make room, preferring to drop a connection to the same host over starving other hosts
+    if (of_host >= HTTP_POOL_MAX_IDLE_PER_HOST) {
+        evict(oldest_of_host);
+        vacant = oldest_of_host;
+    } else if (!vacant) {
+        evict(oldest);
+        vacant = oldest;
+    }
+
+    vacant->owner      = owner;
+    vacant->port       = port;
+    vacant->connection = connection;
+    vacant->close      = close;
+    vacant->last_used  = ++ticks;
+    wcscpy_s(vacant->server, BUFF_SIZE, server);
+    stats.reuses++;
+
+    pool_unlock();
+}
+
+void __cdecl pool_drain(void) {
+    pool_lock();
+    for (unsigned long i = 0; i < HTTP_POOL_MAX_IDLE; ++i)
+        if (entries[i].owner) evict(entries + i);
+    pool_unlock();
+}
+
+[[nodiscard]] pool_stats_t __cdecl pool_statistics(void) {
+    pool_lock();
+    const pool_stats_t snapshot = stats;
+    pool_unlock();
+    return snapshot;
+}
@@ -0,0 +1,386 @@
+#include <project.h>
+
+// output of the parsed releases. every format is rendered into a single byte buffer sized up front by render_size and flushed to stdout
+// with one WriteFile, so the cost of printing is a formatting pass over the releases plus a single write no matter how many rows there are.
+// the spans are narrow UTF-8 (ASCII in practice) and are copied as they are, nothing goes through the wide printf family, a locale or a
+// code page conversion. besides the coloured table there are three machine readable formats for scripts, JSON, NDJSON and CSV.
+
+static const wchar_t* const format_names[OUTPUT_FORMATS] = { L"table", L"json", L"ndjson", L"csv" };
+
+#define TABLE_RULE           "-----------------------------------------------------------------------------------\n"
+#define TABLE_HEADER         "|\x1b[36m  Version\x1b[m  |\x1b[36m                            Download URL\x1b[m                             |\n"
+#define TABLE_VERSION_COLUMN 7  // versions shorter than this are padded with spaces, longer ones widen their row
+#define TABLE_URL_COLUMN     66 // likewise for the download URLs
+#define TABLE_ROW_SIZE       64 // bytes a table row takes up besides its padded version and URL, escape sequences included
+#define JSON_RECORD_SIZE     96 // bytes a JSON or NDJSON record takes up besides its escaped version and URL, the kind included
+#define CSV_RECORD_SIZE      32 // bytes a CSV record takes up besides its quoted version and URL, the kind included
+#define RENDER_PREAMBLE_SIZE 512 // the table's header and footer, the enclosing JSON object, the CSV header
+
+[[nodiscard]] output_format_t __cdecl find_output_format(_In_ const wchar_t* const restrict name) {
+    for (unsigned long i = 0; i < OUTPUT_FORMATS; ++i)
+        if (!wcscmp(format_names[i], name)) return (output_format_t) i;
+    return OUTPUT_FORMATS;
+}
+
+// "Python 3.10.5" as returned by get_system_python_version, the version number starts at offset 7 and runs over digits and dots.
+// an empty string or NULL gives an empty version, which never matches a release
+static unsigned long __cdecl system_python_version(_In_opt_ const char* const restrict syspyversion, _Inout_ char* const restrict version) {
+    unsigned long length = 0;
+    if (syspyversion)
+        for (unsigned long i = 7; i < BUFF_SIZE && (syspyversion[i] == '.' || (syspyversion[i] >= '0' && syspyversion[i] <= '9')); ++i)
+            version[length++] = syspyversion[i];
+    return length;
+}
+
+[[nodiscard]] unsigned long __cdecl render_size(_In_ const results_t results, _In_ const unsigned artifacts, _In_ const output_format_t format) {
+    unsigned long size = RENDER_PREAMBLE_SIZE + BUFF_SIZE * 6; // the system python version goes into the JSON object, escaped
+    for (unsigned long i = 0; i < results.count; ++i) {
+        if (!(artifacts & ARTIFACT_MASK(results.kinds[i]))) continue;
+        const unsigned long text = results.versions[i].length + results.downloadurls[i].length;
+        // a JSON string escapes a byte to at most 6 (\u001f), a quoted CSV field doubles the quotes at worst
+        size += format == OUTPUT_TABLE ? TABLE_ROW_SIZE + TABLE_VERSION_COLUMN + TABLE_URL_COLUMN + text
+              : format == OUTPUT_CSV   ? CSV_RECORD_SIZE + 2 * text
+                                       : JSON_RECORD_SIZE + 6 * text;
+    }
+    return size;
+}
+
+static inline char* __cdecl append(_Inout_ char* restrict cursor, _In_ const char* const restrict bytes, _In_ const unsigned long size) {
+    memcpy(cursor, bytes, size);
+    return cursor + size;
+}
+
+#define append_literal(cursor, literal) append((cursor), (literal), sizeof(literal) - 1)
+
+// the bytes, left aligned in a column of width bytes like the %-*s conversion would
+static inline char* __cdecl append_padded(
+    _Inout_ char* restrict cursor, _In_ const char* const restrict bytes, _In_ const unsigned long size, _In_ const unsigned long width
+) {
+    cursor = append(cursor, bytes, size);
+    if (size < width) {
+        memset(cursor, ' ', width - size);
+        cursor += width - size;
+    }
+    return cursor;
+}
+
+// the names of the artifact kinds in narrow form, looked up once per render rather than once per release
+typedef struct _kind_names {
+        char          names[ARTIFACT_KINDS][BUFF_SIZE / 4];
+        unsigned long lengths[ARTIFACT_KINDS];
+} kind_names_t;
+
+static void __cdecl narrow_kind_names(_Inout_ kind_names_t* const restrict kinds) {
+    for (unsigned kind = 0; kind < ARTIFACT_KINDS; ++kind) {
+        const wchar_t* const name = artifact_name((artifact_kind_t) kind);
+        unsigned long        i    = 0;
+        for (; name[i] && i < BUFF_SIZE / 4; ++i) kinds->names[kind][i] = (char) name[i]; // the names are ASCII, narrowing is a plain copy
+        kinds->lengths[kind] = i;
+    }
+}
+
+// URLs hardly ever hold a byte JSON or CSV would have to escape, so the escaping below looks for those 8 bytes at a time
+#define BYTES(byte) (0x0101010101010101LLU * (byte)) // the byte in every lane of a word
+
+static inline uint64_t __cdecl load_word(_In_ const char* const restrict bytes) {
+    uint64_t word = 0;
+    memcpy(&word, bytes, sizeof(uint64_t));
+    return word;
+}
+
+// nonzero when a byte of the word equals byte
+static inline uint64_t __cdecl has_byte(_In_ const uint64_t word, _In_ const unsigned char byte) {
+    const uint64_t difference = word ^ BYTES(byte);
+    return (difference - BYTES(0x01)) & ~difference & BYTES(0x80);
+}
+
+// nonzero when a byte of the word is a control character (below 0x20)
+static inline uint64_t __cdecl has_control(_In_ const uint64_t word) { return (word - BYTES(0x20)) & ~word & BYTES(0x80); }
+
+static inline bool __cdecl is_json_special(_In_ const unsigned char byte) { return byte < 0x20 || byte == '"' || byte == '\\'; }
+
+static inline bool __cdecl is_csv_special(_In_ const unsigned char byte) { return byte == ',' || byte == '"' || byte == '\r' || byte == '\n'; }
+
+// length of the leading run of bytes a JSON string carries as they are
+static unsigned long __cdecl json_plain_run(_In_ const char* const restrict bytes, _In_ const unsigned long size) {
+    unsigned long i = 0;
+    for (uint64_t word = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        word = load_word(bytes + i);
+        if (has_control(word) | has_byte(word, '"') | has_byte(word, '\\')) break;
+    }
+    while (i < size && !is_json_special((unsigned char) bytes[i])) ++i;
+    return i;
+}
+
+// length of the leading run of bytes a CSV field can hold without being quoted
+static unsigned long __cdecl csv_plain_run(_In_ const char* const restrict bytes, _In_ const unsigned long size) {
+    unsigned long i = 0;
+    for (uint64_t word = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        word = load_word(bytes + i);
+        if (has_byte(word, ',') | has_byte(word, '"') | has_byte(word, '\r') | has_byte(word, '\n')) break;
+    }
+    while (i < size && !is_csv_special((unsigned char) bytes[i])) ++i;
+    return i;
+}
+
+// a JSON string, quotes included
+static char* __cdecl append_json_string(_Inout_ char* restrict cursor, _In_ const char* const restrict bytes, _In_ const unsigned long size) {
+    static const char hexdigits[] = "0123456789abcdef";
+    *cursor++                     = '"';
+    for (unsigned long i = 0; i < size; ++i) {
+        const unsigned long run  = json_plain_run(bytes + i, size - i);
+        cursor                   = append(cursor, bytes + i, run);
+        i                       += run;
+        if (i == size) break;
+
+        const unsigned char byte = (unsigned char) bytes[i];
+        if (byte < 0x20) {
+            cursor    = append_literal(cursor, "\\u00");
+            *cursor++ = hexdigits[byte >> 4];
+            *cursor++ = hexdigits[byte & 0xF];
+        } else {
+            *cursor++ = '\\';
+            *cursor++ = (char) byte;
+        }
+    }
+    *cursor++ = '"';
+    return cursor;
+}
+
+// a CSV field, quoted only when it has to be (RFC 4180)
+static char* __cdecl append_csv_field(_Inout_ char* restrict cursor, _In_ const char* const restrict bytes, _In_ const unsigned long size) {
+    if (csv_plain_run(bytes, size) == size) return append(cursor, bytes, size);
+
+    *cursor++ = '"';
+    for (unsigned long i = 0; i < size; ++i) {
+        if (bytes[i] == '"') *cursor++ = '"';
+        *cursor++ = bytes[i];
+    }
+    *cursor++ = '"';
+    return cursor;
+}
+
+// {"version":"3.13.3","url":"https://...","kind":"amd64","installed":false}
+static char* __cdecl append_json_record(
+    _Inout_ char* restrict cursor,
+    _In_ const results_t results,
+    _In_ const unsigned long i,
+    _In_ const kind_names_t* const restrict kinds,
+    _In_ const bool is_installed
+) {
+    cursor = append_literal(cursor, "{\"version\":");
+    cursor = append_json_string(cursor, results.text + results.versions[i].offset, results.versions[i].length);
+    cursor = append_literal(cursor, ",\"url\":");
+    cursor = append_json_string(cursor, results.text + results.downloadurls[i].offset, results.downloadurls[i].length);
+    cursor = append_literal(cursor, ",\"kind\":\"");
+    cursor = append(cursor, kinds->names[results.kinds[i]], kinds->lengths[results.kinds[i]]);
+    cursor = is_installed ? append_literal(cursor, "\",\"installed\":true}") : append_literal(cursor, "\",\"installed\":false}");
+    return cursor;
+}
+
+[[nodiscard]] unsigned long __cdecl render(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_opt_ const char* const restrict syspyversion,
+    _In_ const output_format_t format,
+    _Inout_ char* const restrict buffer
+) {
+    char                version[BUFF_SIZE] = { 0 }; // the installed python's version, its releases are highlighted or flagged as installed
+    const unsigned long version_length     = system_python_version(syspyversion, version);
+    char*               cursor             = buffer;
+    bool                is_first           = true;
+    kind_names_t        kinds              = { 0 };
+
+    if (format != OUTPUT_TABLE) narrow_kind_names(&kinds);
+
+    if (format == OUTPUT_TABLE) cursor = append_literal(cursor, TABLE_RULE TABLE_HEADER TABLE_RULE);
+    else if (format == OUTPUT_JSON) {
+        cursor = append_literal(cursor, "{\"system_python\":");
+        cursor = version_length ? append_json_string(cursor, version, version_length) : append_literal(cursor, "null");
+        cursor = append_literal(cursor, ",\"releases\":[");
+    } else if (format == OUTPUT_CSV)
+        cursor = append_literal(cursor, "version,url,kind,installed\n");
+
+    for (unsigned long i = 0; i < results.count; ++i) {
+        if (!(artifacts & ARTIFACT_MASK(results.kinds[i]))) continue;
+        const span_t version_span = results.versions[i], url = results.downloadurls[i]; // NOLINT(readability-isolate-declaration)
+        const bool   is_installed
+            = version_length && version_span.length == version_length && !memcmp(version, results.text + version_span.offset, version_length);
+
+        switch (format) {
+            case OUTPUT_TABLE :
+                // the installed version's row is highlighted as a whole
+                cursor = is_installed ? append_literal(cursor, "|\x1b[35;47;1m   ") : append_literal(cursor, "|\x1b[91m   ");
+                cursor = append_padded(cursor, results.text + version_span.offset, version_span.length, TABLE_VERSION_COLUMN);
+                cursor = is_installed ? append_literal(cursor, " |  ") : append_literal(cursor, " \x1b[m| \x1b[32m ");
+                cursor = append_padded(cursor, results.text + url.offset, url.length, TABLE_URL_COLUMN);
+                cursor = append_literal(cursor, " \x1b[m|\n");
+                break;
+            case OUTPUT_JSON :
+                if (!is_first) *cursor++ = ',';
+                cursor = append_json_record(cursor, results, i, &kinds, is_installed);
+                break;
+            case OUTPUT_NDJSON :
+                cursor    = append_json_record(cursor, results, i, &kinds, is_installed);
+                *cursor++ = '\n';
+                break;
+            case OUTPUT_CSV :
+                cursor    = append_csv_field(cursor, results.text + version_span.offset, version_span.length);
+                *cursor++ = ',';
+                cursor    = append_csv_field(cursor, results.text + url.offset, url.length);
+                *cursor++ = ',';
+                cursor    = append(cursor, kinds.names[results.kinds[i]], kinds.lengths[results.kinds[i]]);
+                cursor    = is_installed ? append_literal(cursor, ",true\n") : append_literal(cursor, ",false\n");
+                break;
+            default : break;
+        }
+        is_first = false;
+    }
+
+    if (format == OUTPUT_TABLE) cursor = append_literal(cursor, TABLE_RULE);
+    else if (format == OUTPUT_JSON) cursor = append_literal(cursor, "]}\n");
+
+    return (unsigned long) (cursor - buffer);
+}
+
+// writes the rendered bytes to stdout in as many WriteFile calls as it takes, a pipe may take fewer bytes than it was given
+static bool __cdecl write_stdout(_In_ const char* const restrict buffer, _In_ const unsigned long size) {
+    const HANDLE  console    = GetStdHandle(STD_OUTPUT_HANDLE);
+    unsigned long written    = 0;
+    bool          is_written = true;
+
+    fflush(stdout); // whatever went through the CRT before must come out first
+    for (unsigned long offset = 0; offset < size && is_written; offset += written)
+        is_written = WriteFile(console, buffer + offset, size - offset, &written, NULL) && written;
+    if (!is_written) fwprintf_s(stderr, L"Error %lu in WriteFile.\n", GetLastError());
+    return is_written;
+}
+
+bool __cdecl print_ex(
+    _In_ const results_t results, _In_ const unsigned artifacts, _In_opt_ const char* const restrict syspyversion, _In_ const output_format_t format
+) {
+    const trace_span_t  span       = trace_begin("print", "print");
+    const unsigned long capacity   = render_size(results, artifacts, format);
+    bool                is_written = false;
+
+    char* const restrict buffer = malloc(capacity);
+    if (!buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        goto PREMATURE_RETURN;
+    }
+
+    const unsigned long size = render(results, artifacts, syspyversion, format, buffer);
+    assert(size <= capacity);
+    is_written = write_stdout(buffer, size);
+
+PREMATURE_RETURN:
+    free(buffer);
+    trace_end(span, 0, results.count);
+    return is_written;
+}
+
+void __cdecl print(_In_ const results_t results, _In_ const unsigned artifacts, _In_ const char* const restrict syspyversion) {
+    print_ex(results, artifacts, syspyversion, OUTPUT_TABLE); // print_ex will do the error reporting
+}
+
+// {"event":"added","version":"3.13.3","url":"https://...","kind":"amd64"}, or without the event member inside the arrays of a JSON batch
+static char* __cdecl append_json_event(
+    _Inout_ char* restrict cursor,
+    _In_opt_ const char* const restrict event,
+    _In_ const results_t results,
+    _In_ const unsigned long i,
+    _In_ const kind_names_t* const restrict kinds
+) {
+    if (event) {
+        cursor = append_literal(cursor, "{\"event\":\"");
+        cursor = append(cursor, event, (unsigned long) strlen(event));
+        cursor = append_literal(cursor, "\",\"version\":");
+    } else
+        cursor = append_literal(cursor, "{\"version\":");
+    cursor = append_json_string(cursor, results.text + results.versions[i].offset, results.versions[i].length);
+    cursor = append_literal(cursor, ",\"url\":");
+    cursor = append_json_string(cursor, results.text + results.downloadurls[i].offset, results.downloadurls[i].length);
+    cursor = append_literal(cursor, ",\"kind\":\"");
+    cursor = append(cursor, kinds->names[results.kinds[i]], kinds->lengths[results.kinds[i]]);
+    cursor = append_literal(cursor, "\"}");
+    return cursor;
+}
+
+// the releases of one side of a batch of events, event is "added" or "removed"
+static char* __cdecl append_events(
+    _Inout_ char* restrict cursor,
+    _In_ const char* const restrict event,
+    _In_ const results_t results,
+    _In_ const output_format_t format,
+    _In_ const kind_names_t* const restrict kinds
+) {
+    for (unsigned long i = 0; i < results.count; ++i) {
+        const span_t version = results.versions[i], url = results.downloadurls[i]; // NOLINT(readability-isolate-declaration)
+
+        switch (format) {
+            case OUTPUT_TABLE :
+                cursor    = *event == 'a' ? append_literal(cursor, "\x1b[32m+ ") : append_literal(cursor, "\x1b[91m- ");
+                cursor    = append_padded(cursor, results.text + version.offset, version.length, TABLE_VERSION_COLUMN);
+                cursor    = append_literal(cursor, "\x1b[m ");
+                cursor    = append(cursor, results.text + url.offset, url.length);
+                *cursor++ = '\n';
+                break;
+            case OUTPUT_JSON :
+                if (i) *cursor++ = ',';
+                cursor = append_json_event(cursor, NULL, results, i, kinds);
+                break;
+            case OUTPUT_NDJSON :
+                cursor    = append_json_event(cursor, event, results, i, kinds);
+                *cursor++ = '\n';
+                break;
+            case OUTPUT_CSV :
+                cursor    = append(cursor, event, (unsigned long) strlen(event));
+                *cursor++ = ',';
+                cursor    = append_csv_field(cursor, results.text + version.offset, version.length);
+                *cursor++ = ',';
+                cursor    = append_csv_field(cursor, results.text + url.offset, url.length);
+                *cursor++ = ',';
+                cursor    = append(cursor, kinds->names[results.kinds[i]], kinds->lengths[results.kinds[i]]);
+                *cursor++ = '\n';
+                break;
+            default : break;
+        }
+    }
+    return cursor;
+}
+
+bool __cdecl print_events(
+    _In_ const results_t added, _In_ const results_t removed, _In_ const output_format_t format, _In_ const bool is_first
+) {
+    const trace_span_t span = trace_begin("print", "print");
+    // the event records are no longer than the release records render_size accounts for, see append_json_event
+    const unsigned long capacity   = render_size(added, ARTIFACT_MASK_ALL, format) + render_size(removed, ARTIFACT_MASK_ALL, format);
+    bool                is_written = false;
+    kind_names_t        kinds      = { 0 };
+
+    char* const restrict buffer = malloc(capacity);
+    if (!buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        goto PREMATURE_RETURN;
+    }
+
+    char* cursor = buffer;
+    if (format != OUTPUT_TABLE) narrow_kind_names(&kinds);
+
+    if (format == OUTPUT_JSON) cursor = append_literal(cursor, "{\"added\":[");
+    else if (format == OUTPUT_CSV && is_first)
+        cursor = append_literal(cursor, "event,version,url,kind\n");
+
+    cursor = append_events(cursor, "added", added, format, &kinds);
+    if (format == OUTPUT_JSON) cursor = append_literal(cursor, "],\"removed\":[");
+    cursor = append_events(cursor, "removed", removed, format, &kinds);
+    if (format == OUTPUT_JSON) cursor = append_literal(cursor, "]}\n");
+
+    assert((unsigned long) (cursor - buffer) <= capacity);
+    is_written = write_stdout(buffer, (unsigned long) (cursor - buffer));
+
+PREMATURE_RETURN:
+    free(buffer);
+    trace_end(span, 0, added.count + removed.count);
+    return is_written;
+}
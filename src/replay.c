@@ -0,0 +1,278 @@
+#include <project.h>
+
+// --from-file and --record, crawls that don't touch the network. a saved response is mapped read-only and parsed where it lies: a bare
+// body goes through locate_stable_releases_htmldiv and parse_stable_releases_parallel over the mapping itself, the releases borrowing
+// their text from it like they borrow a mapped snapshot's, so an archived crawl of any size costs no copy and no heap beyond the spans.
+// a compressed body (gzip by its magic, or whatever the recorded Content-Encoding says) and a body too large for 32 bit spans stream
+// through the inflater and the streaming parser chunk by chunk instead, the releases then owning their text. the mapping is advised
+// sequential, which is how every one of those paths walks it, so the kernel reads ahead aggressively and drops the pages behind.
+// a recording is the status line and the headers crawl knows about, the status and the validators, followed by the body as the parser
+// saw it, after the transport took off any chunking and content encoding. the headers of curl -i and the like are skipped too, as are
+// the interim and redirect responses before the final one
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <strings.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #define strncasecmp_(a, b, n) strncasecmp((a), (b), (n))
+#else
+    #define strncasecmp_(a, b, n) _strnicmp((a), (b), (n))
+#endif
+
+#ifdef _WIN32
+// the view keeps the mapping object and the file alive on its own. FILE_FLAG_SEQUENTIAL_SCAN is the closest Windows has to
+// MADV_SEQUENTIAL, it makes the cache manager read ahead of the page faults on the view
+static const char* __cdecl map_file(_In_ const wchar_t* const restrict filename, _Inout_ unsigned long long* const restrict size) {
+    LARGE_INTEGER length = { .QuadPart = 0 };
+    const char*   view   = NULL;
+
+    const HANDLE file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        fwprintf_s(stderr, L"Error %lu in CreateFileW(%s).\n", GetLastError(), filename);
+        return NULL;
+    }
+    if (!GetFileSizeEx(file, &length)) {
+        fwprintf_s(stderr, L"Error %lu in GetFileSizeEx.\n", GetLastError());
+        goto CLOSE_FILE;
+    }
+    if (!length.QuadPart) { // empty files can't be mapped
+        fwprintf_s(stderr, L"Error: %s is empty!\n", filename);
+        goto CLOSE_FILE;
+    }
+
+    const HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        fwprintf_s(stderr, L"Error %lu in CreateFileMappingW.\n", GetLastError());
+        goto CLOSE_FILE;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) fwprintf_s(stderr, L"Error %lu in MapViewOfFile.\n", GetLastError());
+    else *size = (unsigned long long) length.QuadPart;
+    CloseHandle(mapping);
+
+CLOSE_FILE:
+    CloseHandle(file);
+    return view;
+}
+
+static void __cdecl unmap_file(_In_ const char* const restrict view, _In_ const unsigned long long size) {
+    (void) size;
+    UnmapViewOfFile(view);
+}
+#else
+static const char* __cdecl map_file(_In_ const wchar_t* const restrict filename, _Inout_ unsigned long long* const restrict size) {
+    char        narrowed[MAX_PATH * 4] = { 0 };
+    struct stat status                 = { 0 };
+    void*       view                   = NULL;
+
+    if (wcstombs(narrowed, filename, sizeof(narrowed)) >= sizeof(narrowed)) {
+        fwprintf_s(stderr, L"Error: %s is not a valid path!\n", filename);
+        return NULL;
+    }
+    const int file = open(narrowed, O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        fwprintf_s(stderr, L"Error %d in open(%s).\n", errno, filename);
+        return NULL;
+    }
+    if (fstat(file, &status)) {
+        fwprintf_s(stderr, L"Error %d in fstat.\n", errno);
+        goto CLOSE_FILE;
+    }
+    if (!status.st_size) { // empty files can't be mapped
+        fwprintf_s(stderr, L"Error: %s is empty!\n", filename);
+        goto CLOSE_FILE;
+    }
+
+    view = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED) {
+        fwprintf_s(stderr, L"Error %d in mmap.\n", errno);
+        view = NULL;
+        goto CLOSE_FILE;
+    }
+    (void) madvise(view, (size_t) status.st_size, MADV_SEQUENTIAL); // only a hint, the mapping works just the same without it
+    *size = (unsigned long long) status.st_size;
+
+CLOSE_FILE:
+    close(file); // the mapping holds on to the file by itself
+    return view;
+}
+
+static void __cdecl unmap_file(_In_ const char* const restrict view, _In_ const unsigned long long size) {
+    munmap((void*) view, (size_t) size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+#endif
+
+// skips the status line and headers of a recorded response, setting the status and the body's content encoding from them. returns the
+// offset of the body, 0 if the header block doesn't end within REPLAY_MAX_HEADERS bytes
+static unsigned long long __cdecl skip_headers(
+    _In_ const char* const restrict text, _In_ const unsigned long long size, _Inout_ replay_t* const restrict replay
+) {
+    const unsigned long long limit = size < REPLAY_MAX_HEADERS ? size : REPLAY_MAX_HEADERS;
+    const char* const        space = memchr(text, ' ', limit);
+    if (!space) return 0;
+    replay->status   = (unsigned) strtoul(space + 1, NULL, 10);
+    replay->encoding = INFLATE_NONE;
+
+    for (unsigned long long line = (unsigned long long) (space - text); line < limit;) {
+        const char* const newline = memchr(text + line, '\n', limit - line);
+        if (!newline) return 0;
+        line = (unsigned long long) (newline - text) + 1; // the start of the next line
+        if (line < limit && text[line] == '\n') return line + 1;
+        if (line + 1 < limit && text[line] == '\r' && text[line + 1] == '\n') return line + 2;
+
+        if (limit - line > 17 && !strncasecmp_(text + line, "Content-Encoding:", 17)) { // copied out, the mapping isn't terminated
+            char                     value[HTTP_HEADER_LINE_LENGTH] = { 0 };
+            const unsigned long long width = limit - line - 17 < sizeof(value) - 1 ? limit - line - 17 : sizeof(value) - 1;
+            memcpy(value, text + line + 17, width);
+            if (strchr(value, '\n')) *strchr(value, '\n') = 0;
+            if (strstr(value, "gzip")) replay->encoding = INFLATE_GZIP;
+            else if (strstr(value, "deflate")) replay->encoding = INFLATE_ZLIB;
+        }
+    }
+    return 0;
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl replay_map(
+    _In_ const wchar_t* const restrict filename, _Inout_ replay_t* const restrict replay
+) {
+    *replay                 = (replay_t) { .base = NULL, .size = 0, .body = NULL, .length = 0, .status = HTTP_STATUS_OK, .encoding = INFLATE_NONE };
+    const trace_span_t span = trace_begin("map", "replay");
+    replay->base            = map_file(filename, &replay->size);
+    if (!replay->base) return false; // map_file will do the error reporting
+
+    // a recording, or a capture holding several responses of which the last one counts (100 Continue, redirects followed by curl -L)
+    unsigned long long offset = 0;
+    while (replay->size - offset > 5 && !memcmp(replay->base + offset, "HTTP/", 5)) {
+        const unsigned long long length = skip_headers(replay->base + offset, replay->size - offset, replay);
+        if (!length) {
+            fwprintf_s(stderr, L"Error: the recorded headers in %s don't end within %llu bytes!\n", filename, REPLAY_MAX_HEADERS);
+            goto UNMAP;
+        }
+        offset += length;
+    }
+    if (replay->status != HTTP_STATUS_OK) {
+        fwprintf_s(stderr, L"Error: %s holds a response with status %u, not the page itself!\n", filename, replay->status);
+        goto UNMAP;
+    }
+
+    replay->body   = replay->base + offset;
+    replay->length = replay->size - offset;
+    if (replay->length > 2 && (unsigned char) replay->body[0] == 0x1F && (unsigned char) replay->body[1] == 0x8B)
+        replay->encoding = INFLATE_GZIP; // a gzip'ed page saved as is
+    trace_end(span, offset, 0);
+    return true;
+
+UNMAP:
+    unmap_file(replay->base, replay->size);
+    *replay = (replay_t) { .base = NULL, .size = 0, .body = NULL, .length = 0, .status = 0, .encoding = INFLATE_NONE };
+    return false;
+}
+
+static bool __cdecl parser_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    stream_parser_feed(context, chunk, size);
+    return true;
+}
+
+// the body HTTP_CHUNK_SIZE bytes at a time through the inflater when it's compressed, straight into the streaming parser when it isn't
+static results_t __cdecl stream_body(_In_ const replay_t* const restrict replay) {
+    stream_parser_t parser   = { 0 };
+    inflater_t      inflater = { 0 };
+    bool            is_fed   = true;
+
+    if (!stream_parser_init(&parser)) return (results_t) { 0 }; // stream_parser_init will do the error reporting
+    const bool is_compressed = replay->encoding != INFLATE_NONE;
+    if (is_compressed && !inflater_init(&inflater, replay->encoding, parser_sink, &parser)) { // inflater_init will do the error reporting
+        stream_parser_discard(&parser);
+        return (results_t) { 0 };
+    }
+
+    for (unsigned long long offset = 0; offset < replay->length && is_fed; offset += HTTP_CHUNK_SIZE) {
+        const unsigned long size = (unsigned long) (replay->length - offset < HTTP_CHUNK_SIZE ? replay->length - offset : HTTP_CHUNK_SIZE);
+        if (is_compressed) is_fed = inflater_push(&inflater, replay->body + offset, size);
+        else stream_parser_feed(&parser, replay->body + offset, size);
+    }
+    if (is_compressed) is_fed = inflater_finish(&inflater) && is_fed; // inflater_push and inflater_finish will do the error reporting
+
+    results_t results = stream_parser_finish(&parser); // must be called regardless, it releases the parser's buffers
+    if (!is_fed) results_release(&results);
+    return results;
+}
+
+[[nodiscard]] results_t __cdecl replay_parse(_In_ const replay_t* const restrict replay) {
+    if (replay->encoding != INFLATE_NONE || replay->length > UINT32_MAX) return stream_body(replay);
+
+    const range_t stable = locate_stable_releases_htmldiv(replay->body, (unsigned long) replay->length);
+    if (!stable.begin) {
+        fputws(L"Error: the saved page has no stable releases section!\n", stderr);
+        return (results_t) { 0 };
+    }
+    const unsigned long end = stable.end ? stable.end : (unsigned long) replay->length; // an archive cut short of the pre-releases
+    return parse_stable_releases_parallel(replay->body + stable.begin, end - stable.begin, 0); // will do the error reporting
+}
+
+void __cdecl replay_unmap(_Inout_ replay_t* const restrict replay) {
+    if (replay->base) unmap_file(replay->base, replay->size);
+    *replay = (replay_t) { .base = NULL, .size = 0, .body = NULL, .length = 0, .status = 0, .encoding = INFLATE_NONE };
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl record_open(
+    _In_ const wchar_t* const restrict filename,
+    _In_ const http_request_t* const restrict request,
+    _In_ const wchar_t* const restrict accesspoint,
+    _Inout_ stream_parser_t* const restrict parser,
+    _Inout_ recorder_t* const restrict recorder
+) {
+    *recorder      = (recorder_t) { .file = INVALID_HANDLE_VALUE, .request = request, .accesspoint = accesspoint, .parser = parser };
+    recorder->file = CreateFileW(filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (recorder->file != INVALID_HANDLE_VALUE) return true;
+    fwprintf_s(stderr, L"Error %lu in CreateFileW(%s).\n", GetLastError(), filename);
+    return false;
+}
+
+// a failed write doesn't stop the crawl, the page is still parsed and printed and record_close fails afterwards
+static void __cdecl record_bytes(
+    _Inout_ recorder_t* const restrict recorder, _In_ const char* const restrict bytes, _In_ const unsigned long size
+) {
+    unsigned long written = 0;
+    if (recorder->is_failed || (WriteFile(recorder->file, bytes, size, &written, NULL) && written == size)) return;
+    fwprintf_s(stderr, L"Error %lu in WriteFile, the rest of the response goes unrecorded.\n", GetLastError());
+    recorder->is_failed = true;
+}
+
+// the headers go out ahead of the first piece of the body, the status and validators are known by then
+static void __cdecl record_head(_Inout_ recorder_t* const restrict recorder) {
+    const http_request_t* const request    = recorder->request;
+    char                        head[1024] = { 0 };
+
+    int length = snprintf(head, sizeof(head), "HTTP/1.1 %u %s\r\n", request->status, request->status == HTTP_STATUS_OK ? "OK" : "");
+    length    += snprintf(
+        head + length, sizeof(head) - length, "Content-Location: http://%S:%hu%S\r\n", request->server, request->port, recorder->accesspoint
+    );
+    if (*request->validators.etag) length += snprintf(head + length, sizeof(head) - length, "ETag: %s\r\n", request->validators.etag);
+    if (*request->validators.last_modified)
+        length += snprintf(head + length, sizeof(head) - length, "Last-Modified: %s\r\n", request->validators.last_modified);
+    length += snprintf(head + length, sizeof(head) - length, "\r\n");
+
+    recorder->is_head_written = true;
+    record_bytes(recorder, head, (unsigned long) length); // the validators and the two BUFF_SIZE names fit with room to spare
+}
+
+bool __cdecl record_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    recorder_t* const recorder = context;
+    if (!recorder->is_head_written) record_head(recorder);
+    record_bytes(recorder, chunk, size);
+    stream_parser_feed(recorder->parser, chunk, size);
+    return true;
+}
+
+[[nodiscard]] bool __cdecl record_close(_Inout_ recorder_t* const restrict recorder) {
+    if (recorder->file == INVALID_HANDLE_VALUE) return false;
+    if (!recorder->is_head_written && recorder->request->status) record_head(recorder); // a response without a body
+    CloseHandle(recorder->file);
+    recorder->file = INVALID_HANDLE_VALUE;
+    return !recorder->is_failed;
+}
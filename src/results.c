@@ -0,0 +1,120 @@
+#include <project.h>
+
+// storage for parsed releases. a release is two spans, a version and a download URL, and an artifact kind, kept in three parallel arrays that
+// share a single heap block (versions, then downloadurls, then kinds). the spans are offsets into text, which is either borrowed from the caller
+// or lives in the results' own arena, so nothing is copied into fixed size string fields and there's no upper bound on the release count.
+
+[[nodiscard]] bool __cdecl results_init(
+    _Inout_ results_t* const restrict results, _In_opt_ const char* const text, _In_ const unsigned long capacity
+) {
+    *results = (results_t) { .text = text, .versions = NULL, .downloadurls = NULL, .kinds = NULL, .count = 0, .capacity = 0, .arena = NULL };
+
+    span_t* const restrict spans = malloc(RESULTS_RECORD_SIZE * (capacity ? capacity : 1));
+    if (!spans) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    results->versions     = spans;
+    results->downloadurls = spans + (capacity ? capacity : 1);
+    results->kinds        = (uint8_t*) (spans + 2 * (capacity ? capacity : 1));
+    results->capacity     = capacity ? capacity : 1;
+    return true;
+}
+
+[[nodiscard]] bool __cdecl results_push(
+    _Inout_ results_t* const restrict results, _In_ const span_t version, _In_ const span_t downloadurl, _In_ const artifact_kind_t kind
+) {
+    if (results->count == results->capacity) {
+        span_t* const restrict spans = realloc(results->versions, RESULTS_RECORD_SIZE * 2 * results->capacity);
+        if (!spans) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            return false;
+        }
+        // the kinds sat right after the old download URLs and the download URLs right after the old capacity, move both up to where the
+        // grown block keeps them. the kinds go first, they move the farthest
+        memmove(spans + 4 * results->capacity, spans + 2 * results->capacity, results->count);
+        memmove(spans + 2 * results->capacity, spans + results->capacity, sizeof(span_t) * results->count);
+        results->versions      = spans;
+        results->downloadurls  = spans + 2 * results->capacity;
+        results->kinds         = (uint8_t*) (spans + 4 * results->capacity);
+        results->capacity     *= 2;
+    }
+
+    results->versions[results->count]     = version;
+    results->downloadurls[results->count] = downloadurl;
+    results->kinds[results->count]        = (uint8_t) kind;
+    results->count++;
+    return true;
+}
+
+[[nodiscard]] bool __cdecl results_intern(
+    _Inout_ results_t* const restrict results,
+    _In_ const char* const restrict bytes,
+    _In_ const unsigned long size,
+    _Inout_ uint32_t* const restrict offset
+) {
+    if (results->arena_size + size > results->arena_capacity) {
+        unsigned long capacity = results->arena_capacity ? results->arena_capacity : HTTP_CHUNK_SIZE / 4;
+        while (capacity < results->arena_size + size) capacity *= 2;
+
+        char* const restrict arena = realloc(results->arena, capacity);
+        if (!arena) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            return false;
+        }
+        results->arena          = arena;
+        results->arena_capacity = capacity;
+    }
+
+    memcpy(results->arena + results->arena_size, bytes, size);
+    *offset              = results->arena_size;
+    results->arena_size += size;
+    results->text        = results->arena;
+    return true;
+}
+
+void __cdecl results_release(_Inout_ results_t* const restrict results) {
+    free(results->versions); // downloadurls and kinds live in the same block
+    free(results->arena);
+    *results = (results_t) { .text = NULL, .versions = NULL, .downloadurls = NULL, .kinds = NULL, .count = 0, .capacity = 0, .arena = NULL };
+}
+
+// the version of a release is part of its download URL (.../ftp/python/3.10.11/python-3.10.11-amd64.exe), in which case it doesn't need
+// bytes of its own in the serialized text
+static inline bool __cdecl is_within(_In_ const span_t inner, _In_ const span_t outer) {
+    return inner.offset >= outer.offset && inner.offset + inner.length <= outer.offset + outer.length;
+}
+
+[[nodiscard]] unsigned long __cdecl results_text_size(_In_ const results_t results) {
+    unsigned long size = 0;
+    for (unsigned long i = 0; i < results.count; ++i)
+        size += results.downloadurls[i].length + (is_within(results.versions[i], results.downloadurls[i]) ? 0 : results.versions[i].length);
+    return size;
+}
+
+void __cdecl results_serialize(_In_ const results_t results, _Inout_ unsigned char* const restrict buffer) {
+    span_t* const restrict versions     = (span_t*) buffer;
+    span_t* const restrict downloadurls = versions + results.count;
+    uint8_t* const restrict kinds       = (uint8_t*) (downloadurls + results.count);
+    char* const restrict text           = (char*) (kinds + results.count);
+    uint32_t             offset         = 0;
+
+    memcpy(kinds, results.kinds, results.count);
+
+    for (unsigned long i = 0; i < results.count; ++i) {
+        const span_t version = results.versions[i], downloadurl = results.downloadurls[i]; // NOLINT(readability-isolate-declaration)
+
+        memcpy(text + offset, results.text + downloadurl.offset, downloadurl.length);
+        downloadurls[i]  = (span_t) { .offset = offset, .length = downloadurl.length };
+        offset          += downloadurl.length;
+
+        if (is_within(version, downloadurl))
+            versions[i] = (span_t) { .offset = downloadurls[i].offset + (version.offset - downloadurl.offset), .length = version.length };
+        else {
+            memcpy(text + offset, results.text + version.offset, version.length);
+            versions[i]  = (span_t) { .offset = offset, .length = version.length };
+            offset      += version.length;
+        }
+    }
+}
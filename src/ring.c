@@ -0,0 +1,973 @@
+#include <project.h>
+
+// fetch_all, an HTTP/1.1 engine for fetching hundreds of pages from one server at once. where the socket transport spends a thread and a
+// system call per send and receive of every request, a completion ring drives all of its connections from one thread: the connects, sends
+// and receives of every connection are queued up, handed to the kernel together and their completions collected together, one system call
+// per wakeup however many connections there are. there's a ring per logical processor, each with its share of the connections, taking the
+// next page from the shared list whenever one of its connections is free.
+// on Linux the ring is an io_uring. every connection has a single multishot receive armed for as long as it's open, the kernel picks a
+// buffer for each piece of a response out of a ring of receive buffers registered with it up front, and the piece is copied out of it (into
+// the pooled slabs of the page's body_t, see body.c) and the buffer handed back straight away, so a few buffers per connection go a long way. on Windows it's an I/O completion port, where every
+// receive is a request of its own and every connection has a receive buffer of its own.
+// keep-alive connections carry one request after the other, responses are parsed as they arrive by a small state machine. there's no TLS
+// and no compression, the bodies are asked for as they are.
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <mswsock.h> // after winsock2.h, which it builds on
+    #include <ws2tcpip.h>
+
+    #pragma comment(lib, "Ws2_32.lib")
+
+typedef SOCKET socket_t;
+    #define strncasecmp_(a, b, n) _strnicmp((a), (b), (n))
+    #define last_socket_error()   WSAGetLastError()
+    #define next_fetch(next)      (InterlockedIncrement(next) - 1)
+    #define count_success(count)  InterlockedIncrement(count)
+#else // io_uring, Linux only
+    #include <errno.h>
+    #include <linux/io_uring.h>
+    #include <netdb.h>
+    #include <signal.h>
+    #include <strings.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+
+typedef int socket_t;
+    #define INVALID_SOCKET        (-1)
+    #define strncasecmp_(a, b, n) strncasecmp((a), (b), (n))
+    #define last_socket_error()   errno
+    #define next_fetch(next)      __atomic_fetch_add((next), 1, __ATOMIC_RELAXED)
+    #define count_success(count)  __atomic_fetch_add((count), 1, __ATOMIC_RELAXED)
+#endif
+
+#define RING_MESSAGE_SIZE     (HTTP_HEADER_LINE_LENGTH * 2) // bytes of the request message of a connection
+#define RING_HEAD_SIZE        (HTTP_HEADER_LINE_LENGTH * 4) // longest header block a response may have
+#define RING_MAX_COMPLETIONS  256LLU                        // completions a ring takes in one go
+#define RING_BUFFERS_PER_LINK 2LLU                          // receive buffers an io_uring has per connection
+
+typedef enum _ring_op { RING_CONNECT, RING_SEND, RING_RECV, RING_CANCEL } ring_op_t;
+
+// where the parser is in the response of a connection
+typedef enum _response_state {
+    RESPONSE_HEAD,        // the status line and the headers, gathered in line until the empty line
+    RESPONSE_LENGTH,      // a body of Content-Length bytes, remaining are still to come
+    RESPONSE_UNTIL_CLOSE, // a body that ends when the server closes the connection
+    RESPONSE_CHUNK_SIZE,  // the size line of the next chunk
+    RESPONSE_CHUNK_DATA,  // the bytes of a chunk, remaining are still to come
+    RESPONSE_CHUNK_END,   // the CRLF that closes every chunk
+    RESPONSE_TRAILERS,    // the trailer lines after the last chunk, up to an empty line
+    RESPONSE_DONE
+} response_state_t;
+
+typedef enum _feed_result { FEED_MORE, FEED_DONE, FEED_ERROR } feed_result_t;
+
+typedef struct _ring_connection {
+        socket_t           socket;              // INVALID_SOCKET while the connection is closed
+        fetch_t*           fetch;               // the page the connection is fetching, NULL when it has none
+        unsigned long      npending;            // operations submitted that haven't completed yet
+        bool               is_open;             // false once the connection is being torn down, its completions are then ignored
+        bool               is_connected;
+        bool               is_receiving;        // a receive is armed
+        bool               is_keep_alive;       // whether the server will keep the connection open after this response
+        response_state_t   state;
+        char*              message;             // the request, RING_MESSAGE_SIZE bytes
+        unsigned long      message_size;
+        unsigned long      sent;                // bytes of the message sent so far
+        unsigned long long remaining;           // bytes of the body or the chunk still to come
+        unsigned long      line_size;           // bytes gathered in line
+        char               line[RING_HEAD_SIZE]; // the header block, then chunk size and trailer lines
+#ifdef _WIN32
+        WSAOVERLAPPED      send_overlapped;     // shared by the connect and the sends, there's never more than one of them in flight
+        WSAOVERLAPPED      recv_overlapped;
+        char*              buffer;              // RING_BUFFER_SIZE bytes receive buffer
+#endif
+} ring_connection_t;
+
+// what fetch_all shares with its rings
+typedef struct _batch {
+        fetch_t*                fetches;
+        unsigned long           count;
+        volatile long           next;         // the next fetch to hand to a connection
+        volatile long           nsucceeded;
+        char                    host[BUFF_SIZE * 4];
+        struct sockaddr_storage address;      // where every connection goes
+        int                     address_size;
+        bool                    is_aborted;   // a ring timed out, the server isn't answering and no new fetches are started
+} batch_t;
+
+// a completion, in the same shape on both backends
+typedef struct _ring_completion {
+        unsigned long connection;
+        ring_op_t     op;
+        unsigned long transferred; // bytes sent or received
+        unsigned long error;       // errno or WSA error code, 0 on success
+        bool          is_more;     // the operation stays armed and has more completions to come, a multishot receive
+        bool          is_buffered; // data lies in the registered receive buffer numbered buffer, handed back once copied out of
+        unsigned      buffer;
+        const char*   data;        // the received bytes
+} ring_completion_t;
+
+typedef struct _ring {
+        batch_t*                  batch;
+        ring_connection_t*        connections;
+        unsigned long             nconnections;
+        unsigned long             nlive;    // connections with a socket, open or being torn down
+        char*                     messages; // the request messages of all connections
+#ifdef _WIN32
+        HANDLE                    port;
+        LPFN_CONNECTEX            connect_ex;
+        char*                     buffers;  // the receive buffers of all connections
+#else
+        int                       fd;
+        void*                     queues;   // the submission and completion queue rings, mapped together
+        size_t                    queues_size;
+        struct io_uring_sqe*      sqes;
+        size_t                    sqes_size;
+        unsigned*                 sq_head;
+        unsigned*                 sq_tail;
+        unsigned*                 sq_array;
+        unsigned                  sq_mask;
+        unsigned                  sq_entries;
+        unsigned                  nqueued;  // entries queued since the last io_uring_enter
+        unsigned*                 cq_head;
+        unsigned*                 cq_tail;
+        unsigned                  cq_mask;
+        struct io_uring_cqe*      cqes;
+        struct io_uring_buf_ring* buffer_ring; // the receive buffers handed to the kernel
+        size_t                    buffer_ring_size;
+        char*                     buffers;
+        unsigned                  nbuffers;    // a power of two
+#endif
+} ring_t;
+
+// a ring's thread
+typedef struct _ring_task {
+        ring_t  ring;
+        task_t  task;
+} ring_task_t;
+
+// server names and paths are plain ASCII
+static bool __cdecl narrow_host(_In_ const wchar_t* const restrict wide, _Inout_ char* const restrict buffer, _In_ const unsigned long size) {
+    unsigned long i = 0;
+    for (; wide[i] && i < size - 1; ++i) {
+        if (wide[i] > 0x7F) return false;
+        buffer[i] = (char) wide[i];
+    }
+    buffer[i] = 0;
+    return !wide[i];
+}
+
+#ifdef _WIN32
+
+static bool __cdecl ring_startup(void) {
+    static bool is_started = false;
+    WSADATA     wsadata    = { 0 };
+    if (is_started) return true;
+    if (WSAStartup(MAKEWORD(2, 2), &wsadata)) {
+        fwprintf_s(stderr, L"Error %d in WSAStartup.\n", WSAGetLastError());
+        return false;
+    }
+    is_started = true;
+    return true;
+}
+
+static bool __cdecl ring_open(_Inout_ ring_t* const restrict ring) {
+    ring->port    = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    ring->buffers = malloc(RING_BUFFER_SIZE * ring->nconnections);
+    if (!ring->port || !ring->buffers) {
+        fwprintf_s(stderr, L"Error %lu in CreateIoCompletionPort.\n", GetLastError());
+        return false;
+    }
+    for (unsigned long i = 0; i < ring->nconnections; ++i) ring->connections[i].buffer = ring->buffers + RING_BUFFER_SIZE * i;
+    return true;
+}
+
+static void __cdecl ring_close(_Inout_ ring_t* const restrict ring) {
+    if (ring->port) CloseHandle(ring->port);
+    free(ring->buffers);
+}
+
+// sockets for ConnectEx must be bound and opened for overlapped I/O, the completion key is the connection's index
+static socket_t __cdecl open_socket(_Inout_ ring_t* const restrict ring, _In_ const unsigned long index) {
+    const int      family  = ring->batch->address.ss_family;
+    const socket_t socket_ = WSASocketW(family, SOCK_STREAM, IPPROTO_TCP, NULL, 0, WSA_FLAG_OVERLAPPED);
+    if (socket_ == INVALID_SOCKET) return INVALID_SOCKET;
+
+    struct sockaddr_storage any  = { .ss_family = (ADDRESS_FAMILY) family }; // the unspecified address and port 0 of either family
+    const int               size = family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+    GUID                    guid = WSAID_CONNECTEX;
+    DWORD                   read = 0;
+    if (bind(socket_, (struct sockaddr*) &any, size) || !CreateIoCompletionPort((HANDLE) socket_, ring->port, index, 0)
+        || (!ring->connect_ex
+            && WSAIoctl(socket_, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &ring->connect_ex, sizeof(ring->connect_ex), &read, NULL, NULL))) {
+        closesocket(socket_);
+        return INVALID_SOCKET;
+    }
+    return socket_;
+}
+
+// false when the operation failed right away, there won't be a completion for it then
+static bool __cdecl submit_connect(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    memset(&connection->send_overlapped, 0, sizeof(WSAOVERLAPPED));
+    const batch_t* const batch = ring->batch;
+    return ring->connect_ex(
+               connection->socket, (const struct sockaddr*) &batch->address, batch->address_size, NULL, 0, NULL, &connection->send_overlapped
+           )
+        || WSAGetLastError() == ERROR_IO_PENDING;
+}
+
+static bool __cdecl submit_send(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    (void) ring;
+    WSABUF buffer = { .len = connection->message_size - connection->sent, .buf = connection->message + connection->sent };
+    memset(&connection->send_overlapped, 0, sizeof(WSAOVERLAPPED));
+    return !WSASend(connection->socket, &buffer, 1, NULL, 0, &connection->send_overlapped, NULL) || WSAGetLastError() == WSA_IO_PENDING;
+}
+
+static bool __cdecl submit_recv(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    (void) ring;
+    WSABUF buffer = { .len = RING_BUFFER_SIZE, .buf = connection->buffer };
+    DWORD  flags  = 0;
+    memset(&connection->recv_overlapped, 0, sizeof(WSAOVERLAPPED));
+    return !WSARecv(connection->socket, &buffer, 1, NULL, &flags, &connection->recv_overlapped, NULL) || WSAGetLastError() == WSA_IO_PENDING;
+}
+
+// closing the socket cancels whatever is in flight on it, the operations still complete (with an error) before the connection is reused
+static void __cdecl submit_cancel(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    (void) ring;
+    closesocket(connection->socket);
+    connection->socket = INVALID_SOCKET;
+}
+
+static void __cdecl release_socket(_Inout_ ring_connection_t* const restrict connection) {
+    if (connection->socket != INVALID_SOCKET) closesocket(connection->socket);
+    connection->socket = INVALID_SOCKET;
+}
+
+static void __cdecl recycle_buffer(_Inout_ ring_t* const restrict ring, _In_ const unsigned buffer) { (void) ring, (void) buffer; }
+
+// waits up to HTTP_SOCKET_TIMEOUT for completions and collects as many as there are, returns how many or -1 on timeouts and errors
+static long __cdecl ring_wait(_Inout_ ring_t* const restrict ring, _Inout_ ring_completion_t* const restrict completions) {
+    OVERLAPPED_ENTRY entries[RING_MAX_COMPLETIONS] = { 0 };
+    ULONG            count                         = 0;
+    if (!GetQueuedCompletionStatusEx(ring->port, entries, RING_MAX_COMPLETIONS, &count, HTTP_SOCKET_TIMEOUT, FALSE)) {
+        if (GetLastError() != WAIT_TIMEOUT) fwprintf_s(stderr, L"Error %lu in GetQueuedCompletionStatusEx.\n", GetLastError());
+        return -1;
+    }
+
+    for (ULONG i = 0; i < count; ++i) {
+        ring_connection_t* const connection = ring->connections + entries[i].lpCompletionKey;
+        const bool               is_recv    = entries[i].lpOverlapped == &connection->recv_overlapped;
+        DWORD                    flags      = 0;
+        DWORD                    bytes      = 0;
+        completions[i]                      = (ring_completion_t) {
+                                 .connection  = (unsigned long) entries[i].lpCompletionKey,
+                                 .op          = is_recv ? RING_RECV : connection->is_connected ? RING_SEND : RING_CONNECT,
+                                 .transferred = entries[i].dwNumberOfBytesTransferred,
+                                 .data        = connection->buffer,
+        };
+        if (entries[i].lpOverlapped->Internal) // a failure, the socket is gone already when it was cancelled
+            completions[i].error = connection->socket == INVALID_SOCKET
+                                    || WSAGetOverlappedResult(connection->socket, entries[i].lpOverlapped, &bytes, FALSE, &flags)
+                                     ? ERROR_OPERATION_ABORTED
+                                     : (unsigned long) WSAGetLastError();
+        else if (completions[i].op == RING_CONNECT)
+            setsockopt(connection->socket, SOL_SOCKET, SO_UPDATE_CONNECT_CONTEXT, NULL, 0);
+    }
+    return (long) count;
+}
+
+#else
+
+static bool __cdecl ring_startup(void) {
+    return true;
+}
+
+static int __cdecl ring_enter(
+    _In_ const int fd, _In_ const unsigned submitted, _In_ const unsigned waited, _In_ const unsigned flags, _In_opt_ const void* const argument
+) {
+    return (int) syscall(__NR_io_uring_enter, fd, submitted, waited, flags, argument, sizeof(struct io_uring_getevents_arg));
+}
+
+// a submission queue with room for every connection's receive and its connect or send, a ring of receive buffers registered with the
+// kernel, and whatever the setup needs mapped into the process
+static bool __cdecl ring_open(_Inout_ ring_t* const restrict ring) {
+    struct io_uring_params parameters = { 0 };
+    unsigned               entries    = 8;
+    while (entries < 2 * ring->nconnections + 1) entries *= 2;
+
+    ring->fd = (int) syscall(__NR_io_uring_setup, entries, &parameters);
+    if (ring->fd < 0) {
+        fwprintf_s(stderr, L"Error %d in io_uring_setup.\n", errno);
+        return false;
+    }
+    if (!(parameters.features & IORING_FEAT_SINGLE_MMAP) || !(parameters.features & IORING_FEAT_EXT_ARG)) {
+        fputws(L"Error: io_uring on this kernel is too old for the ring transport, it needs Linux 5.19 or later.\n", stderr);
+        return false;
+    }
+
+    const size_t sq_size = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+    const size_t cq_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+    ring->queues_size    = sq_size > cq_size ? sq_size : cq_size;
+    ring->sqes_size      = parameters.sq_entries * sizeof(struct io_uring_sqe);
+    ring->queues = mmap(NULL, ring->queues_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->sqes   = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->queues == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        fwprintf_s(stderr, L"Error %d in mmap.\n", errno);
+        return false;
+    }
+
+    char* const queues = ring->queues;
+    ring->sq_head      = (unsigned*) (queues + parameters.sq_off.head);
+    ring->sq_tail      = (unsigned*) (queues + parameters.sq_off.tail);
+    ring->sq_array     = (unsigned*) (queues + parameters.sq_off.array);
+    ring->sq_mask      = *(unsigned*) (queues + parameters.sq_off.ring_mask);
+    ring->sq_entries   = parameters.sq_entries;
+    ring->cq_head      = (unsigned*) (queues + parameters.cq_off.head);
+    ring->cq_tail      = (unsigned*) (queues + parameters.cq_off.tail);
+    ring->cq_mask      = *(unsigned*) (queues + parameters.cq_off.ring_mask);
+    ring->cqes         = (struct io_uring_cqe*) (queues + parameters.cq_off.cqes);
+
+    ring->nbuffers = 16;
+    while (ring->nbuffers < RING_BUFFERS_PER_LINK * ring->nconnections) ring->nbuffers *= 2;
+    ring->buffer_ring_size = ring->nbuffers * sizeof(struct io_uring_buf);
+    ring->buffer_ring      = mmap(NULL, ring->buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buffers          = malloc(RING_BUFFER_SIZE * ring->nbuffers);
+    if (ring->buffer_ring == MAP_FAILED || !ring->buffers) {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+    struct io_uring_buf_reg registration = { .ring_addr = (uintptr_t) ring->buffer_ring, .ring_entries = ring->nbuffers, .bgid = 0 };
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        fwprintf_s(stderr, L"Error %d in io_uring_register, the ring transport needs Linux 5.19 or later.\n", errno);
+        return false;
+    }
+    for (unsigned i = 0; i < ring->nbuffers; ++i)
+        ring->buffer_ring->bufs[i]
+            = (struct io_uring_buf) { .addr = (uintptr_t) (ring->buffers + RING_BUFFER_SIZE * i), .len = RING_BUFFER_SIZE, .bid = (uint16_t) i };
+    __atomic_store_n(&ring->buffer_ring->tail, (uint16_t) ring->nbuffers, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void __cdecl ring_close(_Inout_ ring_t* const restrict ring) {
+    if (ring->buffer_ring && ring->buffer_ring != MAP_FAILED) munmap(ring->buffer_ring, ring->buffer_ring_size);
+    if (ring->sqes && ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+    if (ring->queues && ring->queues != MAP_FAILED) munmap(ring->queues, ring->queues_size);
+    if (ring->fd > 0) close(ring->fd); // cancels whatever is still in flight
+    free(ring->buffers);
+}
+
+static socket_t __cdecl open_socket(_Inout_ ring_t* const restrict ring, _In_ const unsigned long index) {
+    (void) index;
+    return socket(ring->batch->address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+}
+
+// queues an entry, handing the queue to the kernel first when it's full. the kernel sees the entries with the next io_uring_enter
+static void __cdecl queue_entry(_Inout_ ring_t* const restrict ring, _In_ const struct io_uring_sqe* const restrict entry) {
+    const unsigned tail = *ring->sq_tail;
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->sq_entries) {
+        while (ring_enter(ring->fd, ring->nqueued, 0, 0, NULL) < 0 && errno == EINTR) continue;
+        ring->nqueued = tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE); // whatever the kernel didn't take goes with the next call
+    }
+    ring->sqes[tail & ring->sq_mask]     = *entry;
+    ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->nqueued++;
+}
+
+static uint64_t __cdecl user_data(_In_ const ring_t* const restrict ring, _In_ const ring_connection_t* const restrict connection, _In_ const ring_op_t op) {
+    return (uint64_t) (connection - ring->connections) << 2 | op;
+}
+
+static bool __cdecl submit_connect(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    const struct io_uring_sqe entry = { .opcode    = IORING_OP_CONNECT,
+                                        .fd        = connection->socket,
+                                        .addr      = (uintptr_t) &ring->batch->address,
+                                        .off       = (uint64_t) ring->batch->address_size,
+                                        .user_data = user_data(ring, connection, RING_CONNECT) };
+    queue_entry(ring, &entry);
+    return true;
+}
+
+static bool __cdecl submit_send(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    const struct io_uring_sqe entry = { .opcode    = IORING_OP_SEND,
+                                        .fd        = connection->socket,
+                                        .addr      = (uintptr_t) (connection->message + connection->sent),
+                                        .len       = connection->message_size - connection->sent,
+                                        .msg_flags = MSG_NOSIGNAL,
+                                        .user_data = user_data(ring, connection, RING_SEND) };
+    queue_entry(ring, &entry);
+    return true;
+}
+
+// a multishot receive, completing once for every piece that arrives until the connection is closed or the ring runs out of buffers
+static bool __cdecl submit_recv(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    const struct io_uring_sqe entry = { .opcode    = IORING_OP_RECV,
+                                        .flags     = IOSQE_BUFFER_SELECT,
+                                        .ioprio    = IORING_RECV_MULTISHOT,
+                                        .fd        = connection->socket,
+                                        .buf_group = 0,
+                                        .user_data = user_data(ring, connection, RING_RECV) };
+    queue_entry(ring, &entry);
+    return true;
+}
+
+// cancels everything in flight on the socket, the cancellation completes like any other operation
+static void __cdecl submit_cancel(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    const struct io_uring_sqe entry = { .opcode       = IORING_OP_ASYNC_CANCEL,
+                                        .fd           = connection->socket,
+                                        .cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL,
+                                        .user_data    = user_data(ring, connection, RING_CANCEL) };
+    queue_entry(ring, &entry);
+    connection->npending++;
+}
+
+static void __cdecl release_socket(_Inout_ ring_connection_t* const restrict connection) {
+    if (connection->socket != INVALID_SOCKET) close(connection->socket);
+    connection->socket = INVALID_SOCKET;
+}
+
+static void __cdecl recycle_buffer(_Inout_ ring_t* const restrict ring, _In_ const unsigned buffer) {
+    const uint16_t tail                                      = ring->buffer_ring->tail;
+    ring->buffer_ring->bufs[tail & (ring->nbuffers - 1)] = (struct io_uring_buf) {
+        .addr = (uintptr_t) (ring->buffers + RING_BUFFER_SIZE * buffer), .len = RING_BUFFER_SIZE, .bid = (uint16_t) buffer
+    };
+    __atomic_store_n(&ring->buffer_ring->tail, (uint16_t) (tail + 1), __ATOMIC_RELEASE);
+}
+
+// submits everything queued and waits up to HTTP_SOCKET_TIMEOUT for completions, in one system call. returns how many were collected or -1
+// on timeouts and errors
+static long __cdecl ring_wait(_Inout_ ring_t* const restrict ring, _Inout_ ring_completion_t* const restrict completions) {
+    struct __kernel_timespec           timeout  = { .tv_sec = HTTP_SOCKET_TIMEOUT / 1000, .tv_nsec = (HTTP_SOCKET_TIMEOUT % 1000) * 1000000 };
+    const struct io_uring_getevents_arg argument = { .sigmask = 0, .sigmask_sz = _NSIG / 8, .ts = (uintptr_t) &timeout };
+    const unsigned                      flags    = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+
+    int result = 0;
+    while ((result = ring_enter(ring->fd, ring->nqueued, 1, flags, &argument)) < 0 && errno == EINTR) continue;
+    ring->nqueued = *ring->sq_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (result < 0 && errno != ETIME) {
+        fwprintf_s(stderr, L"Error %d in io_uring_enter.\n", errno);
+        return -1;
+    }
+
+    const unsigned head  = *ring->cq_head;
+    const unsigned tail  = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    long           count = 0;
+    for (; head + count != tail && count < (long) RING_MAX_COMPLETIONS; ++count) {
+        const struct io_uring_cqe* const entry = ring->cqes + ((head + count) & ring->cq_mask);
+        const unsigned                   index = (unsigned) (entry->flags >> IORING_CQE_BUFFER_SHIFT);
+        completions[count]                     = (ring_completion_t) { .connection  = (unsigned long) (entry->user_data >> 2),
+                                                                       .op          = (ring_op_t) (entry->user_data & 3),
+                                                                       .transferred = entry->res > 0 ? (unsigned long) entry->res : 0,
+                                                                       .error       = entry->res < 0 ? (unsigned long) -entry->res : 0,
+                                                                       .is_more     = entry->flags & IORING_CQE_F_MORE,
+                                                                       .is_buffered = entry->flags & IORING_CQE_F_BUFFER,
+                                                                       .buffer      = index,
+                                                                       .data        = ring->buffers + RING_BUFFER_SIZE * index };
+    }
+    __atomic_store_n(ring->cq_head, head + (unsigned) count, __ATOMIC_RELEASE);
+    return count ? count : -(result < 0); // nothing after a wakeup without a timeout, spurious
+}
+
+#endif
+
+// copies a header value without its leading whitespace, values that don't fit are dropped rather than truncated
+static void __cdecl copy_value(_In_ const char* restrict value, _Inout_ char* const restrict buffer) {
+    while (*value == ' ' || *value == '\t') value++;
+    if (strlen(value) >= HTTP_VALIDATOR_LENGTH) return;
+    strcpy_s(buffer, HTTP_VALIDATOR_LENGTH, value);
+}
+
+// reads the status line and the headers gathered in line, NUL terminated, and picks how the body is delimited
+static bool __cdecl parse_head(_Inout_ ring_connection_t* const restrict connection) {
+    fetch_t* const fetch          = connection->fetch;
+    long long      content_length = -1;
+    bool           is_chunked     = false;
+    char*          cursor         = NULL;
+
+    if (strncmp(connection->line, "HTTP/", 5)) {
+        fputws(L"Error: malformed HTTP status line.\n", stderr);
+        return false;
+    }
+    const unsigned long major = strtoul(connection->line + 5, &cursor, 10);
+    const unsigned long minor = *cursor == '.' ? strtoul(cursor + 1, &cursor, 10) : 0;
+    fetch->status             = (unsigned) strtoul(cursor, NULL, 10);
+    connection->is_keep_alive = major > 1 || (major == 1 && minor >= 1); // HTTP/1.1 connections are persistent unless told otherwise
+
+    for (char* line = strchr(connection->line, '\n'); line && *++line;) {
+        char* const end = strchr(line, '\n');
+        if (end) *end = 0;
+        if (end && end > line && end[-1] == '\r') end[-1] = 0;
+
+        if (!strncasecmp_(line, "Content-Length:", 15))
+            content_length = strtoll(line + 15, NULL, 10);
+        else if (!strncasecmp_(line, "Content-Range:", 14)) { // bytes 0-1023/4096, the size after the slash is * when unknown
+            const char* const slash = strchr(line + 14, '/');
+            if (slash) fetch->total_size = strtoull(slash + 1, NULL, 10);
+        } else if (!strncasecmp_(line, "Transfer-Encoding:", 18))
+            is_chunked = strstr(line + 18, "chunked") != NULL;
+        else if (!strncasecmp_(line, "Connection:", 11)) {
+            if (strstr(line + 11, "close")) connection->is_keep_alive = false;
+            if (strstr(line + 11, "keep-alive")) connection->is_keep_alive = true;
+        } else if (!strncasecmp_(line, "Content-Encoding:", 17) && !strstr(line + 17, "identity")) {
+            fwprintf_s(stderr, L"Error: unsupported Content-Encoding%S.\n", line + 16);
+            return false;
+        } else if (!strncasecmp_(line, "ETag:", 5))
+            copy_value(line + 5, fetch->validators.etag);
+        else if (!strncasecmp_(line, "Last-Modified:", 14))
+            copy_value(line + 14, fetch->validators.last_modified);
+        line = end;
+    }
+
+    if (fetch->status == HTTP_STATUS_OK && content_length >= 0) fetch->total_size = (unsigned long long) content_length;
+    if (fetch->status == HTTP_STATUS_NOT_MODIFIED || fetch->status == 204 || (content_length == 0 && !is_chunked))
+        connection->state = RESPONSE_DONE;
+    else if (is_chunked)
+        connection->state = RESPONSE_CHUNK_SIZE;
+    else if (content_length > 0) {
+        connection->state     = RESPONSE_LENGTH;
+        connection->remaining = (unsigned long long) content_length;
+    } else {
+        connection->state         = RESPONSE_UNTIL_CLOSE;
+        connection->is_keep_alive = false;
+    }
+    return true;
+}
+
+// gathers a line into line and consumes it, returns the bytes taken from data or -1 when the line doesn't fit. the line is complete and
+// NUL terminated without its CRLF when line_size is 0 afterwards
+static long __cdecl gather_line(_Inout_ ring_connection_t* const restrict connection, _In_ const char* const restrict data, _In_ const unsigned long size) {
+    const char* const   newline = memchr(data, '\n', size);
+    const unsigned long length  = newline ? (unsigned long) (newline - data) + 1 : size;
+    if (connection->line_size + length >= sizeof(connection->line)) {
+        fputws(L"Error: a line of the response is too long.\n", stderr);
+        return -1;
+    }
+    memcpy(connection->line + connection->line_size, data, length);
+    connection->line_size += length;
+    if (!newline) return (long) length;
+
+    unsigned long end = connection->line_size - 1;
+    if (end && connection->line[end - 1] == '\r') end--;
+    connection->line[end] = 0;
+    connection->line_size = 0;
+    return (long) length;
+}
+
+// the header block ends with an empty line, a lone LF counts as a line ending too. returns one past its end in line, 0 until it's complete
+static unsigned long __cdecl find_head_end(_In_ const char* const restrict line, _In_ const unsigned long from, _In_ const unsigned long size) {
+    for (unsigned long i = from; i < size; ++i) {
+        if (line[i] != '\n') continue;
+        if (i + 1 < size && line[i + 1] == '\n') return i + 2;
+        if (i + 2 < size && line[i + 1] == '\r' && line[i + 2] == '\n') return i + 3;
+    }
+    return 0;
+}
+
+// pushes the next piece of the response through the parser
+static feed_result_t __cdecl feed(_Inout_ ring_connection_t* const restrict connection, _In_ const char* restrict data, _In_ unsigned long size) {
+    while (size) {
+        switch (connection->state) {
+            case RESPONSE_HEAD : {
+                const unsigned long before = connection->line_size;
+                const unsigned long room   = sizeof(connection->line) - 1 - before;
+                const unsigned long taken  = size < room ? size : room;
+                memcpy(connection->line + before, data, taken);
+                connection->line_size         += taken;
+                const unsigned long end        = find_head_end(connection->line, before > 2 ? before - 2 : 0, connection->line_size);
+                if (!end) {
+                    if (taken < size) {
+                        fputws(L"Error: the response headers are too long.\n", stderr);
+                        return FEED_ERROR;
+                    }
+                    return FEED_MORE;
+                }
+                connection->line[end - 1] = 0;
+                connection->line_size     = 0;
+                data                     += end - before;
+                size                     -= end - before;
+                if (!parse_head(connection)) return FEED_ERROR; // parse_head will do the error reporting
+                break;
+            }
+
+            case RESPONSE_LENGTH :
+            case RESPONSE_CHUNK_DATA : {
+                const unsigned long taken = connection->remaining < size ? (unsigned long) connection->remaining : size;
+                if (!body_append(&connection->fetch->body, data, taken)) return FEED_ERROR; // body_append will do the error reporting
+                data                  += taken;
+                size                  -= taken;
+                connection->remaining -= taken;
+                if (!connection->remaining) connection->state = connection->state == RESPONSE_LENGTH ? RESPONSE_DONE : RESPONSE_CHUNK_END;
+                break;
+            }
+
+            case RESPONSE_UNTIL_CLOSE : return body_append(&connection->fetch->body, data, size) ? FEED_MORE : FEED_ERROR;
+
+            case RESPONSE_CHUNK_SIZE :
+            case RESPONSE_CHUNK_END :
+            case RESPONSE_TRAILERS : {
+                const long taken = gather_line(connection, data, size);
+                if (taken < 0) return FEED_ERROR; // gather_line will do the error reporting
+                data += taken;
+                size -= (unsigned long) taken;
+                if (connection->line_size) break; // the line isn't complete yet
+
+                if (connection->state == RESPONSE_CHUNK_SIZE) {
+                    char* end             = NULL;
+                    connection->remaining = strtoull(connection->line, &end, 16); // chunk extensions after a ';' are ignored
+                    if (end == connection->line) {
+                        fputws(L"Error: malformed chunk size in a chunked response.\n", stderr);
+                        return FEED_ERROR;
+                    }
+                    connection->state = connection->remaining ? RESPONSE_CHUNK_DATA : RESPONSE_TRAILERS;
+                } else if (*connection->line) { // a trailer, or whatever came instead of the CRLF closing a chunk
+                    if (connection->state == RESPONSE_CHUNK_END) return FEED_ERROR;
+                } else
+                    connection->state = connection->state == RESPONSE_CHUNK_END ? RESPONSE_CHUNK_SIZE : RESPONSE_DONE;
+                break;
+            }
+
+            case RESPONSE_DONE : // bytes past the end of the response, the connection can't carry another request
+                connection->is_keep_alive = false;
+                return FEED_DONE;
+        }
+    }
+    return connection->state == RESPONSE_DONE ? FEED_DONE : FEED_MORE;
+}
+
+// tears the connection down, it's released once all of its operations have completed
+static void __cdecl close_connection(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    if (!connection->is_open) return;
+    connection->is_open = false;
+    if (connection->npending) submit_cancel(ring, connection);
+}
+
+// hands the page over, or discards what arrived of it when the fetch failed
+static void __cdecl finish_fetch(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection, _In_ bool is_fetched) {
+    fetch_t* const fetch = connection->fetch;
+    if (is_fetched && fetch->status != HTTP_STATUS_NOT_MODIFIED && (fetch->status < 200 || fetch->status > 299)) {
+        fwprintf_s(stderr, L"Error: the server responded with HTTP status %u for %S.\n", fetch->status, fetch->path);
+        is_fetched = false;
+    }
+
+    fetch->is_fetched = is_fetched;
+    if (is_fetched) count_success(&ring->batch->nsucceeded);
+    else body_release(&fetch->body);
+    connection->fetch = NULL;
+}
+
+static void __cdecl fail_fetch(
+    _Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection, _In_ const wchar_t* const restrict operation,
+    _In_ const unsigned long error
+) {
+    fwprintf_s(stderr, L"Error %lu in %s for %S.\n", error, operation, connection->fetch->path);
+    finish_fetch(ring, connection, false);
+    close_connection(ring, connection);
+}
+
+// sends what's left of the request message, failing the fetch when that can't even be started
+static void __cdecl send_message(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    if (submit_send(ring, connection)) connection->npending++;
+    else fail_fetch(ring, connection, L"send", (unsigned long) last_socket_error());
+}
+
+// arms a receive on a connection that has none, it stays armed on io_uring while it's open. one that can't even be started closes it
+static void __cdecl arm_recv(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    connection->is_receiving = submit_recv(ring, connection);
+    if (connection->is_receiving) connection->npending++;
+    else if (connection->fetch) fail_fetch(ring, connection, L"recv", (unsigned long) last_socket_error());
+    else close_connection(ring, connection);
+}
+
+// gives the connection the next page, over the connection it has when it's kept alive or a new one otherwise. false when there's no page
+// left to fetch, or when the connection couldn't be opened
+static bool __cdecl start_fetch(_Inout_ ring_t* const restrict ring, _Inout_ ring_connection_t* const restrict connection) {
+    batch_t* const batch = ring->batch;
+    if (batch->is_aborted) return false;
+    const long next = next_fetch(&batch->next);
+    if (next >= (long) batch->count) return false;
+
+    fetch_t* const fetch     = batch->fetches + next;
+    *fetch                   = (fetch_t) { .path = fetch->path, .headers = fetch->headers };
+    connection->fetch        = fetch;
+    connection->state        = RESPONSE_HEAD;
+    connection->line_size    = 0;
+    connection->sent         = 0;
+    const int size           = snprintf(
+        connection->message,
+        RING_MESSAGE_SIZE,
+        "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: crawl\r\nAccept: */*\r\nAccept-Encoding: identity\r\nConnection: keep-alive\r\n%s\r\n",
+        fetch->path,
+        batch->host,
+        fetch->headers ? fetch->headers : ""
+    );
+    if (size < 0 || size >= (int) RING_MESSAGE_SIZE) {
+        fwprintf_s(stderr, L"Error: the request for %S is too long.\n", fetch->path);
+        finish_fetch(ring, connection, false);
+        return start_fetch(ring, connection);
+    }
+    connection->message_size = (unsigned long) size;
+
+    if (connection->is_open) { // a kept alive connection, its receive is armed already
+        send_message(ring, connection);
+        return true;
+    }
+
+    connection->socket = open_socket(ring, (unsigned long) (connection - ring->connections));
+    if (connection->socket == INVALID_SOCKET) {
+        fwprintf_s(stderr, L"Error: could not open a socket for %S.\n", fetch->path);
+        finish_fetch(ring, connection, false);
+        return false;
+    }
+    ring->nlive++;
+    connection->is_open      = true;
+    connection->is_connected = false;
+    if (!submit_connect(ring, connection)) {
+        release_socket(connection);
+        ring->nlive--;
+        connection->is_open = false;
+        fwprintf_s(stderr, L"Error: could not connect to %S.\n", batch->host);
+        finish_fetch(ring, connection, false);
+        return false;
+    }
+    connection->npending++;
+    return true;
+}
+
+// hands the completion to the connection's state machine
+static void __cdecl complete(_Inout_ ring_t* const restrict ring, _In_ const ring_completion_t* const restrict completion) {
+    ring_connection_t* const connection = ring->connections + completion->connection;
+    if (!completion->is_more) connection->npending--;
+    if (completion->op == RING_RECV && !completion->is_more) connection->is_receiving = false;
+
+    if (connection->is_open) switch (completion->op) {
+            case RING_CONNECT :
+                if (completion->error) {
+                    fail_fetch(ring, connection, L"connect", completion->error);
+                    break;
+                }
+                connection->is_connected = true;
+                arm_recv(ring, connection);
+                if (connection->is_open) send_message(ring, connection);
+                break;
+
+            case RING_SEND :
+                if (completion->error) {
+                    fail_fetch(ring, connection, L"send", completion->error);
+                    break;
+                }
+                connection->sent += completion->transferred;
+                if (connection->sent < connection->message_size) send_message(ring, connection);
+                break;
+
+            case RING_RECV : {
+                if (completion->error) {
+#ifndef _WIN32
+                    if (completion->error == ENOBUFS) break; // the receive buffers ran out for a moment, rearmed below
+#endif
+                    if (connection->fetch) fail_fetch(ring, connection, L"recv", completion->error);
+                    else close_connection(ring, connection);
+                    break;
+                }
+
+                if (!completion->transferred) { // the server closed the connection
+                    if (connection->fetch && connection->state == RESPONSE_UNTIL_CLOSE) finish_fetch(ring, connection, true);
+                    else if (connection->fetch) {
+                        fwprintf_s(stderr, L"Error: the server closed the connection in the middle of %S.\n", connection->fetch->path);
+                        finish_fetch(ring, connection, false);
+                    }
+                    close_connection(ring, connection);
+                    break;
+                }
+
+                const feed_result_t result = connection->fetch ? feed(connection, completion->data, completion->transferred) : FEED_ERROR;
+                if (result == FEED_ERROR) {
+                    if (connection->fetch) finish_fetch(ring, connection, false); // feed will do the error reporting
+                    close_connection(ring, connection);
+                } else if (result == FEED_DONE) {
+                    finish_fetch(ring, connection, true);
+                    if (!connection->is_keep_alive || !start_fetch(ring, connection)) close_connection(ring, connection);
+                }
+                break;
+            }
+
+            case RING_CANCEL : break;
+        }
+
+    if (completion->is_buffered) recycle_buffer(ring, completion->buffer);
+    if (connection->is_open && connection->is_connected && !connection->is_receiving) arm_recv(ring, connection);
+
+    if (!connection->is_open && !connection->npending && connection->socket != INVALID_SOCKET) { // torn down for good
+        release_socket(connection);
+        ring->nlive--;
+        (void) start_fetch(ring, connection);
+    }
+}
+
+// runs the ring until there's no page left to fetch and every connection is closed
+static bool __cdecl run_ring(_Inout_opt_ void* const argument) {
+    ring_t* const restrict ring = argument;
+    ring_completion_t      completions[RING_MAX_COMPLETIONS];
+    bool                   is_run = false;
+
+    ring->connections = calloc(ring->nconnections, sizeof(ring_connection_t));
+    ring->messages    = malloc(RING_MESSAGE_SIZE * ring->nconnections);
+    if (!ring->connections || !ring->messages) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        goto CLEANUP;
+    }
+    for (unsigned long i = 0; i < ring->nconnections; ++i) {
+        ring->connections[i].socket  = INVALID_SOCKET;
+        ring->connections[i].message = ring->messages + RING_MESSAGE_SIZE * i;
+    }
+    if (!ring_open(ring)) goto CLEANUP; // ring_open will do the error reporting
+
+    for (unsigned long i = 0; i < ring->nconnections; ++i)
+        while (!start_fetch(ring, ring->connections + i) && ring->connections[i].socket == INVALID_SOCKET && ring->batch->next < (long) ring->batch->count)
+            continue; // a connection that couldn't be opened takes the next page
+
+    while (ring->nlive) {
+        const long count = ring_wait(ring, completions);
+        if (count < 0) { // nothing completed for HTTP_SOCKET_TIMEOUT, the server is gone
+            fwprintf_s(stderr, L"Error: timed out waiting on %S.\n", ring->batch->host);
+            ring->batch->is_aborted = true;
+            for (unsigned long i = 0; i < ring->nconnections; ++i) {
+                ring_connection_t* const connection = ring->connections + i;
+                if (connection->fetch) finish_fetch(ring, connection, false);
+                close_connection(ring, connection);
+                if (!connection->npending && connection->socket != INVALID_SOCKET) {
+                    release_socket(connection);
+                    ring->nlive--;
+                }
+            }
+#ifdef _WIN32
+            if (ring->nlive) continue; // the cancelled operations complete promptly
+#endif
+            break; // closing the io_uring cancels the rest
+        }
+        for (long i = 0; i < count; ++i) complete(ring, completions + i);
+    }
+    is_run = true;
+
+CLEANUP:
+    if (ring->connections)
+        for (unsigned long i = 0; i < ring->nconnections; ++i) {
+            if (ring->connections[i].fetch) finish_fetch(ring, ring->connections + i, false);
+            release_socket(ring->connections + i);
+        }
+    ring_close(ring);
+    free(ring->connections);
+    free(ring->messages);
+    return is_run;
+}
+
+[[nodiscard("entails expensive http io")]] unsigned long __cdecl fetch_all(
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _Inout_ fetch_t* const restrict fetches,
+    _In_ const unsigned long count,
+    _In_ const unsigned long concurrency
+) {
+    batch_t          batch    = { .fetches = fetches, .count = count };
+    struct addrinfo  hints    = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_protocol = IPPROTO_TCP };
+    struct addrinfo* address  = NULL;
+    char             service[8] = { 0 };
+    unsigned long    nrings   = processor_count();
+    unsigned long    nconnections = concurrency < RING_MAX_CONNECTIONS ? concurrency : RING_MAX_CONNECTIONS;
+
+    for (unsigned long i = 0; i < count; ++i) fetches[i] = (fetch_t) { .path = fetches[i].path, .headers = fetches[i].headers };
+    if (!count) return 0;
+    if (!narrow_host(server, batch.host, sizeof(batch.host))) {
+        fputws(L"Error: server names must be ASCII for the ring transport.\n", stderr);
+        return 0;
+    }
+    if (!ring_startup()) return 0; // ring_startup will do the error reporting
+
+    snprintf(service, sizeof(service), "%u", port);
+    const int status = getaddrinfo(batch.host, service, &hints, &address);
+    if (status || !address) {
+        fwprintf_s(stderr, L"Error %d in getaddrinfo.\n", status);
+        return 0;
+    }
+    memcpy(&batch.address, address->ai_addr, address->ai_addrlen);
+    batch.address_size = (int) address->ai_addrlen;
+    freeaddrinfo(address);
+
+#ifndef _WIN32
+    // every connection is a file descriptor, the soft limit is often 1024 with a much higher hard limit
+    struct rlimit limit = { 0 };
+    if (!getrlimit(RLIMIT_NOFILE, &limit) && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < nconnections + 64) {
+        limit.rlim_cur = limit.rlim_max == RLIM_INFINITY || limit.rlim_max > nconnections + 64 ? nconnections + 64 : limit.rlim_max;
+        (void) setrlimit(RLIMIT_NOFILE, &limit);
+        (void) getrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < nconnections + 64) nconnections = limit.rlim_cur > 128 ? (unsigned long) limit.rlim_cur - 64 : 64;
+    }
+#endif
+    if (nconnections > count) nconnections = count;
+    if (!nconnections) nconnections = 1;
+    if (nrings > nconnections) nrings = nconnections;
+    ring_task_t* const rings = calloc(nrings, sizeof(ring_task_t));
+    if (!rings) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return 0;
+    }
+
+    // the connections are dealt out as evenly as they go, the first ring runs on the calling thread
+    const trace_span_t span = trace_begin("fetch all", "http");
+    for (unsigned long i = 0; i < nrings; ++i) {
+        rings[i].ring.batch        = &batch;
+        rings[i].ring.nconnections = nconnections / nrings + (i < nconnections % nrings);
+        if (i) task_start(&rings[i].task, run_ring, &rings[i].ring);
+    }
+    (void) run_ring(&rings[0].ring); // run_ring will do the error reporting
+    for (unsigned long i = 1; i < nrings; ++i) (void) task_wait(&rings[i].task);
+    trace_end(span, 0, (unsigned long long) batch.nsucceeded);
+
+    // fetches no ring got to, because none of them could be opened or the server stopped answering
+    for (long i = batch.next; i < (long) count; ++i) fetches[i] = (fetch_t) { .path = fetches[i].path, .headers = fetches[i].headers };
+    free(rings);
+    return (unsigned long) batch.nsucceeded;
+}
+
+static bool __cdecl ring_get(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint
+) {
+    (void) server, (void) port; // the request carries them too
+    if (!narrow_host(accesspoint, request->ring.path, sizeof(request->ring.path))) {
+        fputws(L"Error: paths must be ASCII for the ring transport.\n", stderr);
+        return false;
+    }
+    (void) format_request_conditions(request, request->ring.headers, sizeof(request->ring.headers));
+    return true;
+}
+
+static bool __cdecl ring_read(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const http_sink_t sink,
+    _Inout_opt_ void* const context,
+    _Inout_ unsigned long* const restrict size
+) {
+    fetch_t fetch = { .path = request->ring.path, .headers = request->ring.headers };
+
+    *size                 = 0;
+    const bool is_fetched = fetch_all(request->server, request->port, &fetch, 1, 1) == 1; // fetch_all will do the error reporting
+    request->status       = fetch.status;
+    request->validators   = fetch.validators;
+    request->total_size   = fetch.total_size;
+    *size                 = fetch.body.size;
+
+    bool is_read = is_fetched;
+    for (const body_slab_t* slab = fetch.body.head; slab && is_read; slab = slab->next)
+        is_read = sink(context, slab->data, (unsigned long) slab->size);
+    body_release(&fetch.body);
+    return is_read;
+}
+
+const http_transport_t ring_transport = { .name = L"ring", .get = ring_get, .read = ring_read };
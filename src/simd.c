@@ -0,0 +1,116 @@
+#include <project.h>
+
+// vectorized candidate scanners for the HTML parsers in lib.c
+// both locate_stable_releases_htmldiv and parse_stable_releases are only ever interested in positions where a two byte sequence like "<h" or
+// "<a" begins, so instead of testing every byte against '<' and then the next one, these kernels compare 16 (SSE2) or 32 (AVX2) bytes at once
+// against both characters and AND the two masks, the lowest set bit of the combined mask is the next candidate offset.
+// the expensive prefix checks downstream are then only done on actual candidates.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define __target_avx2 // MSVC does not need per function target attributes to emit AVX2 instructions
+#else
+    #include <cpuid.h>
+    #include <immintrin.h>
+    #define __target_avx2 __attribute__((target("avx2")))
+#endif
+
+// index of the lowest set bit of a non-zero comparison mask
+static inline unsigned long __cdecl lowest_set_bit(_In_ const unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return (unsigned long) __builtin_ctz(mask);
+#endif
+}
+
+[[nodiscard]] unsigned long __cdecl scan_pair_scalar(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+) {
+    for (unsigned long i = begin; i < end; ++i)
+        if (html[i] == first && html[i + 1] == second) return i;
+    return end;
+}
+
+[[nodiscard]] unsigned long __cdecl scan_pair_sse2(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+) {
+    const __m128i first_x16 = _mm_set1_epi8(first), second_x16 = _mm_set1_epi8(second); // NOLINT(readability-isolate-declaration)
+    unsigned long i         = begin;
+
+    // the second load reads html[i + 1] to html[i + 16], so stop the vector loop when that would step past html[end]
+    for (; i + 17 <= end; i += 16) {
+        const __m128i lead  = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (html + i)), first_x16);
+        const __m128i trail = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (html + i + 1)), second_x16);
+        const unsigned mask = (unsigned) _mm_movemask_epi8(_mm_and_si128(lead, trail));
+        if (mask) return i + lowest_set_bit(mask);
+    }
+
+    return scan_pair_scalar(html, i, end, first, second); // leftovers
+}
+
+[[nodiscard]] __target_avx2 unsigned long __cdecl scan_pair_avx2(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+) {
+    const __m256i first_x32 = _mm256_set1_epi8(first), second_x32 = _mm256_set1_epi8(second); // NOLINT(readability-isolate-declaration)
+    unsigned long i         = begin;
+
+    for (; i + 33 <= end; i += 32) {
+        const __m256i lead  = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (html + i)), first_x32);
+        const __m256i trail = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (html + i + 1)), second_x32);
+        const unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_and_si256(lead, trail));
+        if (mask) return i + lowest_set_bit(mask);
+    }
+
+    // leftovers, at most 32 bytes. gcc turns this into a tail call without the vzeroupper it puts before a ret, and the SSE2 kernel's legacy
+    // encoded instructions would then pay for the transition out of dirty YMM upper halves on every call that gets this far
+    _mm256_zeroupper();
+    return scan_pair_sse2(html, i, end, first, second);
+}
+
+// AVX2 needs both the CPUID feature bit and the OS saving the YMM registers across context switches (XCR0 bits 1 and 2)
+[[maybe_unused]] static bool __cdecl is_avx2_usable(void) { // CRAWL_FORCE_SCALAR_SCAN builds never ask
+#if defined(_MSC_VER) && !defined(__clang__)
+    int registers[4] = { 0 }; // eax, ebx, ecx, edx
+    __cpuid(registers, 0);
+    if (registers[0] < 7) return false;
+    __cpuid(registers, 1);
+    if (!(registers[2] & (1 << 27))) return false; // OSXSAVE
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(registers, 7, 0);
+    return registers[1] & (1 << 5); // NOLINT(readability-implicit-bool-conversion)
+#else
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0; // NOLINT(readability-isolate-declaration)
+    if (__get_cpuid_max(0, NULL) < 7) return false;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (!(ecx & bit_OSXSAVE)) return false;
+    unsigned xcr0_lo = 0, xcr0_hi = 0; // NOLINT(readability-isolate-declaration)
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6) return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return ebx & bit_AVX2; // NOLINT(readability-implicit-bool-conversion)
+#endif
+}
+
+// SSE2 is part of the x86-64 baseline so it is always safe to fall back to it, the scalar kernel is only reachable through
+// CRAWL_FORCE_SCALAR_SCAN which exists to cross-check the vector kernels
+static scan_kernel_t __cdecl select_scan_kernel(void) {
+#ifdef CRAWL_FORCE_SCALAR_SCAN
+    return scan_pair_scalar;
+#else
+    return is_avx2_usable() ? scan_pair_avx2 : scan_pair_sse2;
+#endif
+}
+
+// resolved on the first call, racing threads will all store the same pointer so there's no need for synchronization here
+static scan_kernel_t scan_kernel = NULL;
+
+[[nodiscard]] unsigned long __cdecl scan_pair(
+    _In_ const char* const restrict html, _In_ const unsigned long begin, _In_ const unsigned long end, _In_ const char first, _In_ const char second
+) {
+    if (!scan_kernel) [[unlikely]]
+        scan_kernel = select_scan_kernel();
+    return scan_kernel(html, begin, end, first, second);
+}
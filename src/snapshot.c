@@ -0,0 +1,153 @@
+#include <project.h>
+
+// binary snapshots of parsed releases, for callers like status bars and shell prompts that want the releases without a round trip or a parse.
+// a snapshot is laid out to be used straight from a read-only file mapping:
+//
+//     snapshot_header_t | span_t versions[count] | span_t downloadurls[count] | uint8_t kinds[count] | string pool (pool_size bytes)
+//
+// which is results_serialize's output behind a header, so a mapped snapshot is a results_t that borrows its spans and text from the mapping.
+// spans are offsets into the pool, so nothing in the file depends on where it gets mapped. the checksum covers everything after the header,
+// and the version guards against files written by builds with a different layout.
+
+#define SNAPSHOT_MAGIC   0x4E535243U // "CRSN"
+#define SNAPSHOT_VERSION 3U          // 2 replaced the record table with the span arrays of results_t, 3 added the artifact kinds
+
+static_assert(sizeof(snapshot_header_t) == 32, "the snapshot header is part of the file format");
+static_assert(sizeof(span_t) == 8, "spans are part of the file format");
+
+// FNV-1a, the payload is a few KiB so there's no point in anything fancier
+static uint64_t __cdecl checksum(_In_ const unsigned char* const restrict bytes, _In_ const unsigned long long size) {
+    uint64_t hash = 0xCBF29CE484222325LLU;
+    for (unsigned long long i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x100000001B3LLU;
+    return hash;
+}
+
+[[nodiscard("entails expensive file io"
+)]] bool __cdecl snapshot_write(_In_ const wchar_t* const restrict filename, _In_ const results_t results) {
+    const unsigned long long pool_size = results_text_size(results);
+    const unsigned long long size      = sizeof(snapshot_header_t) + results.count * RESULTS_RECORD_SIZE + pool_size;
+    if (size > UINT32_MAX) [[unlikely]] {
+        fputws(L"Error in " __FUNCTIONW__ ": too many releases for a snapshot!\n", stderr);
+        return false;
+    }
+
+    unsigned char* const restrict buffer = malloc(size);
+    if (!buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+    results_serialize(results, buffer + sizeof(snapshot_header_t));
+
+    FILETIME now = { 0 };
+    GetSystemTimeAsFileTime(&now);
+    const snapshot_header_t header = {
+        .magic     = SNAPSHOT_MAGIC,
+        .version   = SNAPSHOT_VERSION,
+        .count     = results.count,
+        .pool_size = (uint32_t) pool_size,
+        .created   = ((uint64_t) now.dwHighDateTime << 32) | now.dwLowDateTime,
+        .checksum  = checksum(buffer + sizeof(snapshot_header_t), size - sizeof(snapshot_header_t)),
+    };
+    memcpy(buffer, &header, sizeof(snapshot_header_t));
+
+    // write next to the target and rename over it, readers that open the snapshot mid-write then keep seeing the previous one
+    wchar_t temporary[MAX_PATH] = { 0 };
+    bool    is_written          = swprintf_s(temporary, MAX_PATH, L"%s.tmp", filename) > 0;
+    is_written                  = is_written && __serialize(buffer, (unsigned long) size, temporary); // __serialize will do the error reporting
+    free(buffer);
+
+    if (is_written && !MoveFileExW(temporary, filename, MOVEFILE_REPLACE_EXISTING)) {
+        fwprintf_s(stderr, L"Error %lu in MoveFileExW.\n", GetLastError());
+        DeleteFileW(temporary);
+        is_written = false;
+    }
+    return is_written;
+}
+
+// checks everything a reader of the spans relies on, a snapshot that passes can be read without any further bounds checks
+static bool __cdecl is_valid_snapshot(_In_ const unsigned char* const restrict base, _In_ const unsigned long long size) {
+    snapshot_header_t header = { 0 };
+    if (size < sizeof(snapshot_header_t)) return false;
+    memcpy(&header, base, sizeof(snapshot_header_t));
+
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) return false;
+    if (size != sizeof(snapshot_header_t) + (unsigned long long) header.count * RESULTS_RECORD_SIZE + header.pool_size) return false;
+    if (checksum(base + sizeof(snapshot_header_t), size - sizeof(snapshot_header_t)) != header.checksum) return false;
+
+    const span_t* const restrict  spans = (const span_t*) (base + sizeof(snapshot_header_t));
+    const uint8_t* const restrict kinds = (const uint8_t*) (spans + 2LLU * header.count);
+    for (unsigned long long i = 0; i < 2LLU * header.count; ++i) // every string must lie inside the pool
+        if ((unsigned long long) spans[i].offset + spans[i].length > header.pool_size) return false;
+    for (unsigned long long i = 0; i < header.count; ++i)
+        if (kinds[i] >= ARTIFACT_KINDS) return false;
+    return true;
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl snapshot_map(
+    _In_ const wchar_t* const restrict filename, _Inout_ snapshot_t* const restrict snapshot
+) {
+    LARGE_INTEGER size = { .QuadPart = 0 };
+    *snapshot          = (snapshot_t) { .file = INVALID_HANDLE_VALUE, .mapping = NULL, .base = NULL };
+
+    // FILE_SHARE_DELETE lets snapshot_write rename a new snapshot over this one while it's open
+    snapshot->file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (snapshot->file == INVALID_HANDLE_VALUE) {
+        fwprintf_s(stderr, L"Error %lu in CreateFileW\n", GetLastError());
+        return false;
+    }
+
+    if (!GetFileSizeEx(snapshot->file, &size)) {
+        fwprintf_s(stderr, L"Error %lu in GetFileSizeEx\n", GetLastError());
+        goto CLOSE_FILE;
+    }
+    if (size.QuadPart < (long long) sizeof(snapshot_header_t)) goto INVALID_SNAPSHOT; // empty files can't even be mapped
+
+    snapshot->mapping = CreateFileMappingW(snapshot->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!snapshot->mapping) {
+        fwprintf_s(stderr, L"Error %lu in CreateFileMappingW\n", GetLastError());
+        goto CLOSE_FILE;
+    }
+
+    snapshot->base = MapViewOfFile(snapshot->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!snapshot->base) {
+        fwprintf_s(stderr, L"Error %lu in MapViewOfFile\n", GetLastError());
+        goto CLOSE_MAPPING;
+    }
+
+    if (!is_valid_snapshot(snapshot->base, size.QuadPart)) {
+        UnmapViewOfFile(snapshot->base);
+        CloseHandle(snapshot->mapping);
+        goto INVALID_SNAPSHOT;
+    }
+
+    // the mapping is read-only, the spans are cast to non const only because results_t is shared with the owning case
+    span_t* const restrict spans = (span_t*) (snapshot->base + sizeof(snapshot_header_t));
+    snapshot->header             = (const snapshot_header_t*) snapshot->base;
+    snapshot->releases           = (results_t) {
+        .text         = (const char*) (spans + 2LLU * snapshot->header->count) + snapshot->header->count,
+        .versions     = spans,
+        .downloadurls = spans + snapshot->header->count,
+        .kinds        = (uint8_t*) (spans + 2LLU * snapshot->header->count),
+        .count        = snapshot->header->count,
+        .capacity     = snapshot->header->count,
+        .arena        = NULL,
+    };
+    return true;
+
+CLOSE_MAPPING:
+    CloseHandle(snapshot->mapping);
+    goto CLOSE_FILE;
+INVALID_SNAPSHOT:
+    fwprintf_s(stderr, L"Error: %s is either corrupt or not a snapshot of this version of crawl!\n", filename);
+CLOSE_FILE:
+    CloseHandle(snapshot->file);
+    *snapshot = (snapshot_t) { .file = INVALID_HANDLE_VALUE, .mapping = NULL, .base = NULL };
+    return false;
+}
+
+void __cdecl snapshot_unmap(_Inout_ snapshot_t* const restrict snapshot) {
+    if (snapshot->base) UnmapViewOfFile(snapshot->base);
+    if (snapshot->mapping) CloseHandle(snapshot->mapping);
+    if (snapshot->file != INVALID_HANDLE_VALUE) CloseHandle(snapshot->file);
+    *snapshot = (snapshot_t) { .file = INVALID_HANDLE_VALUE, .mapping = NULL, .base = NULL };
+}
@@ -0,0 +1,502 @@
+#include <project.h>
+
+// a minimal HTTP/1.1 client over non-blocking BSD sockets.
+// only the POSIX subset of the socket API is used, the few places where Winsock differs are hidden behind the macros below.
+// there's no TLS here, this transport is meant for plain HTTP endpoints like local mirrors, caches and recorded page servers.
+// gzip and deflate encoded bodies are inflated on the fly by the decoder in inflate.c, WinHTTP does the same for its transport.
+// connections are kept alive and parked in the connection pool between requests.
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+
+    #pragma comment(lib, "Ws2_32.lib")
+
+typedef SOCKET socket_t;
+    #define close_socket(s)      closesocket(s)
+    #define last_socket_error()  WSAGetLastError()
+    #define is_in_progress(e)    ((e) == WSAEWOULDBLOCK || (e) == WSAEINPROGRESS)
+    #define is_would_block(e)    ((e) == WSAEWOULDBLOCK)
+    #define is_dropped(e)        ((e) == WSAECONNRESET || (e) == WSAECONNABORTED)
+    #define strncasecmp_(a, b, n) _strnicmp((a), (b), (n))
+    #define SEND_FLAGS           0
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <strings.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+
+typedef int socket_t;
+    #define INVALID_SOCKET        (-1)
+    #define SOCKET_ERROR          (-1)
+    #define close_socket(s)       close(s)
+    #define last_socket_error()   errno
+    #define is_in_progress(e)     ((e) == EINPROGRESS || (e) == EWOULDBLOCK)
+    #define is_would_block(e)     ((e) == EAGAIN || (e) == EWOULDBLOCK)
+    #define is_dropped(e)         ((e) == EPIPE || (e) == ECONNRESET)
+    #define strncasecmp_(a, b, n) strncasecmp((a), (b), (n))
+    #define SEND_FLAGS            MSG_NOSIGNAL // a send on a connection the server has reset raises SIGPIPE otherwise
+#endif
+
+#define SOCKET_REQUEST_SIZE (HTTP_HEADER_LINE_LENGTH * 2) // longest request line and headers socket_get sends
+
+// Winsock needs a WSAStartup before the first socket call, a no-op elsewhere
+static bool __cdecl socket_startup(void) {
+#ifdef _WIN32
+    static bool is_started = false;
+    WSADATA     wsadata    = { 0 };
+    if (is_started) return true;
+    if (WSAStartup(MAKEWORD(2, 2), &wsadata)) {
+        fwprintf_s(stderr, L"Error %d in WSAStartup.\n", WSAGetLastError());
+        return false;
+    }
+    is_started = true;
+#endif
+    return true;
+}
+
+static bool __cdecl set_non_blocking(_In_ const socket_t socket) {
+#ifdef _WIN32
+    unsigned long is_non_blocking = 1;
+    return !ioctlsocket(socket, FIONBIO, &is_non_blocking);
+#else
+    const int flags = fcntl(socket, F_GETFL, 0);
+    return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+// waits until the socket becomes readable (or writable), returns false on timeouts and errors
+static bool __cdecl wait_socket(_In_ const socket_t socket, _In_ const bool is_write) {
+    fd_set         descriptors = { 0 };
+    struct timeval timeout     = { .tv_sec = HTTP_SOCKET_TIMEOUT / 1000, .tv_usec = (HTTP_SOCKET_TIMEOUT % 1000) * 1000 };
+
+    FD_ZERO(&descriptors);
+    FD_SET(socket, &descriptors);
+
+    // the first argument is ignored by Winsock
+    const int ready = select((int) socket + 1, is_write ? NULL : &descriptors, is_write ? &descriptors : NULL, NULL, &timeout);
+    if (ready <= 0) {
+        if (!ready)
+            fputws(L"Error: timed out waiting on the socket.\n", stderr);
+        else
+            fwprintf_s(stderr, L"Error %d in select.\n", last_socket_error());
+        return false;
+    }
+    return true;
+}
+
+// server names are plain ASCII host names or addresses, no need for a locale aware conversion
+static bool __cdecl narrow(_In_ const wchar_t* const restrict wide, _Inout_ char* const restrict buffer, _In_ const unsigned long size) {
+    unsigned long i = 0;
+    for (; wide[i] && i < size - 1; ++i) {
+        if (wide[i] > 0x7F) return false;
+        buffer[i] = (char) wide[i];
+    }
+    buffer[i] = 0;
+    return !wide[i];
+}
+
+// resolves the server and connects to the first address that accepts the connection, within HTTP_SOCKET_TIMEOUT per address
+static socket_t __cdecl connect_to(_In_ const char* const restrict host, _In_ const unsigned short port) {
+    struct addrinfo  hints   = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_protocol = IPPROTO_TCP };
+    struct addrinfo* address = NULL;
+    char             service[8] = { 0 };
+    socket_t         socket_    = INVALID_SOCKET;
+    trace_span_t     span       = trace_begin("connect", "http"); // name resolution included
+
+    snprintf(service, sizeof(service), "%u", port);
+    const int status = getaddrinfo(host, service, &hints, &address);
+    if (status) {
+        fwprintf_s(stderr, L"Error %d in getaddrinfo.\n", status);
+        trace_end(span, 0, 0);
+        return INVALID_SOCKET;
+    }
+
+    for (const struct addrinfo* candidate = address; candidate; candidate = candidate->ai_next) {
+        socket_ = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (socket_ == INVALID_SOCKET) continue;
+
+        if (set_non_blocking(socket_)) {
+            if (!connect(socket_, candidate->ai_addr, (int) candidate->ai_addrlen)) break;
+
+            // a non-blocking connect completes in the background, the socket turns writable once it has either succeeded or failed
+            if (is_in_progress(last_socket_error()) && wait_socket(socket_, true)) {
+                int       error  = 0;
+                socklen_t length = sizeof(error);
+                if (!getsockopt(socket_, SOL_SOCKET, SO_ERROR, (char*) &error, &length) && !error) break;
+            }
+        }
+
+        close_socket(socket_);
+        socket_ = INVALID_SOCKET;
+    }
+
+    freeaddrinfo(address);
+    trace_end(span, 0, 0);
+    if (socket_ == INVALID_SOCKET) fwprintf_s(stderr, L"Error: could not connect to %S:%u.\n", host, port);
+    return socket_;
+}
+
+// a pooled connection the server has dropped while it sat idle fails quietly, the request then goes out again over a fresh one
+static bool __cdecl send_all(
+    _In_ const socket_t socket, _In_ const char* const restrict data, _In_ const unsigned long size, _In_ const bool is_pooled
+) {
+    for (unsigned long sent = 0; sent < size;) {
+        const int written = send(socket, data + sent, (int) (size - sent), SEND_FLAGS);
+        if (written > 0) {
+            sent += (unsigned long) written;
+            continue;
+        }
+        if (written == SOCKET_ERROR && is_would_block(last_socket_error()) && wait_socket(socket, true)) continue;
+        if (!is_pooled || !is_dropped(last_socket_error())) fwprintf_s(stderr, L"Error %d in send.\n", last_socket_error());
+        return false;
+    }
+    return true;
+}
+
+// moves the unconsumed bytes to the front of the buffer and receives more after them
+// returns the number of bytes received, 0 when the server has closed the connection and -1 on errors. a pooled connection the server
+// resets before the first byte of the response counts as closed, it's what dropping an idle connection looks like from here
+static long __cdecl fill(_Inout_ socket_request_t* const restrict request) {
+    if (request->head) {
+        memmove(request->buffer, request->buffer + request->head, request->tail - request->head);
+        request->tail -= request->head;
+        request->head  = 0;
+    }
+    if (request->tail == HTTP_CHUNK_SIZE) return -1; // nothing consumed anything, a header line longer than the buffer
+
+    for (;;) {
+        const int received = recv((socket_t) request->socket, request->buffer + request->tail, (int) (HTTP_CHUNK_SIZE - request->tail), 0);
+        if (received >= 0) {
+            request->tail += (unsigned long) received;
+            return received;
+        }
+        if (request->is_pooled && !request->tail && is_dropped(last_socket_error())) return 0;
+        if (!is_would_block(last_socket_error())) {
+            fwprintf_s(stderr, L"Error %d in recv.\n", last_socket_error());
+            return -1;
+        }
+        if (!wait_socket((socket_t) request->socket, false)) return -1;
+    }
+}
+
+// copies the next CRLF (or LF) terminated line into line, without the line terminator
+static bool __cdecl read_line(_Inout_ socket_request_t* const restrict request, _Inout_ char* const restrict line, _In_ const unsigned long size) {
+    for (;;) {
+        const char* const newline = memchr(request->buffer + request->head, '\n', request->tail - request->head);
+        if (newline) {
+            unsigned long length = (unsigned long) (newline - (request->buffer + request->head));
+            if (length >= size) return false;
+            memcpy(line, request->buffer + request->head, length);
+            request->head += length + 1;
+            if (length && line[length - 1] == '\r') length--;
+            line[length] = 0;
+            return true;
+        }
+        if (fill(request) <= 0) return false;
+    }
+}
+
+// hands the next count bytes of the body to the sink, count == -1 forwards everything until the server closes the connection
+static bool __cdecl forward(
+    _Inout_ socket_request_t* const restrict request,
+    _In_ long long                           count,
+    _In_ const http_sink_t                   sink,
+    _Inout_opt_ void* const                  context,
+    _Inout_ unsigned long* const restrict    size
+) {
+    while (count) {
+        if (request->head == request->tail) {
+            const long received = fill(request);
+            if (received < 0) return false;
+            if (!received) return count < 0; // connection closed, fine only if we were reading until the end
+        }
+
+        unsigned long available = request->tail - request->head;
+        if (count > 0 && (unsigned long long) count < available) available = (unsigned long) count;
+        if (!sink(context, request->buffer + request->head, available)) return false;
+
+        request->head += available;
+        *size         += available;
+        trace_counter("bytes received", *size);
+        if (count > 0) count -= available;
+    }
+    return true;
+}
+
+// copies a header value without its leading whitespace, values that don't fit are dropped rather than truncated
+static void __cdecl copy_validator(_In_ const char* restrict value, _Inout_ char* const restrict buffer) {
+    while (*value == ' ' || *value == '\t') value++;
+    if (strlen(value) >= HTTP_VALIDATOR_LENGTH) {
+        *buffer = 0;
+        return;
+    }
+    strcpy_s(buffer, HTTP_VALIDATOR_LENGTH, value);
+}
+
+static bool __cdecl read_headers(_Inout_ http_request_t* const restrict request) {
+    char              line[HTTP_HEADER_LINE_LENGTH] = { 0 };
+    char*             cursor                        = NULL;
+    socket_request_t* socket_                       = &request->socket;
+
+    // HTTP/1.1 200 OK
+    if (!read_line(socket_, line, sizeof(line)) || strncmp(line, "HTTP/", 5)) {
+        fputws(L"Error: malformed HTTP status line.\n", stderr);
+        return false;
+    }
+    const unsigned long major = strtoul(line + 5, &cursor, 10);
+    const unsigned long minor = *cursor == '.' ? strtoul(cursor + 1, &cursor, 10) : 0;
+    request->status           = (unsigned) strtoul(cursor, NULL, 10);
+    socket_->is_keep_alive    = major > 1 || (major == 1 && minor >= 1); // HTTP/1.1 connections are persistent unless told otherwise
+    socket_->content_length   = -1;
+    socket_->is_chunked       = false;
+    socket_->content_encoding = INFLATE_NONE;
+
+    for (;;) {
+        if (!read_line(socket_, line, sizeof(line))) {
+            fputws(L"Error: malformed HTTP response headers.\n", stderr);
+            return false;
+        }
+        if (!*line) { // the empty line ending the header block
+            // a whole body tells its size by its length, as long as it isn't encoded
+            if (request->status == HTTP_STATUS_OK && socket_->content_length >= 0 && socket_->content_encoding == INFLATE_NONE)
+                request->total_size = (unsigned long long) socket_->content_length;
+            return true;
+        }
+
+        if (!strncasecmp_(line, "Content-Length:", 15))
+            socket_->content_length = strtoll(line + 15, NULL, 10);
+        else if (!strncasecmp_(line, "Content-Range:", 14)) { // bytes 0-1023/4096, the size after the slash is * when unknown
+            const char* const slash = strchr(line + 14, '/');
+            if (slash) request->total_size = strtoull(slash + 1, NULL, 10);
+        } else if (!strncasecmp_(line, "Transfer-Encoding:", 18))
+            socket_->is_chunked = strstr(line + 18, "chunked") != NULL;
+        else if (!strncasecmp_(line, "Connection:", 11)) {
+            if (strstr(line + 11, "close")) socket_->is_keep_alive = false;
+            if (strstr(line + 11, "keep-alive")) socket_->is_keep_alive = true;
+        } else if (!strncasecmp_(line, "Content-Encoding:", 17)) {
+            if (strstr(line + 17, "gzip"))
+                socket_->content_encoding = INFLATE_GZIP;
+            else if (strstr(line + 17, "deflate"))
+                socket_->content_encoding = INFLATE_ZLIB;
+            else if (!strstr(line + 17, "identity")) {
+                fwprintf_s(stderr, L"Error: unsupported Content-Encoding%S.\n", line + 16);
+                return false;
+            }
+        } else if (!strncasecmp_(line, "ETag:", 5))
+            copy_validator(line + 5, request->validators.etag);
+        else if (!strncasecmp_(line, "Last-Modified:", 14))
+            copy_validator(line + 14, request->validators.last_modified);
+    }
+}
+
+static bool __cdecl read_chunked_body(
+    _Inout_ socket_request_t* const restrict request,
+    _In_ const http_sink_t                   sink,
+    _Inout_opt_ void* const                  context,
+    _Inout_ unsigned long* const restrict    size
+) {
+    char line[HTTP_HEADER_LINE_LENGTH] = { 0 };
+
+    for (;;) {
+        if (!read_line(request, line, sizeof(line))) return false;
+
+        char*                    end    = NULL;
+        const unsigned long long length = strtoull(line, &end, 16); // chunk extensions after a ';' are ignored
+        if (end == line) {
+            fputws(L"Error: malformed chunk size in a chunked response.\n", stderr);
+            return false;
+        }
+
+        if (!length) { // the last chunk, skip the trailers up to the final empty line
+            do
+                if (!read_line(request, line, sizeof(line))) return false;
+            while (*line);
+            return true;
+        }
+
+        if (!forward(request, (long long) length, sink, context, size)) return false;
+        if (!read_line(request, line, sizeof(line)) || *line) return false; // the CRLF that closes every chunk
+    }
+}
+
+static void __cdecl close_pooled_socket(_In_ const uintptr_t connection) { close_socket((socket_t) connection); }
+
+// an idle keep-alive connection must have nothing to read, a readable one has either been closed by the server (recv returns 0) or
+// carries bytes that don't belong to any request of ours
+static bool __cdecl is_idle_socket_usable(_In_ const uintptr_t connection) {
+    char      byte     = 0;
+    const int received = recv((socket_t) connection, &byte, 1, MSG_PEEK);
+    return received == SOCKET_ERROR && is_would_block(last_socket_error());
+}
+
+int __cdecl format_request_conditions(
+    _In_ const http_request_t* const restrict request, _Inout_ char* const restrict buffer, _In_ const unsigned long size
+) {
+    const http_validators_t* const conditions = &request->conditions;
+    int                            length     = 0;
+
+    if (request->range_end) { // If-Range takes a single validator and a weak ETag won't do
+        const bool        is_strong = *conditions->etag && strncmp(conditions->etag, "W/", 2);
+        const char* const validator = is_strong ? conditions->etag : conditions->last_modified;
+        length += snprintf(buffer, size, "Range: bytes=%llu-%llu\r\n", request->range_begin, request->range_end - 1);
+        if (*validator) length += snprintf(buffer + length, size - length, "If-Range: %s\r\n", validator);
+        return length;
+    }
+
+    if (*conditions->etag) length += snprintf(buffer + length, size - length, "If-None-Match: %s\r\n", conditions->etag);
+    if (*conditions->last_modified) length += snprintf(buffer + length, size - length, "If-Modified-Since: %s\r\n", conditions->last_modified);
+    return length;
+}
+
+// a server may drop a keep-alive connection while it sits in the pool, the request sent over it then fails or gets no answer at all.
+// GETs are idempotent, so the request goes out once more over a fresh connection, which isn't pooled and can't fail the same way again
+static bool __cdecl resend(_Inout_ http_request_t* const restrict request) {
+    char              host[BUFF_SIZE * 4] = { 0 };
+    socket_request_t* socket_             = &request->socket;
+
+    close_socket((socket_t) socket_->socket);
+    socket_->socket    = (uintptr_t) INVALID_SOCKET;
+    socket_->is_pooled = false;
+    socket_->head = socket_->tail = 0;
+    if (!narrow(request->server, host, sizeof(host))) return false; // socket_get has narrowed the same name before
+
+    const socket_t fresh = connect_to(host, request->port);
+    if (fresh == INVALID_SOCKET) return false; // connect_to will do the error reporting
+    socket_->socket = (uintptr_t) fresh;
+    return send_all(fresh, socket_->buffer + HTTP_CHUNK_SIZE, socket_->request_size, false);
+}
+
+static bool __cdecl socket_get(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint
+) {
+    char host[BUFF_SIZE * 4] = { 0 }, path[HTTP_HEADER_LINE_LENGTH / 2] = { 0 }; // NOLINT(readability-isolate-declaration)
+    char conditions[HTTP_VALIDATOR_LENGTH * 3] = { 0 }; // If-None-Match and If-Modified-Since lines of a conditional request, or the range
+    int  length                                = 0;
+    // ranges are for downloads of binaries. a range refers to the bytes of the encoded body, which can't be cut into pieces that decode on
+    // their own, so ranged requests ask for the body as it is
+    const char* const accept                   = request->range_end ? "*/*" : "text/html";
+    const char* const encodings                = request->range_end ? "identity" : "gzip, deflate";
+
+    if (!narrow(server, host, sizeof(host)) || !narrow(accesspoint, path, sizeof(path))) {
+        fputws(L"Error: server names and paths must be ASCII for the socket transport.\n", stderr);
+        return false;
+    }
+    if (!socket_startup()) return false;
+
+    // the request is kept after the receive buffer, socket_read may have to send it again
+    request->socket.buffer = malloc(HTTP_CHUNK_SIZE + SOCKET_REQUEST_SIZE);
+    if (!request->socket.buffer) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+    request->socket.head = request->socket.tail = 0;
+
+    (void) format_request_conditions(request, conditions, sizeof(conditions));
+    length = snprintf(
+        request->socket.buffer + HTTP_CHUNK_SIZE,
+        SOCKET_REQUEST_SIZE,
+        "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: crawl\r\nAccept: %s\r\nAccept-Encoding: %s\r\nConnection: keep-alive\r\n%s\r\n",
+        path,
+        host,
+        accept,
+        encodings,
+        conditions
+    );
+    if (length < 0 || length >= (int) SOCKET_REQUEST_SIZE) {
+        fputws(L"Error: the request is too long for the socket transport.\n", stderr);
+        free(request->socket.buffer);
+        request->socket.buffer = NULL;
+        return false;
+    }
+    request->socket.request_size = (unsigned long) length;
+
+    uintptr_t pooled          = 0;
+    request->socket.is_pooled = pool_checkout(&socket_transport, server, port, is_idle_socket_usable, &pooled);
+    request->socket.socket    = request->socket.is_pooled ? pooled : (uintptr_t) connect_to(host, port);
+    const socket_t socket_    = (socket_t) request->socket.socket;
+    const char*    message    = request->socket.buffer + HTTP_CHUNK_SIZE;
+    bool           is_sent    = socket_ != INVALID_SOCKET && send_all(socket_, message, (unsigned long) length, request->socket.is_pooled);
+    if (!is_sent && request->socket.is_pooled) is_sent = resend(request);
+    if (!is_sent) {
+        if ((socket_t) request->socket.socket != INVALID_SOCKET) close_socket((socket_t) request->socket.socket);
+        free(request->socket.buffer);
+        request->socket.buffer = NULL;
+        return false;
+    }
+    return true;
+}
+
+static bool __cdecl socket_read(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const http_sink_t sink,
+    _Inout_opt_ void* const context,
+    _Inout_ unsigned long* const restrict size
+) {
+    socket_request_t* const restrict socket_      = &request->socket;
+    bool                             is_read      = false;
+    bool                             is_delimited = false;
+    inflater_t                       inflater     = { 0 };
+    http_sink_t                      body_sink    = sink;
+    void*                            body_context = context;
+    trace_span_t                     span         = trace_begin("first byte", "http"); // up to the end of the header block
+
+    *size = 0;
+    // the first bytes over a pooled connection tell whether the server still had it, see resend
+    if (socket_->is_pooled) {
+        const long received = fill(socket_);
+        if (received < 0 || (!received && !resend(request))) {
+            trace_end(span, 0, 0);
+            goto CLEANUP;
+        }
+    }
+    const bool is_headed = read_headers(request);
+    trace_end(span, 0, 0);
+    if (!is_headed) goto CLEANUP;
+    is_delimited = socket_->is_chunked || socket_->content_length >= 0;
+
+    if (request->status == HTTP_STATUS_NOT_MODIFIED) { // never has a body, whatever its headers say
+        is_read = is_delimited = true;
+        goto CLEANUP;
+    }
+
+    if (request->status < 200 || request->status > 299) {
+        fwprintf_s(stderr, L"Error: the server responded with HTTP status %u.\n", request->status);
+        goto CLEANUP;
+    }
+
+    // an encoded body goes through the decoder, which passes the inflated bytes on to the sink. size still counts the bytes received
+    if (socket_->content_encoding != INFLATE_NONE) {
+        if (!inflater_init(&inflater, socket_->content_encoding, sink, context)) goto CLEANUP; // inflater_init will do the error reporting
+        body_sink    = inflater_push;
+        body_context = &inflater;
+    }
+
+    span = trace_begin("transfer", "http"); // the decoder's and the sink's own spans nest inside this one
+    if (socket_->is_chunked)
+        is_read = read_chunked_body(socket_, body_sink, body_context, size);
+    else
+        is_read = forward(socket_, socket_->content_length, body_sink, body_context, size);
+    trace_end(span, *size, 0);
+
+    // inflater_finish must be called regardless, it releases the window
+    if (socket_->content_encoding != INFLATE_NONE) is_read = inflater_finish(&inflater) && is_read;
+
+CLEANUP:
+    // the connection can carry another request only if this response was delimited by its length and read to the last byte
+    if (is_read && is_delimited && socket_->is_keep_alive && socket_->head == socket_->tail)
+        pool_checkin(&socket_transport, request->server, request->port, socket_->socket, close_pooled_socket);
+    else
+        close_socket((socket_t) socket_->socket);
+    free(socket_->buffer);
+    socket_->buffer = NULL;
+    return is_read;
+}
+
+const http_transport_t socket_transport = { .name = L"socket", .get = socket_get, .read = socket_read };
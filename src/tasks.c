@@ -0,0 +1,51 @@
+#include <project.h>
+
+// a routine on a thread of its own and a future to wait for its result with, which is all it takes for crawl.exe to overlap the work of
+// stages that don't depend on each other. the python probe (see pipes.c) only talks to the file system and maybe a child process, the fetch
+// only to the network, so the probe runs as a task while the page downloads and is parsed and publishing the releases waits on its future.
+// a run costs the longer of the two instead of their sum. there's no pool, the tasks crawl.exe runs are few and live for the whole run
+
+#ifdef _WIN32
+static unsigned long __stdcall task_thread(_In_ void* const context) {
+    task_t* const restrict task = context;
+    task->result                = task->routine(task->argument);
+    return 0;
+}
+#else
+static void* task_thread(_In_ void* const context) {
+    task_t* const restrict task = context;
+    task->result                = task->routine(task->argument);
+    return NULL;
+}
+#endif
+
+void __cdecl task_start(_Inout_ task_t* const restrict task, _In_ const task_routine_t routine, _Inout_opt_ void* const argument) {
+    *task = (task_t) { .routine = routine, .argument = argument, .is_threaded = false, .is_joined = false, .result = false };
+
+#ifdef _WIN32
+    task->thread      = CreateThread(NULL, 0, task_thread, task, 0, NULL);
+    task->is_threaded = task->thread != NULL;
+#else
+    task->is_threaded = !pthread_create(&task->thread, NULL, task_thread, task);
+#endif
+
+    if (!task->is_threaded) {
+        dbgwprintf_s(L"Error %lu in CreateThread, running the task inline\n", GetLastError());
+        task->result    = routine(argument); // the future is complete before it's handed out
+        task->is_joined = true;
+    }
+}
+
+bool __cdecl task_wait(_Inout_ task_t* const restrict task) {
+    if (task->is_joined) return task->result;
+
+    // joining the thread is what makes the routine's writes visible here, no other synchronization needed
+#ifdef _WIN32
+    WaitForSingleObject(task->thread, INFINITE);
+    CloseHandle(task->thread);
+#else
+    pthread_join(task->thread, NULL);
+#endif
+    task->is_joined = true;
+    return task->result;
+}
@@ -0,0 +1,142 @@
+#include <project.h>
+
+// per stage latency tracing. the instrumented stages open a span with trace_begin and close it with trace_end, which hands the timestamps
+// and the byte and release counts to trace_record. events are appended to a buffer allocated by trace_start, a slot is reserved with a single
+// atomic increment so threads never wait on each other, and nothing is formatted until trace_write turns the buffer into Chrome's trace event
+// JSON at the end of the run. with tracing off (the default) trace_begin and trace_counter return right after checking trace_enabled.
+
+#ifdef _WIN32
+    #define reserve_slot()       ((unsigned long) InterlockedIncrement(&next_slot) - 1)
+    #define current_thread_id()  GetCurrentThreadId()
+    #define current_process_id() GetCurrentProcessId()
+#else
+    #include <sys/syscall.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define reserve_slot()       ((unsigned long) __atomic_fetch_add(&next_slot, 1, __ATOMIC_RELAXED))
+    #define current_thread_id()  ((unsigned long) syscall(SYS_gettid))
+    #define current_process_id() ((unsigned long) getpid())
+#endif
+
+#define TRACE_EVENT_JSON_SIZE 256LLU // upper bound of an event's JSON, names and categories are short literals
+
+bool trace_enabled = false;
+
+static trace_event_t*     events    = NULL;
+static volatile long      next_slot = 0; // slots past TRACE_MAX_EVENTS are reserved all the same, they're counted as dropped
+static unsigned long long origin    = 0; // value of trace_ticks when tracing started, the trace's timestamps are relative to it
+static unsigned long long frequency = 0; // ticks per second
+
+[[nodiscard]] unsigned long long __cdecl trace_ticks(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter = { 0 };
+    QueryPerformanceCounter(&counter); // never fails on Windows XP and later
+    return (unsigned long long) counter.QuadPart;
+#else
+    struct timespec now = { 0 };
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000000LLU + (unsigned long long) now.tv_nsec;
+#endif
+}
+
+[[nodiscard]] bool __cdecl trace_start(void) {
+    events = malloc(sizeof(trace_event_t) * TRACE_MAX_EVENTS);
+    if (!events) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return false;
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER counter_frequency = { 0 };
+    QueryPerformanceFrequency(&counter_frequency);
+    frequency = (unsigned long long) counter_frequency.QuadPart;
+#else
+    frequency = 1000000000LLU;
+#endif
+    next_slot     = 0;
+    origin        = trace_ticks();
+    trace_enabled = true;
+    return true;
+}
+
+void __cdecl trace_record(
+    _In_ const char* const restrict name,
+    _In_opt_ const char* const restrict category,
+    _In_ const unsigned long long begin,
+    _In_ const unsigned long long end,
+    _In_ const unsigned long long bytes,
+    _In_ const unsigned long long records
+) {
+    if (!trace_enabled) return; // a span that was still open when trace_write released the buffer
+
+    const unsigned long slot = reserve_slot();
+    if (slot >= TRACE_MAX_EVENTS) [[unlikely]]
+        return;
+    events[slot] = (trace_event_t) {
+        .name = name, .category = category, .begin = begin, .end = end, .bytes = bytes, .records = records, .thread = current_thread_id()
+    };
+}
+
+// microseconds since the trace started, the unit of the trace event format
+static inline double __cdecl microseconds(_In_ const unsigned long long ticks) {
+    return (double) (ticks - origin) * 1000000.0 / (double) frequency;
+}
+
+[[nodiscard("entails expensive file io")]] bool __cdecl trace_write(_In_ const wchar_t* const restrict filename) {
+    trace_enabled = false; // spans still open are dropped by trace_end from here on
+
+    const unsigned long reserved   = (unsigned long) next_slot;
+    const unsigned long count      = reserved < TRACE_MAX_EVENTS ? reserved : TRACE_MAX_EVENTS;
+    const unsigned long size       = (count + 2) * TRACE_EVENT_JSON_SIZE;
+    const unsigned long pid        = current_process_id();
+    bool                is_written = false;
+    int                 length     = 0;
+
+    char* const restrict json = malloc(size);
+    if (!json) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        goto cleanup;
+    }
+
+    length = sprintf_s(json, size, "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"args\":{\"name\":\"crawl\"}}", pid);
+    for (unsigned long i = 0; i < count; ++i) {
+        const trace_event_t event = events[i];
+        if (event.category)
+            length += sprintf_s(
+                json + length,
+                size - length,
+                ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu,\"args\":{\"bytes\":%llu,\"records\":%llu}}",
+                event.name,
+                event.category,
+                microseconds(event.begin),
+                microseconds(event.end) - microseconds(event.begin),
+                pid,
+                event.thread,
+                event.bytes,
+                event.records
+            );
+        else
+            length += sprintf_s(
+                json + length,
+                size - length,
+                ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu,\"args\":{\"value\":%llu}}",
+                event.name,
+                microseconds(event.begin),
+                pid,
+                event.thread,
+                event.bytes
+            );
+    }
+    length += sprintf_s(
+        json + length, size - length, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%lu}}\n", reserved - count
+    );
+
+    if (reserved > count) fwprintf_s(stderr, L"Warning: the trace is missing %lu events, the buffer holds %llu!\n", reserved - count, TRACE_MAX_EVENTS);
+    is_written = __serialize((const unsigned char*) json, (unsigned long) length, filename); // __serialize will do the error reporting
+
+cleanup:
+    free(json);
+    free(events);
+    events = NULL;
+    return is_written;
+}
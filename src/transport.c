@@ -0,0 +1,118 @@
+#include <project.h>
+
+// transport agnostic front doors, everything past transport_get goes through the function pointers of the backend that issued the request
+
+#ifdef _WIN32
+static const http_transport_t* const transports[] = { &winhttp_transport, &socket_transport, &ring_transport };
+#else // WinHttp is Windows only, http.c isn't built elsewhere
+static const http_transport_t* const transports[] = { &socket_transport, &ring_transport };
+#endif
+
+[[nodiscard]] const http_transport_t* __cdecl find_transport(_In_ const wchar_t* const restrict name) {
+    for (unsigned long i = 0; i < sizeof(transports) / sizeof(transports[0]); ++i)
+        if (!wcscmp(transports[i]->name, name)) return transports[i];
+    return NULL;
+}
+
+void __cdecl transport_cleanup(void) {
+    body_drain();
+    pool_drain(); // pooled connections may depend on the state the cleanups release
+
+    for (unsigned long i = 0; i < sizeof(transports) / sizeof(transports[0]); ++i)
+        if (transports[i]->cleanup) transports[i]->cleanup();
+}
+
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get_conditional(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_opt_ const http_validators_t* const restrict conditions
+) {
+    http_request_t request = { 0 };
+    request.port           = port;
+    wcscpy_s(request.server, BUFF_SIZE, server);
+    if (conditions) request.conditions = *conditions; // the backends pick these up from the request
+    if (transport->get(&request, server, port, accesspoint)) request.transport = transport;
+    return request;
+}
+
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint
+) {
+    return transport_get_conditional(transport, server, port, accesspoint, NULL);
+}
+
+[[nodiscard("entails expensive http io")]] http_request_t __cdecl transport_get_range(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const unsigned long long begin,
+    _In_ const unsigned long long end,
+    _In_opt_ const http_validators_t* const restrict validators
+) {
+    http_request_t request = { 0 };
+    request.port           = port;
+    request.range_begin    = begin;
+    request.range_end      = end;
+    wcscpy_s(request.server, BUFF_SIZE, server);
+    if (validators) request.conditions = *validators; // the backends send these as If-Range when there's a range
+    if (transport->get(&request, server, port, accesspoint)) request.transport = transport;
+    return request;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl transport_read(
+    _Inout_ http_request_t* const restrict request,
+    _In_ const http_sink_t sink,
+    _Inout_opt_ void* const context,
+    _Inout_ unsigned long* const restrict size
+) {
+    *size = 0;
+    if (!request->transport) {
+        fputws(__FUNCTIONW__ " failed! (Errors in previous call to transport_get)\n", stderr);
+        return false;
+    }
+    return request->transport->read(request, sink, context, size);
+}
+
+// appends the chunk to the body_t in context, a slab at a time
+static bool __cdecl body_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    return body_append(context, chunk, size); // body_append will do the error reporting
+}
+
+[[nodiscard("entails expensive http io"
+)]] bool __cdecl transport_read_ex(_Inout_ http_request_t* const restrict request, _Inout_ body_t* const restrict body) {
+    if (!request->transport) {
+        fputws(__FUNCTIONW__ " failed! (Errors in previous call to transport_get)\n", stderr);
+        return false;
+    }
+
+    unsigned long received = 0;
+    return request->transport->read(request, body_sink, body, &received);
+}
+
+static bool __cdecl stream_parser_sink(_Inout_opt_ void* const context, _In_ const char* const restrict chunk, _In_ const unsigned long size) {
+    stream_parser_feed(context, chunk, size);
+    return true;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl transport_read_stream(
+    _Inout_ http_request_t* const restrict request, _Inout_ stream_parser_t* const restrict parser, _Inout_ unsigned long* const restrict size
+) {
+    *size = 0;
+    if (!request->transport) {
+        fputws(__FUNCTIONW__ " failed! (Errors in previous call to transport_get)\n", stderr);
+        return false;
+    }
+
+#ifdef _DEBUG // dbgwprintf_s is all that looks at it
+    const unsigned long emitted = parser->emitted;
+#endif
+    const bool is_read = request->transport->read(request, stream_parser_sink, parser, size);
+    dbgwprintf_s(L"%lu bytes streamed through %s, %lu releases parsed on the fly\n", *size, request->transport->name, parser->emitted - emitted);
+    return is_read;
+}
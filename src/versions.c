@@ -0,0 +1,310 @@
+#include <project.h>
+
+// versions as 64 bit keys and the sorted index the release queries run on. a version is parsed once when the index is built, after that
+// every comparison is an integer comparison and every query a binary search over the keys, no matter how many releases a page lists.
+
+// parses the decimal number at text[*offset], at most limit. returns false when there's no digit there or the number is too large
+static bool __cdecl parse_number(
+    _In_ const char* const restrict text,
+    _In_ const unsigned long length,
+    _Inout_ unsigned long* const restrict offset,
+    _In_ const unsigned long limit,
+    _Inout_ unsigned long* const restrict number
+) {
+    const unsigned long begin = *offset;
+    *number                   = 0;
+    for (; *offset < length && text[*offset] >= '0' && text[*offset] <= '9'; ++*offset) {
+        *number = *number * 10 + (unsigned long) (text[*offset] - '0');
+        if (*number > limit) return false;
+    }
+    return *offset > begin;
+}
+
+[[nodiscard]] version_key_t __cdecl version_key(_In_ const char* const restrict text, _In_ const unsigned long length) {
+    unsigned long   offset = 0, major = 0, minor = 0, micro = 0, serial = 0; // NOLINT(readability-isolate-declaration)
+    release_level_t level  = RELEASE_FINAL;
+
+    if (!parse_number(text, length, &offset, 0xFFFF, &major) || offset == length || text[offset++] != '.') return VERSION_KEY_INVALID;
+    if (!parse_number(text, length, &offset, 0xFFFF, &minor)) return VERSION_KEY_INVALID;
+    if (offset < length && text[offset] == '.') {
+        offset++;
+        if (!parse_number(text, length, &offset, 0xFFFF, &micro)) return VERSION_KEY_INVALID;
+    }
+
+    if (offset < length) { // a pre-release tag, a1, b2 or rc3
+        if (text[offset] == 'a')
+            level = RELEASE_ALPHA;
+        else if (text[offset] == 'b')
+            level = RELEASE_BETA;
+        else if (text[offset] == 'r' && offset + 1 < length && text[offset + 1] == 'c') {
+            level = RELEASE_CANDIDATE;
+            offset++;
+        } else
+            return VERSION_KEY_INVALID;
+        offset++;
+        if (!parse_number(text, length, &offset, 0xFFF, &serial)) return VERSION_KEY_INVALID;
+    }
+
+    return offset == length ? VERSION_KEY(major, minor, micro, level, serial) : VERSION_KEY_INVALID;
+}
+
+[[nodiscard]] version_key_t __cdecl system_python_key(_In_opt_ const char* const restrict syspyversion) {
+    if (!syspyversion || strncmp(syspyversion, "Python ", 7)) return VERSION_KEY_INVALID;
+
+    // the version runs up to the line break python --version ends with
+    unsigned long length = 7;
+    while (length < BUFF_SIZE && syspyversion[length] && syspyversion[length] != '\r' && syspyversion[length] != '\n') length++;
+    return version_key(syspyversion + 7, length - 7);
+}
+
+unsigned long __cdecl version_format(_In_ const version_key_t key, _Inout_ char* const restrict buffer, _In_ const unsigned long size) {
+    static const char* const tags[16] = { [RELEASE_ALPHA] = "a", [RELEASE_BETA] = "b", [RELEASE_CANDIDATE] = "rc", [RELEASE_FINAL] = "" };
+    const char* const        tag      = tags[VERSION_LEVEL(key)] ? tags[VERSION_LEVEL(key)] : "?";
+
+    int length = snprintf(buffer, size, "%u.%u.%u", VERSION_MAJOR(key), VERSION_MINOR(key), VERSION_MICRO(key));
+    if (length > 0 && VERSION_LEVEL(key) != RELEASE_FINAL && (unsigned long) length < size)
+        length += snprintf(buffer + length, size - length, "%s%u", tag, (unsigned) (key & 0xFFFU));
+    return length > 0 && (unsigned long) length < size ? (unsigned long) length : 0;
+}
+
+// a release and its key, the index is sorted in this form and split into its parallel arrays afterwards
+typedef struct _index_entry {
+        version_key_t key;
+        uint32_t      row;
+} index_entry_t;
+
+// orders by version, then by position in the results so that releases of the same version keep their page order
+static int __cdecl compare_entries(_In_ const void* const left, _In_ const void* const right) {
+    const index_entry_t* const restrict a = left;
+    const index_entry_t* const restrict b = right;
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    return a->row < b->row ? -1 : a->row > b->row;
+}
+
+[[nodiscard]] bool __cdecl release_index_build(
+    _Inout_ release_index_t* const restrict index, _In_ const results_t results, _In_ const unsigned artifacts
+) {
+    const unsigned long           capacity  = results.count ? results.count : 1;
+    index_entry_t* const restrict entries   = malloc(sizeof(index_entry_t) * capacity);
+    unsigned char* const restrict block     = malloc((sizeof(version_key_t) + sizeof(uint32_t)) * capacity);
+    unsigned long                 count     = 0;
+    version_key_t                 last_key  = VERSION_KEY_INVALID;
+    span_t                        last_span = { .offset = 0, .length = 0 };
+
+    *index = (release_index_t) { .keys = NULL, .rows = NULL, .count = 0 };
+    if (!entries || !block) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        free(entries);
+        free(block);
+        return false;
+    }
+
+    for (unsigned long i = 0; i < results.count; ++i) {
+        if (!(artifacts & ARTIFACT_MASK(results.kinds[i]))) continue;
+
+        // the releases of a version come one after the other on the page, most of the time the key of the previous row will do
+        const span_t version = results.versions[i];
+        if (last_key == VERSION_KEY_INVALID || version.length != last_span.length
+            || memcmp(results.text + version.offset, results.text + last_span.offset, version.length)) {
+            last_key  = version_key(results.text + version.offset, version.length);
+            last_span = version;
+        }
+        if (last_key != VERSION_KEY_INVALID) entries[count++] = (index_entry_t) { .key = last_key, .row = (uint32_t) i };
+    }
+
+    qsort(entries, count, sizeof(index_entry_t), compare_entries);
+
+    index->keys  = (version_key_t*) block;
+    index->rows  = (uint32_t*) (index->keys + capacity);
+    index->count = count;
+    for (unsigned long i = 0; i < count; ++i) {
+        index->keys[i] = entries[i].key;
+        index->rows[i] = entries[i].row;
+    }
+
+    free(entries);
+    return true;
+}
+
+void __cdecl release_index_release(_Inout_ release_index_t* const restrict index) {
+    free(index->keys); // rows live in the same block
+    *index = (release_index_t) { .keys = NULL, .rows = NULL, .count = 0 };
+}
+
+// position of the first key that isn't less than key, count when there's none
+static unsigned long __cdecl lower_bound(_In_ const release_index_t* const restrict index, _In_ const version_key_t key) {
+    unsigned long begin = 0, end = index->count; // NOLINT(readability-isolate-declaration)
+    while (begin < end) {
+        const unsigned long middle = begin + (end - begin) / 2;
+        if (index->keys[middle] < key)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    return begin;
+}
+
+[[nodiscard]] range_t __cdecl release_index_find(_In_ const release_index_t* const restrict index, _In_ const version_key_t key) {
+    const unsigned long begin = lower_bound(index, key);
+    return (range_t) { .begin = begin, .end = key == VERSION_KEY_INVALID ? begin : lower_bound(index, key + 1) };
+}
+
+// the newest final release before position, VERSION_KEY_INVALID when there's none
+static version_key_t __cdecl final_before(_In_ const release_index_t* const restrict index, _In_ const unsigned long position) {
+    for (unsigned long i = position; i > 0; --i) // pre-releases sit right below their final release, there are only a few of them to skip
+        if (VERSION_LEVEL(index->keys[i - 1]) == RELEASE_FINAL) return index->keys[i - 1];
+    return VERSION_KEY_INVALID;
+}
+
+[[nodiscard]] version_key_t __cdecl release_index_latest_patch(
+    _In_ const release_index_t* const restrict index, _In_ const unsigned major, _In_ const unsigned minor
+) {
+    if (major > 0xFFFF || minor >= 0xFFFF) return VERSION_KEY_INVALID;
+
+    // everything of major.minor sits below the first key of the next minor
+    const version_key_t latest = final_before(index, lower_bound(index, VERSION_KEY(major, minor + 1, 0, 0, 0)));
+    return VERSION_MAJOR(latest) == major && VERSION_MINOR(latest) == minor ? latest : VERSION_KEY_INVALID;
+}
+
+[[nodiscard]] version_key_t __cdecl release_index_newest(_In_ const release_index_t* const restrict index, _In_ const version_key_t minimum) {
+    const version_key_t newest = final_before(index, index->count);
+    return newest != VERSION_KEY_INVALID && newest >= minimum ? newest : VERSION_KEY_INVALID;
+}
+
+[[nodiscard]] bool __cdecl release_index_is_outdated(
+    _In_ const release_index_t* const restrict index, _In_ const version_key_t installed, _Inout_ version_key_t* const restrict latest
+) {
+    *latest = release_index_latest_patch(index, VERSION_MAJOR(installed), VERSION_MINOR(installed));
+    return installed != VERSION_KEY_INVALID && *latest > installed;
+}
+
+// the releases of the index range as a view borrowing results' text, matches must be released by the caller even on failure
+static bool __cdecl gather_range(
+    _In_ const results_t results,
+    _In_ const release_index_t* const restrict index,
+    _In_ const range_t range,
+    _Inout_ results_t* const restrict matches
+) {
+    if (!results_init(matches, results.text, range.end - range.begin)) return false; // results_init will do the error reporting
+
+    for (unsigned long i = range.begin; i < range.end; ++i) {
+        const uint32_t row = index->rows[i];
+        if (!results_push(matches, results.versions[row], results.downloadurls[row], (artifact_kind_t) results.kinds[row]))
+            return false; // results_push will do the error reporting
+    }
+    return true;
+}
+
+// the index range of the releases a version query (QUERY_EXACT, QUERY_LATEST or QUERY_NEWEST) asks for, empty when nothing matches
+static range_t __cdecl resolve_query(_In_ const release_index_t* const restrict index, _In_ const query_t query) {
+    version_key_t key = VERSION_KEY_INVALID;
+    switch (query.kind) {
+        case QUERY_EXACT :  key = query.key; break;
+        case QUERY_LATEST : key = release_index_latest_patch(index, VERSION_MAJOR(query.key), VERSION_MINOR(query.key)); break;
+        case QUERY_NEWEST : key = release_index_newest(index, query.key); break;
+        default :           return (range_t) { .begin = 0, .end = 0 };
+    }
+    return release_index_find(index, key);
+}
+
+// prints the verdict of an --outdated query, returns whether the installed version is current
+static bool __cdecl print_verdict(
+    _In_ const version_key_t installed, _In_ const version_key_t latest, _In_ const bool is_outdated, _In_ const output_format_t format
+) {
+    char installed_text[BUFF_SIZE] = { 0 }, latest_text[BUFF_SIZE] = { 0 }; // NOLINT(readability-isolate-declaration)
+    version_format(installed, installed_text, BUFF_SIZE);
+    if (latest != VERSION_KEY_INVALID) version_format(latest, latest_text, BUFF_SIZE);
+
+    switch (format) {
+        case OUTPUT_JSON :
+        case OUTPUT_NDJSON :
+            if (latest != VERSION_KEY_INVALID)
+                wprintf_s(
+                    L"{\"installed\":\"%S\",\"latest\":\"%S\",\"outdated\":%s}\n", installed_text, latest_text, is_outdated ? L"true" : L"false"
+                );
+            else
+                wprintf_s(L"{\"installed\":\"%S\",\"latest\":null,\"outdated\":false}\n", installed_text);
+            break;
+        case OUTPUT_CSV :
+            wprintf_s(L"installed,latest,outdated\n%S,%S,%s\n", installed_text, latest_text, is_outdated ? L"true" : L"false");
+            break;
+        default :
+            if (is_outdated)
+                wprintf_s(
+                    L"Python %S is outdated, %S is the latest %u.%u release\n",
+                    installed_text,
+                    latest_text,
+                    VERSION_MAJOR(latest),
+                    VERSION_MINOR(latest)
+                );
+            else if (latest == VERSION_KEY_INVALID)
+                wprintf_s(
+                    L"Python %S is up to date, there are no %u.%u releases listed\n",
+                    installed_text,
+                    VERSION_MAJOR(installed),
+                    VERSION_MINOR(installed)
+                );
+            else
+                wprintf_s(L"Python %S is up to date\n", installed_text);
+    }
+    return !is_outdated;
+}
+
+[[nodiscard]] bool __cdecl answer_query(
+    _In_ const results_t results,
+    _In_ const unsigned artifacts,
+    _In_opt_ const char* const restrict syspyversion,
+    _In_ const output_format_t format,
+    _In_ const query_t query
+) {
+    release_index_t index       = { 0 };
+    results_t       matches     = { 0 };
+    range_t         range       = { .begin = 0, .end = 0 };
+    bool            is_answered = false;
+
+    if (query.kind == QUERY_NONE) return print_ex(results, artifacts, syspyversion, format); // print_ex will do the error reporting
+    if (!release_index_build(&index, results, artifacts)) return false; // release_index_build will do the error reporting
+
+    if (query.kind == QUERY_OUTDATED) {
+        const version_key_t installed = system_python_key(syspyversion);
+        if (installed == VERSION_KEY_INVALID) {
+            fputws(L"Error: the version of the system python is unknown, nothing to compare!\n", stderr);
+            goto cleanup;
+        }
+        version_key_t latest      = VERSION_KEY_INVALID;
+        const bool    is_outdated = release_index_is_outdated(&index, installed, &latest);
+        is_answered               = print_verdict(installed, latest, is_outdated, format);
+        goto cleanup;
+    }
+
+    range = resolve_query(&index, query);
+    if (range.begin == range.end) {
+        fputws(L"Error: no release matches the query!\n", stderr);
+        goto cleanup;
+    }
+    // the index only holds the requested kinds, there's nothing left to filter. gather_range and print_ex will do the error reporting
+    is_answered = gather_range(results, &index, range, &matches) && print_ex(matches, ARTIFACT_MASK_ALL, syspyversion, format);
+
+cleanup:
+    results_release(&matches);
+    release_index_release(&index);
+    return is_answered;
+}
+
+[[nodiscard]] bool __cdecl select_releases(
+    _In_ const results_t results, _In_ const unsigned artifacts, _In_ const query_t query, _Inout_ results_t* const restrict matches
+) {
+    release_index_t index       = { 0 };
+    bool            is_selected = false;
+
+    if (!release_index_build(&index, results, artifacts)) return false; // release_index_build will do the error reporting
+    const range_t range = resolve_query(&index, query);
+    if (range.begin == range.end)
+        fputws(L"Error: no release matches the query!\n", stderr);
+    else
+        is_selected = gather_range(results, &index, range, matches); // gather_range will do the error reporting
+
+    if (!is_selected) results_release(matches);
+    release_index_release(&index);
+    return is_selected;
+}
@@ -0,0 +1,316 @@
+#include <project.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <signal.h>
+    #include <time.h>
+#endif
+
+// --watch, crawl.exe as a long running poller instead of a cron job that pays for a process start, a connection setup and a full parse on
+// every run. the connection stays in the keep-alive pool between polls and every poll sends the previous response's validators, so an
+// unchanged page costs a 304 over a warm connection. a page that did change is hashed over its stable releases section before anything
+// else, a change elsewhere on the page (a banner, a timestamp) then skips the parse too. releases that do get parsed are sorted by download
+// URL and merged against the previous poll's, one linear pass that yields the added and the removed releases, and only those are printed.
+// while nothing changes the polls back off exponentially, and every delay is jittered so watchers started together don't poll in lockstep
+// the responses land in pooled slabs (see body.c) that are hashed and parsed where they lie, so a poll past the first allocates no buffer
+// for the page
+
+#define WATCH_SLICE 250LLU // milliseconds, the longest the posix sleep goes without checking for a stop request
+
+// a release among the requested artifacts, the merge compares download URLs since they carry the version and the artifact kind both
+typedef struct _watch_entry {
+        const char* url;    // the download URL, in the text of the page's results
+        uint32_t    length; // length of the download URL
+        uint32_t    row;    // index of the release in the page's results
+} watch_entry_t;
+
+// what the last parse of the watched page found, the releases own their text so the response can go back to the pool right away
+typedef struct _watched_page {
+        results_t         results;    // releases of the stable releases section, versions is NULL before the first parse
+        watch_entry_t*    entries;    // the releases among the requested artifacts, sorted by download URL
+        unsigned long     count;      // number of entries
+        uint64_t          hash;       // FNV-1a of the stable releases section
+        http_validators_t validators; // validators of the last response, sent along with the next poll
+} watched_page_t;
+
+typedef enum _poll_outcome {
+    POLL_CHANGED,   // the releases changed, the events have been printed
+    POLL_UNCHANGED, // 304, the same stable releases section or the same releases
+    POLL_FAILED     // the request, the parse or the print failed, the errors have been reported
+} poll_outcome_t;
+
+#ifdef _WIN32
+static HANDLE stop_event = NULL; // signaled by the console control handler, the sleeps between polls wait on it
+
+static BOOL __stdcall on_console_event(_In_ const DWORD type) {
+    if (type != CTRL_C_EVENT && type != CTRL_BREAK_EVENT) return FALSE;
+    SetEvent(stop_event);
+    return TRUE;
+}
+
+static bool __cdecl watch_setup(void) {
+    stop_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!stop_event) {
+        fwprintf_s(stderr, L"Error %lu in CreateEventW.\n", GetLastError());
+        return false;
+    }
+    if (!SetConsoleCtrlHandler(on_console_event, TRUE)) {
+        fwprintf_s(stderr, L"Error %lu in SetConsoleCtrlHandler.\n", GetLastError());
+        CloseHandle(stop_event);
+        return false;
+    }
+    return true;
+}
+
+static void __cdecl watch_teardown(void) {
+    SetConsoleCtrlHandler(on_console_event, FALSE);
+    CloseHandle(stop_event);
+}
+
+// sleeps for delay milliseconds, returns false as soon as a stop was requested
+static bool __cdecl watch_sleep(_In_ const unsigned long long delay) {
+    return WaitForSingleObject(stop_event, (DWORD) delay) == WAIT_TIMEOUT;
+}
+#else
+static volatile sig_atomic_t is_stop_requested = 0;
+
+static void on_signal(_In_ const int signal) {
+    (void) signal;
+    is_stop_requested = 1;
+}
+
+static bool __cdecl watch_setup(void) {
+    struct sigaction action = { 0 };
+    action.sa_handler       = on_signal;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGINT, &action, NULL) || sigaction(SIGTERM, &action, NULL)) {
+        fwprintf_s(stderr, L"Error %d in sigaction.\n", errno);
+        return false;
+    }
+    return true;
+}
+
+static void __cdecl watch_teardown(void) {
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+}
+
+// sleeps for delay milliseconds in slices of at most WATCH_SLICE, returns false as soon as a stop was requested
+static bool __cdecl watch_sleep(_In_ const unsigned long long delay) {
+    for (unsigned long long slept = 0; slept < delay && !is_stop_requested; slept += WATCH_SLICE) {
+        const unsigned long long slice    = delay - slept < WATCH_SLICE ? delay - slept : WATCH_SLICE;
+        const struct timespec    duration = { .tv_sec = (time_t) (slice / 1000), .tv_nsec = (long) (slice % 1000) * 1000000L };
+        nanosleep(&duration, NULL); // a signal cuts the slice short, which is the point
+    }
+    return !is_stop_requested;
+}
+#endif
+
+// FNV-1a, a 64 bit hash of the section only has to tell it from the previous poll's
+static uint64_t __cdecl hash_section(_In_ const body_slice_t* const restrict slices, _In_ const unsigned long count, _In_ const range_t section) {
+    uint64_t      hash = 0xCBF29CE484222325LLU;
+    unsigned long base = 0; // offset of the slice in the body
+    for (unsigned long k = 0; k < count && base < section.end; base += slices[k++].size) {
+        const unsigned long begin = section.begin > base ? section.begin - base : 0;
+        const unsigned long end   = section.end - base < slices[k].size ? section.end - base : slices[k].size;
+        for (unsigned long i = begin; i < end; ++i) hash = (hash ^ (unsigned char) slices[k].data[i]) * 0x100000001B3LLU;
+    }
+    return hash;
+}
+
+// xorshift64, the jitter only has to keep watchers apart, not be unpredictable
+static uint64_t __cdecl next_random(_Inout_ uint64_t* const restrict state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// the interval doubled for every poll in the streak of unchanged or failed ones, capped at WATCH_MAX_BACKOFF_SHIFT doublings, then jittered
+// the "equal jitter" way: half of the delay is kept and the other half is drawn at random, so a delay never drops below half the interval
+static unsigned long long __cdecl next_delay(
+    _In_ const unsigned long long interval, _In_ const unsigned long streak, _Inout_ uint64_t* const restrict state
+) {
+    const unsigned long long delay = interval << (streak < WATCH_MAX_BACKOFF_SHIFT ? streak : WATCH_MAX_BACKOFF_SHIFT);
+    return delay / 2 + next_random(state) % (delay / 2 + 1);
+}
+
+static int __cdecl compare_entries(_In_ const void* const left, _In_ const void* const right) {
+    const watch_entry_t* const restrict a = left;
+    const watch_entry_t* const restrict b = right;
+
+    const int order = memcmp(a->url, b->url, a->length < b->length ? a->length : b->length);
+    if (order) return order;
+    return a->length < b->length ? -1 : a->length > b->length;
+}
+
+// the releases among the requested artifacts sorted by download URL, NULL with a zero count when there are none. caller frees
+static watch_entry_t* __cdecl sort_releases(
+    _In_ const results_t results, _In_ const unsigned artifacts, _Inout_ unsigned long* const restrict count
+) {
+    *count = 0;
+    if (!results.count) return NULL;
+
+    watch_entry_t* const restrict entries = malloc(sizeof(watch_entry_t) * results.count);
+    if (!entries) [[unlikely]] {
+        fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+        return NULL;
+    }
+
+    for (unsigned long i = 0; i < results.count; ++i) {
+        if (!(artifacts & ARTIFACT_MASK(results.kinds[i]))) continue;
+        entries[(*count)++] = (watch_entry_t) {
+            .url = results.text + results.downloadurls[i].offset, .length = results.downloadurls[i].length, .row = (uint32_t) i
+        };
+    }
+    qsort(entries, *count, sizeof(watch_entry_t), compare_entries);
+    return entries;
+}
+
+// merges two sorted runs of releases, the ones only the current poll has go to added and the ones only the previous poll had to removed.
+// both are views that borrow the text of their page's results
+static bool __cdecl diff_releases(
+    _In_ const watched_page_t* const restrict previous,
+    _In_ const watched_page_t* const restrict current,
+    _Inout_ results_t* const restrict added,
+    _Inout_ results_t* const restrict removed
+) {
+    if (!results_init(added, current->results.text, RESULTS_INITIAL_CAPACITY)) return false; // results_init will do the error reporting
+    if (!results_init(removed, previous->results.text, RESULTS_INITIAL_CAPACITY)) return false;
+
+    const results_t now = current->results, before = previous->results; // NOLINT(readability-isolate-declaration)
+    unsigned long   i = 0, j = 0;                                       // NOLINT(readability-isolate-declaration)
+    bool            is_pushed = true;
+
+    while (is_pushed && (i < previous->count || j < current->count)) {
+        const int order = i == previous->count ? 1 : j == current->count ? -1 : compare_entries(previous->entries + i, current->entries + j);
+        if (order < 0) {
+            const uint32_t row = previous->entries[i++].row;
+            is_pushed          = results_push(removed, before.versions[row], before.downloadurls[row], (artifact_kind_t) before.kinds[row]);
+        } else if (order > 0) {
+            const uint32_t row = current->entries[j++].row;
+            is_pushed          = results_push(added, now.versions[row], now.downloadurls[row], (artifact_kind_t) now.kinds[row]);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+    return is_pushed; // results_push will do the error reporting
+}
+
+static void __cdecl release_page(_Inout_ watched_page_t* const restrict page) {
+    results_release(&page->results);
+    free(page->entries);
+    page->entries = NULL;
+    page->count   = 0;
+}
+
+// one round trip to the server, printing the events when the releases changed. the page is only replaced when the poll got as far as a
+// successful print, so a failed poll is diffed against the last good one the next time around
+static poll_outcome_t __cdecl poll_page(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _Inout_ watched_page_t* const restrict page
+) {
+    const bool     is_first = !page->results.versions;
+    watched_page_t current  = { 0 };
+    poll_outcome_t outcome  = POLL_FAILED;
+    body_t         body     = { 0 };
+    body_slice_t   view[BODY_POOL_MAX_IDLE]; // the page is a handful of slabs, larger ones get a heap allocated view
+    body_slice_t*  slices   = view;
+    results_t      added    = { 0 };
+    results_t      removed  = { 0 };
+
+    http_request_t request = transport_get_conditional(transport, server, port, accesspoint, is_first ? NULL : &page->validators);
+    if (!transport_read_ex(&request, &body)) { // transport_read_ex will do the error reporting
+        body_release(&body);
+        fwprintf_s(stderr, L"Error: polling %s failed!\n", accesspoint);
+        return POLL_FAILED;
+    }
+    if (request.status == HTTP_STATUS_NOT_MODIFIED && !is_first) { // a successful read with an empty body
+        body_release(&body);
+        dbgwprintf_s(L"%s has not been modified\n", accesspoint);
+        return POLL_UNCHANGED;
+    }
+    current.validators = request.validators;
+
+    const unsigned long count = body_view(&body, view, BODY_POOL_MAX_IDLE);
+    if (count > BODY_POOL_MAX_IDLE) {
+        slices = malloc(sizeof(body_slice_t) * count);
+        if (!slices) [[unlikely]] {
+            fputws(L"Memory allocation error in " __FUNCTIONW__ "!\n", stderr);
+            goto PREMATURE_RETURN;
+        }
+        (void) body_view(&body, slices, count);
+    }
+
+    const range_t stable = locate_stable_releases_view(slices, count);
+    if (stable.begin == stable.end) {
+        fwprintf_s(stderr, L"Error: %s has no stable releases section!\n", accesspoint);
+        goto PREMATURE_RETURN;
+    }
+
+    current.hash = hash_section(slices, count, stable);
+    if (!is_first && current.hash == page->hash) { // something outside the section changed, the releases can't have
+        dbgwprintf_s(L"the stable releases of %s are unchanged, skipping the parse\n", accesspoint);
+        page->validators = current.validators;
+        outcome          = POLL_UNCHANGED;
+        goto PREMATURE_RETURN;
+    }
+
+    current.results = parse_stable_releases_view(slices, count);
+    if (!current.results.versions) goto PREMATURE_RETURN; // parse_stable_releases_view will do the error reporting
+    current.entries = sort_releases(current.results, artifacts, &current.count);
+    if (current.results.count && !current.entries) goto PREMATURE_RETURN; // sort_releases will do the error reporting
+    if (!diff_releases(page, &current, &added, &removed)) goto PREMATURE_RETURN;
+
+    outcome = POLL_UNCHANGED;
+    if (added.count || removed.count) {
+        if (!print_events(added, removed, format, is_first)) goto PREMATURE_RETURN; // print_events will do the error reporting
+        outcome = POLL_CHANGED;
+    }
+
+    release_page(page); // the events are out, the previous releases have served their purpose
+    *page   = current;
+    current = (watched_page_t) { 0 };
+
+PREMATURE_RETURN:
+    results_release(&added);
+    results_release(&removed);
+    release_page(&current);
+    if (slices != view) free(slices);
+    body_release(&body);
+    return outcome;
+}
+
+[[nodiscard("entails expensive http io")]] bool __cdecl watch(
+    _In_ const http_transport_t* const restrict transport,
+    _In_ const wchar_t* const restrict server,
+    _In_ const unsigned short port,
+    _In_ const wchar_t* const restrict accesspoint,
+    _In_ const unsigned artifacts,
+    _In_ const output_format_t format,
+    _In_ const unsigned long interval
+) {
+    watched_page_t page    = { 0 };
+    poll_outcome_t outcome = POLL_FAILED;
+    unsigned long  streak  = 0; // polls in a row that were unchanged or failed
+    uint64_t       state   = trace_ticks() | 1; // xorshift64 never leaves zero
+
+    if (!watch_setup()) return false; // watch_setup will do the error reporting
+
+    do {
+        const trace_span_t span = trace_begin("poll", "watch");
+        outcome                 = poll_page(transport, server, port, accesspoint, artifacts, format, &page);
+        trace_end(span, 0, page.count);
+        streak = outcome == POLL_CHANGED ? 0 : streak + 1;
+    } while (watch_sleep(next_delay(interval * 1000LLU, streak, &state)));
+
+    release_page(&page);
+    watch_teardown();
+    return outcome != POLL_FAILED;
+}